@@ -0,0 +1,87 @@
+#-------------------------------------------------
+#
+# Headless batch solver, see src/climain.cpp
+#
+#-------------------------------------------------
+
+# The solver and its plot payloads need QtCore only, the plot library is linked by the GUI
+QT        = core
+
+TARGET = flysmps-cli
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+SOURCES += \
+    src/batchsolve.cpp \
+    src/bodekernel.cpp \
+    src/bodekernel_sse2.cpp \
+    src/bodekernel_avx2.cpp \
+    src/bodekernel_avx512.cpp \
+    src/bodeplotdata.cpp \
+    src/bodesweep.cpp \
+    src/bulkcap.cpp \
+    src/capout.cpp \
+    src/climain.cpp \
+    src/comptuner.cpp \
+    src/controlout.cpp \
+    src/designsens.cpp \
+    src/diodebridge.cpp \
+    src/diodeout.cpp \
+    src/discretize.cpp \
+    src/fbptransformer.cpp \
+    src/freqgrid.cpp \
+    src/lcfilter.cpp \
+    src/loggercategories.cpp \
+    src/loopmargin.cpp \
+    src/measfit.cpp \
+    src/modemap.cpp \
+    src/montecarlo.cpp \
+    src/outfilter.cpp \
+    src/plotdecimator.cpp \
+    src/powsuppsolve.cpp \
+    src/rootlocus.cpp \
+    src/statespace.cpp \
+    src/sweepbuffer.cpp \
+    src/swmosfet.cpp \
+    src/transferfunc.cpp \
+
+HEADERS += \
+    inc/batchsolve.h \
+    inc/bodekernel.h \
+    inc/bodeplotdata.h \
+    inc/bodesweep.h \
+    src/bodekernel_simd.h \
+    inc/bulkcap.h \
+    inc/capout.h \
+    inc/comptuner.h \
+    inc/controlout.h \
+    inc/designsens.h \
+    inc/diodebridge.h \
+    inc/diodeout.h \
+    inc/discretize.h \
+    inc/dual.h \
+    inc/fbptransformer.h \
+    inc/freqgrid.h \
+    inc/lcfilter.h \
+    inc/loggercategories.h \
+    inc/loopmargin.h \
+    inc/measfit.h \
+    inc/modemap.h \
+    inc/montecarlo.h \
+    inc/outfilter.h \
+    inc/plotdecimator.h \
+    inc/poolrunner.h \
+    inc/powsuppsolve.h \
+    inc/rootlocus.h \
+    inc/statespace.h \
+    inc/sweepbuffer.h \
+    inc/swmosfet.h \
+    inc/transferfunc.h \
+
+# Default rules for deployment.
+unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
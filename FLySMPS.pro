@@ -35,19 +35,40 @@ SOURCES += \
     coretabmodel.cpp \
     magneticcoredialog.cpp \
     src/FLySMPS.cpp \
+    src/bodekernel.cpp \
+    src/bodekernel_sse2.cpp \
+    src/bodekernel_avx2.cpp \
+    src/bodekernel_avx512.cpp \
+    src/bodeplotdata.cpp \
+    src/bodesweep.cpp \
     src/bulkcap.cpp \
     src/capout.cpp \
+    src/comptuner.cpp \
     src/controlout.cpp \
+    src/designsens.cpp \
     src/diodebridge.cpp \
     src/diodeout.cpp \
+    src/discretize.cpp \
     src/fbptransformer.cpp \
+    src/freqgrid.cpp \
+    src/lcfilter.cpp \
     src/logfilewriter.cpp \
     src/loggercategories.cpp \
+    src/loopmargin.cpp \
     src/main.cpp \
+    src/measfit.cpp \
+    src/modemap.cpp \
+    src/montecarlo.cpp \
     src/outfilter.cpp \
+    src/plotdecimator.cpp \
+    src/plotlink.cpp \
     src/powsuppsolve.cpp \
     #src/qcustomplot.cpp \
+    src/rootlocus.cpp \
+    src/statespace.cpp \
+    src/sweepbuffer.cpp \
     src/swmosfet.cpp \
+    src/transferfunc.cpp \
     qcustomplot/qcustomplot.cpp \
 
 HEADERS += \
@@ -57,18 +78,39 @@ HEADERS += \
     base/singleton.h \
     coretabmodel.h \
     inc/FLySMPS.h \
+    inc/bodekernel.h \
+    inc/bodeplotdata.h \
+    inc/bodesweep.h \
+    src/bodekernel_simd.h \
     inc/bulkcap.h \
     inc/capout.h \
+    inc/comptuner.h \
     inc/controlout.h \
+    inc/designsens.h \
     inc/diodebridge.h \
     inc/diodeout.h \
+    inc/discretize.h \
+    inc/dual.h \
     inc/fbptransformer.h \
+    inc/freqgrid.h \
+    inc/lcfilter.h \
     inc/logfilewriter.h \
     inc/loggercategories.h \
+    inc/loopmargin.h \
+    inc/measfit.h \
+    inc/modemap.h \
+    inc/montecarlo.h \
     inc/outfilter.h \
+    inc/plotdecimator.h \
+    inc/plotlink.h \
+    inc/poolrunner.h \
     inc/powsuppsolve.h \
     #inc/qcustomplot.h \
+    inc/rootlocus.h \
+    inc/statespace.h \
+    inc/sweepbuffer.h \
     inc/swmosfet.h \
+    inc/transferfunc.h \
     magneticcoredialog.h \
     qcustomplot/qcustomplot.h \
 
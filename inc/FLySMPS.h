@@ -36,6 +36,7 @@
 #include "base/coremanager.h"
 #include "base/coremodel.h"
 #include "qcustomplot.h"
+#include "plotlink.h"
 #include "magneticcoredialog.h"
 
 #include "ui_FLySMPS.h"
@@ -77,15 +78,51 @@ private slots:
 
     void initOutFilter();
     void setSolveLCFilter(QHash<QString, double> h_data);
-    void setLCPlot(QVector<double> mg_data, QVector<double> ph_data);
+    void setLCPlot(BodePlotData pl_data);
+
+    void initFilterDesign();
+    void setFilterDesign(QHash<QString, double> h_data);
+    void setFilterDesignPlot(BodePlotData pl_data);
 
     void initPowerStageModel();
     void setPowerStageModel(QHash<QString, double> h_data);
-    void setPowerStagePlot(QVector<double> mg_data, QVector<double> ph_data);
+    void setPowerStagePlot(BodePlotData pl_data);
+
+    void setModeMap(QHash<QString, double> h_data);
+    void setModeMapPlot(ModeMapPlotData pl_data);
+    void showModeMap(int view);
 
     void initOptoFeedbStage();
     void setOptoFeedbStage(QHash<QString, double> h_data);
-    void setOptoFeedbPlot(QVector<double> mg_data, QVector<double> ph_data);
+    void setOptoFeedbPlot(BodePlotData pl_data);
+
+    void initMeasureImport(int32_t target);
+    void setMeasurePlot(int32_t target, BodePlotData pl_data);
+    void setMeasureFit(int32_t target, QHash<QString, double> h_data);
+    void setMeasureFitPlot(int32_t target, BodePlotData pl_data);
+
+    void setLoopGain(QHash<QString, double> h_data);
+    void setLoopPlot(LoopPlotData pl_data);
+    void setCompTuner(QHash<QString, double> h_data);
+
+    void initDigitalComp();
+    void setDigitalComp(QHash<QString, double> h_data);
+    void setDigitalCompPlot(DigitalCompData pl_data);
+
+    void setClosedLoop(QHash<QString, double> h_data);
+    void setClosedLoopPlot(ClosedLoopPlotData pl_data);
+
+    void setLocusGain(QHash<QString, double> h_data);
+    void setLocusPlot(RootLocusPlotData pl_data);
+    void setLocusMarker(int step);
+
+    void setTransient(QHash<QString, double> h_data);
+    void setTransientPlot(TransientPlotData pl_data);
+
+    void setMonteCarlo(QHash<QString, double> h_data);
+    void setMonteCarloPlot(MonteCarloPlotData pl_data);
+
+    void setSensitivity(SensTableData tb_data);
 
     void setUpdateInputValues();
     //void checkCorrect(const QString &text);
@@ -100,19 +137,34 @@ signals:
     void initMosfetValuesComplete();
     void initOutCapValuesComplete();
     void initOutFilterComplete();
+    void initFilterDesignComplete();
     void initPowerStageModelComplete();
     void initOptoFeedbStageComplete();
+    void initMeasureImportComplete(int32_t target, QString path);
+    void initMeasureFitComplete(int32_t target);
+    void initDigitalCompComplete();
     void sendCore(const db::CoreModel*);
 
 private:
     void initOutDCData();
     void initInputValues();
     void initLCPlot();
+    void initLcdPlot();
     void initFCPlot();
     void initSSMplot();
+    void initModeMapPlot();
+    void initMeasureGraphs(QCustomPlot *plot);
+    QCustomPlot *measurePlot(int32_t target);
+    void initLoopPlot();
+    void initDigitalPlot();
+    void initClosedLoopPlot();
+    void initClosedBode(QCustomPlot *plot, const QString &mag_label, double mag_lo, double mag_hi);
+    void initLocusPlot();
+    void initTransientPlot();
+    void initMonteCarloPlot();
+    void plotHistogram(QCustomPlot *plot, const McHistogram &hist, double limit);
     double convertToValues(const QString& input);
     void updateVCData(const QString& input, bool chkval, bool err = false, int16_t vo=0, float io=0.0);
-    double outPwr(const float mrg);
 
     QScopedPointer<Ui::FLySMPS> ui; // Current ui object
     QPointer<PowSuppSolve> m_psolve; // Current solver object, who is work on separated thread
@@ -132,5 +184,8 @@ private:
     QList<QLabel*> cap_out_three;
     QList<QLabel*> cap_out_four;
     QList<QLabel*> cap_out_aux;
+
+    RootLocusPlotData m_locus; // Last root locus, the marker moves along it
+    ModeMapPlotData m_modemap; // Last conduction mode map, the view selects one of its layers
 };
 #endif // FLYSMPS_H
@@ -0,0 +1,92 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef BATCHSOLVE_H
+#define BATCHSOLVE_H
+#include <QIODevice>
+#include <QStringList>
+#include <cstdint>
+
+#define BS_BATCH_SPECS  4096  //Specs read ahead and solved in one pass of the pool, the results are written in between
+#define BS_CHUNK_SPECS  8     //Specs of one pool task
+#define BS_DIGITS       10    //Significant digits of the results
+#define BS_KEY_ID       "id"  //Key of the spec echoed to its result
+
+enum BS_FORMAT
+{
+    BS_FORMAT_JSON = 0, //One object per line
+    BS_FORMAT_CSV  = 1  //Header line with the keys, one record per line
+};
+
+/**
+ * @brief The BsOptions struct - settings of the batch run, the input format
+ *        is taken from the first line, '{' for JSON and the CSV header else
+ */
+struct BsOptions
+{
+    BS_FORMAT out_fmt = BS_FORMAT_JSON;
+    int32_t threads = 0; //Solvers running at once, zero for the ideal thread count
+    int32_t batch = BS_BATCH_SPECS;
+};
+
+/**
+ * @brief The BsStats struct - totals of the batch run
+ */
+struct BsStats
+{
+    int64_t specs = 0;
+    int64_t failed = 0; //Specs with the parse error or the invalid values
+    double elapsed = 0.; //s
+    QString error; //Not empty if the run is stopped, the bad CSV header or the output failure
+};
+
+/**
+ * @brief bsSpecKeys - keys of the spec, the object names of the input fields of the GUI,
+ *        the key left out of the spec takes the default of the form, "id" is echoed to the result
+ */
+QStringList bsSpecKeys();
+
+/**
+ * @brief bsSpecDefault - default of the key as typed into the form
+ */
+QString bsSpecDefault(const QString &key);
+
+/**
+ * @brief bsResultKeys - columns of the result, "section.KEY" with the key of the result hash
+ */
+QStringList bsResultKeys();
+
+/**
+ * @brief bsParseValue - number with the optional SI suffix p, n, u, m, K or M as typed into the form
+ * @return false if the text is not a number
+ */
+bool bsParseValue(const QString &text, double &value);
+
+/**
+ * @brief bsRun - solve the each spec of the input by the whole PowSuppSolve chain without the plots,
+ *        the specs are split into BS_CHUNK_SPECS slices solved on the own QThreadPool by
+ *        one solver per thread, the results go out in the input order after the each batch
+ * @param in - JSON lines or CSV, the empty lines and the lines from '#' are skipped
+ * @param out - JSON lines or CSV with the header, one result per spec
+ * @param opt - settings
+ * @return totals
+ */
+BsStats bsRun(QIODevice &in, QIODevice &out, const BsOptions &opt);
+#endif // BATCHSOLVE_H
@@ -0,0 +1,214 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef BODEKERNEL_H
+#define BODEKERNEL_H
+#include <QtMath>
+#include <QVector>
+#include <cstdint>
+
+/**
+ * The vectorized paths agree with the scalar path within BK_ULP_BOUND
+ * units in the last place for the magnitude in dB and the phase in degree.
+ * The scalar path uses std::log10 and std::atan2 and is the reference.
+ */
+#define BK_ULP_BOUND    4
+
+/**
+ * The fast mode replaces log and atan2 of the vectorized paths by the truncated
+ * atanh series and the odd polynomial of Abramowitz & Stegun 4.4.47. The error
+ * against the exact path is below BK_FAST_MAG_ERR dB and BK_FAST_PHS_ERR degree,
+ * the scalar path has no fast form and stays exact.
+ */
+#define BK_FAST_MAG_ERR 1E-4
+#define BK_FAST_PHS_ERR 1E-3
+
+enum BK_ISA
+{
+    BK_ISA_SCALAR = 0,
+    BK_ISA_SSE2   = 1,
+    BK_ISA_AVX2   = 2,
+    BK_ISA_AVX512 = 3
+};
+
+enum BK_OUT
+{
+    BK_OUT_BODE    = 0, //Magnitude in dB and principal phase in degree
+    BK_OUT_COMPLEX = 1, //Real and imaginary part
+    BK_OUT_BODE_FAST = 2 //As BK_OUT_BODE within BK_FAST_MAG_ERR and BK_FAST_PHS_ERR
+};
+
+enum BK_PREC
+{
+    BK_PREC_EXACT = 0, //Within BK_ULP_BOUND, for the final results
+    BK_PREC_FAST  = 1  //Within BK_FAST_MAG_ERR and BK_FAST_PHS_ERR, for the exploratory sweeps
+};
+
+/**
+ * @brief The BodeFactorsT struct - factored form of the rational response
+ *        H(s) = gain * s^order * prod(1 + s*tz) * prod(1 + s*bz + s^2*az)
+ *                              / prod(1 + s*tp) / prod(1 + s*bp + s^2*ap)
+ *        The first order factor with negative time constant is the rhp zero/pole.
+ *        The scalar T is double for the sweeps and Dual for the gradients, see dual.h
+ */
+template<typename T>
+struct BodeFactorsT
+{
+    T gain = 1.;
+    int32_t order = 0; //Number of differentiators, negative for integrators
+    QVector<T> tz; //1/\omega_{z}
+    QVector<T> tp; //1/\omega_{p}
+    QVector<T> bz; //1/(Q\omega_{0}) of the zero pair
+    QVector<T> az; //1/\omega_{0}^2 of the zero pair
+    QVector<T> bp; //1/(Q\omega_{0}) of the pole pair
+    QVector<T> ap; //1/\omega_{0}^2 of the pole pair
+
+    /**
+     * @brief bfAddZero - (1 + s/omega), negative omega for the rhp zero
+     */
+    inline void bfAddZero(T omega) {tz.push_back(1./omega);}
+
+    /**
+     * @brief bfAddPole - 1/(1 + s/omega)
+     */
+    inline void bfAddPole(T omega) {tp.push_back(1./omega);}
+
+    /**
+     * @brief bfAddZeroPair - (1 + s/(Q*omega) + s^2/omega^2)
+     */
+    inline void bfAddZeroPair(T omega, T qual)
+    {
+        bz.push_back(1./(qual * omega));
+        az.push_back(1./(omega * omega));
+    }
+
+    /**
+     * @brief bfAddPolePair - 1/(1 + s/(Q*omega) + s^2/omega^2)
+     */
+    inline void bfAddPolePair(T omega, T qual)
+    {
+        bp.push_back(1./(qual * omega));
+        ap.push_back(1./(omega * omega));
+    }
+
+    /**
+     * @brief bfAddZeroQuad - (1 + s*b + s^2*a), the quadratic with real roots is allowed
+     */
+    inline void bfAddZeroQuad(T b, T a)
+    {
+        bz.push_back(b);
+        az.push_back(a);
+    }
+
+    /**
+     * @brief bfAddPoleQuad - 1/(1 + s*b + s^2*a), the quadratic with real roots is allowed
+     */
+    inline void bfAddPoleQuad(T b, T a)
+    {
+        bp.push_back(b);
+        ap.push_back(a);
+    }
+
+    /**
+     * @brief bfAppend - series connection with the other response
+     */
+    inline void bfAppend(const BodeFactorsT &rhs)
+    {
+        gain *= rhs.gain;
+        order += rhs.order;
+        tz += rhs.tz;
+        tp += rhs.tp;
+        bz += rhs.bz;
+        az += rhs.az;
+        bp += rhs.bp;
+        ap += rhs.ap;
+    }
+};
+
+typedef BodeFactorsT<double> BodeFactors;
+
+/**
+ * @brief bkActiveIsa - instruction set selected by the cpu dispatch at first call
+ * @return
+ */
+BK_ISA bkActiveIsa();
+
+/**
+ * @brief bkSetIsa - force the instruction set, the unsupported one is lowered to the best available
+ * @param isa
+ */
+void bkSetIsa(BK_ISA isa);
+
+/**
+ * @brief bkEvalBode - magnitude in dB and principal phase in degree for each frequency point
+ * @param bf - factored response
+ * @param freq - frequency points in Hz
+ * @param num - number of points
+ * @param mag - out magnitude
+ * @param phs - out phase, use bkUnwrapPhase for the continuous one
+ * @param prec - exact or fast transcendental functions
+ */
+void bkEvalBode(const BodeFactors &bf, const double *freq, int32_t num, double *mag, double *phs,
+                BK_PREC prec = BK_PREC_EXACT);
+
+/**
+ * @brief bkEvalComplex - complex response for each frequency point
+ * @param bf - factored response
+ * @param freq - frequency points in Hz
+ * @param num - number of points
+ * @param re - out real part
+ * @param im - out imaginary part
+ */
+void bkEvalComplex(const BodeFactors &bf, const double *freq, int32_t num, double *re, double *im);
+
+/**
+ * @brief bkComplexToBode - magnitude in dB and principal phase in degree of the complex sequence
+ */
+void bkComplexToBode(const double *re, const double *im, int32_t num, double *mag, double *phs,
+                     BK_PREC prec = BK_PREC_EXACT);
+
+/**
+ * @brief bkUnwrapPhase - remove the 360 degree jumps between the neighbour points
+ * @param phs - phase sequence in degree
+ * @param num - number of points
+ */
+void bkUnwrapPhase(double *phs, int32_t num);
+
+/**
+ * @brief bkEvalBode - QVector form of the sweep, the phase is unwrapped
+ */
+void bkEvalBode(const BodeFactors &bf, const QVector<double> &freq, QVector<double> &mag, QVector<double> &phs,
+                BK_PREC prec = BK_PREC_EXACT);
+
+/** Instruction set specific paths, see bkEvalBode */
+void bkEvalScalar(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode);
+void bkPolarScalar(const double *re, const double *im, int32_t num, double *mag, double *phs);
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define BK_HAVE_X86
+void bkEvalSSE2(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode);
+void bkPolarSSE2(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_OUT mode);
+#if defined(__GNUC__)
+#define BK_HAVE_AVX
+void bkEvalAVX2(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode);
+void bkPolarAVX2(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_OUT mode);
+void bkEvalAVX512(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode);
+void bkPolarAVX512(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_OUT mode);
+#endif
+#endif
+#endif // BODEKERNEL_H
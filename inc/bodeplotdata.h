@@ -0,0 +1,260 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef BODEPLOTDATA_H
+#define BODEPLOTDATA_H
+#include <QSharedPointer>
+#include <QMetaType>
+#include <QStringList>
+#include <cstdint>
+#include "plotdecimator.h"
+#include "sweepbuffer.h"
+#include "rootlocus.h"
+#include "statespace.h"
+#include "montecarlo.h"
+#include "designsens.h"
+#include "discretize.h"
+#include "modemap.h"
+
+/**
+ * @brief The BodePlotData struct - graph data of one sweep, built once in the
+ *        solver thread and handed to the GUI thread by the shared pointer.
+ *        The min/max pyramids are ready on arrival, the GUI thread only picks
+ *        the points of the visible range.
+ */
+struct BodePlotData
+{
+    QSharedPointer<const PlotDecimator> mag;
+    QSharedPointer<const PlotDecimator> phs;
+};
+Q_DECLARE_METATYPE(BodePlotData)
+
+/**
+ * @brief The CurvePlotData struct - points of the parametric curve,
+ *        the index of the point is the parameter t of the curve
+ */
+struct CurvePlotData
+{
+    QVector<double> key;
+    QVector<double> value;
+};
+
+/**
+ * @brief The ColorMapPlotData struct - cells of the color map over the uniform
+ *        key and value steps, the range is of the cell centres
+ */
+struct ColorMapPlotData
+{
+    int32_t key_num = 0;
+    int32_t value_num = 0;
+    double key_min = 0.;
+    double key_max = 0.;
+    double value_min = 0.;
+    double value_max = 0.;
+    QVector<double> cell; //Row of the keys by row of the values
+};
+
+/**
+ * @brief bpdFromSweep - graph data of magnitude and phase from the sweep buffer
+ * @param buf - sweep buffer of the analysis
+ * @return
+ */
+BodePlotData bpdFromSweep(const SweepBuffer &buf);
+
+/**
+ * @brief bpdFromPoints - graph data of magnitude and phase from the plain sequences,
+ *        the imported measure and the fitted response on its frequencies
+ * @param freq - frequency points in Hz, ascending
+ * @param mag - magnitude in dB
+ * @param phs - phase in degree
+ * @param num - number of points
+ * @return
+ */
+BodePlotData bpdFromPoints(const double *freq, const double *mag, const double *phs, int32_t num);
+
+/**
+ * @brief The LoopPlotData struct - Bode, Nyquist and Nichols views of the loop gain,
+ *        all three are taken from the one complex sweep of the loop.
+ *        The curve keeps the sweep order in the parameter t of the points.
+ */
+struct LoopPlotData
+{
+    BodePlotData bode;
+    CurvePlotData nyquist; //Re(T), Im(T)
+    CurvePlotData nichols; //Phase in degree, magnitude in dB
+};
+Q_DECLARE_METATYPE(LoopPlotData)
+
+/**
+ * @brief lpdFromSweep - loop views from the sweep buffer with the complex part
+ * @param buf - loop sweep filled by lmSweepLoop
+ * @return
+ */
+LoopPlotData lpdFromSweep(const SweepBuffer &buf);
+
+/**
+ * @brief The ClosedLoopPlotData struct - closed loop gain, output impedance and audio susceptibility,
+ *        taken from the same pass as the loop gain
+ */
+struct ClosedLoopPlotData
+{
+    BodePlotData closed; //T/(1 + T)
+    BodePlotData zout; //Magnitude in dBOhm
+    BodePlotData audio; //Line to output
+};
+Q_DECLARE_METATYPE(ClosedLoopPlotData)
+
+/**
+ * @brief cpdFromSweep - closed loop views from the sweep buffers filled by lmSweepLoop
+ * @return
+ */
+ClosedLoopPlotData cpdFromSweep(const SweepBuffer &closed, const SweepBuffer &zout, const SweepBuffer &audio);
+
+/**
+ * @brief The RootLocusPlotData struct - s-plane view of the closed loop poles,
+ *        one curve for each branch with the gain step in the parameter t.
+ *        The locus is kept for the marker of the selected multiplier.
+ */
+struct RootLocusPlotData
+{
+    QSharedPointer<const RootLocus> locus;
+    QVector<CurvePlotData> branch; //Re, Im of the branch in rad/s
+    CurvePlotData poles; //Open loop poles
+    CurvePlotData zeros; //Open loop zeros
+    double ctr = 0.; //CTR of the unit multiplier
+    double span = 0.; //Half width of the initial view around origin, rad/s
+};
+Q_DECLARE_METATYPE(RootLocusPlotData)
+
+/**
+ * @brief rpdFromLocus - branch curves of the solved locus
+ * @param rl - solved locus
+ * @return
+ */
+RootLocusPlotData rpdFromLocus(const QSharedPointer<const RootLocus> &rl);
+
+/**
+ * @brief The TransientPlotData struct - output deviation after the load and line steps,
+ *        time in ms on the key, volt on the value
+ */
+struct TransientPlotData
+{
+    QSharedPointer<const PlotDecimator> load;
+    QSharedPointer<const PlotDecimator> line;
+    double span = 0.; //Simulated time, ms
+};
+Q_DECLARE_METATYPE(TransientPlotData)
+
+/**
+ * @brief tpdFromStep - graph data of the simulated steps
+ * @param load - response to the load current step
+ * @param line - response to the input voltage step
+ * @return
+ */
+TransientPlotData tpdFromStep(const StepResponse &load, const StepResponse &line);
+
+/**
+ * @brief The MonteCarloPlotData struct - histograms of the margins and the crossover
+ *        over the samples with the limits of the acceptance
+ */
+struct MonteCarloPlotData
+{
+    McHistogram phase_marg; //Degree
+    McHistogram gain_marg; //dB
+    McHistogram freq_cross; //kHz
+    double phase_limit = 0.;
+    double gain_limit = 0.;
+};
+Q_DECLARE_METATYPE(MonteCarloPlotData)
+
+/**
+ * @brief mpdFromRun - graph data of the Monte Carlo run
+ * @param res - margins of the samples
+ * @param lim - acceptance of the sample
+ * @return
+ */
+MonteCarloPlotData mpdFromRun(const McResult &res, const McLimits &lim);
+
+/**
+ * @brief The SensTableData struct - elasticities of the design outputs,
+ *        the row per output and the column per input, the percent of the output
+ *        changed by the one percent of the input
+ */
+struct SensTableData
+{
+    QStringList rows;
+    QStringList cols;
+    QVector<double> value; //Output values, row order
+    QVector<QVector<double>> elast;
+};
+Q_DECLARE_METATYPE(SensTableData)
+
+/**
+ * @brief spdFromRun - table data of the sensitivity run
+ * @param res - outputs and gradients of the design
+ * @return
+ */
+SensTableData spdFromRun(const DsResult &res);
+
+/**
+ * @brief The DigitalCompData struct - analog and sampled compensator with the sampled loop,
+ *        the quantized sections are kept for the coefficient listing
+ */
+struct DigitalCompData
+{
+    BodePlotData analog; //Continuous compensator
+    BodePlotData digital; //Quantized compensator up to the Nyquist frequency
+    BodePlotData loop; //Loop gain with the quantized compensator and the sampling delay
+    DzQuantized coeff;
+};
+Q_DECLARE_METATYPE(DigitalCompData)
+
+/**
+ * @brief dpdFromRun - graph data of the discretized compensator
+ * @param analog - sweep of the continuous compensator
+ * @param digital - sweep of the quantized compensator
+ * @param loop - sweep of the sampled loop
+ * @param qnt - quantized sections
+ * @return
+ */
+DigitalCompData dpdFromRun(const SweepBuffer &analog, const SweepBuffer &digital, const SweepBuffer &loop,
+                           const DzQuantized &qnt);
+
+/**
+ * @brief The ModeMapPlotData struct - color maps of the conduction mode over the line
+ *        in V rms on the key and the load in percent on the value, with the boundary curve
+ */
+struct ModeMapPlotData
+{
+    ColorMapPlotData mode; //0 - CCM, 1 - BCM, 2 - DCM
+    ColorMapPlotData ind_crit; //L_{crit}, uH
+    ColorMapPlotData margin; //Percent of L_{crit}
+    CurvePlotData bound; //Boundary load over the line
+    double ind_prim = 0.; //L_{p}, uH, the level of the boundary on the inductance view
+};
+Q_DECLARE_METATYPE(ModeMapPlotData)
+
+/**
+ * @brief mmpdFromMap - color map data of the solved map
+ * @param map - solved map
+ * @param ind_prim - primary inductance, H
+ * @return
+ */
+ModeMapPlotData mmpdFromMap(const MmMap &map, double ind_prim);
+#endif // BODEPLOTDATA_H
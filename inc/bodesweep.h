@@ -0,0 +1,99 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef BODESWEEP_H
+#define BODESWEEP_H
+#include "bodekernel.h"
+
+#define BS_CHUNK_POINTS   1024 //Points of one task, in/out slices of the chunk fit into L1 cache
+
+/**
+ * The sweep is split into BS_CHUNK_POINTS slices evaluated on the global
+ * QThreadPool, every task writes only its own slice of the preallocated output.
+ * Each point is computed from its own frequency only, the phase is unwrapped
+ * serially after all slices are done, so the result does not depend on
+ * the number of threads.
+ */
+
+/**
+ * @brief bsSweepBode - chunked parallel form of bkEvalBode, the phase is unwrapped
+ * @param bf - factored response
+ * @param freq - frequency points in Hz
+ * @param mag - out magnitude in dB, resized to the frequency points
+ * @param phs - out phase in degree, resized to the frequency points
+ * @param prec - exact or fast transcendental functions
+ */
+void bsSweepBode(const BodeFactors &bf, const QVector<double> &freq, QVector<double> &mag, QVector<double> &phs,
+                 BK_PREC prec = BK_PREC_EXACT);
+
+/**
+ * @brief bsSweepBode - pointer form of the sweep into the preallocated output
+ * @param bf - factored response
+ * @param freq - frequency points in Hz
+ * @param num - number of points
+ * @param mag - out magnitude in dB
+ * @param phs - out unwrapped phase in degree
+ * @param prec - exact or fast transcendental functions
+ */
+void bsSweepBode(const BodeFactors &bf, const double *freq, int32_t num, double *mag, double *phs,
+                 BK_PREC prec = BK_PREC_EXACT);
+
+/**
+ * @brief bsSweepComplex - chunked parallel form of bkEvalComplex
+ * @param bf - factored response
+ * @param freq - frequency points in Hz
+ * @param num - number of points
+ * @param re - out real part
+ * @param im - out imaginary part
+ */
+void bsSweepComplex(const BodeFactors &bf, const double *freq, int32_t num, double *re, double *im);
+
+/**
+ * @brief bsSweepClosedLoop - loop gain and the closed loop responses in one pass over the points,
+ *        each slice evaluates the loop once and divides the open loop paths by 1 + T while
+ *        the slice is in cache
+ * @param loop - factored open loop gain T
+ * @param path - factored open loop paths from the disturbance to the output
+ * @param freq - frequency points in Hz
+ * @param num - number of points
+ * @param loop_re - out real part of T
+ * @param loop_im - out imaginary part of T
+ * @param loop_mag - out magnitude of T in dB
+ * @param loop_phs - out principal phase of T in degree
+ * @param mag - out magnitude of T/(1 + T) and then of each path/(1 + T), path.size() + 1 arrays
+ * @param phs - out unwrapped phase, as mag
+ * @param prec - exact or fast transcendental functions
+ */
+void bsSweepClosedLoop(const BodeFactors &loop, const QVector<BodeFactors> &path, const double *freq, int32_t num,
+                       double *loop_re, double *loop_im, double *loop_mag, double *loop_phs,
+                       const QVector<double*> &mag, const QVector<double*> &phs, BK_PREC prec = BK_PREC_EXACT);
+
+/**
+ * @brief bsSweepFamily - sweep of the several operating points on the same frequency points,
+ *        the tasks are distributed over the operating points and the slices together
+ * @param family - factored response of each operating point
+ * @param freq - frequency points in Hz
+ * @param mag - out magnitude of each operating point
+ * @param phs - out phase of each operating point
+ * @param prec - exact or fast transcendental functions
+ */
+void bsSweepFamily(const QVector<BodeFactors> &family, const QVector<double> &freq,
+                   QVector<QVector<double>> &mag, QVector<QVector<double>> &phs,
+                   BK_PREC prec = BK_PREC_EXACT);
+#endif // BODESWEEP_H
@@ -21,15 +21,21 @@
 #define BULKCAP_H
 #include <QtMath>
 #include <cstdint>
+#include "dual.h"
 
-class BulkCap
+/**
+ * @brief The BulkCapT class - the model on the scalar T, double for the design
+ *        and Dual for the gradients along the inputs, see dual.h
+ */
+template<typename T>
+class BulkCapT
 {
 private:
-    int16_t ac_inp_volt_max;
-    int16_t ac_inp_volt_min;
-    float efficiency;
-    float pow_max_out;
-    float freq_line;
+    T ac_inp_volt_max;
+    T ac_inp_volt_min;
+    T efficiency;
+    T pow_max_out;
+    T freq_line;
     int16_t v_dc_in_rippl = 30;
 
 public:
@@ -41,9 +47,9 @@ public:
      * @param pout - Total max power output W
      * @param fl - Line frequency default 50Hz
      */
-    BulkCap(int16_t max_volt, int16_t min_volt,
-            float eff, float pout,
-            float fl = 50.0f)
+    BulkCapT(T max_volt, T min_volt,
+             T eff, T pout,
+             T fl = T(50.0f))
         :ac_inp_volt_max(max_volt)
         ,ac_inp_volt_min(min_volt)
         ,efficiency(eff)
@@ -55,10 +61,10 @@ public:
      * @brief DeltaT - The total refueling time from Vmin to Vpeak
      * @return Calculating time value from Vmin to Vpeak
      */
-    double DeltaT() const
+    T DeltaT() const
     {
-        double num = qAsin(ac_inp_volt_min / (ac_inp_volt_min * M_SQRT2));
-        double dnm = 2.0 * M_PI * (static_cast<double>(freq_line));
+        T num = qAsin(ac_inp_volt_min / (ac_inp_volt_min * M_SQRT2));
+        T dnm = 2.0 * M_PI * freq_line;
         return num/dnm;
     }
 
@@ -66,9 +72,9 @@ public:
      * @brief ChargTime - The total charging time
      * @return total charging time value
      */
-    double ChargTime() const
+    T ChargTime() const
     {
-        double frq_coeff = 1.0 / (4.0 * static_cast<double>(freq_line));
+        T frq_coeff = 1.0 / (4.0 * freq_line);
         return frq_coeff - DeltaT();
     }
 
@@ -76,14 +82,14 @@ public:
      * @brief CapValue - Calculate the bulk capacitor value
      * @return bulk capacitor value
      */
-    double CapValue() const
+    T CapValue() const
     {
-        double pwr_coeff = 2.0 * static_cast<double>(pow_max_out);
-        double frq_coeff = 1.0 / (4.0 * static_cast<double>(freq_line));
-        double num = pwr_coeff * (frq_coeff + DeltaT());
-        double v_dc_min = ac_inp_volt_min * M_SQRT2 * 0.75;
-        double v_min_pre = v_dc_min - v_dc_in_rippl;
-        double dnm = static_cast<double>(efficiency) * (qPow(v_dc_min, 2) - qPow(v_min_pre, 2));
+        T pwr_coeff = 2.0 * pow_max_out;
+        T frq_coeff = 1.0 / (4.0 * freq_line);
+        T num = pwr_coeff * (frq_coeff + DeltaT());
+        T v_dc_min = ac_inp_volt_min * M_SQRT2 * 0.75;
+        T v_min_pre = v_dc_min - v_dc_in_rippl;
+        T dnm = efficiency * (qPow(v_dc_min, 2) - qPow(v_min_pre, 2));
         return num / dnm;
      }
 
@@ -91,27 +97,27 @@ public:
      * @brief ILoadMax - Load peak current value
      * @return peak current value
      */
-    double ILoadMax() const
+    T ILoadMax() const
     {
-        return (static_cast<double>(pow_max_out))/(static_cast<double>(efficiency)*(ac_inp_volt_min/qSqrt(2)));
+        return pow_max_out/(efficiency*(ac_inp_volt_min/qSqrt(2)));
     }
 
     /**
      * @brief ILoadMin - Load minimum current value
      * @return minimum current value
      */
-    double ILoadMin() const
+    T ILoadMin() const
     {
-        return (static_cast<double>(pow_max_out))/(static_cast<double>(efficiency)*(ac_inp_volt_max/qSqrt(2)));
+        return pow_max_out/(efficiency*(ac_inp_volt_max/qSqrt(2)));
     }
 
     /**
      * @brief IBulkCapPeak - The bulk capacitor peak current
      * @return bulk capacitor peak current A
      */
-    double IBulkCapPeak() const
+    T IBulkCapPeak() const
     {
-        return 2. * M_PI * static_cast<double>(freq_line) * CapValue() * (ac_inp_volt_min * M_SQRT2) * (qCos(2. * M_PI * static_cast<double>(freq_line) * DeltaT()));
+        return 2. * M_PI * freq_line * CapValue() * (ac_inp_volt_min * M_SQRT2) * (qCos(2. * M_PI * freq_line * DeltaT()));
     }
 
     /**
@@ -120,27 +126,29 @@ public:
      * @param dio_cond_time - total conduction time for diode
      * @return bulk capacitor RMS current
      */
-    double IBulkCapRMS(double dio_av_curr, double dio_cond_time) const
+    T IBulkCapRMS(T dio_av_curr, T dio_cond_time) const
     {
-        return dio_av_curr*(qSqrt((2./(3.*static_cast<double>(freq_line)*dio_cond_time))-1));
+        return dio_av_curr*(qSqrt((2./(3.*freq_line*dio_cond_time))-1));
     }
 
     /**
      * @brief VMinInp - Recalculation after input capacitor selection
      * @return recalculation after input capacitor selection
      */
-    double VMinInp() const
+    T VMinInp() const
     {
-        return qSqrt(qPow((ac_inp_volt_min * M_SQRT2),2)-((2.*static_cast<double>(pow_max_out)*((1./(4.*static_cast<double>(freq_line))-DeltaT())))/CapValue()));
+        return qSqrt(qPow((ac_inp_volt_min * M_SQRT2),2)-((2.*pow_max_out*((1./(4.*freq_line)-DeltaT())))/CapValue()));
     }
 
     /**
      * @brief VDCMin - simply the average value of MinInp and VRectMinPeak
      * @return simply the average value of MinIng and VRectMinPeak
      */
-    double VDCMin() const
+    T VDCMin() const
     {
         return 0.5 * ((ac_inp_volt_min * M_SQRT2) + VMinInp());
     }
 };
+
+typedef BulkCapT<double> BulkCap;
 #endif // BULKCAP_H
@@ -21,6 +21,7 @@
 #define CAPOUT_H
 #include <QtMath>
 #include <cstdint>
+#include "dual.h"
 
 struct CapOutProp
 {
@@ -36,8 +37,10 @@ struct CapOutProp
  *        See more:
  *        UCC28722-UCC28720 5W USB BJT Flyback Design Example
  *        MAXREFDES1036.-20.25W Offline Flyback Converter Using MAX17595
+ *        The primary current is the scalar T, the capacitor data are the constants of the part
  */
-class CapOut
+template<typename T>
+class CapOutT
 {
 private:
     CapOutProp m_cop;
@@ -60,7 +63,7 @@ private:
         return m_cop.co_curr_peak_out/2;
     }
 public:
-    CapOut(CapOutProp& cop)
+    CapOutT(CapOutProp& cop)
     {
         qSwap(m_cop, cop);
     }
@@ -91,9 +94,9 @@ public:
      * @param actual_max_duty_cycle - actual switching duty cycle
      * @return rms current in A
      */
-    inline double ocCurrOurRMS(double curr_pri_peak, float trn_rat_curr) const
+    inline T ocCurrOurRMS(T curr_pri_peak, float trn_rat_curr) const
     {
-        double num = 2. * curr_pri_peak;
+        T num = 2. * curr_pri_peak;
         double dnm = 3. * trn_rat_curr * m_cop.co_curr_peak_out;
         return m_cop.co_curr_peak_out * qSqrt((num / dnm) - 1);
     }
@@ -114,10 +117,10 @@ public:
      * @param ncap
      * @return
      */
-    inline double ocOutRippleVolt(double curr_pri_peak, double cap_out, float trn_rat, uint32_t freq_switch) const
+    inline T ocOutRippleVolt(T curr_pri_peak, T cap_out, float trn_rat, uint32_t freq_switch) const
     {
-        double num = 4.5 * qPow((curr_pri_peak - (trn_rat * 4.5)), 2);
-        double dnm = qPow(curr_pri_peak, 2) * freq_switch * cap_out;
+        T num = 4.5 * qPow((curr_pri_peak - (trn_rat * 4.5)), 2);
+        T dnm = qPow(curr_pri_peak, 2) * freq_switch * cap_out;
         return num / dnm;
     }
 
@@ -126,10 +129,12 @@ public:
      * @param actual_max_duty_cycle  - actual_max_duty_cycle for rms current
      * @return losses in W
      */
-    inline double ocCapOutLoss(double cur_cap_rms) const
+    inline T ocCapOutLoss(T cur_cap_rms) const
     {
         return qPow(cur_cap_rms, 2)*ocESRCapOut();
     }
 };
 
+typedef CapOutT<double> CapOut;
+
 #endif // CAPOUT_H
@@ -0,0 +1,140 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef COMPTUNER_H
+#define COMPTUNER_H
+#include <QVector>
+#include <cstdint>
+#include "transferfunc.h"
+#include "loopmargin.h"
+
+#define CT_RATIO_SPAN      30.    //Compensator zero below and optocoupler pole above the crossover, up to span times
+#define CT_CAP_WIDEN       2.     //Widening of the zero capacitor range over the mid-band estimate of R_f
+#define CT_RES_MIN         100.   //Lowest R_{f}, Ohm
+#define CT_RES_MAX         1E6    //Highest R_{f}, Ohm
+#define CT_CAP_MIN         1E-11  //Lowest C_{f} and C_{opto}, F
+#define CT_CAP_MAX         1E-5   //Highest C_{f} and C_{opto}, F
+#define CT_CROSS_WEIGHT    1E4    //Cost of the crossover error per decade squared, the margin deficit costs per degree or dB squared
+#define CT_NO_CROSS_COST   1E9    //Cost of the corner without the crossover
+#define CT_REFINE_ITER_MAX 50     //Moves of the lattice search
+#define CT_GAIN_MARG       10.    //Default gain margin target, dB
+#define CT_CTR_SPREAD      3.     //Highest CTR of the optocoupler, multiple of the minimum one
+#define CT_LIGHT_LOAD      0.1    //Light load corner, part of the full load
+
+/**
+ * Preferred number series IEC 60063, the value is the number of the steps per decade
+ */
+enum CT_SERIES
+{
+    CT_E6  = 6,
+    CT_E12 = 12,
+    CT_E24 = 24,
+    CT_E48 = 48,
+    CT_E96 = 96
+};
+
+/**
+ * @brief The TunerTarget struct - goal of the tune, the crossover is met on the
+ *        nominal corner and the margins on the worst corner
+ */
+struct TunerTarget
+{
+    double freq_cross; //Hz
+    double phase_marg; //Degree
+    double gain_marg; //dB
+    double freq_begin; //Search range of the margins, Hz
+    double freq_end;
+};
+
+/**
+ * @brief The TunerNetwork struct - fixed part of the type 2 compensator
+ *        H_{c}(s) = K(R_{f} + 1/(sC_{f}))/(1 + sR_{pullup}C_{opto})
+ */
+struct TunerNetwork
+{
+    double gain_per_res; //K = K_{c}/R_{up} at the minimum CTR, 1/Ohm
+    double res_pull_up; //R_{pullup}, Ohm
+    double ctr_spread; //Highest CTR over the minimum one, the loop gain follows it
+    CT_SERIES res_series;
+    CT_SERIES cap_series;
+};
+
+/**
+ * @brief The TunerResult struct - chosen values and the margins over the corners
+ */
+struct TunerResult
+{
+    bool feasible = false; //The margins are met on all corners
+    double res_zero = 0.; //R_{f}, Ohm
+    double cap_zero = 0.; //C_{f}, F
+    double cap_pole = 0.; //C_{opto}, F
+    double freq_cross = 0.; //Crossover of the nominal corner, Hz
+    double phase_marg = 0.; //Worst phase margin over the corners, degree
+    double gain_marg = 0.; //Worst gain margin over the corners, dB
+    double cost = 0.;
+    int32_t evals = 0; //Margin solutions spent
+};
+
+/**
+ * @brief ctSeriesValue - value of the step on the lattice of the series
+ * @param step - decade * series + index in decade, step 0 is 1.0
+ * @param series
+ * @return
+ */
+double ctSeriesValue(int32_t step, CT_SERIES series);
+
+/**
+ * @brief ctSeriesStep - nearest step of the series on the log scale
+ * @param value - positive value
+ * @param series
+ * @return
+ */
+int32_t ctSeriesStep(double value, CT_SERIES series);
+
+/**
+ * @brief ctSnap - nearest value of the series
+ */
+inline double ctSnap(double value, CT_SERIES series) {return ctSeriesValue(ctSeriesStep(value, series), series);}
+
+/**
+ * @brief ctCompFactors - plant in series with the compensator of the values
+ * @param plant - factored plant of the corner
+ * @param net - fixed part of the compensator
+ * @param ctr - CTR multiplier of the corner
+ * @param res_zero - R_{f}
+ * @param cap_zero - C_{f}
+ * @param cap_pole - C_{opto}
+ * @return factored loop gain
+ */
+BodeFactors ctCompFactors(const BodeFactors &plant, const TunerNetwork &net, double ctr,
+                          double res_zero, double cap_zero, double cap_pole);
+
+/**
+ * @brief ctTune - compensator values of the series for the target over the corners.
+ *        The candidates place the optocoupler pole and the zero around the crossover,
+ *        R_{f} is solved for the crossover of the nominal corner and snapped to the series.
+ *        The best candidate is refined by the moves to the neighbour values of all three parts.
+ *        Each candidate costs one margin solution per corner, no sweep arrays are built.
+ * @param corners - plant without compensator on each operating corner, the first is nominal
+ * @param net - fixed part of the compensator
+ * @param tg - target
+ * @return
+ */
+TunerResult ctTune(const QVector<TransferFunction> &corners, const TunerNetwork &net, const TunerTarget &tg);
+#endif // COMPTUNER_H
@@ -22,7 +22,10 @@
 #include <QObject>
 #include <QtMath>
 #include <QVector>
+#include <complex>
 #include <cstdint>
+#include "freqgrid.h"
+#include "transferfunc.h"
 
 #define S_TL431_VREF           2.5      //V_TL431_min - the TL431 minimum operating voltage V
 #define S_TL431_CURR_CATH      0.0015   //I_TL431_bias - the additional TL431 bias current A
@@ -32,12 +35,22 @@
 #define S_OPTO_POLE            10000    //f_opto - the optocoupler pole that has ben characterized with R_pullup Hz
 #define M_PI_DEG               180
 
+/**
+ * The small-signal responses are templated on the conduction mode and on the
+ * compensator type, the mode is resolved once at the sweep entry and the
+ * vector kernel gets the fixed factor shape of the mode.
+ */
 enum PS_MODE
 {
     CCM_MODE = 0,
     DCM_MODE = 1
 };
 
+enum FC_COMP
+{
+    FC_TYPE_2 = 0 //Integrator, zero and optocoupler pole
+};
+
 struct SSMPreDesign
 {
     int16_t input_voltage; //Input voltage
@@ -56,16 +69,310 @@ struct SSMPreDesign
     double sawvolt; //the externally added voltage - S_e(The compensation slope)
 };
 
-class PCSSM: public QObject
+/**
+ * @brief The SSMCoeffT struct - compiled form of the power stage model,
+ *        all values depend on SSMPreDesign only. Angular frequency in rad/s.
+ */
+template<typename T>
+struct SSMCoeffT
+{
+    T gain_fm; //F_{m} - the PWM modulator gain
+    T gain_vd; //K_{vd} - DCM critical value or CCM voltage gain
+    T gain_id; //K_{id} - CCM current gain
+    T gain_ri; //F_{m}R_{s} - CCM current loop gain
+    T omega_zc; //\omega_{zc} - esr zero
+    T omega_rc; //\omega_{rc} - dominant pole
+    T omega_zrhp; //\omega_{zrhp} - rhp zero
+    T omega_p2; //\omega_{p2} - DCM second pole
+    T omega_o; //\omega_{o} - CCM double pole
+    T qual; //Q - CCM quality factor of the double pole
+};
+
+typedef SSMCoeffT<double> SSMCoeff;
+
+/**
+ * @brief The SSMPreDesignT struct - SSMPreDesign on the scalar T without its storage types,
+ *        the values of the design chain carry their derivatives into the power stage
+ */
+template<typename T>
+struct SSMPreDesignT
+{
+    T input_voltage;
+    T freq_switch;
+    T actual_duty;
+    T primary_ind;
+    T res_sense;
+    T output_voltage;
+    T output_full_load_res;
+    T turn_ratio;
+    T output_cap;
+    T output_cap_esr;
+    T sawvolt;
+};
+
+/**
+ * @brief The SSMModelT class - the formulas of the power stage on the scalar T, double
+ *        for PCSSM and Dual for the gradients of the loop, see dual.h
+ * @param P - the design, SSMPreDesign with its storage types or SSMPreDesignT<T>
+ */
+template<typename T, typename P>
+class SSMModelT
+{
+protected:
+    P m_ssmvar;
+
+public:
+    SSMModelT() {}
+    explicit SSMModelT(const P &ssmvar)
+        :m_ssmvar(ssmvar)
+    {}
+
+    /********************COM*************************/
+
+    /**
+     * @brief coZeroOneAngFreq - $\f_{zc}$ - esr zero, lhp
+     * @return esr zero value, angular frequency
+     */
+    T coZeroOneAngFreq() const
+    {
+        return 1/(m_ssmvar.output_cap * m_ssmvar.output_cap_esr);
+    }
+
+    /**
+     * @brief coPoleOneAngFreq - $\f_{rc}$ the dominant pole
+     * @return
+     */
+    T coPoleOneAngFreq() const
+    {
+        return 2/(static_cast<T>(m_ssmvar.output_full_load_res) * m_ssmvar.output_cap);
+    }
+
+    /********************COM*************************/
+    /********************DCM*************************/
+
+    /**
+     * @brief coZeroTwoAngFreq - $\f_{zrhp}$ - rhp zero
+     * @return
+     */
+    T coDCMZeroTwoAngFreq() const
+    {
+        T voltrat = static_cast<T>(m_ssmvar.output_voltage)/m_ssmvar.input_voltage;
+        T tmp = qPow(m_ssmvar.turn_ratio, 2) * static_cast<T>(m_ssmvar.output_full_load_res);
+
+        return tmp/(m_ssmvar.primary_ind * voltrat*(voltrat+1));
+    }
+
+    /**
+     * @brief coPoleTwoAngFreq - $\f_{p2}$ - pole
+     * @return
+     */
+    T coDCMPoleTwoAngFreq() const
+    {
+        T voltrat = static_cast<T>(m_ssmvar.output_voltage)/m_ssmvar.input_voltage;
+
+        return (qPow(m_ssmvar.turn_ratio, 2) * static_cast<T>(m_ssmvar.output_full_load_res))
+                /(m_ssmvar.primary_ind * qPow((voltrat+1),2));
+    }
+
+    /**
+     * @brief coDCMCriticValue - $K_{vd}$ -
+     * @return
+     */
+    T coDCMCriticValue() const
+    {
+        T ktmp = (2. * m_ssmvar.primary_ind * static_cast<T>(m_ssmvar.freq_switch))
+                /static_cast<T>(m_ssmvar.output_full_load_res);
+
+        return static_cast<T>(m_ssmvar.input_voltage)
+                /(static_cast<T>(m_ssmvar.turn_ratio) * qSqrt(ktmp));
+    }
+
+    /********************DCM*************************/
+    /********************CCM*************************/
+
+    /**
+     * @brief coCCMZeroTwoAngFreq - $f_{zrhp}$
+     * @return
+     */
+    T coCCMZeroTwoAngFreq() const
+    {
+        T tmp = qPow(m_ssmvar.turn_ratio, 2) * qPow((1-m_ssmvar.actual_duty), 2)
+                * static_cast<T>(m_ssmvar.output_full_load_res);
+
+        return tmp/(2 * M_PI * m_ssmvar.actual_duty * m_ssmvar.primary_ind);
+    }
+
+    /**
+     * @brief coCCMPoleTwoAngFreq - $f_{o}$
+     * @return
+     */
+    T coCCMPoleTwoAngFreq() const
+    {
+        T tmp = static_cast<T>(m_ssmvar.turn_ratio)
+                /(2 * M_PI * qSqrt(m_ssmvar.output_cap * m_ssmvar.primary_ind));
+
+        T num = qPow((1-m_ssmvar.actual_duty), 2);
+
+        T ld = qSqrt((num*static_cast<T>(m_ssmvar.output_full_load_res))
+                     /(static_cast<T>(m_ssmvar.output_full_load_res)+m_ssmvar.output_cap_esr));
+        return tmp*ld;
+    }
+
+    /**
+     * @brief coDCMVoltGainCoeff - $K_{vd}$
+     * @return
+     */
+    T coCCMVoltGainCoeff() const
+    {
+        return static_cast<T>(m_ssmvar.input_voltage)
+                /(static_cast<T>(m_ssmvar.turn_ratio) * (qPow((1-m_ssmvar.actual_duty),2)));
+    }
+
+    /**
+     * @brief coDCMCurrGainCoeff - $K_{id}$
+     * @return
+     */
+    T coCCMCurrGainCoeff() const
+    {
+        T tmp = 1.+(2.*m_ssmvar.actual_duty/(1.-m_ssmvar.actual_duty));
+
+        T dnm = qPow((1-m_ssmvar.actual_duty), 2);
+
+        T mult = m_ssmvar.input_voltage
+                /(static_cast<T>(m_ssmvar.turn_ratio) * dnm * static_cast<T>(m_ssmvar.output_full_load_res));
+
+        return tmp*mult;
+    }
+
+    /**
+     * @brief coDCMQualityFact - $Q$
+     * @return
+     */
+    T coCCMQualityFact() const
+    {
+        T dnm1 = m_ssmvar.primary_ind
+                /(qPow(static_cast<T>(m_ssmvar.turn_ratio), 2)
+                * qPow((1-m_ssmvar.actual_duty), 2) * static_cast<T>(m_ssmvar.output_full_load_res));
+
+        T dnm2 = m_ssmvar.output_cap_esr * static_cast<T>(m_ssmvar.output_full_load_res);
+
+        return 1/(coCCMPoleTwoAngFreq()*(dnm1+dnm2));
+    }
+
+    /********************CCM*************************/
+    /********************F_m*************************/
+
+    /**
+     * @brief coCurrDetectSlopeVolt - $S_{n}$ - the voltage slope when the primary-side current is detected on RS_s
+     *        The inductor rising slope.
+     * @return
+     */
+    T coCurrDetectSlopeVolt() const
+    {
+        return (m_ssmvar.input_voltage * m_ssmvar.res_sense)
+                / m_ssmvar.primary_ind;
+    }
+
+    /**
+     * @brief coTimeConst - $\tau_{L}$ - switching period
+     * @return
+     */
+    T coTimeConst() const
+    {
+        return (2 * m_ssmvar.primary_ind * static_cast<T>(m_ssmvar.freq_switch))
+                /(qPow(m_ssmvar.turn_ratio, 2) * static_cast<T>(m_ssmvar.output_full_load_res));
+    }
+
+    /**
+     * @brief coGainCurrModeContrModulator - $F_{m}$ - the PWM modulator gain
+     * @return
+     */
+    T coGainCurrModeContrModulator() const
+    {
+        return 1/((coCurrDetectSlopeVolt()+m_ssmvar.sawvolt)*coTimeConst());
+    }
+
+    /********************F_m*************************/
+
+    /**
+     * @brief coCompile - precompute the gain, poles, zeros and Q of the model
+     * @param mode - operation mode
+     * @return compiled coefficients
+     */
+    SSMCoeffT<T> coCompile(PS_MODE mode) const
+    {
+        SSMCoeffT<T> cf;
+        cf.gain_fm = coGainCurrModeContrModulator();
+        cf.gain_id = 0.;
+        cf.gain_ri = 0.;
+        cf.omega_zc = coZeroOneAngFreq();
+        cf.omega_rc = coPoleOneAngFreq();
+        cf.omega_p2 = 0.;
+        cf.omega_o = 0.;
+        cf.qual = 0.;
+
+        if(mode == DCM_MODE)
+        {
+            cf.gain_vd = coDCMCriticValue();
+            cf.omega_zrhp = coDCMZeroTwoAngFreq();
+            cf.omega_p2 = coDCMPoleTwoAngFreq();
+        }
+        else
+        {
+            /** CCM zero and pole are in Hz */
+            cf.gain_vd = coCCMVoltGainCoeff();
+            cf.gain_id = coCCMCurrGainCoeff();
+            cf.gain_ri = cf.gain_fm * m_ssmvar.res_sense;
+            cf.omega_zrhp = 2*M_PI*coCCMZeroTwoAngFreq();
+            cf.omega_o = 2*M_PI*coCCMPoleTwoAngFreq();
+            cf.qual = coCCMQualityFact();
+        }
+        return cf;
+    }
+
+    /**
+     * @brief coFactors - $G_{vc}(s)$ of the coefficients in factored form, the factors
+     *        of the mode have the fixed shape and the sweep hands them to the vector kernel.
+     *        DCM - F_{m}K_{vd}(1+s/\omega_{zc})(1-s/\omega_{zrhp})/((1+s/\omega_{rc})(1+s/\omega_{p2})),
+     *        CCM - the current loop closes over the double pole, see SSMKernel
+     * @param cf - compiled coefficients
+     * @param mode - operation mode
+     * @return
+     */
+    static BodeFactorsT<T> coFactors(const SSMCoeffT<T> &cf, PS_MODE mode)
+    {
+        BodeFactorsT<T> bf;
+        if(mode == CCM_MODE)
+        {
+            const T kil = cf.gain_ri * cf.gain_id;
+            const T cf0 = 1. + kil;
+            bf.gain = cf.gain_fm * cf.gain_vd / cf0;
+            bf.bfAddZero(cf.omega_zc);
+            bf.bfAddZero(-cf.omega_zrhp);
+            bf.bfAddPoleQuad((1./(cf.qual*cf.omega_o) + kil/cf.omega_rc)/cf0,
+                             (1./(cf.omega_o*cf.omega_o))/cf0);
+        }
+        else
+        {
+            bf.gain = cf.gain_fm * cf.gain_vd;
+            bf.bfAddZero(cf.omega_zc);
+            bf.bfAddZero(-cf.omega_zrhp);
+            bf.bfAddPole(cf.omega_rc);
+            bf.bfAddPole(cf.omega_p2);
+        }
+        return bf;
+    }
+};
+
+class PCSSM: public QObject, public SSMModelT<double, SSMPreDesign>
 {
     Q_OBJECT
 signals:
-    void arrayMagSSMComplete();
-    void arrayPhaseSSMComplete();
+    void arraySSMComplete();
 
 private:
-    SSMPreDesign m_ssmvar;
     PS_MODE m_mode;
+    SSMCoeff m_coeff;
 
 public:
     /**
@@ -117,139 +424,137 @@ public:
      */
     PCSSM(SSMPreDesign &ssmvar, PS_MODE mode = DCM_MODE);
 
-    /********************COM*************************/
+    /********************CCM*************************/
 
     /**
-     * @brief coZeroOneAngFreq - $\f_{zc}$ - esr zero, lhp
-     * @return esr zero value, angular frequency
+     * @brief coDCMDutyToInductCurrTrasfFunct - $G_{id}(s) magnitude value for current frequency$
+     * @param freq
+     * @return
      */
-    double coZeroOneAngFreq() const;
+    double coMagCCMDutyToInductCurrTrasfFunct(const double freq);
 
     /**
-     * @brief coPoleOneAngFreq - $\f_{rc}$ the dominant pole
+     * @brief coPhsCCMDutyToInductCurrTrasfFunct - $G_{id}(s) phase value of current frequency$
+     * @param freq
      * @return
      */
-    double coPoleOneAngFreq() const;
+    double coPhsCCMDutyToInductCurrTrasfFunct(const double freq);
 
-    /********************COM*************************/
-    /********************DCM*************************/
+    /********************CCM*************************/
 
     /**
-     * @brief coZeroTwoAngFreq - $\f_{zrhp}$ - rhp zero
+     * @brief coMagDutyToOutTrasfFunct - $G_{vd}(s)$ -
+     * @param freq
      * @return
      */
-    double coDCMZeroTwoAngFreq() const;
+    double coMagDutyToOutTrasfFunct(const double freq);
 
     /**
-     * @brief coPoleTwoAngFreq - $\f_{p2}$ - pole
+     * @brief coPhsDutyToOutTrasfFunct - $G_{vd}(s)$ -
+     * @param freq
      * @return
      */
-    double coDCMPoleTwoAngFreq() const;
+    double coPhsDutyToOutTrasfFunct(const double freq);
 
     /**
-     * @brief coDCMCriticValue - $K_{vd}$ -
+     * @brief coMagControlToOutTransfFunct - $G_{vc}(s)$ - The control-to-output transfer function
+     * @param freq
      * @return
      */
-    double coDCMCriticValue() const;
+    double coMagControlToOutTransfFunct(const double freq);
 
-    /********************DCM*************************/
-    /********************CCM*************************/
+    double coPhsControlToOutTransfFunct(const double freq);
 
     /**
-     * @brief coCCMZeroTwoAngFreq - $f_{zrhp}$
-     * @return
+     * @brief coCompile - precompute the gain, poles, zeros and Q of the model
+     * @return compiled coefficients
      */
-    double coCCMZeroTwoAngFreq() const;
+    SSMCoeff coCompile() const;
 
     /**
-     * @brief coCCMPoleTwoAngFreq - $f_{o}$
+     * @brief coCoeff - compiled coefficients, built once in constructor
      * @return
      */
-    double coCCMPoleTwoAngFreq() const;
+    inline const SSMCoeff &coCoeff() const {return m_coeff;}
 
     /**
-     * @brief coDCMVoltGainCoeff - $K_{vd}$
-     * @return
+     * @brief coRecompile - replace the design values and compile them again,
+     *        one model serves the many operating points of the run
+     * @param ssmvar - design values
      */
-    double coCCMVoltGainCoeff() const;
+    void coRecompile(const SSMPreDesign &ssmvar);
 
     /**
-     * @brief coDCMCurrGainCoeff - $K_{id}$
-     * @return
+     * @brief coDutyToInductCurrResponse - $G_{id}(j\omega)$ - CCM duty-to-inductor current
+     * @param freq - frequency in Hz
+     * @return complex response
      */
-    double coCCMCurrGainCoeff() const;
+    std::complex<double> coDutyToInductCurrResponse(const double freq) const;
 
     /**
-     * @brief coDCMQualityFact - $Q$
-     * @return
+     * @brief coDutyToOutResponse - $G_{vd}(j\omega)$ - duty-to-output
+     * @param freq - frequency in Hz
+     * @return complex response
      */
-    double coCCMQualityFact() const;
+    std::complex<double> coDutyToOutResponse(const double freq) const;
 
     /**
-     * @brief coDCMDutyToInductCurrTrasfFunct - $G_{id}(s) magnitude value for current frequency$
-     * @param freq
-     * @return
+     * @brief coControlToOutResponse - $G_{vc}(j\omega)$ - control-to-output,
+     *        F_{m}G_{vd} in DCM, F_{m}G_{vd}/(1+F_{m}R_{s}G_{id}) in CCM
+     * @param freq - frequency in Hz
+     * @return complex response
      */
-    double coMagCCMDutyToInductCurrTrasfFunct(const double freq);
+    std::complex<double> coControlToOutResponse(const double freq) const;
 
     /**
-     * @brief coPhsCCMDutyToInductCurrTrasfFunct - $G_{id}(s) phase value of current frequency$
-     * @param freq
+     * @brief coBodeFactors - $G_{vc}(s)$ in factored form for the sweep kernel
      * @return
      */
-    double coPhsCCMDutyToInductCurrTrasfFunct(const double freq);
-
-    /********************CCM*************************/
-    /********************F_m*************************/
+    BodeFactors coBodeFactors() const;
 
     /**
-     * @brief coCurrDetectSlopeVolt - $S_{n}$ - the voltage slope when the primary-side current is detected on RS_s
-     *        The inductor rising slope.
+     * @brief coTransfFunc - $G_{vc}(s)$ for composition of the loop
      * @return
      */
-    double coCurrDetectSlopeVolt() const;
+    inline TransferFunction coTransfFunc() const {return TransferFunction(coBodeFactors());}
 
     /**
-     * @brief coTimeConst - $\tau_{L}$ - switching period
-     * @return
+     * @brief coControlToOutTransfFunct - single pass over the frequency points,
+     *        create the 20*log_10(|G_{vc}|) and unwrapped /_G_{vc} sequence values
+     * @param buf - frequency points in Hz, out magnitude in dB and phase in degree
      */
-    inline double coTimeConst() const;
+    void coControlToOutTransfFunct(SweepBuffer &buf);
 
     /**
-     * @brief coGainCurrModeContrModulator - $F_{m}$ - the PWM modulator gain
-     * @return
+     * @brief coFillFreqGrid - register the poles and zeros of the power stage
+     *        for refinement of the sweep grid
+     * @param grid - frequency grid of the sweep
      */
-    inline double coGainCurrModeContrModulator() const;
-
-    /********************F_m*************************/
-    /********************OUT*************************/
+    void coFillFreqGrid(FreqGrid &grid) const;
 
     /**
-     * @brief coMagDutyToOutTrasfFunct - $G_{vd}(s)$ -
-     * @param freq
+     * @brief coOutImpTransfFunc - $Z_{out}(s)$ - open loop output impedance with the control held,
+     *        R_{o}(1 + s/\omega_{zc})/(1 + s/\omega_{rc}), R_{o} = 1/(\omega_{rc}C_{out})
      * @return
      */
-    double coMagDutyToOutTrasfFunct(const double freq);
+    TransferFunction coOutImpTransfFunc() const;
 
     /**
-     * @brief coPhsDutyToOutTrasfFunct - $G_{vd}(s)$ -
-     * @param freq
+     * @brief coLineToOutTransfFunc - $G_{vg}(s)$ - open loop audio susceptibility with the control held,
+     *        the dc gain is spread by the dominant pole and esr zero of the output
      * @return
      */
-    double coPhsDutyToOutTrasfFunct(const double freq);
+    TransferFunction coLineToOutTransfFunc() const;
+
+    inline double coLoadCurrent() const {return static_cast<double>(m_ssmvar.output_voltage) / m_ssmvar.output_full_load_res;}
+    inline double coInputVoltage() const {return m_ssmvar.input_voltage;}
 
     /**
-     * @brief coMagControlToOutTransfFunct - $G_{vc}(s)$ - The control-to-output transfer function
-     * @param freq
+     * @brief coPreDesign - design values of the model, the copy builds the other operating corner
      * @return
      */
-    double coMagControlToOutTransfFunct(const double freq);
-
-    double coPhsControlToOutTransfFunct(const double freq);
-
-    void coGainControlToOutTransfFunct(QVector<double> &in_freq, QVector<double> &out_mag);
-
-    void coPhaseControlToOutTransfFunct(QVector<double> &in_freq, QVector<double> &out_phase);
+    inline const SSMPreDesign &coPreDesign() const {return m_ssmvar;}
+    inline PS_MODE coMode() const {return m_mode;}
 
     /********************OUT*************************/
 };
@@ -287,6 +592,21 @@ struct LCSecondStage
     double lcf_cap_esr;
 };
 
+/**
+ * @brief The FCCoeff struct - compiled form of the feedback network,
+ *        all values depend on FCPreDesign, RampSlopePreDesign and LCSecondStage only.
+ *        Angular frequency in rad/s.
+ */
+struct FCCoeff
+{
+    double gain; //G_{0} - the mid-band gain K_{c}R_{f}/R_{up}
+    double omega_z; //\omega_{z} - compensator zero
+    double omega_p1; //\omega_{p1} - optocoupler pole
+    double omega_rc; //\omega_{zesr} - LC stage esr zero
+    double omega_lc; //\omega_{op} - LC stage double pole
+    double qual_lc; //Q_{lc}
+};
+
 class FCCD: public QObject
 {
     Q_OBJECT
@@ -295,6 +615,8 @@ private:
     RampSlopePreDesign m_rsvar;
     LCSecondStage m_lcfvar;
     PS_MODE m_mode;
+    FC_COMP m_comp;
+    FCCoeff m_coeff;
 
     /**
      * @brief coBoost - Boost
@@ -315,8 +637,9 @@ public:
      *        Hua L.-Design Considerations and Small Signal Modeling of the Flyback Converter
      *               Using Second Stage LC Filtering Circuit.
      *        Srinivasa Rao M.-Designing flyback converters using peak-current-mode controllers.
+     * @param comp - compensator type, the type 1 drops the zero when no phase boost is needed
      */
-    FCCD(FCPreDesign &fcvar, RampSlopePreDesign &rsvar, LCSecondStage &lcfvar, PS_MODE mode = DCM_MODE);
+    FCCD(FCPreDesign &fcvar, RampSlopePreDesign &rsvar, LCSecondStage &lcfvar, PS_MODE mode = DCM_MODE, FC_COMP comp = FC_TYPE_2);
 
     /**
      * @brief coFreqCrossSection - f_{cross}
@@ -474,19 +797,113 @@ public:
      */
     double coPhsOptoFeedbTransfFunc(const double freq) const;
 
-    //7.
     /**
-     * @brief coGainOptoFeedbTransfFunc - create the 20*log_10(|H(s)|) sequence values
-     * @param freq
+     * @brief coCompile - precompute the gain, poles, zeros and Q of the network,
+     *        the crossover chain is evaluated once
+     * @return compiled coefficients
+     */
+    FCCoeff coCompile() const;
+
+    /**
+     * @brief coCoeff - compiled coefficients, built once in constructor
      * @return
      */
-    void coGainOptoFeedbTransfFunc(QVector<double> &in_freq, QVector<double> &out_mag);
+    inline const FCCoeff &coCoeff() const {return m_coeff;}
 
     /**
-     * @brief coPhaseOptoFeedbTransfFunc
-     * @param freq
+     * @brief coLCResponse - H_{lc}(j\omega)
+     * @param freq - frequency in Hz
+     * @return complex response
+     */
+    std::complex<double> coLCResponse(const double freq) const;
+
+    /**
+     * @brief coOptoFeedbResponse - H(j\omega), compensator with second stage LC filter
+     * @param freq - frequency in Hz
+     * @return complex response
+     */
+    std::complex<double> coOptoFeedbResponse(const double freq) const;
+
+    /**
+     * @brief coCompFactors - compensator alone, without LC second stage
+     * @return
+     */
+    BodeFactors coCompFactors() const;
+
+    /**
+     * @brief coCompFactors - compensator of the coefficients, the varied network
+     *        is built without the design values
+     * @param cf - compiled coefficients
+     * @param comp - compensator type
+     * @return
+     */
+    static BodeFactors coCompFactors(const FCCoeff &cf, FC_COMP comp);
+
+    /**
+     * @brief coBodeFactors - H(s) in factored form for the sweep kernel
+     * @return
+     */
+    BodeFactors coBodeFactors() const;
+
+    /**
+     * @brief coBodeFactors - H(s) of the coefficients, see coCompFactors
+     * @param cf - compiled coefficients
+     * @param comp - compensator type
+     * @return
+     */
+    static BodeFactors coBodeFactors(const FCCoeff &cf, FC_COMP comp);
+
+    /**
+     * @brief coCompTransfFunc - compensator for composition of the loop,
+     *        the LC stage is brought by OutFilter
+     * @return
+     */
+    inline TransferFunction coCompTransfFunc() const {return TransferFunction(coCompFactors());}
+
+    /**
+     * @brief coTransfFunc - H(s) for composition of the loop
+     * @return
+     */
+    inline TransferFunction coTransfFunc() const {return TransferFunction(coBodeFactors());}
+
+    /**
+     * @brief coOptoCtr - CTR of the optocoupler, the loop gain is proportional to it
      * @return
      */
-    void coPhaseOptoFeedbTransfFunc(QVector<double> &in_freq, QVector<double> &out_phase);
+    inline double coOptoCtr() const {return m_fcvar.opto_ctr;}
+
+    inline double coResPullUp() const {return m_fcvar.res_pull_up;}
+    inline FC_COMP coComp() const {return m_comp;}
+    inline double coPhaseMarg() const {return m_fcvar.phase_marg;}
+
+    /**
+     * @brief coGainPerRes - K_{c}/R_{up}, the mid-band gain G_{0} per ohm of R_{f}
+     * @return
+     */
+    double coGainPerRes() const;
+
+    /**
+     * @brief coApplyNetwork - replace the heuristic R_{f}, C_{f} and C_{opto}
+     *        by the chosen values, the responses follow them
+     * @param res_zero - R_{f}
+     * @param cap_zero - C_{f}
+     * @param cap_pole - C_{opto}
+     */
+    void coApplyNetwork(double res_zero, double cap_zero, double cap_pole);
+
+    //7.
+    /**
+     * @brief coOptoFeedbTransfFunc - single pass over the frequency points,
+     *        create the 20*log_10(|H(s)|) and unwrapped /_H(s) sequence values
+     * @param buf - frequency points in Hz, out magnitude in dB and phase in degree
+     */
+    void coOptoFeedbTransfFunc(SweepBuffer &buf);
+
+    /**
+     * @brief coFillFreqGrid - register the crossover, poles and zeros of the
+     *        feedback network for refinement of the sweep grid
+     * @param grid - frequency grid of the sweep
+     */
+    void coFillFreqGrid(FreqGrid &grid) const;
 };
 #endif // CONTROLOUT_H
@@ -0,0 +1,167 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef DESIGNSENS_H
+#define DESIGNSENS_H
+#include <QVector>
+#include <QPair>
+#include <cstdint>
+#include "dual.h"
+#include "bulkcap.h"
+#include "fbptransformer.h"
+#include "swmosfet.h"
+#include "capout.h"
+#include "controlout.h"
+#include "loopmargin.h"
+
+/**
+ * Seeded input, the value is the index of the derivative
+ */
+enum DS_INPUT
+{
+    DS_VAC_MAX = 0,  //Max input AC voltage
+    DS_VAC_MIN,      //Min input AC voltage
+    DS_FREQ_LINE,    //Line frequency
+    DS_FREQ_SWITCH,  //Switching frequency
+    DS_EFF,          //Efficiency
+    DS_POUT,         //Max output power
+    DS_REFL_VOLT,    //Max reflected voltage
+    DS_VOLT_SPIKE,   //Voltage spike of the switch
+    DS_RIPPLE_FACT,  //Current ripple factor
+    DS_INPUT_NUM
+};
+
+/**
+ * Output of the design, the value is the row of the gradient
+ */
+enum DS_OUTPUT
+{
+    DS_CAP_BULK = 0, //Bulk capacitor
+    DS_VDC_MIN,      //Min DC input voltage
+    DS_PRIM_IND,     //Primary inductance
+    DS_CURR_PEAK,    //Primary peak current
+    DS_CURR_RMS,     //Primary RMS current
+    DS_FLUX_PEAK,    //Actual peak flux density
+    DS_DUTY_MAX,     //Actual max duty cycle
+    DS_VOLT_REFL,    //Actual reflected voltage
+    DS_MOS_VOLT,     //Switch voltage stress
+    DS_MOS_COND,     //Switch conduction loss
+    DS_MOS_SWITCH,   //Switch switching loss
+    DS_MOS_TOTAL,    //Switch total loss
+    DS_SNUB_DISS,    //Snubber dissipation
+    DS_SENSE_LOSS,   //Current sense resistor loss
+    DS_CAP_OUT_LOSS, //First output capacitor loss
+    DS_FREQ_CROSS,   //Crossover frequency of the loop
+    DS_PHASE_MARG,   //Phase margin of the loop
+    DS_GAIN_MARG,    //Gain margin of the loop
+    DS_OUTPUT_NUM
+};
+
+typedef Dual<DS_INPUT_NUM> DsScalar;
+
+/**
+ * @brief The DsModel struct - the design of the primary side and of the loop, the seeded
+ *        inputs are the InputValue fields, the parts and the core are constants. The power
+ *        stage of the loop follows the chain, the compensator and the output filter are parts
+ */
+struct DsModel
+{
+    double input[DS_INPUT_NUM]; //Nominal values as stored by InputValue
+    QVector<QPair<float, float>> out_vlcr; //Voltage and current of the four outputs
+    CoreArea ca;
+    CoreSelection cs;
+    MechDimension md;
+    FBPT_NUM_SETTING fns;
+    FBPT_SHAPE_AIR_GAP fsag;
+    MosfetProp mospr;
+    ClampCSProp ccsp;
+    CapOutProp cop; //First output capacitor
+    uint32_t num_sec; //Turns of the first output winding
+    bool has_loop = false; //The loop is designed, else the margins are zero
+    SSMPreDesign ssm; //Power stage, the fields of the chain are replaced by its values
+    PS_MODE mode;
+    float volt_ramp; //V_{out} + V_{d} of the controlled output, the compensation ramp
+    BodeFactors loop_rest; //Compensator and output filter
+    double freq_begin; //Search range of the margins, Hz
+    double freq_end;
+};
+
+/**
+ * @brief The DsResult struct - the outputs and their exact derivatives
+ *        along the inputs, the turn counts are held at the nominal design
+ */
+struct DsResult
+{
+    double input[DS_INPUT_NUM];
+    double value[DS_OUTPUT_NUM];
+    double grad[DS_OUTPUT_NUM][DS_INPUT_NUM];
+
+    /**
+     * @brief dsElasticity - relative change of the output by the relative change of the input,
+     *        the inputs of the different units are compared by it
+     */
+    inline double dsElasticity(int32_t out, int32_t in) const
+    {
+        return (value[out] != 0.) ? grad[out][in] * input[in] / value[out] : 0.;
+    }
+};
+
+/**
+ * @brief dsPipeline - the design chain of PowSuppSolve from the bulk capacitor to the output capacitor
+ *        and the margins of the loop
+ * @param model - the design
+ * @param in - inputs, the double or the seeded Dual ones
+ * @param out - outputs in the order of DS_OUTPUT
+ */
+template<typename T>
+void dsPipeline(const DsModel &model, const T in[DS_INPUT_NUM], T out[DS_OUTPUT_NUM]);
+
+/**
+ * @brief dsLoopMargins - crossover, phase and gain margin of the loop, zero where the crossing
+ *        is not found. The crossings are solved on the values by lmSolveMargins, the derivatives
+ *        follow at the roots, d(ln\omega_{c})/dp = -(\partial ln|T|/\partial p)/(\partial ln|T|/\partial ln\omega)
+ *        and the phase crossover alike
+ * @param loop - factored loop gain, double or Dual
+ * @param freq_begin - lower frequency of the search, Hz
+ * @param freq_end - upper frequency of the search, Hz
+ * @param freq_cross - out crossover frequency, Hz
+ * @param phase_marg - out phase margin, degree
+ * @param gain_marg - out gain margin, dB
+ */
+template<typename T>
+void dsLoopMargins(const BodeFactorsT<T> &loop, double freq_begin, double freq_end,
+                   T &freq_cross, T &phase_marg, T &gain_marg);
+
+/**
+ * @brief dsRun - all outputs and all gradients in one pass of the chain
+ * @param model - the design
+ * @return
+ */
+DsResult dsRun(const DsModel &model);
+
+/**
+ * @brief dsInputName - short name of the input for the tables
+ */
+const char *dsInputName(int32_t in);
+
+/**
+ * @brief dsOutputName - short name of the output for the tables
+ */
+const char *dsOutputName(int32_t out);
+#endif // DESIGNSENS_H
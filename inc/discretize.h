@@ -0,0 +1,136 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef DISCRETIZE_H
+#define DISCRETIZE_H
+#include <complex>
+#include <functional>
+#include "transferfunc.h"
+
+#define DZ_SECTION_COEFF  5     //b0 b1 b2 a1 a2 of one second order section
+#define DZ_LOOP_DELAY     1.5   //Samples of the computation delay and the half sample of the modulator hold
+#define DZ_WORD_BITS_MAX  31    //Qm.n with the sign bit fits into int32_t
+#define DZ_PREWARP_MAX    0.9   //Upper limit of the prewarp frequency, part of the Nyquist frequency
+
+/**
+ * @brief The DZ_METHOD enum - mapping of the continuous compensator to the z-plane
+ */
+enum DZ_METHOD
+{
+    DZ_TUSTIN  = 0, //Bilinear, exact at the prewarp frequency
+    DZ_ZOH     = 1, //Zero order hold, exact at the sampling instants of the step response
+    DZ_MATCHED = 2  //z = e^{sT} of the roots, the zeros at infinity go to z = -1
+};
+
+/**
+ * @brief The DzSection struct - second order section in z^{-1}
+ *        (b0 + b1 z^{-1} + b2 z^{-2}) / (1 + a1 z^{-1} + a2 z^{-2}),
+ *        the first order one has b2 = a2 = 0. The leading nonzero b is 1.
+ */
+struct DzSection
+{
+    double b[3] = {0., 0., 0.};
+    double a[3] = {1., 0., 0.}; //a0 is always 1
+};
+
+/**
+ * @brief The DzFilter struct - cascade of the sections with the gain
+ */
+struct DzFilter
+{
+    double freq_smp = 0.; //Sample rate, Hz
+    double gain = 1.;
+    QVector<DzSection> sect;
+
+    /**
+     * @brief dzEval - H(e^{j omega T})
+     * @param omega - rad/s
+     * @return
+     */
+    std::complex<double> dzEval(double omega) const;
+
+    /**
+     * @brief dzPoleRadius - largest pole magnitude, 1 for the integrator
+     * @return
+     */
+    double dzPoleRadius() const;
+};
+
+/**
+ * @brief The DzQFormat struct - signed fixed point Qm.n, the word is m + n + 1 bits
+ */
+struct DzQFormat
+{
+    int32_t int_bits = 2; //m, the sections need |c| < 2 and 4 for the double pole at z = 1
+    int32_t frac_bits = 13; //n
+};
+
+/**
+ * @brief The DzQuantized struct - coefficients for the firmware,
+ *        y = gain_mant * 2^{gain_shift - n} * prod(section), each value v stored as round(v * 2^n)
+ */
+struct DzQuantized
+{
+    DzQFormat fmt;
+    QVector<int32_t> coeff; //DZ_SECTION_COEFF per section
+    int32_t gain_mant = 0;
+    int32_t gain_shift = 0;
+    bool saturated = false; //A coefficient is out of the range of the format
+    DzFilter filt; //Response of the stored values
+};
+
+/**
+ * @brief The DzSpec struct - settings of the digital compensator
+ */
+struct DzSpec
+{
+    DZ_METHOD method = DZ_TUSTIN;
+    double freq_smp = 0.; //Sample rate, Hz
+    double freq_warp = 0.; //Prewarp frequency, Hz, zero for the loop crossover
+    DzQFormat fmt;
+};
+
+/**
+ * @brief dzDiscretize - sampled equivalent of the proper continuous response
+ * @param tf - continuous response
+ * @param method - mapping of the roots
+ * @param freq_smp - sample rate, Hz
+ * @param freq_warp - Tustin prewarp and the gain match of the matched-Z, Hz;
+ *        zero or above DZ_PREWARP_MAX of the Nyquist frequency takes the plain bilinear
+ *        map and the match at a decade below the Nyquist frequency
+ * @return the sections, empty for the improper response
+ */
+DzFilter dzDiscretize(const TransferFunction &tf, DZ_METHOD method, double freq_smp, double freq_warp);
+
+/**
+ * @brief dzQuantize - round the coefficients and the gain to the fixed point format
+ * @param filt - sections of dzDiscretize
+ * @param fmt - Qm.n, the word is limited to DZ_WORD_BITS_MAX
+ * @return
+ */
+DzQuantized dzQuantize(const DzFilter &filt, DzQFormat fmt);
+
+/**
+ * @brief dzSweep - magnitude in dB and unwrapped phase in degree of the sampled response,
+ *        the response has no factored form for the sweep kernel
+ * @param resp - complex response at the angular frequency in rad/s
+ * @param buf - frequency points in Hz, out magnitude and phase
+ */
+void dzSweep(const std::function<std::complex<double>(double)> &resp, SweepBuffer &buf);
+#endif // DISCRETIZE_H
@@ -0,0 +1,200 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef DUAL_H
+#define DUAL_H
+#include <QtMath>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief The Dual class - forward mode automatic differentiation scalar,
+ *        the value with the exact derivatives along N seeded inputs.
+ *        The model classes templated on the scalar give the value and all N
+ *        partial derivatives of each output in one pass, the double
+ *        instantiation is the plain model. The comparisons use the value only.
+ */
+template<int32_t N>
+class Dual
+{
+public:
+    double val;
+    double der[N];
+
+    Dual(double value = 0.)
+        :val(value)
+    {
+        for(int32_t indx = 0; indx < N; ++indx)
+            der[indx] = 0.;
+    }
+
+    /**
+     * @brief dVar - seeded input, the derivative along its own index is one
+     * @param value
+     * @param indx - index of the input, 0..N-1
+     * @return
+     */
+    static Dual dVar(double value, int32_t indx)
+    {
+        Dual out(value);
+        out.der[indx] = 1.;
+        return out;
+    }
+
+    /**
+     * @brief dChain - f(x) with the derivative f'(x) along all inputs
+     */
+    Dual dChain(double value, double slope) const
+    {
+        Dual out(value);
+        for(int32_t indx = 0; indx < N; ++indx)
+            out.der[indx] = slope * der[indx];
+        return out;
+    }
+
+    Dual &operator+=(const Dual &rhs)
+    {
+        val += rhs.val;
+        for(int32_t indx = 0; indx < N; ++indx)
+            der[indx] += rhs.der[indx];
+        return *this;
+    }
+
+    Dual &operator-=(const Dual &rhs)
+    {
+        val -= rhs.val;
+        for(int32_t indx = 0; indx < N; ++indx)
+            der[indx] -= rhs.der[indx];
+        return *this;
+    }
+
+    Dual &operator*=(const Dual &rhs)
+    {
+        for(int32_t indx = 0; indx < N; ++indx)
+            der[indx] = der[indx] * rhs.val + val * rhs.der[indx];
+        val *= rhs.val;
+        return *this;
+    }
+
+    Dual &operator/=(const Dual &rhs)
+    {
+        /** (u/v)' = (u' - (u/v)v')/v, the value is divided as the double model does */
+        val /= rhs.val;
+        for(int32_t indx = 0; indx < N; ++indx)
+            der[indx] = (der[indx] - val * rhs.der[indx]) / rhs.val;
+        return *this;
+    }
+
+    /** The operators are found by the argument lookup and take the double on either side */
+    friend Dual operator+(Dual lhs, const Dual &rhs) {return lhs += rhs;}
+    friend Dual operator-(Dual lhs, const Dual &rhs) {return lhs -= rhs;}
+    friend Dual operator*(Dual lhs, const Dual &rhs) {return lhs *= rhs;}
+    friend Dual operator/(Dual lhs, const Dual &rhs) {return lhs /= rhs;}
+    friend Dual operator-(const Dual &rhs) {return rhs.dChain(-rhs.val, -1.);}
+    friend Dual operator+(const Dual &rhs) {return rhs;}
+
+    friend bool operator<(const Dual &lhs, const Dual &rhs) {return lhs.val < rhs.val;}
+    friend bool operator>(const Dual &lhs, const Dual &rhs) {return lhs.val > rhs.val;}
+    friend bool operator<=(const Dual &lhs, const Dual &rhs) {return lhs.val <= rhs.val;}
+    friend bool operator>=(const Dual &lhs, const Dual &rhs) {return lhs.val >= rhs.val;}
+    friend bool operator==(const Dual &lhs, const Dual &rhs) {return lhs.val == rhs.val;}
+    friend bool operator!=(const Dual &lhs, const Dual &rhs) {return lhs.val != rhs.val;}
+
+    friend Dual sqrt(const Dual &x)
+    {
+        const double root = std::sqrt(x.val);
+        return x.dChain(root, 0.5 / root);
+    }
+    friend Dual exp(const Dual &x)
+    {
+        const double ex = std::exp(x.val);
+        return x.dChain(ex, ex);
+    }
+    friend Dual log(const Dual &x) {return x.dChain(std::log(x.val), 1. / x.val);}
+    friend Dual log2(const Dual &x) {return x.dChain(std::log2(x.val), 1. / (x.val * M_LN2));}
+    friend Dual log10(const Dual &x) {return x.dChain(std::log10(x.val), 1. / (x.val * M_LN10));}
+    friend Dual sin(const Dual &x) {return x.dChain(std::sin(x.val), std::cos(x.val));}
+    friend Dual cos(const Dual &x) {return x.dChain(std::cos(x.val), -std::sin(x.val));}
+    friend Dual tan(const Dual &x)
+    {
+        const double tn = std::tan(x.val);
+        return x.dChain(tn, 1. + tn * tn);
+    }
+    friend Dual asin(const Dual &x) {return x.dChain(std::asin(x.val), 1. / std::sqrt(1. - x.val * x.val));}
+    friend Dual acos(const Dual &x) {return x.dChain(std::acos(x.val), -1. / std::sqrt(1. - x.val * x.val));}
+    friend Dual atan(const Dual &x) {return x.dChain(std::atan(x.val), 1. / (1. + x.val * x.val));}
+    friend Dual fabs(const Dual &x) {return (x.val < 0.) ? -x : x;}
+    friend Dual pow(const Dual &x, double ex)
+    {
+        /** The integer power is defined at zero and on the negative base */
+        const double pw = std::pow(x.val, ex);
+        return x.dChain(pw, (ex == 0.) ? 0. : ex * std::pow(x.val, ex - 1.));
+    }
+    friend Dual pow(const Dual &x, const Dual &ex)
+    {
+        /** x^y = exp(y ln x) */
+        return exp(ex * log(x));
+    }
+    friend Dual atan2(const Dual &y, const Dual &x)
+    {
+        /** d atan2(y, x) = (x dy - y dx)/(x^2 + y^2) */
+        const double r2 = x.val * x.val + y.val * y.val;
+        Dual out(std::atan2(y.val, x.val));
+        for(int32_t indx = 0; indx < N; ++indx)
+            out.der[indx] = (x.val * y.der[indx] - y.val * x.der[indx]) / r2;
+        return out;
+    }
+};
+
+/** Qt forms of the functions, the model classes call them */
+template<int32_t N> inline Dual<N> qSqrt(const Dual<N> &x) {return sqrt(x);}
+template<int32_t N> inline Dual<N> qExp(const Dual<N> &x) {return exp(x);}
+template<int32_t N> inline Dual<N> qLn(const Dual<N> &x) {return log(x);}
+template<int32_t N> inline Dual<N> qSin(const Dual<N> &x) {return sin(x);}
+template<int32_t N> inline Dual<N> qCos(const Dual<N> &x) {return cos(x);}
+template<int32_t N> inline Dual<N> qTan(const Dual<N> &x) {return tan(x);}
+template<int32_t N> inline Dual<N> qAsin(const Dual<N> &x) {return asin(x);}
+template<int32_t N> inline Dual<N> qAcos(const Dual<N> &x) {return acos(x);}
+template<int32_t N> inline Dual<N> qAtan(const Dual<N> &x) {return atan(x);}
+template<int32_t N> inline Dual<N> qFabs(const Dual<N> &x) {return fabs(x);}
+template<int32_t N> inline Dual<N> qPow(const Dual<N> &x, double ex) {return pow(x, ex);}
+template<int32_t N> inline Dual<N> qPow(const Dual<N> &x, const Dual<N> &ex) {return pow(x, ex);}
+template<int32_t N> inline Dual<N> qAtan2(const Dual<N> &y, const Dual<N> &x) {return atan2(y, x);}
+
+/**
+ * @brief dualValue - value of the scalar without the derivatives
+ */
+inline double dualValue(double x) {return x;}
+template<int32_t N> inline double dualValue(const Dual<N> &x) {return x.val;}
+
+/**
+ * @brief dualStore - the value passed through the storage type S of the model,
+ *        int16_t truncates and float rounds as the plain model does, the derivative
+ *        is kept and the gradient is the one of the smooth model
+ */
+template<typename S> inline double dualStore(double x) {return static_cast<S>(x);}
+template<typename S, int32_t N> inline Dual<N> dualStore(const Dual<N> &x) {return x.dChain(static_cast<S>(x.val), 1.);}
+
+/**
+ * @brief dualHold - the integer count of the model, the turns and the like,
+ *        the count is the step function of the inputs and has no derivative
+ */
+inline double dualHold(double x) {return std::trunc(x);}
+template<int32_t N> inline Dual<N> dualHold(const Dual<N> &x) {return Dual<N>(std::trunc(x.val));}
+#endif // DUAL_H
@@ -23,22 +23,29 @@
 #include <QVector>
 #include <QPair>
 #include <cstdint>
+#include "dual.h"
 
 #define S_MU_Z     4.*M_PI*1E-7 //H/m
 #define S_RO_OM    1.72E-8 //Ohm/m
 #define S_K_1      85*1E-4
+#define S_TURNS_MAX 1000 //Limit of the primary turns search
 
-class FBPTPrimary
+/**
+ * @brief The FBPTPrimaryT class - the model on the scalar T, double for the design
+ *        and Dual for the gradients along the inputs, see dual.h
+ */
+template<typename T>
+class FBPTPrimaryT
 {
 private:
-    double ripple_factor;
-    int16_t refl_volt;
-    double pow_max_out;
-    float efficiency;
-    float freq_switch;
+    T ripple_factor;
+    T refl_volt;
+    T pow_max_out;
+    T efficiency;
+    T freq_switch;
 
-    int16_t input_dc_min_voltage; // dc average, between min input and rectify min peak
-    int16_t input_min_voltage; // recalc after input capacitor selection
+    T input_dc_min_voltage; // dc average, between min input and rectify min peak, int16_t storage
+    T input_min_voltage; // recalc after input capacitor selection, int16_t storage
 
 public:
     /**
@@ -49,9 +56,9 @@ public:
      * @param eff
      * @param swfr
      */
-    FBPTPrimary(double krf, int16_t rv,
-                double pout, float eff,
-                float swfr):
+    FBPTPrimaryT(T krf, T rv,
+                 T pout, T eff,
+                 T swfr):
         ripple_factor(krf), refl_volt(rv),
         pow_max_out(pout), efficiency(eff),
         freq_switch(swfr)
@@ -62,17 +69,17 @@ public:
      * @param idcmv - dc average, between min input and rectify min peak
      * @param imv - recalc after input capacitor selection
      */
-    void setInputVoltage(int16_t input_volt_ac_min,
-                         double input_pwr,
+    void setInputVoltage(T input_volt_ac_min,
+                         T input_pwr,
                          int16_t freq_line,
-                         double bulk_cap_value,
-                         double bulk_cap_delta_time)
+                         T bulk_cap_value,
+                         T bulk_cap_delta_time)
     {
-        double input_pk_min_voltage = input_volt_ac_min * M_SQRT2;
-        double pwr_cap_coeff = input_pwr / bulk_cap_value;
-        double chg_time = (1 / freq_line) - 2 * bulk_cap_delta_time;
-        input_min_voltage = qSqrt(qPow(input_pk_min_voltage, 2) - (pwr_cap_coeff * chg_time));
-        input_dc_min_voltage = 0.5 * (input_pk_min_voltage + input_min_voltage);
+        T input_pk_min_voltage = input_volt_ac_min * M_SQRT2;
+        T pwr_cap_coeff = input_pwr / bulk_cap_value;
+        T chg_time = (1 / freq_line) - 2 * bulk_cap_delta_time;
+        input_min_voltage = dualStore<int16_t>(qSqrt(qPow(input_pk_min_voltage, 2) - (pwr_cap_coeff * chg_time)));
+        input_dc_min_voltage = dualStore<int16_t>(0.5 * (input_pk_min_voltage + input_min_voltage));
     }
 
     /*Inductance of primary side*/
@@ -80,27 +87,27 @@ public:
      * @brief DutyCycleDCM - Maximum duty cycle
      * @return duty cycle ratio
      */
-    double DutyCycleDCM()
+    T DutyCycleDCM()
     {
-        return static_cast<double>(refl_volt)/(refl_volt+input_dc_min_voltage);
+        return refl_volt/(refl_volt+input_dc_min_voltage);
     }
 
     /**
      * @brief InputPower - Maximum input power
      * @return in pwr in W
      */
-    double InputPower()
+    T InputPower()
     {
-        return pow_max_out/static_cast<double>(efficiency);
+        return pow_max_out/efficiency;
     }
 
     /**
      * @brief PriInduct - Primary inductance
      * @return inductance in H
      */
-    double PriInduct()
+    T PriInduct()
     {
-        return qPow((input_dc_min_voltage * DutyCycleDCM()), 2)/(2. * InputPower()*static_cast<double>(freq_switch)*ripple_factor);
+        return qPow((input_dc_min_voltage * DutyCycleDCM()), 2)/(2. * InputPower()*freq_switch*ripple_factor);
     }
     /*Inductance of primary side*/
 
@@ -109,7 +116,7 @@ public:
      * @brief CurrPriAver - Primary average current during turn-on
      * @return average current
      */
-    double CurrPriAver()
+    T CurrPriAver()
     {
         return InputPower()/(input_min_voltage*DutyCycleDCM());
     }
@@ -118,16 +125,16 @@ public:
      * @brief CurrPriPeakToPeak - Primary peak-to-peak current
      * @return primare delta current
      */
-    double CurrPriPeakToPeak()
+    T CurrPriPeakToPeak()
     {
-        return (input_dc_min_voltage*DutyCycleDCM())/(PriInduct()*static_cast<double>(freq_switch));
+        return (input_dc_min_voltage*DutyCycleDCM())/(PriInduct()*freq_switch);
     }
 
     /**
       * @brief CurrPriMax - Primary peak current
       * @return peak value of primary current
       */
-    double CurrPriMax()
+    T CurrPriMax()
     {
         return  CurrPriAver()+(CurrPriPeakToPeak()/2);
     }
@@ -136,7 +143,7 @@ public:
       * @brief CurrPriValley - Primary valley current
       * @return the valley of the inductor current
       */
-    double CurrPriValley()
+    T CurrPriValley()
     {
         return CurrPriMax()-CurrPriPeakToPeak();
     }
@@ -145,7 +152,7 @@ public:
       * @brief CurrPriRMS - Primary RMS current
       * @return current rms value
       */
-    double CurrPriRMS()
+    T CurrPriRMS()
     {
         return qSqrt((3.*(qPow(CurrPriAver(),2))+(qPow((CurrPriPeakToPeak()/2.),2)))*(DutyCycleDCM()/3.));
     }
@@ -153,6 +160,8 @@ public:
     /*All current primary side*/
 };
 
+typedef FBPTPrimaryT<double> FBPTPrimary;
+
 struct CoreArea
 {
     double mag_flux_dens;
@@ -198,7 +207,13 @@ enum class FBPT_SHAPE_AIR_GAP
     ROUND_AIR_GAP = 1
 };
 
-class FBPTCore
+/**
+ * @brief The FBPTCoreT class - the model on the scalar T, double for the design
+ *        and Dual for the gradients along the inputs, see dual.h. The core and
+ *        the mechanical data are the constants of the part, the turns are counts.
+ */
+template<typename T>
+class FBPTCoreT
 {
 public:
     /**
@@ -207,9 +222,9 @@ public:
      * @param utilfact
      * @param fluxdens
      */
-    FBPTCore(CoreArea& ca, double prin,
-             double pkprcr, double rmsprcr,
-             double ppprcr, double pout)
+    FBPTCoreT(CoreArea& ca, T prin,
+              T pkprcr, T rmsprcr,
+              T ppprcr, T pout)
         :primary_induct(prin)//Lp - primary inductance
         ,curr_primary_peak(pkprcr)//Ippk - primary peak current
         ,curr_primary_rms(rmsprcr)//Iprms - primary RMS current
@@ -224,17 +239,17 @@ public:
 
 private:
     CoreArea m_ca;
-    double primary_induct;
-    double curr_primary_peak;
-    double curr_primary_rms;
-    double curr_primary_peak_peak;
-    double power_out_max;
+    T primary_induct;
+    T curr_primary_peak;
+    T curr_primary_rms;
+    T curr_primary_peak_peak;
+    T power_out_max;
 
     /**
      * @brief EnergyStoredChoke - The maximum energy stored in the inductor
      * @return stored value in watt(W_l) w
      */
-    double EnergyStoredChoke() const
+    T EnergyStoredChoke() const
     {
         return (primary_induct * qPow(curr_primary_peak, 2))/2.;
     }
@@ -248,7 +263,7 @@ public:
      *                       peak current requement.
      * @return core area value(A_p) m^4 - using for select next core parameters
      */
-    double CoreAreaProd() const
+    T CoreAreaProd() const
     {
         return (2. * EnergyStoredChoke())/(m_ca.win_util_factor * m_ca.max_curr_dens * m_ca.mag_flux_dens);
     }
@@ -261,9 +276,9 @@ public:
      * @param outPow - Total output power in converter
      * @return core geometry coefficient(K_g) m^5
      */
-    double CoreGeometryCoeff(double outPwr) const
+    T CoreGeometryCoeff(T outPwr) const
     {
-        double k_electr = outPwr * qPow(m_ca.mag_flux_dens, 2);
+        T k_electr = outPwr * qPow(m_ca.mag_flux_dens, 2);
         return (2. * 1.72 * qPow(EnergyStoredChoke(), 2)) / (k_electr * 0.5);
         //return (2 * S_RO_OM * primary_induct * EnergyStoredChoke() * qPow(curr_primary_rms,2))/(outPwr * qPow(m_ca.mag_flux_dens,2));
     }
@@ -272,9 +287,9 @@ public:
      * @brief CoreWinToCoreSect - Estimate cross-sectional area to Window area core(WaAe) equivalent to Ap
      * @return core area value(A_p) m^4
      */
-    double CoreAreaProd_WaAe() const
+    T CoreAreaProd_WaAe() const
     {
-        double tmp = (primary_induct * curr_primary_rms * curr_primary_peak)/(m_ca.mag_flux_dens * S_K_1);
+        T tmp = (primary_induct * curr_primary_rms * curr_primary_peak)/(m_ca.mag_flux_dens * S_K_1);
         return qPow(tmp, (4./3.));
     }
 
@@ -284,9 +299,9 @@ private:
      * @param cs - Multiparameters object, contain core selection properties
      * @return cross-section wind area(A_w) m^2
      */
-    double AreaWindTotal(const CoreSelection &cs) const
+    T AreaWindTotal(const CoreSelection &cs) const
     {
-        double wa=0., result=0.;
+        T wa=0., result=0.;
     //FIX Branch
         if(cs.core_wind_area != -1.0){
             result = m_ca.win_util_factor * cs.core_wind_area * S_RO_OM * cs.mean_leng_per_turn;
@@ -296,7 +311,7 @@ private:
             result = m_ca.win_util_factor * wa * S_RO_OM * cs.mean_leng_per_turn;
         }
         //A_w - in A/m^2 to A/mm^2 - A_w*10^-6
-        return curr_primary_peak * qSqrt(result/static_cast<double>(power_out_max));
+        return curr_primary_peak * qSqrt(result/power_out_max);
     }
 
 public:
@@ -306,7 +321,7 @@ public:
      * @param cs - Multiparameters object, contain core selection properties
      * @return - current density(J_m) A/m^2
      */
-    double CurrentDens(const CoreSelection &cs) const
+    T CurrentDens(const CoreSelection &cs) const
     {
         //J_m - in A/m^2 to A/mm^2 - J_m*10^-6
         return curr_primary_peak/AreaWindTotal(cs);
@@ -318,9 +333,9 @@ public:
       * @param fns - Select method for num primary turns calculate
       * @return number of turns the primary side
       */
-    double numPrimary(const CoreSelection &cs, const FBPT_NUM_SETTING &fns)
+    T numPrimary(const CoreSelection &cs, const FBPT_NUM_SETTING &fns)
     {
-        double temp = 0.0;
+        T temp = 0.0;
         if(fns == FBPT_NUM_SETTING::FBPT_INDUCT_FACTOR)
         {
             temp = qSqrt(primary_induct/cs.ind_fact);
@@ -331,7 +346,7 @@ public:
         }
         else if(fns == FBPT_NUM_SETTING::FBPT_CORE_AREA)
         {
-            auto check_wa = [&](){
+            auto check_wa = [&]() -> T {
                 if(cs.core_wind_area != -1.0){
                     return cs.core_wind_area;
                 }
@@ -350,7 +365,7 @@ public:
       * @param varNumPrim - Number of turns the primary side
       * @return Air gap length(l_g)
       */
-    double agLength(const CoreSelection &cs, double varNumPrim) const
+    T agLength(const CoreSelection &cs, double varNumPrim) const
     {
         return ((S_MU_Z * cs.core_cross_sect_area * std::pow(varNumPrim, 2))/(primary_induct))-
                 (cs.mean_mag_path_leng / cs.core_permeal);
@@ -371,10 +386,11 @@ public:
     * @param mchdm - Mechanical dimensions of the core
     * @return fringing flux factor value()
     */
-   double agFringFluxFact(const CoreSelection &cs, double varNumPrim, /*double ewff,*/
+   T agFringFluxFact(const CoreSelection &cs, double varNumPrim, /*double ewff,*/
                                     FBPT_SHAPE_AIR_GAP &fsag, MechDimension &mchdm) const
    {
-       double csa, af, temp = 0.0;
+       double csa;
+       T af, temp = 0.0;
        double k = /*empl/agLength(cs, varNumPrim);*/ 2;//empl - the mean effective of the magnetic path length in the fringing area
        double u = /*ewff/agLength(cs, varNumPrim);*/ 1;//ewff - the effective width of the fringing flux cross-sectional area
        if(fsag == FBPT_SHAPE_AIR_GAP::RECT_AIR_GAP)
@@ -405,18 +421,19 @@ public:
     */
    int16_t actNumPrimary(const CoreSelection &cs, FBPT_SHAPE_AIR_GAP &fsag,
                                    MechDimension &mchdm, uint32_t varNumPrim,
-                                   double varIndPrim, double currPeakPrim) const
+                                   T varIndPrim, T currPeakPrim) const
    {
        int16_t act_num_prim_turns = 0;
-       double ag, ffg, flux_peak = 0.0;
+       T ag, ffg, flux_peak = 0.0;
+       /** The turn is added until the flux peak fits, the longer gap of more turns lowers it */
        do
        {
            ag = agLength(cs, varNumPrim);
            ffg = agFringFluxFact(cs, varNumPrim, fsag, mchdm);
-           act_num_prim_turns = static_cast<int16_t>(qSqrt((ag*varIndPrim)/(S_MU_Z*cs.core_cross_sect_area*ffg)));
+           act_num_prim_turns = static_cast<int16_t>(dualValue(qSqrt((ag*varIndPrim)/(S_MU_Z*cs.core_cross_sect_area*ffg))));
            flux_peak = (S_MU_Z * act_num_prim_turns * ffg * (currPeakPrim/2))/(ag+(cs.mean_mag_path_leng/cs.core_permeal));
        }
-       while(flux_peak > m_ca.mag_flux_dens);
+       while(flux_peak > m_ca.mag_flux_dens && ++varNumPrim < S_TURNS_MAX);
        return act_num_prim_turns;
    }
 
@@ -429,7 +446,7 @@ public:
     * @param agLength - Air gap length
     * @return actual maximum flux density
     */
-   double actMagneticFluxPeak(const CoreSelection &cs, uint32_t actNumPrim, double maxCurPrim, double agLength) const
+   T actMagneticFluxPeak(const CoreSelection &cs, uint32_t actNumPrim, T maxCurPrim, T agLength) const
    {
        return (S_MU_Z * actNumPrim * maxCurPrim)/(agLength + (cs.mean_mag_path_leng/cs.core_permeal));
    }
@@ -443,10 +460,10 @@ public:
     * @param prim_ind - Primary inductance
     * @return duty cycle value
     */
-   float actDutyCycle(const QVector<QPair<float, float>>& outVtcr, double in_volt_min,
-                                int32_t fsw, double prim_ind) const
+   T actDutyCycle(const QVector<QPair<float, float>>& outVtcr, T in_volt_min,
+                                T fsw, T prim_ind) const
    {
-       auto get_max = [](double frst, double scnd){return qMax(frst, scnd);};
+       auto get_max = [](T frst, T scnd){return qMax(frst, scnd);};
 
        auto max_vdc1_ratio = [&outVtcr, &in_volt_min](){return outVtcr[0].first/in_volt_min;}; //first - n-th voltage out
        auto duty1_max = max_vdc1_ratio()*qSqrt((2*fsw*prim_ind)/(outVtcr[0].first/outVtcr[0].second));
@@ -460,7 +477,7 @@ public:
        auto max_vdc4_ratio = [&outVtcr, &in_volt_min](){return outVtcr[3].first/in_volt_min;};
        auto duty4_max = max_vdc4_ratio()*qSqrt((2*fsw*prim_ind)/(outVtcr[3].first/outVtcr[3].second));
 
-       return static_cast<float>(qMax(get_max(duty1_max, duty2_max), get_max(duty3_max, duty4_max)));
+       return dualStore<float>(qMax(get_max(duty1_max, duty2_max), get_max(duty3_max, duty4_max)));
    }
 
    /**
@@ -473,13 +490,16 @@ public:
     * @param fsw - Switching frequency value
     * @return reflected voltage value
     */
-   int16_t actReflVoltage(float actDuty, float maxOutPwr,
-                                    double primInduct, int32_t fsw) const
+   T actReflVoltage(T actDuty, T maxOutPwr,
+                                    T primInduct, T fsw) const
    {
-       return qSqrt(2*maxOutPwr*primInduct*fsw)/(1-actDuty);
+       /** The float and int16_t storage of the plain model */
+       return dualStore<int16_t>(qSqrt(2*maxOutPwr*primInduct*fsw)/dualStore<float>(1-actDuty));
    }
 };
 
+typedef FBPTCoreT<double> FBPTCore;
+
 class FBPTSecondary
 {
 public:
@@ -0,0 +1,101 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef FREQGRID_H
+#define FREQGRID_H
+#include <QtMath>
+#include <QVector>
+#include <cstdint>
+
+#define FG_POINTS_PER_DECADE   100    //Base density of the log-spaced grid
+#define FG_CORNER_SPAN         2.     //Refined band around pole/zero, f/span..f*span
+#define FG_CORNER_REFINE       2      //Density multiplier around pole/zero
+#define FG_CROSS_SPAN          1.5    //Refined band around crossover, f/span..f*span
+#define FG_CROSS_REFINE        4      //Density multiplier around crossover
+#define FG_RES_POINTS          64     //Points placed in the -3dB band of a resonance
+#define FG_MAX_DENSITY         20000  //Upper limit of the refined density, points per decade
+
+/**
+ * @brief The FreqGrid class - frequency grid for the Bode sweeps.
+ *        The base grid is log-spaced with fixed points per decade,
+ *        the dense bands are placed only around the pole/zero, resonance
+ *        and crossover frequencies registered by the models.
+ *        All frequencies in Hz.
+ */
+class FreqGrid
+{
+private:
+    struct Feature
+    {
+        double freq; //Center frequency
+        double span; //Multiplicative half width of band, freq/span..freq*span
+        double density; //Points per decade inside band
+    };
+
+    double m_begin;
+    double m_end;
+    int32_t m_ppd;
+    QVector<Feature> m_feat;
+
+    void fgAddBand(double freq, double span, double density);
+
+public:
+    /**
+     * @brief FreqGrid
+     * @param begin - begin frequency point, must be above zero
+     * @param end - end frequency point
+     * @param ppd - base number of points per decade
+     */
+    FreqGrid(double begin, double end, int32_t ppd = FG_POINTS_PER_DECADE);
+
+    /**
+     * @brief fgAddCorner - register real pole or zero
+     * @param freq - corner frequency
+     */
+    void fgAddCorner(double freq);
+
+    /**
+     * @brief fgAddResonance - register complex pole or zero pair
+     * @param freq - natural frequency
+     * @param qual - quality factor, the pair with low Q is a corner
+     */
+    void fgAddResonance(double freq, double qual);
+
+    /**
+     * @brief fgAddCrossover - register expected crossover frequency
+     * @param freq - crossover frequency
+     */
+    void fgAddCrossover(double freq);
+
+    /**
+     * @brief fgBuild - create sorted sequence of the frequency points
+     * @return the frequency points in Hz
+     */
+    QVector<double> fgBuild() const;
+
+    /**
+     * @brief fgLogSpace - plain log-spaced grid without refinement
+     * @param begin - begin frequency point
+     * @param end - end frequency point
+     * @param ppd - points per decade
+     * @return the frequency points in Hz
+     */
+    static QVector<double> fgLogSpace(double begin, double end, int32_t ppd = FG_POINTS_PER_DECADE);
+};
+#endif // FREQGRID_H
@@ -0,0 +1,162 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef LCFILTER_H
+#define LCFILTER_H
+#include <QVector>
+#include <complex>
+#include <cstdint>
+#include "transferfunc.h"
+#include "freqgrid.h"
+
+#define LF_MAX_STAGES     3     //Upper limit of the stages of the post-filter
+#define LF_SWEEP_STEPS    16    //Points of the each swept L and C scale
+#define LF_SWEEP_SPAN     4.    //Swept range of L and C, nominal/span..nominal*span
+#define LF_DAMP_CAP_RATIO 4.    //C_d/C of the damping leg, the optimum of the R_d damping is near it
+#define LF_EVAL_PPD       40    //Points per decade of the candidate evaluation
+#define LF_PEAK_ITER      40    //Golden section steps of the resonance peak
+#define LF_CHUNK          32    //Candidates of one pool task
+
+/**
+ * @brief The LfStage struct - one LC section, the series inductor followed by
+ *        the shunt capacitor with its parasitics and the optional R_d-C_d damping leg across it
+ */
+struct LfStage
+{
+    double ind = 0.;      //L, H
+    double ind_res = 0.;  //DCR of L, Ohm
+    double cap = 0.;      //C, F
+    double cap_esr = 0.;  //ESR of C, Ohm
+    double cap_esl = 0.;  //ESL of C, H
+    double damp_res = 0.; //R_d, Ohm, no leg with zero
+    double damp_cap = 0.; //C_d, F
+};
+
+/**
+ * @brief The LfFilter struct - cascade of the stages from the source to the load
+ */
+struct LfFilter
+{
+    QVector<LfStage> stage;
+    double src_res = 0.;  //Source resistance, the ESR of the output capacitor before the filter
+    double load_res = 0.; //Load resistance
+};
+
+/**
+ * @brief The LfMetrics struct - figures of the filter response
+ */
+struct LfMetrics
+{
+    double atten_sw = 0.;    //Attenuation at the switching frequency, dB, positive
+    double peak_db = 0.;     //Gain of the resonance over the dc gain, dB
+    double freq_peak = 0.;   //Frequency of the peak, Hz
+    double zout_peak = 0.;   //Peak of the output impedance, Ohm
+    double mag_cross = 0.;   //Gain at the loop crossover, dB
+    double phase_cross = 0.; //Phase at the loop crossover, degree
+};
+
+/**
+ * @brief The LfSpec struct - the nominal filter and the targets of the sweep
+ */
+struct LfSpec
+{
+    int32_t stages = 1;        //Number of the identical stages, 1..LF_MAX_STAGES
+    LfStage nominal;           //Nominal stage, L and C are the centre of the sweep
+    double src_res = 0.;       //Ohm
+    double load_res = 0.;      //Ohm
+    double freq_switch = 0.;   //Hz
+    double freq_cross = 0.;    //Loop crossover, Hz
+    double atten_min = 0.;     //Lowest attenuation at the switching frequency, dB
+    double peak_max = 0.;      //Highest resonance peak, dB
+    double phase_max = 0.;     //Highest phase lag at the loop crossover, degree
+};
+
+/**
+ * @brief The LfCandidate struct - one point of the sweep
+ */
+struct LfCandidate
+{
+    double ind;      //L of the each stage
+    double cap;      //C of the each stage
+    double damp_res; //R_d of the each stage, zero without the leg
+    LfMetrics met;
+    bool feasible;
+    double cost;     //Reactive parts over the nominal ones, lower is better
+};
+
+/**
+ * @brief The LfSweepResult struct - all candidates, the best one by index
+ */
+struct LfSweepResult
+{
+    QVector<LfCandidate> cand;
+    int32_t best = -1; //Lowest cost of the feasible ones, else the lowest peak
+};
+
+/**
+ * @brief lfResponse - voltage transfer and output impedance by the cascade of the ABCD matrices
+ * @param flt - filter
+ * @param omega - rad/s
+ * @param zout - out impedance seen by the load with the source in place, may be null
+ * @return Vout/Vsource
+ */
+std::complex<double> lfResponse(const LfFilter &flt, double omega, std::complex<double> *zout = nullptr);
+
+/**
+ * @brief lfMetrics - attenuation, resonance peak and the loop interaction of the filter
+ * @param flt - filter
+ * @param freq_switch - Hz
+ * @param freq_cross - loop crossover, Hz
+ * @return
+ */
+LfMetrics lfMetrics(const LfFilter &flt, double freq_switch, double freq_cross);
+
+/**
+ * @brief lfTransfFunc - rational Vout/Vsource of the filter for composition of the loop,
+ *        the ABCD entries are expanded as polynomials of s over the common denominator
+ * @param flt - filter
+ * @return
+ */
+TransferFunction lfTransfFunc(const LfFilter &flt);
+
+/**
+ * @brief lfFillFreqGrid - register the poles of the filter for refinement of the sweep grid
+ * @param tf - filter response
+ * @param grid - frequency grid of the sweep
+ */
+void lfFillFreqGrid(const TransferFunction &tf, FreqGrid &grid);
+
+/**
+ * @brief lfBuild - the cascade of the identical stages
+ * @param spec - parasitics, source and load
+ * @param ind - L of the each stage
+ * @param cap - C of the each stage
+ * @param damp_res - R_d of the each stage, zero without the leg
+ * @return
+ */
+LfFilter lfBuild(const LfSpec &spec, double ind, double cap, double damp_res);
+
+/**
+ * @brief lfSweep - the grid of L, C and R_d around the nominal stage, the candidates
+ *        are split into LF_CHUNK slices solved by prRunPool
+ * @param spec - the nominal filter and the targets
+ * @return
+ */
+LfSweepResult lfSweep(const LfSpec &spec);
+#endif // LCFILTER_H
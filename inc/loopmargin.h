@@ -0,0 +1,186 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef LOOPMARGIN_H
+#define LOOPMARGIN_H
+#include <functional>
+#include "transferfunc.h"
+#include "sweepbuffer.h"
+
+#define LM_SCAN_PER_DECADE  8      //Points per decade of the bracketing scan
+#define LM_BRENT_TOL        1E-12  //Tolerance on ln(omega), relative accuracy of the frequency
+#define LM_BRENT_ITER_MAX   100
+#define LM_DEG_COEFF        (180./M_PI)
+#define LM_DB_COEFF         (20./M_LN10)
+
+/**
+ * @brief The LoopMargins struct - stability margins of the open loop gain.
+ *        Where several crossings exist the worst margin is reported.
+ */
+struct LoopMargins
+{
+    bool has_cross = false; //0dB crossing found
+    double freq_cross = 0.; //Crossover frequency, Hz
+    double phase_marg = 0.; //Phase margin at the crossover, degree
+    bool has_180 = false; //-180 degree crossing found
+    double freq_180 = 0.; //Phase crossover frequency, Hz
+    double gain_marg = 0.; //Gain margin at the phase crossover, dB
+};
+
+/**
+ * @brief The LoopNyquist struct - Nyquist criterion of the loop, Z = N + P
+ */
+struct LoopNyquist
+{
+    int32_t encircle = 0; //Clockwise encirclements of -1 + j0
+    int32_t open_rhp = 0; //Open loop poles in rhp, P
+    int32_t closed_rhp = 0; //Closed loop poles in rhp, Z
+};
+
+/**
+ * @brief The ClosedLoopFigures struct - peaks of the closed loop responses read from their sweeps
+ */
+struct ClosedLoopFigures
+{
+    double bandwidth = 0.; //-3dB frequency of T/(1 + T), Hz, zero if not reached
+    double peaking = 0.; //Peak of T/(1 + T) over its value at the first point, dB
+    double zout_peak = 0.; //Peak of the closed loop output impedance, Ohm
+    double zout_freq = 0.; //Hz
+    double audio_peak = 0.; //Peak of the audio susceptibility, dB
+    double audio_freq = 0.; //Hz
+};
+
+/**
+ * @brief lmLogMagPhase - natural log of magnitude and continuous phase of the response,
+ *        the phase is the sum of the per-factor phases and has no wrapping,
+ *        on the scalar T of the factors
+ * @param bf - factored response
+ * @param omega - rad/s
+ * @param lnmag - out ln|H|
+ * @param phase - out phase in degree
+ */
+template<typename T>
+void lmLogMagPhase(const BodeFactorsT<T> &bf, T omega, T &lnmag, T &phase)
+{
+    using std::log; using std::fabs; using std::atan; using std::atan2;
+    T mag2 = 1.;
+    T lnm = log(fabs(bf.gain)) + bf.order * log(omega);
+    T phs = 0.5 * M_PI * bf.order + ((bf.gain < 0.) ? M_PI : 0.);
+
+    /** The squared magnitudes of numerator and denominator are folded into log separately to stay in range */
+    for(const T &tc : bf.tz)
+    {
+        const T wt = omega * tc;
+        mag2 *= 1. + wt * wt;
+        phs += atan(wt);
+    }
+    for(int32_t indx = 0; indx < bf.az.size(); ++indx)
+    {
+        const T re = 1. - omega * omega * bf.az[indx];
+        const T im = omega * bf.bz[indx];
+        mag2 *= re * re + im * im;
+        phs += atan2(im, re);
+    }
+    lnm += 0.5 * log(mag2);
+
+    mag2 = 1.;
+    for(const T &tc : bf.tp)
+    {
+        const T wt = omega * tc;
+        mag2 *= 1. + wt * wt;
+        phs -= atan(wt);
+    }
+    for(int32_t indx = 0; indx < bf.ap.size(); ++indx)
+    {
+        const T re = 1. - omega * omega * bf.ap[indx];
+        const T im = omega * bf.bp[indx];
+        mag2 *= re * re + im * im;
+        phs -= atan2(im, re);
+    }
+    lnm -= 0.5 * log(mag2);
+
+    lnmag = lnm;
+    phase = phs * LM_DEG_COEFF;
+}
+
+/**
+ * @brief lmSolveMargins - crossover, phase and gain margin without the sweep arrays,
+ *        the crossings are bracketed on a coarse log grid refined by the corners
+ *        of the response and solved by Brent on ln(omega)
+ * @param bf - factored open loop gain
+ * @param freq_begin - lower frequency of the search, Hz
+ * @param freq_end - upper frequency of the search, Hz
+ * @return
+ */
+LoopMargins lmSolveMargins(const BodeFactors &bf, double freq_begin, double freq_end);
+
+/**
+ * @brief lmSolveMargins - see above
+ */
+LoopMargins lmSolveMargins(const TransferFunction &tf, double freq_begin, double freq_end);
+
+/**
+ * @brief lmSolveMargins - the crossings are bracketed by the points of the loop sweep
+ * @param bf - factored open loop gain
+ * @param buf - loop sweep filled by lmSweepLoop
+ * @return
+ */
+LoopMargins lmSolveMargins(const BodeFactors &bf, const SweepBuffer &buf);
+
+/**
+ * @brief lmSolveMargins - as above for the response without the factored form,
+ *        the loop with the sampled compensator
+ * @param resp - complex response at the angular frequency in rad/s
+ * @param buf - sweep of the response with the unwrapped phase
+ * @return
+ */
+LoopMargins lmSolveMargins(const std::function<std::complex<double>(double)> &resp, const SweepBuffer &buf);
+
+/**
+ * @brief lmSweepLoop - complex response of the loop on the points of the buffer,
+ *        the magnitude, unwrapped phase and the encirclement count are taken
+ *        from it without the further model evaluation. The sweep must start
+ *        low enough that |T| >> 1 where the loop has the integrator.
+ * @param tf - open loop gain
+ * @param buf - buffer with the complex part and the frequency points
+ * @return
+ */
+LoopNyquist lmSweepLoop(const TransferFunction &tf, SweepBuffer &buf);
+
+/**
+ * @brief lmSweepLoop - as above with the closed loop responses in the same pass over the points,
+ *        the first closed buffer gets T/(1 + T) and the next ones path/(1 + T)
+ * @param tf - open loop gain
+ * @param path - open loop paths from the disturbance to the output
+ * @param buf - buffer with the complex part and the frequency points
+ * @param closed - path.size() + 1 buffers, the frequency points are taken from buf
+ * @return
+ */
+LoopNyquist lmSweepLoop(const TransferFunction &tf, const QVector<TransferFunction> &path,
+                        SweepBuffer &buf, const QVector<SweepBuffer*> &closed);
+
+/**
+ * @brief lmClosedFigures - bandwidth and peaks on the points of the closed loop sweeps
+ * @param closed - T/(1 + T)
+ * @param zout - closed loop output impedance
+ * @param audio - closed loop line to output
+ * @return
+ */
+ClosedLoopFigures lmClosedFigures(const SweepBuffer &closed, const SweepBuffer &zout, const SweepBuffer &audio);
+#endif // LOOPMARGIN_H
@@ -0,0 +1,132 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef MEASFIT_H
+#define MEASFIT_H
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include "controlout.h"
+
+#define MF_CHUNK_BYTES    (1 << 20) //Bytes of the file parsed by one pool task
+#define MF_CHUNK_POINTS   4096      //Points of one fit task
+#define MF_PARAM_NUM      2         //Fitted parameters of each model
+#define MF_ITER_MAX       50        //Levenberg-Marquardt iterations
+#define MF_LAMBDA_INIT    1E-3      //Initial damping of the normal equations
+#define MF_LAMBDA_MAX     1E10      //No descent direction above it
+#define MF_DIFF_STEP      1E-6      //Step of the forward difference on the log of the parameter
+#define MF_COST_TOL       1E-10     //Relative decrease of the cost to stop
+#define MF_STEP_TOL       1E-9      //Step on the log of the parameters to stop
+
+/**
+ * @brief The MF_TARGET enum - the measured response and its fitted parameters
+ */
+enum MF_TARGET
+{
+    MF_POWER_STAGE = 0, //G_{vc}, ESR of C_{out} and L_{p}
+    MF_OPTO_FEEDB  = 1  //H(s) of the feedback, CTR and the optocoupler pole
+};
+
+/**
+ * @brief The MfMeasure struct - measured response sorted by the frequency
+ */
+struct MfMeasure
+{
+    QVector<double> freq; //Hz
+    QVector<double> mag; //dB
+    QVector<double> phs; //Degree, unwrapped
+    QString error; //Empty on success
+};
+
+/**
+ * @brief The MfFitModel struct - nominal model of the fit, the fitted parameters
+ *        are varied around their design values
+ */
+struct MfFitModel
+{
+    MF_TARGET target;
+    SSMPreDesign ssm; //Power stage
+    PS_MODE mode;
+    FCCoeff comp; //Feedback network with the LC stage
+    FC_COMP comp_type;
+    double opto_ctr; //Design CTR, the gain of the network is proportional to it
+};
+
+/**
+ * @brief The MfFitResult struct - fitted values, for MF_POWER_STAGE the ESR in Ohm and L_{p} in H,
+ *        for MF_OPTO_FEEDB the CTR and the optocoupler pole in Hz
+ */
+struct MfFitResult
+{
+    double nominal[MF_PARAM_NUM] = {0., 0.};
+    double fitted[MF_PARAM_NUM] = {0., 0.};
+    double rms_mag = 0.; //dB
+    double rms_phs = 0.; //Degree
+    int32_t iter = 0;
+    bool converged = false;
+    bool stalled = false; //No descent at the highest damping, the fit stopped off the minimum
+    BodeFactors fit; //Response of the fitted parameters
+};
+
+/**
+ * @brief mfLoad - import the measured Bode data. The file is memory mapped and split
+ *        into MF_CHUNK_BYTES slices at the line ends. The lines of the slices are counted and
+ *        then parsed on the global QThreadPool, each slice writes its points in place
+ *        after the points of the slices before it, so the file order is kept.
+ *        CSV: frequency in Hz, magnitude in dB and phase in degree, separated by the comma,
+ *        semicolon, tab or space, the lines that do not start with a number are skipped.
+ *        Touchstone (.s1p, .s2p): the option line sets the frequency unit and DB/MA/RI format,
+ *        S11 of the one port and S21 of the two port file is taken.
+ *        The numbers are parsed with the dot as decimal point whatever the locale is.
+ * @param path - file name
+ * @return the measure, the error is set if nothing was read
+ */
+MfMeasure mfLoad(const QString &path);
+
+/**
+ * @brief mfParseText - see mfLoad, for the text in memory
+ * @param text - file content
+ * @param size - bytes
+ * @param touchstone - the touchstone format
+ * @return
+ */
+MfMeasure mfParseText(const char *text, int64_t size, bool touchstone);
+
+/**
+ * @brief mfModelFactors - response of the model with the parameter values
+ * @param model - nominal model
+ * @param param - MF_PARAM_NUM values, see MfFitResult
+ * @return
+ */
+BodeFactors mfModelFactors(const MfFitModel &model, const double *param);
+
+/**
+ * @brief mfFit - Levenberg-Marquardt fit of the model to the measure. The residual of
+ *        the point is the difference of the natural log of the magnitude and of the
+ *        wrapped phase in radian, the parameters are fitted on their log so they stay positive.
+ *        The Jacobian by the forward difference and the normal equations are accumulated
+ *        over MF_CHUNK_POINTS slices on the global QThreadPool and summed in the slice order,
+ *        the result does not depend on the number of threads.
+ * @param model - nominal model, the start of the fit
+ * @param meas - measured response
+ * @return
+ */
+MfFitResult mfFit(const MfFitModel &model, const MfMeasure &meas);
+#endif // MEASFIT_H
@@ -0,0 +1,118 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef MODEMAP_H
+#define MODEMAP_H
+#include <QVector>
+#include <cstdint>
+#include "controlout.h"
+
+#define MM_VOLT_STEPS   256   //Points of the input voltage axis
+#define MM_LOAD_STEPS   256   //Points of the load axis
+#define MM_LOAD_MIN     1.    //Lowest load of the map, percent, the boundary is at infinity without load
+#define MM_BCM_BAND     2.    //Margin of the boundary conduction, percent of L_{crit}
+#define MM_CHUNK_ROWS   8     //Load rows of one pool task
+
+/**
+ * @brief The MM_MODE enum - conduction mode of the map cell, the value is the level of the plot
+ */
+enum MM_MODE
+{
+    MM_CCM = 0,
+    MM_BCM = 1, //Inside MM_BCM_BAND of the boundary
+    MM_DCM = 2
+};
+
+/**
+ * @brief The MmSpec struct - design values of the conduction mode map,
+ *        the input is the peak of the line at the bulk capacitor without its ripple
+ */
+struct MmSpec
+{
+    double volt_ac_min = 0.; //V rms
+    double volt_ac_max = 0.; //V rms
+    double power_max = 0.; //Full load output power, W
+    double eff = 1.; //Efficiency, the input power is P_{out}/eff
+    double prim_ind = 0.; //L_{p}, H
+    double volt_refl = 0.; //V_{r} = N_{p}/N_{s}(V_{out} + V_{d}), V
+    double freq_switch = 0.; //Hz
+};
+
+/**
+ * @brief The MmMap struct - critical inductance and the margin to the boundary
+ *        over the line and load, the row per load and the column per voltage.
+ *        L_{crit} = (V_{in}D)^2 eff/(2 P_{out} f_{sw}) is the K = K_{crit} = (1-D)^2
+ *        boundary of the coDCMCriticValue model at the CCM duty D.
+ */
+struct MmMap
+{
+    int32_t volt_num = 0;
+    int32_t load_num = 0;
+    double volt_min = 0.; //V rms of the first column
+    double volt_max = 0.; //V rms of the last column
+    double load_min = 0.; //Percent of the full load of the first row
+    double load_max = 0.; //Percent of the full load of the last row
+    QVector<double> ind_crit; //L_{crit}, H
+    QVector<double> margin; //(L_{crit} - L_{p})/L_{crit}, percent, positive in DCM
+    QVector<double> bound; //Load of the boundary for each column, percent of the full load
+    double ccm_share = 0.; //Percent of the cells in CCM
+    double ind_crit_min = 0.; //Lowest L_{crit} of the map, H
+
+    inline double mmVolt(int32_t col) const
+    {
+        return (volt_num > 1) ? volt_min + (volt_max - volt_min) * col / (volt_num - 1) : volt_min;
+    }
+
+    inline double mmLoad(int32_t row) const
+    {
+        return (load_num > 1) ? load_min + (load_max - load_min) * row / (load_num - 1) : load_min;
+    }
+
+    /**
+     * @brief mmMode - conduction mode of the cell, the BCM inside MM_BCM_BAND of the boundary
+     */
+    inline MM_MODE mmMode(int32_t col, int32_t row) const
+    {
+        const double mrg = margin[row * volt_num + col];
+        if(qAbs(mrg) < MM_BCM_BAND)
+            return MM_BCM;
+        return (mrg > 0.) ? MM_DCM : MM_CCM;
+    }
+};
+
+/**
+ * @brief mmCriticInd - primary inductance of the boundary conduction at the operating point
+ * @param spec - design values
+ * @param volt_ac - line voltage, V rms
+ * @param load - output power, percent of the full load
+ * @return L_{crit}, H
+ */
+double mmCriticInd(const MmSpec &spec, double volt_ac, double load);
+
+/**
+ * @brief mmSolveMap - the map on the line and load grid, the load rows are split into
+ *        MM_CHUNK_ROWS slices solved by prRunPool
+ * @param spec - design values
+ * @param volt_num - points of the line voltage
+ * @param load_num - points of the load, MM_LOAD_MIN..100 percent
+ * @return the empty map for the incomplete design
+ */
+MmMap mmSolveMap(const MmSpec &spec, int32_t volt_num = MM_VOLT_STEPS, int32_t load_num = MM_LOAD_STEPS);
+#endif // MODEMAP_H
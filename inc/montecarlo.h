@@ -0,0 +1,165 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+#include <QVector>
+#include <cstdint>
+#include "controlout.h"
+#include "loopmargin.h"
+#include "lcfilter.h"
+
+#define MC_SAMPLES        100000 //Default number of the samples
+#define MC_CHUNK_SAMPLES  512    //Samples of one pool task
+#define MC_HIST_BINS      60     //Bins of the histograms
+#define MC_SEED           0x46534D5053ULL //Default seed of the sample streams
+
+/**
+ * Distribution of the multiplier of the nominal value, the range is lower..upper
+ */
+enum MC_DIST
+{
+    MC_DIST_NONE    = 0, //Nominal value, the range is ignored
+    MC_DIST_UNIFORM = 1, //Flat over the range
+    MC_DIST_NORMAL  = 2, //Mean in the middle of the range, the half width of it is 3 sigma, the tails are cut
+    MC_DIST_LOG     = 3  //Flat over the log of the range, the spread of the CTR
+};
+
+/**
+ * Varied parameter, the value is the index in the tolerance vector
+ */
+enum MC_PARAM
+{
+    MC_PRIMARY_IND = 0, //L_{p}
+    MC_RES_SENSE,       //R_{s}
+    MC_OUTPUT_CAP,      //C_{out}
+    MC_OUTPUT_CAP_ESR,  //ESR of C_{out}
+    MC_LOAD_RES,        //R_{load}
+    MC_SAW_VOLT,        //S_{e}
+    MC_OPTO_CTR,        //CTR of the optocoupler
+    MC_RES_PULL_UP,     //R_{pullup}
+    MC_RES_ZERO,        //R_{f}
+    MC_CAP_ZERO,        //C_{f}
+    MC_CAP_POLE,        //C_{opto}
+    MC_LC_IND,          //L of the output filter stages
+    MC_LC_CAP,          //C and C_{d} of the output filter stages
+    MC_PARAM_NUM
+};
+
+/**
+ * @brief The McTolerance struct - multiplier of the nominal value of one parameter
+ */
+struct McTolerance
+{
+    MC_DIST dist;
+    double lower;
+    double upper;
+};
+
+/**
+ * @brief The McModel struct - nominal loop of the run. The power stage is rebuilt
+ *        from the design values of the sample, the compensator and the output filter
+ *        are varied on the compiled coefficients, their parts enter them as products.
+ *        The output filter is the network of the loop gain, its response is built
+ *        again from the L, C and the load of the sample.
+ */
+struct McModel
+{
+    SSMPreDesign ssm;
+    PS_MODE mode;
+    FCCoeff comp;
+    FC_COMP comp_type;
+    LfFilter filter; //Output filter of the loop gain, no stages until the filter is calculated
+};
+
+/**
+ * @brief The McLimits struct - acceptance of the sample
+ */
+struct McLimits
+{
+    double phase_marg; //Lowest phase margin, degree
+    double gain_marg; //Lowest gain margin, dB
+};
+
+/**
+ * @brief The McResult struct - margins of each sample, the sample index is the
+ *        index of the stream, the result does not depend on the number of threads
+ */
+struct McResult
+{
+    int32_t samples = 0;
+    int32_t passed = 0; //Samples with the crossover and both margins within the limits
+    int32_t no_cross = 0; //Samples without the crossover
+    QVector<double> freq_cross; //Hz, NaN without the crossover
+    QVector<double> phase_marg; //Degree, NaN without the crossover
+    QVector<double> gain_marg; //dB, +inf without the phase crossover
+
+    inline double mcYield() const {return (samples > 0) ? static_cast<double>(passed) / samples : 0.;}
+};
+
+/**
+ * @brief The McHistogram struct - counts of the equal bins
+ */
+struct McHistogram
+{
+    double lower = 0.; //Left edge of the first bin
+    double width = 0.; //Bin width
+    QVector<double> count;
+};
+
+/**
+ * @brief mcDefaultTolerances - usual spread of the parts, the CTR spans the
+ *        datasheet range over the minimum one and the load is nominal
+ * @return MC_PARAM_NUM tolerances
+ */
+QVector<McTolerance> mcDefaultTolerances();
+
+/**
+ * @brief mcRun - margins of the loop over the random parts. The samples are split into
+ *        MC_CHUNK_SAMPLES slices solved on the global QThreadPool, the sample draws from
+ *        its own splitmix64 stream seeded by the hash of the seed and the sample index.
+ *        Each sample costs one margin solution, no sweep arrays are built.
+ * @param model - nominal loop
+ * @param tol - MC_PARAM_NUM tolerances
+ * @param lim - acceptance of the sample
+ * @param samples - number of the samples
+ * @param seed - the same seed gives the same result
+ * @param freq_begin - search range of the margins, Hz
+ * @param freq_end
+ * @return
+ */
+McResult mcRun(const McModel &model, const QVector<McTolerance> &tol, const McLimits &lim,
+               int32_t samples, uint64_t seed, double freq_begin, double freq_end);
+
+/**
+ * @brief mcHistogram - counts of the finite values over their range
+ * @param val - values, NaN and infinity are skipped
+ * @param bins - number of the bins
+ * @return
+ */
+McHistogram mcHistogram(const QVector<double> &val, int32_t bins = MC_HIST_BINS);
+
+/**
+ * @brief mcPercentile - value below which the part of the finite values lies
+ * @param val - values, NaN and infinity are skipped
+ * @param part - 0..1
+ * @return NaN without the finite values
+ */
+double mcPercentile(const QVector<double> &val, double part);
+#endif // MONTECARLO_H
@@ -24,6 +24,8 @@
 #include <QVector>
 //#include <QDebug>
 #include <cstdint>
+#include "freqgrid.h"
+#include "transferfunc.h"
 
 #define M_PI_DEG    180
 
@@ -88,23 +90,30 @@ public:
     }
 
     /**
-     * @brief ofPlotArray - Filling of data table
-     * @param tabmap - ptr to map object
-     * @param begin  - begin frequency point
-     * @param end - end frequency point
-     * @param step - frequency step
+     * @brief ofFillFreqGrid - register the filter resonance for refinement of the sweep grid
+     * @param grid - frequency grid of the sweep
      */
-    void ofPlotArray(QVector<double> &freq_vector, QVector<double> &mag_vector, QVector<double> &phase_vector, int32_t begin, int32_t end, int32_t step);
-
-private:
-    inline double ofTFMagnitude(const double freq);
+    void ofFillFreqGrid(FreqGrid &grid);
 
-    inline double ofTFMagnitudeGain(const double freq);
+    /**
+     * @brief ofBodeFactors - second order low-pass response in factored form for the sweep kernel
+     * @return
+     */
+    BodeFactors ofBodeFactors();
 
-    inline double ofTFPhaseAng(const double freq);
+    /**
+     * @brief ofTransfFunc - filter response for composition of the loop
+     * @return
+     */
+    inline TransferFunction ofTransfFunc() {return TransferFunction(ofBodeFactors());}
 
-    inline double ofTFphase(const double freq);
+    /**
+     * @brief ofPlotArray - Filling of data table
+     * @param buf - frequency points of the sweep, out magnitude in dB and phase in degree
+     */
+    void ofPlotArray(SweepBuffer &buf);
 
+private:
     int32_t m_freq=0;
     int32_t m_rload=0;
 };
@@ -0,0 +1,81 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef PLOTDECIMATOR_H
+#define PLOTDECIMATOR_H
+#include <QVector>
+#include <cstdint>
+
+#define PD_RAW_PER_COLUMN   2   //Visible range below this number of points per column is drawn as is
+#define PD_MIN_COLUMNS      512 //Columns used while the plot is not laid out yet
+
+/**
+ * @brief The PdPoint struct - point of the graph data
+ */
+struct PdPoint
+{
+    double key;
+    double value;
+};
+
+/**
+ * @brief The PlotDecimator class - min/max pyramid of the sorted graph data.
+ *        The level k keeps the minimum and maximum of each 2^k points with their
+ *        indices, so the extremes of any index range are found in O(log n).
+ *        The visible range is split into pixel columns and every column gives
+ *        its minimum and maximum point in the original order, about 2x the pixel
+ *        width of points whatever the size of the data. Built once per dataset,
+ *        immutable after that.
+ */
+class PlotDecimator
+{
+public:
+    /**
+     * @brief PlotDecimator
+     * @param data - points sorted by key
+     */
+    explicit PlotDecimator(const QVector<PdPoint> &data);
+
+    /**
+     * @brief pdDecimate - points of the visible range
+     * @param lower - lower key of the range
+     * @param upper - upper key of the range
+     * @param columns - pixel width of the range
+     * @param logscale - the key axis is logarithmic
+     * @return points in the key order
+     */
+    QVector<PdPoint> pdDecimate(double lower, double upper, int32_t columns, bool logscale) const;
+
+    inline int32_t pdSize() const {return m_data.size();}
+
+private:
+    struct Node
+    {
+        int32_t imin;
+        int32_t imax;
+    };
+
+    void pdRangeExtremes(int32_t begin, int32_t end, int32_t &imin, int32_t &imax) const;
+    void pdMerge(int32_t &imin, int32_t &imax, const Node &node) const;
+    int32_t pdLowerBound(double key, int32_t from) const;
+
+    QVector<PdPoint> m_data;
+    QVector<QVector<Node>> m_level; //m_level[k-1] covers 2^k points per node
+};
+#endif // PLOTDECIMATOR_H
@@ -0,0 +1,67 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef PLOTLINK_H
+#define PLOTLINK_H
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include "plotdecimator.h"
+#include "bodeplotdata.h"
+#include "qcustomplot.h"
+
+/**
+ * @brief The PlotDecimatorLink class - feeds the graph from the decimator and
+ *        refreshes it on each range change of the key axis
+ */
+class PlotDecimatorLink : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief pdAttach - show the dataset on the graph, the link of the graph is reused by the next dataset
+     * @param graph - target graph
+     * @param dec - decimator of the dataset, the null one clears the graph
+     */
+    static void pdAttach(QCPGraph *graph, const QSharedPointer<const PlotDecimator> &dec);
+
+public slots:
+    void pdRefresh();
+
+private:
+    explicit PlotDecimatorLink(QCPGraph *graph);
+
+    QPointer<QCPGraph> m_graph;
+    QSharedPointer<const PlotDecimator> m_dec;
+};
+
+/**
+ * @brief plSetCurve - points of the curve payload on the plottable, the index is the parameter t
+ * @param curve - target curve
+ * @param data - curve of the solver
+ */
+void plSetCurve(QCPCurve *curve, const CurvePlotData &data);
+
+/**
+ * @brief plSetColorMap - cells and ranges of the color map payload on the plottable
+ * @param map - target color map
+ * @param data - cells of the solver
+ */
+void plSetColorMap(QCPColorMap *map, const ColorMapPlotData &data);
+#endif // PLOTLINK_H
@@ -0,0 +1,100 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef POOLRUNNER_H
+#define POOLRUNNER_H
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <cstdint>
+
+/**
+ * @brief The PoolSlices struct - slices of the job shared by the workers and the caller,
+ *        each of them takes the next free slice until nothing left
+ */
+struct PoolSlices
+{
+    int32_t count = 0;
+    QAtomicInt next;
+
+    /**
+     * @brief prTake - index of the next free slice
+     * @return false if all the slices are taken
+     */
+    inline bool prTake(int32_t &slice)
+    {
+        slice = next.fetchAndAddOrdered(1);
+        return slice < count;
+    }
+};
+
+/**
+ * @brief The PoolWorker class - pool worker of the job, see prRunPool
+ */
+template<typename Job>
+class PoolWorker : public QRunnable
+{
+public:
+    PoolWorker(Job *job, QSemaphore *done)
+        :m_job(job)
+        ,m_done(done)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        m_job->prRunSlices();
+        m_done->release();
+    }
+
+private:
+    Job *m_job;
+    QSemaphore *m_done;
+};
+
+/**
+ * @brief prRunPool - evaluate all slices of the job. The job has the PoolSlices member
+ *        slices and the prRunSlices method that takes them. The caller takes the slices
+ *        too, the workers are started only on the idle threads of the pool, so the nested
+ *        job from the pool task can not lock up.
+ * @param job - sliced job
+ * @param pool - the global pool unless the caller owns one
+ */
+template<typename Job>
+void prRunPool(Job &job, QThreadPool *pool = QThreadPool::globalInstance())
+{
+    QSemaphore done;
+    int32_t workers = 0;
+    while(workers < job.slices.count - 1)
+    {
+        PoolWorker<Job> *worker = new PoolWorker<Job>(&job, &done);
+        if(!pool->tryStart(worker))
+        {
+            delete worker;
+            break;
+        }
+        ++workers;
+    }
+    job.prRunSlices();
+    done.acquire(workers);
+}
+#endif // POOLRUNNER_H
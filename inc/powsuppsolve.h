@@ -36,9 +36,24 @@
 #include "capout.h"
 #include "outfilter.h"
 #include "controlout.h"
+#include "loopmargin.h"
+#include "comptuner.h"
+#include "designsens.h"
+#include "lcfilter.h"
+#include "measfit.h"
+#include "discretize.h"
+#include "modemap.h"
+#include "bodeplotdata.h"
 
 #define SET_SECONDARY_WIRED 4
-#define SET_FREQ_SIZE 1*1E7 //10MHz
+#define SET_FREQ_BEGIN 10 //10Hz
+#define SET_FREQ_END 1E7 //10MHz
+#define SET_OF_FREQ_END 1E6 //1MHz, the LC filter sweep
+#define SET_LF_CROSS_RATIO 0.05 //Crossover of the filter design before the loop is solved, part of the switching frequency
+#define SET_TR_CROSS_PERIODS 20 //Simulated time of the steps in periods of the crossover
+#define SET_TR_SAMPLES 20000 //Samples of the each step
+#define SET_TR_LOAD_STEP 0.5 //Load current step, part of the full load
+#define SET_TR_LINE_STEP 0.1 //Input voltage step, part of the input voltage
 
 class PowSuppSolve: public QObject
 {
@@ -47,6 +62,54 @@ public:
     explicit PowSuppSolve(QObject *parent = nullptr);
     ~PowSuppSolve();
 
+    /**
+     * @brief setSweepPrecision - exact or fast transcendental functions of the analysis,
+     *        takes effect from the next calculation, call it from the solver thread
+     * @param id - analysis
+     * @param prec - the fast mode for the exploratory runs, the exact one for the sign-off
+     */
+    void setSweepPrecision(SWEEP_ID id, BK_PREC prec);
+
+    /**
+     * @brief setPlotOutput - the headless run skips the sweeps and payloads drawn only,
+     *        the result hashes are filled in the both modes
+     * @param enabled - false for the batch solver
+     */
+    void setPlotOutput(bool enabled);
+
+    /**
+     * @brief deriveOutputPower - maximum output power of the all outputs with the margin
+     */
+    void deriveOutputPower();
+
+    /**
+     * @brief deriveSwitchNetwork - clamp and current sense values taken from the transformer
+     */
+    void deriveSwitchNetwork();
+
+    /**
+     * @brief deriveOutCap - voltage and current of the each output capacitor, the ripple,
+     *        ESR and crossover of the m_cop entries are set by the caller
+     */
+    void deriveOutCap();
+
+    /**
+     * @brief derivePowerStageModel - the power stage model from the primary side, switch and output capacitor
+     */
+    void derivePowerStageModel();
+
+    /**
+     * @brief deriveOptocouplerFeedback - the derived part of the compensator, ramp and second stage values,
+     *        the resistors, margins and optocoupler values of m_fc and the ESR of m_lc are set by the caller
+     */
+    void deriveOptocouplerFeedback();
+
+    /**
+     * @brief calcDesign - the whole chain from the input network to the loop in one call,
+     *        for the headless run without the connected finished signals
+     */
+    void calcDesign();
+
 
 public slots:
     void calcInputNetwork();
@@ -61,6 +124,23 @@ public slots:
     void calcOutputFilter();
     void calcPowerStageModel();
     void calcOptocouplerFeedback();
+    void calcCompTuner();
+    void calcMonteCarlo();
+    void calcSensitivity();
+    void calcFilterDesign();
+    void calcMeasureImport(int32_t target, QString path);
+    void calcMeasureFit(int32_t target);
+    void calcDigitalComp();
+    /**
+     * @brief calcRootLocus - closed loop poles of the assembled loop over the
+     *        multiplier of the compensator gain or optocoupler CTR
+     */
+    void calcRootLocus();
+    /**
+     * @brief calcTransient - output deviation of the closed loop after the load
+     *        and line steps, simulated on the state-space form of the responses
+     */
+    void calcTransient();
 
 signals:
     void finishedCalcInputNetwork();
@@ -71,14 +151,35 @@ signals:
     void finishedCalcSwitchNetwork();
     void finishedCalcOtputNetwork();
     void newOFDataHash(QHash<QString, double>);
-    void newOFDataPlot(QVector<double>, QVector<double>);
+    void newOFDataPlot(BodePlotData);
     void finishedCalcOutputFilter();
     void newPSMDataHash(QHash<QString, double>);
-    void newPSMDataPlot(QVector<double>, QVector<double>);
+    void newPSMDataPlot(BodePlotData);
+    void newMMDataHash(QHash<QString, double>);
+    void newMMDataPlot(ModeMapPlotData);
     void finishedCalcPowerStageModel();
     void newOCFDataHash(QHash<QString, double>);
-    void newOCFDataPlot(QVector<double>, QVector<double>);
+    void newOCFDataPlot(BodePlotData);
     void finishedCalcOptocouplerFeedback();
+    void newLoopDataHash(QHash<QString, double>);
+    void newLoopDataPlot(LoopPlotData);
+    void newCLDataHash(QHash<QString, double>);
+    void newCLDataPlot(ClosedLoopPlotData);
+    void newLocusDataHash(QHash<QString, double>);
+    void newLocusDataPlot(RootLocusPlotData);
+    void newTransDataHash(QHash<QString, double>);
+    void newTransDataPlot(TransientPlotData);
+    void newTuneDataHash(QHash<QString, double>);
+    void newMCDataHash(QHash<QString, double>);
+    void newMCDataPlot(MonteCarloPlotData);
+    void newSensDataTable(SensTableData);
+    void newLFDDataHash(QHash<QString, double>);
+    void newLFDDataPlot(BodePlotData);
+    void newMeasDataPlot(int32_t, BodePlotData);
+    void newFitDataHash(int32_t, QHash<QString, double>);
+    void newFitDataPlot(int32_t, BodePlotData);
+    void newDZDataHash(QHash<QString, double>);
+    void newDZDataPlot(DigitalCompData);
     void calcFinished();
 
 private:
@@ -287,6 +388,30 @@ private:
     QVector<QSharedPointer<FBPTWinding>> m_wind;
     QScopedPointer<PCSSM> m_pcssm;
     QScopedPointer<FCCD> m_fccd;
+    bool m_plot_out = true;
+
+    /**
+     * @brief calcModeMap - conduction mode over the line and load range
+     *        at the primary inductance and turns ratio of the power stage model
+     */
+    void calcModeMap();
+
+    /**
+     * @brief calcLoopGain - T(s) = G_{vc}(s)H_{comp}(s)H_{lc}(s) assembled once
+     *        from the power stage, compensator and output filter and swept in one pass
+     */
+    void calcLoopGain();
+
+    /**
+     * @brief commTurnRatio - turns ratio of the first output at the actual duty cycle
+     */
+    float commTurnRatio() const;
+
+    /**
+     * @brief sweepGrid - place the grid points into the buffer of the analysis
+     * @return false if the grid does not fit into the buffer
+     */
+    bool sweepGrid(SWEEP_ID id, const FreqGrid &grid);
 
 public:
     InputValue m_indata;
@@ -304,6 +429,8 @@ public:
     FCPreDesign m_fc;
     RampSlopePreDesign m_rs;
     LCSecondStage m_lc;
+    LfSpec m_lfs; /**< Stages, targets and parasitics of the filter design, the rest is set by the solver */
+    DzSpec m_dzs; /**< Method, sample rate and word format of the digital compensator */
 
     /*
     "ACF" - angular_cut_freq
@@ -315,9 +442,6 @@ public:
     "ORV" - out_ripp_voltage
     */
     QHash<QString, double> m_ofhshdata;
-    QVector<double> m_offrq;
-    QVector<double> m_ofmag;
-    QVector<double> m_ofphs;
 
     /*
     "ZONE" - ps_zero_one
@@ -329,9 +453,6 @@ public:
     "GCMC" - ps_gain_cmc_mod
     */
     QHash<QString, double> m_ssmhshdata;
-    QVector<double> m_ssmfrq;
-    QVector<double> m_ssmmag;
-    QVector<double> m_ssmphs;
 
     /*
     "RESOPTLED" - ofs_opto_led_res
@@ -348,9 +469,125 @@ public:
      "CAPERR" - ofs_cap_err_amp
     */
     QHash<QString, double> m_ofshshdata;
-    QVector<double> m_ofsfrq;
-    QVector<double> m_ofsmag;
-    QVector<double> m_ofsphs;
+
+    /*
+    "MMCCM" - mm_ccm_share, percent of the map
+    "MMLC" - mm_crit_ind_min
+    "MMPBL" - mm_boundary_load_low_line, percent of the full load
+    "MMPBH" - mm_boundary_load_high_line, percent of the full load
+    "MMOK" - mm_model_valid, zero if the DCM model is selected and part of the map is in CCM
+    */
+    QHash<QString, double> m_mmhshdata;
+
+    /*
+    "FC" - loop_cross_freq
+    "PM" - loop_phase_marg
+    "F180" - loop_phase_cross_freq
+    "GM" - loop_gain_marg
+    "ENC" - loop_encirclements
+    "ORHP" - loop_open_rhp_poles
+    "CRHP" - loop_closed_rhp_poles
+    */
+    QHash<QString, double> m_loophshdata;
+    TransferFunction m_oftf; /**< output filter response */
+    LfFilter m_ofnet; /**< output filter network of m_oftf, the parts of the tolerance run */
+    TransferFunction m_looptf; /**< open loop gain */
+    TransferFunction m_zoltf; /**< open loop output impedance with the filter */
+    TransferFunction m_audtf; /**< open loop line to output with the filter */
+    LoopMargins m_loopmrg;
+
+    /*
+    "CLBW" - closed_loop_bandwidth
+    "CLPK" - closed_loop_peaking, dB
+    "ZOPK" - closed_out_imp_peak, Ohm
+    "ZOPF" - closed_out_imp_peak_freq
+    "ASPK" - audio_susc_peak, dB
+    "ASPF" - audio_susc_peak_freq
+    */
+    QHash<QString, double> m_clhshdata;
+
+    /*
+    "KMIN" - locus_stable_gain_min
+    "KMAX" - locus_stable_gain_max
+    "CTRMIN" - locus_stable_ctr_min
+    "CTRMAX" - locus_stable_ctr_max
+    */
+    QHash<QString, double> m_locushshdata;
+
+    /*
+    "LDOS" - trans_load_overshoot
+    "LDUS" - trans_load_undershoot
+    "LDST" - trans_load_settling
+    "LNOS" - trans_line_overshoot
+    "LNUS" - trans_line_undershoot
+    "LNST" - trans_line_settling
+    */
+    QHash<QString, double> m_transhshdata;
+
+    /*
+    "TFC" - tune_nominal_cross_freq
+    "TPM" - tune_worst_phase_marg
+    "TGM" - tune_worst_gain_marg
+    "TOK" - tune_feasible
+    */
+    QHash<QString, double> m_tunehshdata;
+
+    /*
+    "SMP" - mc_samples
+    "YLD" - mc_yield, percent
+    "NOCR" - mc_no_crossover
+    "PMLO" - mc_phase_marg_1st_percentile
+    "GMLO" - mc_gain_marg_min
+    "FCLO" - mc_cross_freq_1st_percentile
+    "FCHI" - mc_cross_freq_99th_percentile
+    */
+    QHash<QString, double> m_mchshdata;
+
+    /*
+    "LFN" - lf_stages
+    "LFL" - lf_stage_inductor
+    "LFC" - lf_stage_capacitor
+    "LFRD" - lf_damping_res, zero without the leg
+    "LFCD" - lf_damping_cap
+    "LFAT" - lf_attenuation_at_fsw, dB
+    "LFPK" - lf_resonance_peak, dB
+    "LFFP" - lf_peak_freq
+    "LFZO" - lf_out_impedance_peak
+    "LFPH" - lf_phase_at_crossover
+    "LFOK" - lf_feasible
+    */
+    QHash<QString, double> m_lfdhshdata;
+
+    /** Imported network analyzer data of the each MF_TARGET */
+    MfMeasure m_meas[2];
+
+    /*
+    "MFN" - mf_measured_points, zero if the import failed
+    "MFN0", "MFN1" - mf_nominal_params, ESR and L_{p} or CTR and opto pole
+    "MFP0", "MFP1" - mf_fitted_params
+    "MFRM" - mf_rms_mag_err, dB
+    "MFRP" - mf_rms_phase_err, degree
+    "MFIT" - mf_iterations
+    "MFOK" - mf_converged
+    "MFST" - mf_stalled, no descent at the highest damping
+    */
+    QHash<QString, double> m_mfhshdata;
+
+    /*
+    "DZFC" - dz_loop_cross_freq
+    "DZPM" - dz_loop_phase_marg
+    "DZGM" - dz_loop_gain_marg
+    "DZPL" - dz_phase_marg_loss, against the analog loop
+    "DZGL" - dz_gain_marg_loss, zero if either loop has no phase crossover
+    "DZQL" - dz_quant_phase_marg_loss, against the unquantized sections
+    "DZPR" - dz_pole_radius
+    "DZNS" - dz_sections
+    "DZSAT" - dz_saturated
+    */
+    QHash<QString, double> m_dzhshdata;
+
+    /** Frequency, magnitude and phase of the each sweep, reused by the recalculation */
+    SweepBufferPool m_sweep;
 
     QScopedPointer<BCap> m_bc;
     QScopedPointer<DBridge> m_db;
@@ -0,0 +1,90 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef ROOTLOCUS_H
+#define ROOTLOCUS_H
+#include "transferfunc.h"
+
+#define RL_GAIN_STEPS   4000   //Gain steps of the locus
+#define RL_GAIN_MIN     1E-3   //Lowest multiplier of the nominal loop gain
+#define RL_GAIN_MAX     1E3    //Highest multiplier of the nominal loop gain
+#define RL_CHUNK_STEPS  256    //Gain steps of one pool task, the first step of the task is solved cold
+#define RL_WARM_TILT    1E-3   //Rotation of the warm start off the real axis, the real pair can break away
+
+/**
+ * @brief The RootLocus struct - closed loop poles of 1 + k*T(s) = 0 over the gain multiplier k.
+ *        The compensator gain and the optocoupler CTR both scale T(s), the multiplier
+ *        stands for either of them. The branch index follows the same pole
+ *        from step to step. All roots in rad/s.
+ */
+struct RootLocus
+{
+    QVector<double> gain; //Multiplier of the nominal loop gain, ascending
+    int32_t branches = 0; //Closed loop poles at each step
+    QVector<TransferFunction::Root> root; //Poles of the steps one after another, NaN where the pole is gone to infinity
+    QVector<TransferFunction::Root> open_poles; //Start of the branches, k -> 0
+    QVector<TransferFunction::Root> open_zeros; //End of the branches, k -> inf
+
+    inline const TransferFunction::Root &rlRoot(int32_t step, int32_t branch) const
+    {
+        return root[step * branches + branch];
+    }
+};
+
+/**
+ * @brief rlGainSpace - log-spaced gain multipliers
+ * @param begin - lowest multiplier, above zero
+ * @param end - highest multiplier
+ * @param steps - number of multipliers
+ * @return
+ */
+QVector<double> rlGainSpace(double begin, double end, int32_t steps);
+
+/**
+ * @brief rlSolveLocus - closed loop poles for each multiplier. The gain vector is split
+ *        into RL_CHUNK_STEPS slices solved on the global QThreadPool, inside the slice
+ *        every step starts the root finder from the poles of the previous one and the
+ *        branches are matched to them, the slices are stitched at the borders afterwards.
+ * @param tf - nominal open loop gain T(s)
+ * @param gain - multipliers, ascending
+ * @return
+ */
+RootLocus rlSolveLocus(const TransferFunction &tf, const QVector<double> &gain);
+
+/**
+ * @brief rlStableRange - multipliers around the unit one with all the poles in the lhp
+ * @param rl - solved locus
+ * @param kmin - out lowest stable multiplier, zero if the loop is stable down to the first step
+ * @param kmax - out highest stable multiplier, infinity if the loop is stable up to the last step
+ * @return false if the nominal loop is unstable
+ */
+bool rlStableRange(const RootLocus &rl, double &kmin, double &kmax);
+
+/**
+ * @brief rlStableRange - the same range without the locus, each multiplier is checked
+ *        by the Hurwitz test of the characteristic polynomial instead of its roots
+ * @param tf - nominal open loop gain T(s)
+ * @param gain - multipliers, ascending
+ * @param kmin - out lowest stable multiplier, zero if the loop is stable down to the first step
+ * @param kmax - out highest stable multiplier, infinity if the loop is stable up to the last step
+ * @return false if the nominal loop is unstable
+ */
+bool rlStableRange(const TransferFunction &tf, const QVector<double> &gain, double &kmin, double &kmax);
+#endif // ROOTLOCUS_H
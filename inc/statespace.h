@@ -0,0 +1,115 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#ifndef STATESPACE_H
+#define STATESPACE_H
+#include <QtMath>
+#include <QVector>
+#include <cstdint>
+#include "transferfunc.h"
+
+#define SS_PADE_ORDER   6     //Order of the diagonal Pade approximant of the matrix exponential
+#define SS_NORM_MAX     0.5   //1-norm of the scaled matrix before the squaring
+#define SS_SETTLE_BAND  0.02  //Settling band, part of the largest excursion from the final value
+
+/**
+ * @brief The StepResponse struct - response to the step applied at t = 0 from the steady state
+ */
+struct StepResponse
+{
+    double step_time = 0.; //Sample period, s
+    QVector<double> out; //Deviation of the output from the steady state at each sample
+    double final = 0.; //Steady state from the dc gain, the last sample for the integrating response
+    double overshoot = 0.; //Highest excursion above the final value
+    double undershoot = 0.; //Lowest excursion below the final value, positive
+    double settling = 0.; //Time of the last exit from the settling band, s
+};
+
+/**
+ * @brief The StateSpace class - continuous realization of the rational response
+ *        and its zero order hold equivalent.
+ *        The realization is the series of the first and second order sections,
+ *        one for each real pole and complex pole pair. The sections are scaled
+ *        by their natural frequency, so the entries stay of the order of the pole
+ *        magnitudes spread over decades. The series connection keeps the matrix
+ *        lower block triangular and the simulation skips the upper part.
+ */
+class StateSpace
+{
+public:
+    StateSpace() = default;
+
+    /**
+     * @brief StateSpace - series realization of the response
+     * @param tf - proper response, the improper one has no realization and stays invalid
+     */
+    explicit StateSpace(const TransferFunction &tf);
+
+    inline bool ssValid() const {return m_valid;}
+    inline int32_t ssOrder() const {return m_order;}
+
+    /**
+     * @brief ssDiscretize - zero order hold, [Ad Bd; 0 1] = expm([A B; 0 0]*dt)
+     * @param dt - sample period, s
+     */
+    void ssDiscretize(double dt);
+
+    /**
+     * @brief ssStep - output at the samples for the input held at amp from t = 0,
+     *        zero initial state, one pass of the discrete recursion
+     * @param amp - step height
+     * @param out - output at the samples
+     * @param num - number of samples
+     */
+    void ssStep(double amp, double *out, int32_t num) const;
+
+    /**
+     * @brief ssStepResponse - discretize with the sample period, simulate the step
+     *        and extract the overshoot, undershoot and settling time
+     * @param amp - step height
+     * @param dt - sample period, s
+     * @param num - number of samples
+     * @return
+     */
+    StepResponse ssStepResponse(double amp, double dt, int32_t num);
+
+    /**
+     * @brief ssExpm - matrix exponential by scaling and squaring of the diagonal Pade approximant
+     * @param mat - row major square matrix, replaced by its exponential
+     * @param dim - dimension
+     */
+    static void ssExpm(QVector<double> &mat, int32_t dim);
+
+private:
+    bool m_valid = false;
+    int32_t m_order = 0;
+    QVector<double> m_a; //Row major, order x order
+    QVector<double> m_b;
+    QVector<double> m_c;
+    double m_d = 0.;
+    double m_dc = 0.; //Dc gain, infinite for the integrating response
+    QVector<int32_t> m_row_end; //Past the last nonzero column of the row
+    double m_dt = 0.;
+    QVector<double> m_ad; //Discrete matrices of the sample period m_dt
+    QVector<double> m_bd;
+
+    static void ssMeasure(StepResponse &resp, double final);
+};
+#endif // STATESPACE_H
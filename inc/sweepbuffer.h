@@ -0,0 +1,158 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef SWEEPBUFFER_H
+#define SWEEPBUFFER_H
+#include <QtGlobal>
+#include <QVector>
+#include <cstdint>
+#include "bodekernel.h"
+
+#define SB_ALIGN          64      //Cache line and AVX-512 vector alignment, bytes
+#define SB_GRANULE        1024    //Capacity is rounded up to whole granules, points
+#define SB_MAX_POINTS     1048576 //Upper limit of one sweep, points
+
+enum SWEEP_ID
+{
+    SW_OUT_FILTER  = 0,
+    SW_POWER_STAGE = 1,
+    SW_OPTO_FEEDB  = 2,
+    SW_LOOP_GAIN   = 3,
+    SW_LC_DESIGN   = 4,
+    SW_CLOSED_LOOP = 5,
+    SW_OUT_IMP     = 6,
+    SW_AUDIO_SUSC  = 7,
+    SW_COMP_ANALOG = 8,
+    SW_COMP_DIGITAL = 9,
+    SW_LOOP_DIGITAL = 10,
+    SW_COUNT
+};
+
+/**
+ * @brief The SweepBuffer class - aligned frequency, magnitude and phase
+ *        arrays of one analysis, optionally with the real and imaginary
+ *        part of the response. The storage grows to the largest sweep
+ *        seen and is reused by the next recalculation, it never shrinks
+ *        on its own.
+ */
+class SweepBuffer
+{
+public:
+    SweepBuffer() = default;
+    ~SweepBuffer();
+
+    SweepBuffer(const SweepBuffer&) = delete;
+    SweepBuffer &operator=(const SweepBuffer&) = delete;
+
+    /**
+     * @brief sbResize - set the number of points, reallocate only above capacity
+     * @param num - number of points
+     * @return false if the sweep is above SB_MAX_POINTS, the buffer is left empty
+     */
+    bool sbResize(int32_t num);
+
+    /**
+     * @brief sbAssignFreq - take the frequency points of the grid
+     * @param freq - frequency points in Hz
+     * @return see sbResize
+     */
+    bool sbAssignFreq(const QVector<double> &freq);
+
+    /**
+     * @brief sbAssignFreq - take the frequency points of the other sweep
+     * @param src - sweep with the frequency points
+     * @return see sbResize
+     */
+    bool sbAssignFreq(const SweepBuffer &src);
+
+    /**
+     * @brief sbRelease - free the storage
+     */
+    void sbRelease();
+
+    /**
+     * @brief sbSetComplex - keep the complex response too, takes effect from the next resize
+     * @param cplx
+     */
+    void sbSetComplex(bool cplx);
+    inline bool sbIsComplex() const {return m_complex;}
+
+    /**
+     * @brief sbSetPrecision - transcendental functions of the sweeps into this buffer,
+     *        the fast one is for the exploratory and optimizer runs
+     * @param prec
+     */
+    inline void sbSetPrecision(BK_PREC prec) {m_prec = prec;}
+    inline BK_PREC sbPrecision() const {return m_prec;}
+
+    inline int32_t sbSize() const {return m_size;}
+    inline int32_t sbCapacity() const {return m_capacity;}
+    inline double *sbFreq() {return m_freq;}
+    inline double *sbMag() {return m_mag;}
+    inline double *sbPhase() {return m_phs;}
+    inline const double *sbFreq() const {return m_freq;}
+    inline const double *sbMag() const {return m_mag;}
+    inline const double *sbPhase() const {return m_phs;}
+    inline double *sbReal() {return m_re;}
+    inline double *sbImag() {return m_im;}
+    inline const double *sbReal() const {return m_re;}
+    inline const double *sbImag() const {return m_im;}
+
+    /**
+     * @brief sbFootprint - allocated bytes
+     */
+    inline size_t sbFootprint() const {return (m_complex ? 5 : 3) * static_cast<size_t>(m_capacity) * sizeof(double);}
+
+private:
+    double *m_freq = nullptr;
+    double *m_mag = nullptr;
+    double *m_phs = nullptr;
+    double *m_re = nullptr;
+    double *m_im = nullptr;
+    bool m_complex = false;
+    BK_PREC m_prec = BK_PREC_EXACT;
+    int32_t m_size = 0;
+    int32_t m_capacity = 0;
+};
+
+/**
+ * @brief The SweepBufferPool class - one reusable buffer per analysis
+ */
+class SweepBufferPool
+{
+public:
+    SweepBufferPool();
+
+    inline SweepBuffer &sbpBuffer(SWEEP_ID id) {return m_buf[id];}
+    inline const SweepBuffer &sbpBuffer(SWEEP_ID id) const {return m_buf[id];}
+
+    /**
+     * @brief sbpFootprint - allocated bytes of all buffers
+     */
+    size_t sbpFootprint() const;
+
+    /**
+     * @brief sbpRelease - free the storage of all buffers
+     */
+    void sbpRelease();
+
+private:
+    SweepBuffer m_buf[SW_COUNT];
+};
+#endif // SWEEPBUFFER_H
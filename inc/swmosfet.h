@@ -20,6 +20,7 @@
 #ifndef SWMOSFET_H
 #define SWMOSFET_H
 #include <QtMath>
+#include "dual.h"
 
 /**
  * @brief The MosfetProp struct
@@ -59,18 +60,19 @@ struct ClampCSProp
 
 };
 
-class SwMosfet
+template<typename T>
+class SwMosfetT
 {
 private:
-    uint16_t in_max_pk_voltage;
-    uint16_t voltage_spike;
-    uint32_t freq_switch;
-    double prim_induct;
-    double prim_cur_pkp;
-    double actual_volt_reflected;
+    T in_max_pk_voltage;
+    T voltage_spike;
+    T freq_switch;
+    T prim_induct;
+    T prim_cur_pkp;
+    T actual_volt_reflected;
 
-    float curr_primary_rms;
-    float curr_primary_peak;
+    T curr_primary_rms;
+    T curr_primary_peak;
 
 public:
     /**
@@ -83,13 +85,14 @@ public:
      * @param vref - actual reflected voltage pr. side
      * @param spv - max voltage spike value, for pow switch
      * @param fsw - power switching frequency
+     *        The scalar T is double for the design and Dual for the gradients, see dual.h
      */
-    SwMosfet(uint16_t vmaxrmsin,
-             uint16_t spv,
-             uint32_t fsw,
-             double vref,
-             double pind,
-             double cpkp)
+    SwMosfetT(T vmaxrmsin,
+              T spv,
+              T fsw,
+              T vref,
+              T pind,
+              T cpkp)
         :in_max_pk_voltage(vmaxrmsin)
         ,voltage_spike(spv)
         ,freq_switch(fsw)
@@ -102,7 +105,7 @@ public:
      * @brief swMosfetVoltageNom - estimated voltage of switch not considering spike
      * @return nom voltage value
      */
-    inline double swMosfetVoltageNom() const
+    inline T swMosfetVoltageNom() const
     {
         return in_max_pk_voltage + actual_volt_reflected;
     }
@@ -111,7 +114,7 @@ public:
      * @brief swMosfetVoltageMax - estimated voltage stress of switch
      * @return max voltage value
      */
-    inline double swMosfetVoltageMax() const
+    inline T swMosfetVoltageMax() const
     {
         return swMosfetVoltageNom() + voltage_spike;
     }
@@ -144,7 +147,7 @@ public:
      * @brief swMosfetOnTime
      * @return
      */
-    inline double swMosfetOnTime(const MosfetProp& mprp) const
+    inline T swMosfetOnTime(const MosfetProp& mprp) const
     {
         return ((prim_induct * prim_cur_pkp) / in_max_pk_voltage) + swMosfetRiseTime(mprp);
     }
@@ -154,7 +157,7 @@ public:
      * @param mp
      * @return
      */
-    inline double swMosfetOffTime(const MosfetProp &mprp, float trat, float vout) const
+    inline T swMosfetOffTime(const MosfetProp &mprp, float trat, float vout) const
     {
         return ((prim_induct * prim_cur_pkp) / static_cast<double>((trat * vout))) + swMosfetFallTime(mprp);
     }
@@ -163,16 +166,16 @@ public:
      * @brief swMosfetConductLoss - estimated of conduction losses
      * @retval conduction losses
      */
-    double swMosfetConductLoss(const MosfetProp &mp) const
+    T swMosfetConductLoss(const MosfetProp &mp) const
     {
-        return qPow(static_cast<double>(curr_primary_rms), 2) * static_cast<double>(mp.m_rdson);
+        return qPow(curr_primary_rms, 2) * static_cast<double>(mp.m_rdson);
     }
 
     /**
      * @brief swMosfetDriveLoss - estimated fet power loss by driving the fet’s gate
      * @return loss by driving the gate
      */
-    double swMosfetDriveLoss(const MosfetProp &mp) const
+    T swMosfetDriveLoss(const MosfetProp &mp) const
     {
         return mp.m_vgs * mp.m_qg * freq_switch;
     }
@@ -181,7 +184,7 @@ public:
      * @brief swMosfetSwitchLoss - estimated fet average switching loss
      * @return switching loss
      */
-    double swMosfetSwitchLoss(const MosfetProp &mp) const
+    T swMosfetSwitchLoss(const MosfetProp &mp) const
     {
         double t_coeff = (swMosfetRiseTime(mp) * static_cast<double>(mp.m_fet_cur_min)) + (swMosfetFallTime(mp) * static_cast<double>(mp.m_fet_cur_max));
         return swMosfetVoltageNom() * (freq_switch/2.) * t_coeff;
@@ -191,7 +194,7 @@ public:
      * @brief swMosfetCapacitLoss - estimated fet coss power dissipation
      * @return coss power dissipation
      */
-    double swMosfetCapacitLoss(const MosfetProp &mp) const
+    T swMosfetCapacitLoss(const MosfetProp &mp) const
     {
         return (mp.m_coss * qPow(swMosfetVoltageMax(), 2)*freq_switch)/2.;
     }
@@ -200,7 +203,7 @@ public:
      * @brief swMosfetTotalLoss - multiply of all losses values
      * @return total losses
      */
-    double swMosfetTotalLoss(const MosfetProp &mp) const
+    T swMosfetTotalLoss(const MosfetProp &mp) const
     {
         return swMosfetConductLoss(mp) + swMosfetDriveLoss(mp) + swMosfetSwitchLoss(mp) + swMosfetCapacitLoss(mp);
     }
@@ -210,17 +213,17 @@ public:
      * @param rmscp
      * @param pkcp
      */
-    void setCurrValues(float rmscp, float pkcp)
+    void setCurrValues(T rmscp, T pkcp)
     {
-        curr_primary_rms = rmscp;
-        curr_primary_peak = pkcp;
+        curr_primary_rms = dualStore<float>(rmscp);
+        curr_primary_peak = dualStore<float>(pkcp);
     }
 
     /**
      * @brief clVoltageMax - calculate snubber capacitor voltage
      * @return snubber voltage
      */
-    double clVoltageMax() const
+    T clVoltageMax() const
     {
         return swMosfetVoltageMax() - in_max_pk_voltage - actual_volt_reflected;
     }
@@ -231,10 +234,10 @@ public:
      * @brief clCapValue - the snubber capacitance value
      * @return capacitance value
      */
-    double clCapValue(const ClampCSProp &ccsp) const
+    T clCapValue(const ClampCSProp &ccsp) const
     {
-        double num = ccsp.leakage_induct * qPow(static_cast<double>(curr_primary_peak), 2);
-        double dnm = qPow((actual_volt_reflected + voltage_spike), 2) - qPow(actual_volt_reflected, 2);
+        T num = ccsp.leakage_induct * qPow(curr_primary_peak, 2);
+        T dnm = qPow((actual_volt_reflected + voltage_spike), 2) - qPow(actual_volt_reflected, 2);
         return num / dnm;
         //return clVoltageMax()/(ccsp.cl_vol_rip * clResValue(ccsp) * freq_switch);
     }
@@ -243,9 +246,10 @@ public:
      * @brief clResValue - the snubber resistor value
      * @return resistor value
      */
-    double clResValue(const ClampCSProp &ccsp) const
+    T clResValue(const ClampCSProp &ccsp) const
     {
-        double dnm = freq_switch * clCapValue(ccsp) * std::log2(1 + (voltage_spike / actual_volt_reflected));
+        using std::log2;
+        T dnm = freq_switch * clCapValue(ccsp) * log2(1 + (voltage_spike / actual_volt_reflected));
         return 1. / dnm;
         //return qPow(clVoltageMax(), 2)/clPowerDiss(ccsp);
     }
@@ -254,9 +258,9 @@ public:
      * @brief SwMosfet::clPowerDiss - the power dissipated in the snubber circuit
      * @return power diss val
      */
-    double clPowerDiss(const ClampCSProp &ccsp) const
+    T clPowerDiss(const ClampCSProp &ccsp) const
     {
-        double coeff = 0.5 * ccsp.leakage_induct * qPow(static_cast<double>(curr_primary_peak), 2) * freq_switch;
+        T coeff = 0.5 * ccsp.leakage_induct * qPow(curr_primary_peak, 2) * freq_switch;
         return (qPow(actual_volt_reflected, 2) / clResValue(ccsp)) + coeff;
         /**< the on-time (tSn) of the snubber diode */
         //auto clCurTsPk = (leakage_induct / (static_cast<double>(ccsp.cl_turn_rat * ccsp.cl_first_out_volt))) * static_cast<double>(curr_primary_peak);
@@ -267,19 +271,21 @@ public:
      * @brief csCurrRes - the value of current resistor
      * @return the res value
      */
-    double csCurrRes(const ClampCSProp &ccsp) const
+    T csCurrRes(const ClampCSProp &ccsp) const
     {
-        return ccsp.cs_volt/static_cast<double>(curr_primary_peak);
+        return ccsp.cs_volt/curr_primary_peak;
     }
 
     /**
      * @brief SwMosfet::csCurrResLoss - the current sense resistor loss
      * @return the sense resistor loss
      */
-    double csCurrResLoss(const ClampCSProp &ccsp) const
+    T csCurrResLoss(const ClampCSProp &ccsp) const
     {
         return qPow(curr_primary_rms, 2) * csCurrRes(ccsp);
     }
 };
 
+typedef SwMosfetT<double> SwMosfet;
+
 #endif // SWMOSFET_H
@@ -0,0 +1,159 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#ifndef TRANSFERFUNC_H
+#define TRANSFERFUNC_H
+#include <complex>
+#include "bodesweep.h"
+#include "sweepbuffer.h"
+
+#define TF_ROOT_ITER_MAX  200   //Iteration limit of the root finder
+#define TF_ROOT_TOL       1E-14 //Relative step of the root finder to stop
+#define TF_REAL_TOL       1E-9  //Relative imaginary part of the root treated as real
+#define TF_CANCEL_TOL     1E-9  //Relative distance of the zero and pole cancelled out
+
+/**
+ * @brief The TransferFunction class - rational response in zero-pole-gain form
+ *        H(s) = gain * s^order * prod(1 - s/z) / prod(1 - s/p)
+ *        The zeros and poles at origin are kept in order, the complex roots
+ *        are stored with their conjugate. All roots in rad/s.
+ */
+class TransferFunction
+{
+public:
+    typedef std::complex<double> Root;
+
+    TransferFunction(double gain = 1., int32_t order = 0);
+
+    /**
+     * @brief TransferFunction - zeros and poles of the factored response
+     * @param bf - factored response of the model
+     */
+    explicit TransferFunction(const BodeFactors &bf);
+
+    /**
+     * @brief tfFromPoly - response from the polynomials, the roots are found numerically
+     * @param gain - gain factor
+     * @param order - number of differentiators, negative for integrators
+     * @param num - numerator coefficients in ascending power of s
+     * @param den - denominator coefficients in ascending power of s
+     * @return
+     */
+    static TransferFunction tfFromPoly(double gain, int32_t order, const QVector<double> &num, const QVector<double> &den);
+
+    /**
+     * @brief tfAddZero - (1 + s/omega), negative omega for the rhp zero
+     */
+    void tfAddZero(double omega);
+
+    /**
+     * @brief tfAddPole - 1/(1 + s/omega)
+     */
+    void tfAddPole(double omega);
+
+    /**
+     * @brief tfAddZeroQuad - (1 + s*b + s^2*a)
+     */
+    void tfAddZeroQuad(double b, double a);
+
+    /**
+     * @brief tfAddPoleQuad - 1/(1 + s*b + s^2*a)
+     */
+    void tfAddPoleQuad(double b, double a);
+
+    inline double tfGain() const {return m_gain;}
+    inline int32_t tfOrder() const {return m_order;}
+    inline const QVector<Root> &tfZeros() const {return m_zeros;}
+    inline const QVector<Root> &tfPoles() const {return m_poles;}
+
+    /**
+     * @brief tfNumerator - prod(1 - s/z) in ascending power of s
+     */
+    QVector<double> tfNumerator() const;
+
+    /**
+     * @brief tfDenominator - prod(1 - s/p) in ascending power of s
+     */
+    QVector<double> tfDenominator() const;
+
+    /**
+     * @brief tfEval - response at the angular frequency
+     * @param omega - rad/s
+     * @return
+     */
+    std::complex<double> tfEval(double omega) const;
+
+    /**
+     * @brief tfBodeFactors - factored form for the sweep kernel
+     * @return
+     */
+    BodeFactors tfBodeFactors() const;
+
+    /**
+     * @brief tfSweep - magnitude in dB and unwrapped phase in degree
+     * @param buf - frequency points in Hz, out magnitude and phase
+     */
+    void tfSweep(SweepBuffer &buf) const;
+
+    /**
+     * @brief operator * - product of the responses
+     */
+    TransferFunction operator*(const TransferFunction &rhs) const;
+
+    /**
+     * @brief tfSeries - cascade of the blocks, the same as product
+     */
+    static TransferFunction tfSeries(const TransferFunction &first, const TransferFunction &second);
+
+    /**
+     * @brief tfFeedback - closed loop with negative feedback, fwd/(1 + fwd*fbk)
+     * @param fwd - forward path
+     * @param fbk - feedback path
+     * @return
+     */
+    static TransferFunction tfFeedback(const TransferFunction &fwd, const TransferFunction &fbk);
+
+    /**
+     * @brief tfCancel - drop the zero and pole pairs closer than TF_CANCEL_TOL,
+     *        the product keeps the roots shared by its parts
+     * @return the response of the lower order
+     */
+    TransferFunction tfCancel() const;
+
+    /**
+     * @brief tfRoots - roots of the real polynomial
+     * @param poly - coefficients in ascending power of s, poly[0] is not zero
+     * @param guess - start of the iteration in rad/s, the roots of the nearby polynomial;
+     *        used when it has one root for each degree, else the iteration starts on the circle
+     * @return the roots, the complex ones with their conjugate
+     */
+    static QVector<Root> tfRoots(const QVector<double> &poly, const QVector<Root> &guess = QVector<Root>());
+
+private:
+    double m_gain;
+    int32_t m_order;
+    QVector<Root> m_zeros;
+    QVector<Root> m_poles;
+
+    static void tfAddQuadRoots(QVector<Root> &roots, double b, double a);
+    static QVector<double> tfExpand(const QVector<Root> &roots);
+    static QVector<double> tfPolyMul(const QVector<double> &lhs, const QVector<double> &rhs);
+    static QVector<double> tfPolyAdd(const QVector<double> &lhs, const QVector<double> &rhs);
+};
+#endif // TRANSFERFUNC_H
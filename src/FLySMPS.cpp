@@ -58,8 +58,16 @@ FLySMPS::FLySMPS(QWidget *parent)
 
     initOutDCData();
     initLCPlot();
+    initLcdPlot();
     initSSMplot();
+    initModeMapPlot();
     initFCPlot();
+    initLoopPlot();
+    initDigitalPlot();
+    initClosedLoopPlot();
+    initLocusPlot();
+    initTransientPlot();
+    initMonteCarloPlot();
 
     qInfo(logInfo()) << "Initialize input design parameters - OK";
 
@@ -101,16 +109,55 @@ FLySMPS::FLySMPS(QWidget *parent)
     connect(this, &FLySMPS::initOutFilterComplete, m_psolve.data(), &PowSuppSolve::calcOutputFilter);
     connect(m_psolve.data(), &PowSuppSolve::newOFDataPlot, this, &FLySMPS::setLCPlot);
     connect(m_psolve.data(), &PowSuppSolve::newOFDataHash, this, &FLySMPS::setSolveLCFilter);
+    connect(ui->LcdRunPushButton, &QPushButton::clicked, this, &FLySMPS::initFilterDesign);
+    connect(this, &FLySMPS::initFilterDesignComplete, m_psolve.data(), &PowSuppSolve::calcFilterDesign);
+    connect(m_psolve.data(), &PowSuppSolve::newLFDDataPlot, this, &FLySMPS::setFilterDesignPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newLFDDataHash, this, &FLySMPS::setFilterDesign);
 
     connect(ui->CalcPSMPushButton, &QPushButton::clicked, this, &FLySMPS::initPowerStageModel);
     connect(this, &FLySMPS::initPowerStageModelComplete, m_psolve.data(), &PowSuppSolve::calcPowerStageModel);
     connect(m_psolve.data(), &PowSuppSolve::newPSMDataPlot, this, &FLySMPS::setPowerStagePlot);
     connect(m_psolve.data(), &PowSuppSolve::newPSMDataHash, this, &FLySMPS::setPowerStageModel);
+    connect(m_psolve.data(), &PowSuppSolve::newMMDataPlot, this, &FLySMPS::setModeMapPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newMMDataHash, this, &FLySMPS::setModeMap);
+    connect(ui->ModeMapView, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &FLySMPS::showModeMap);
 
     connect(ui->CalcOptoPushButton, &QPushButton::clicked, this, &FLySMPS::initOptoFeedbStage);
     connect(this, &FLySMPS::initOptoFeedbStageComplete, m_psolve.data(), &PowSuppSolve::calcOptocouplerFeedback);
     connect(m_psolve.data(), &PowSuppSolve::newOCFDataPlot, this, &FLySMPS::setOptoFeedbPlot);
     connect(m_psolve.data(), &PowSuppSolve::newOCFDataHash, this, &FLySMPS::setOptoFeedbStage);
+    connect(ui->PsmImportPushButton, &QPushButton::clicked, this, [this](){initMeasureImport(MF_POWER_STAGE);});
+    connect(ui->OptoImportPushButton, &QPushButton::clicked, this, [this](){initMeasureImport(MF_OPTO_FEEDB);});
+    connect(ui->PsmFitPushButton, &QPushButton::clicked, this, [this](){emit initMeasureFitComplete(MF_POWER_STAGE);});
+    connect(ui->OptoFitPushButton, &QPushButton::clicked, this, [this](){emit initMeasureFitComplete(MF_OPTO_FEEDB);});
+    connect(this, &FLySMPS::initMeasureImportComplete, m_psolve.data(), &PowSuppSolve::calcMeasureImport);
+    connect(this, &FLySMPS::initMeasureFitComplete, m_psolve.data(), &PowSuppSolve::calcMeasureFit);
+    connect(m_psolve.data(), &PowSuppSolve::newMeasDataPlot, this, &FLySMPS::setMeasurePlot);
+    connect(m_psolve.data(), &PowSuppSolve::newFitDataPlot, this, &FLySMPS::setMeasureFitPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newFitDataHash, this, &FLySMPS::setMeasureFit);
+    connect(m_psolve.data(), &PowSuppSolve::newLoopDataPlot, this, &FLySMPS::setLoopPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newLoopDataHash, this, &FLySMPS::setLoopGain);
+    connect(m_psolve.data(), &PowSuppSolve::newCLDataPlot, this, &FLySMPS::setClosedLoopPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newCLDataHash, this, &FLySMPS::setClosedLoop);
+    connect(ui->TuneLoopPushButton, &QPushButton::clicked, m_psolve.data(), &PowSuppSolve::calcCompTuner);
+    connect(m_psolve.data(), &PowSuppSolve::newTuneDataHash, this, &FLySMPS::setCompTuner);
+    connect(ui->DzRunPushButton, &QPushButton::clicked, this, &FLySMPS::initDigitalComp);
+    connect(this, &FLySMPS::initDigitalCompComplete, m_psolve.data(), &PowSuppSolve::calcDigitalComp);
+    connect(m_psolve.data(), &PowSuppSolve::newDZDataPlot, this, &FLySMPS::setDigitalCompPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newDZDataHash, this, &FLySMPS::setDigitalComp);
+    connect(ui->LocusRunPushButton, &QPushButton::clicked, m_psolve.data(), &PowSuppSolve::calcRootLocus);
+    connect(m_psolve.data(), &PowSuppSolve::newLocusDataPlot, this, &FLySMPS::setLocusPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newLocusDataHash, this, &FLySMPS::setLocusGain);
+    connect(ui->LocusGainSlider, &QSlider::valueChanged, this, &FLySMPS::setLocusMarker);
+    connect(ui->TranRunPushButton, &QPushButton::clicked, m_psolve.data(), &PowSuppSolve::calcTransient);
+    connect(m_psolve.data(), &PowSuppSolve::newTransDataPlot, this, &FLySMPS::setTransientPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newTransDataHash, this, &FLySMPS::setTransient);
+    connect(ui->McRunPushButton, &QPushButton::clicked, m_psolve.data(), &PowSuppSolve::calcMonteCarlo);
+    connect(m_psolve.data(), &PowSuppSolve::newMCDataPlot, this, &FLySMPS::setMonteCarloPlot);
+    connect(m_psolve.data(), &PowSuppSolve::newMCDataHash, this, &FLySMPS::setMonteCarlo);
+    connect(ui->SensRunPushButton, &QPushButton::clicked, m_psolve.data(), &PowSuppSolve::calcSensitivity);
+    connect(m_psolve.data(), &PowSuppSolve::newSensDataTable, this, &FLySMPS::setSensitivity);
 
     connect(ui->InpUpdatePushButton, &QPushButton::clicked, this, &FLySMPS::setUpdateInputValues);
 
@@ -173,7 +220,7 @@ void FLySMPS::initInputValues()
 
     m_psolve->m_indata.eff = convertToValues(static_cast<QString>(ui->Eff->text()));
     m_psolve->m_indata.mrgn = static_cast<float>(convertToValues(static_cast<QString>(ui->OutPwrMrg->text())));
-    m_psolve->m_indata.power_out_max = outPwr(m_psolve->m_indata.mrgn);
+    m_psolve->deriveOutputPower();
 
     // logging
     qInfo(logInfo()) << (QString("Efficiency of power converter is=\"%1\" with margin=\"%2\" and maximum output power=\"%3\"W").arg(m_psolve->m_indata.eff).arg(m_psolve->m_indata.mrgn).arg(m_psolve->m_indata.power_out_max)).toStdString().c_str();
@@ -230,6 +277,43 @@ void FLySMPS::initLCPlot()
     ui->LCFilterGraph->xAxis2->setNumberPrecision(0);
 }
 
+void FLySMPS::initLcdPlot()
+{
+    ui->LcdGraph->clearGraphs();
+
+    ui->LcdGraph->addGraph(ui->LcdGraph->xAxis, ui->LcdGraph->yAxis);
+    ui->LcdGraph->graph(0)->setPen(QPen(Qt::blue));
+    ui->LcdGraph->graph(0)->setName("Mag.");
+
+    ui->LcdGraph->addGraph(ui->LcdGraph->xAxis2, ui->LcdGraph->yAxis2);
+    ui->LcdGraph->graph(1)->setPen(QPen(Qt::red));
+    ui->LcdGraph->graph(1)->setName("Phs.");
+
+    ui->LcdGraph->xAxis2->setVisible(true);
+    ui->LcdGraph->yAxis2->setVisible(true);
+
+    ui->LcdGraph->xAxis->setLabel("Freq. Hz");
+    ui->LcdGraph->yAxis->setLabel("Mag. dB");
+    ui->LcdGraph->yAxis2->setLabel("Deg. ");
+
+    ui->LcdGraph->yAxis->grid()->setSubGridVisible(true);
+    ui->LcdGraph->xAxis->grid()->setSubGridVisible(true);
+    ui->LcdGraph->xAxis->setScaleType(QCPAxis::stLogarithmic);
+    ui->LcdGraph->xAxis2->setScaleType(QCPAxis::stLogarithmic);
+
+    //the multi-stage filter rolls off steeper than the single LC
+    ui->LcdGraph->yAxis->setRange(-120, 20);
+    ui->LcdGraph->xAxis->setRange(1e2, 1e6);
+    ui->LcdGraph->yAxis2->setRange(-540, 0);
+    ui->LcdGraph->xAxis2->setRange(1e2, 1e6);
+
+    ui->LcdGraph->xAxis->setNumberFormat("eb");
+    ui->LcdGraph->xAxis->setNumberPrecision(0);
+
+    ui->LcdGraph->xAxis2->setNumberFormat("eb");
+    ui->LcdGraph->xAxis2->setNumberPrecision(0);
+}
+
 void FLySMPS::initSSMplot()
 {
     ui->PSMGraph->clearGraphs();
@@ -267,6 +351,235 @@ void FLySMPS::initSSMplot()
 
     ui->PSMGraph->xAxis2->setNumberFormat("eb");
     ui->PSMGraph->xAxis2->setNumberPrecision(0);
+
+    initMeasureGraphs(ui->PSMGraph);
+}
+
+void FLySMPS::initModeMapPlot()
+{
+    ui->ModeMapGraph->clearPlottables();
+
+    //the color map is the first plottable, the boundary curve is drawn over it:
+    QCPColorMap *map = new QCPColorMap(ui->ModeMapGraph->xAxis, ui->ModeMapGraph->yAxis);
+    map->setName("Mode");
+    QCPColorScale *scale = new QCPColorScale(ui->ModeMapGraph);
+    ui->ModeMapGraph->plotLayout()->addElement(0, 1, scale);
+    scale->setType(QCPAxis::atRight);
+    map->setColorScale(scale);
+
+    QCPMarginGroup *group = new QCPMarginGroup(ui->ModeMapGraph);
+    ui->ModeMapGraph->axisRect()->setMarginGroup(QCP::msBottom|QCP::msTop, group);
+    scale->setMarginGroup(QCP::msBottom|QCP::msTop, group);
+
+    QCPCurve *bnd = new QCPCurve(ui->ModeMapGraph->xAxis, ui->ModeMapGraph->yAxis);
+    bnd->setPen(QPen(Qt::black, 2));
+    bnd->setName("Boundary");
+
+    ui->ModeMapGraph->xAxis->setLabel("Line V rms");
+    ui->ModeMapGraph->yAxis->setLabel("Load %");
+    ui->ModeMapGraph->xAxis->setRange(85, 265);
+    ui->ModeMapGraph->yAxis->setRange(0, 100);
+}
+
+void FLySMPS::initLoopPlot()
+{
+    ui->LoopBodeGraph->clearGraphs();
+
+    ui->LoopBodeGraph->addGraph(ui->LoopBodeGraph->xAxis, ui->LoopBodeGraph->yAxis);
+    ui->LoopBodeGraph->graph(0)->setPen(QPen(Qt::blue));
+    ui->LoopBodeGraph->graph(0)->setName("Mag.");
+
+    ui->LoopBodeGraph->addGraph(ui->LoopBodeGraph->xAxis2, ui->LoopBodeGraph->yAxis2);
+    ui->LoopBodeGraph->graph(1)->setPen(QPen(Qt::red));
+    ui->LoopBodeGraph->graph(1)->setName("Phs.");
+
+    //configure right and top axis to show ticks but no labels:
+    ui->LoopBodeGraph->xAxis2->setVisible(true);
+    ui->LoopBodeGraph->yAxis2->setVisible(true);
+
+    //give the axis some labels:
+    ui->LoopBodeGraph->xAxis->setLabel("Freq. Hz");
+    ui->LoopBodeGraph->yAxis->setLabel("Mag. dB");
+    ui->LoopBodeGraph->yAxis2->setLabel("Deg. ");
+
+    ui->LoopBodeGraph->yAxis->grid()->setSubGridVisible(true);
+    ui->LoopBodeGraph->xAxis->grid()->setSubGridVisible(true);
+    ui->LoopBodeGraph->xAxis->setScaleType(QCPAxis::stLogarithmic);
+    ui->LoopBodeGraph->xAxis2->setScaleType(QCPAxis::stLogarithmic);
+
+    //set axes ranges, so we see all data:
+    ui->LoopBodeGraph->yAxis->setRange(-60, 60);
+    ui->LoopBodeGraph->xAxis->setRange(1e1, 1e5);
+    ui->LoopBodeGraph->yAxis2->setRange(-270, 0);
+    ui->LoopBodeGraph->xAxis2->setRange(1e1, 1e5);
+
+    ui->LoopBodeGraph->xAxis->setNumberFormat("eb");
+    ui->LoopBodeGraph->xAxis->setNumberPrecision(0);
+
+    ui->LoopBodeGraph->xAxis2->setNumberFormat("eb");
+    ui->LoopBodeGraph->xAxis2->setNumberPrecision(0);
+
+    //the sampled loop of the digital compensator dashed over the analog one:
+    ui->LoopBodeGraph->addGraph(ui->LoopBodeGraph->xAxis, ui->LoopBodeGraph->yAxis);
+    ui->LoopBodeGraph->graph(2)->setPen(QPen(Qt::blue, 1, Qt::DashLine));
+    ui->LoopBodeGraph->graph(2)->setName("Dig. mag.");
+
+    ui->LoopBodeGraph->addGraph(ui->LoopBodeGraph->xAxis2, ui->LoopBodeGraph->yAxis2);
+    ui->LoopBodeGraph->graph(3)->setPen(QPen(Qt::red, 1, Qt::DashLine));
+    ui->LoopBodeGraph->graph(3)->setName("Dig. phs.");
+
+    //the curves keep the sweep order, the plot owns them
+    ui->LoopNyquistGraph->clearPlottables();
+    QCPCurve *nyq = new QCPCurve(ui->LoopNyquistGraph->xAxis, ui->LoopNyquistGraph->yAxis);
+    nyq->setPen(QPen(Qt::blue));
+    nyq->setName("T(jw)");
+    ui->LoopNyquistGraph->xAxis->setLabel("Re");
+    ui->LoopNyquistGraph->yAxis->setLabel("Im");
+    ui->LoopNyquistGraph->xAxis->setRange(-3, 1);
+    ui->LoopNyquistGraph->yAxis->setRange(-2, 2);
+
+    ui->LoopNicholsGraph->clearPlottables();
+    QCPCurve *nic = new QCPCurve(ui->LoopNicholsGraph->xAxis, ui->LoopNicholsGraph->yAxis);
+    nic->setPen(QPen(Qt::blue));
+    nic->setName("T(jw)");
+    ui->LoopNicholsGraph->xAxis->setLabel("Deg. ");
+    ui->LoopNicholsGraph->yAxis->setLabel("Mag. dB");
+    ui->LoopNicholsGraph->xAxis->setRange(-270, 0);
+    ui->LoopNicholsGraph->yAxis->setRange(-40, 40);
+}
+
+void FLySMPS::initDigitalPlot()
+{
+    ui->DzGraph->clearGraphs();
+
+    ui->DzGraph->addGraph(ui->DzGraph->xAxis, ui->DzGraph->yAxis);
+    ui->DzGraph->graph(0)->setPen(QPen(Qt::blue));
+    ui->DzGraph->graph(0)->setName("Analog mag.");
+
+    ui->DzGraph->addGraph(ui->DzGraph->xAxis2, ui->DzGraph->yAxis2);
+    ui->DzGraph->graph(1)->setPen(QPen(Qt::red));
+    ui->DzGraph->graph(1)->setName("Analog phs.");
+
+    //the quantized sections dashed over the continuous compensator:
+    ui->DzGraph->addGraph(ui->DzGraph->xAxis, ui->DzGraph->yAxis);
+    ui->DzGraph->graph(2)->setPen(QPen(Qt::blue, 1, Qt::DashLine));
+    ui->DzGraph->graph(2)->setName("Dig. mag.");
+
+    ui->DzGraph->addGraph(ui->DzGraph->xAxis2, ui->DzGraph->yAxis2);
+    ui->DzGraph->graph(3)->setPen(QPen(Qt::red, 1, Qt::DashLine));
+    ui->DzGraph->graph(3)->setName("Dig. phs.");
+
+    ui->DzGraph->xAxis2->setVisible(true);
+    ui->DzGraph->yAxis2->setVisible(true);
+
+    ui->DzGraph->xAxis->setLabel("Freq. Hz");
+    ui->DzGraph->yAxis->setLabel("Mag. dB");
+    ui->DzGraph->yAxis2->setLabel("Deg. ");
+
+    ui->DzGraph->yAxis->grid()->setSubGridVisible(true);
+    ui->DzGraph->xAxis->grid()->setSubGridVisible(true);
+    ui->DzGraph->xAxis->setScaleType(QCPAxis::stLogarithmic);
+    ui->DzGraph->xAxis2->setScaleType(QCPAxis::stLogarithmic);
+
+    ui->DzGraph->yAxis->setRange(-40, 60);
+    ui->DzGraph->xAxis->setRange(1e1, 1e5);
+    ui->DzGraph->yAxis2->setRange(-180, 90);
+    ui->DzGraph->xAxis2->setRange(1e1, 1e5);
+
+    ui->DzGraph->xAxis->setNumberFormat("eb");
+    ui->DzGraph->xAxis->setNumberPrecision(0);
+
+    ui->DzGraph->xAxis2->setNumberFormat("eb");
+    ui->DzGraph->xAxis2->setNumberPrecision(0);
+}
+
+void FLySMPS::initClosedLoopPlot()
+{
+    initClosedBode(ui->ClosedGraph, "T/(1+T) dB", -60, 10);
+    initClosedBode(ui->ZoutGraph, "Zout dBOhm", -80, 0);
+    initClosedBode(ui->AudioGraph, "Vout/Vin dB", -120, 0);
+}
+
+void FLySMPS::initClosedBode(QCustomPlot *plot, const QString &mag_label, double mag_lo, double mag_hi)
+{
+    plot->clearGraphs();
+
+    plot->addGraph(plot->xAxis, plot->yAxis);
+    plot->graph(0)->setPen(QPen(Qt::blue));
+    plot->graph(0)->setName("Mag.");
+
+    plot->addGraph(plot->xAxis2, plot->yAxis2);
+    plot->graph(1)->setPen(QPen(Qt::red));
+    plot->graph(1)->setName("Phs.");
+
+    plot->xAxis2->setVisible(true);
+    plot->yAxis2->setVisible(true);
+
+    plot->xAxis->setLabel("Freq. Hz");
+    plot->yAxis->setLabel(mag_label);
+    plot->yAxis2->setLabel("Deg. ");
+
+    plot->yAxis->grid()->setSubGridVisible(true);
+    plot->xAxis->grid()->setSubGridVisible(true);
+    plot->xAxis->setScaleType(QCPAxis::stLogarithmic);
+    plot->xAxis2->setScaleType(QCPAxis::stLogarithmic);
+
+    plot->yAxis->setRange(mag_lo, mag_hi);
+    plot->xAxis->setRange(1e1, 1e6);
+    plot->yAxis2->setRange(-270, 90);
+    plot->xAxis2->setRange(1e1, 1e6);
+
+    plot->xAxis->setNumberFormat("eb");
+    plot->xAxis->setNumberPrecision(0);
+    plot->xAxis2->setNumberFormat("eb");
+    plot->xAxis2->setNumberPrecision(0);
+}
+
+void FLySMPS::initLocusPlot()
+{
+    //the branch curves are created by the arrived locus, the plot owns them
+    ui->LocusGraph->clearPlottables();
+    ui->LocusGraph->xAxis->setLabel("Re rad/s");
+    ui->LocusGraph->yAxis->setLabel("Im rad/s");
+    ui->LocusGraph->xAxis->grid()->setZeroLinePen(QPen(Qt::black));
+    ui->LocusGraph->yAxis->grid()->setZeroLinePen(QPen(Qt::black));
+    ui->LocusGraph->xAxis->setRange(-1e4, 1e3);
+    ui->LocusGraph->yAxis->setRange(-1e4, 1e4);
+    ui->LocusGainSlider->setEnabled(false);
+}
+
+void FLySMPS::initTransientPlot()
+{
+    ui->TransientGraph->clearGraphs();
+
+    ui->TransientGraph->addGraph(ui->TransientGraph->xAxis, ui->TransientGraph->yAxis);
+    ui->TransientGraph->graph(0)->setPen(QPen(Qt::blue));
+    ui->TransientGraph->graph(0)->setName("Load step");
+
+    ui->TransientGraph->addGraph(ui->TransientGraph->xAxis, ui->TransientGraph->yAxis);
+    ui->TransientGraph->graph(1)->setPen(QPen(Qt::red));
+    ui->TransientGraph->graph(1)->setName("Line step");
+
+    ui->TransientGraph->xAxis->setLabel("Time ms");
+    ui->TransientGraph->yAxis->setLabel("dVout V");
+    ui->TransientGraph->yAxis->grid()->setZeroLinePen(QPen(Qt::black));
+    ui->TransientGraph->xAxis->setRange(0, 1);
+    ui->TransientGraph->yAxis->setRange(-0.5, 0.5);
+}
+
+void FLySMPS::initMonteCarloPlot()
+{
+    //the bars and the limit lines are created by the arrived run, the plot owns them
+    ui->McPmGraph->xAxis->setLabel("PM Deg");
+    ui->McGmGraph->xAxis->setLabel("GM dB");
+    ui->McFcGraph->xAxis->setLabel("Fc kHz");
+    for(QCustomPlot *plot : {ui->McPmGraph, ui->McGmGraph, ui->McFcGraph})
+    {
+        plot->clearPlottables();
+        plot->clearItems();
+        plot->yAxis->setLabel("Samples");
+        plot->yAxis->setRange(0, 1);
+    }
 }
 
 void FLySMPS::initFCPlot()
@@ -306,6 +619,33 @@ void FLySMPS::initFCPlot()
 
     ui->OptoGraph->xAxis2->setNumberFormat("eb");
     ui->OptoGraph->xAxis2->setNumberPrecision(0);
+
+    initMeasureGraphs(ui->OptoGraph);
+}
+
+void FLySMPS::initMeasureGraphs(QCustomPlot *plot)
+{
+    //imported measure dashed over the model, fitted response on top:
+    plot->addGraph(plot->xAxis, plot->yAxis);
+    plot->graph(2)->setPen(QPen(Qt::blue, 1, Qt::DashLine));
+    plot->graph(2)->setName("Meas. mag.");
+
+    plot->addGraph(plot->xAxis2, plot->yAxis2);
+    plot->graph(3)->setPen(QPen(Qt::red, 1, Qt::DashLine));
+    plot->graph(3)->setName("Meas. phs.");
+
+    plot->addGraph(plot->xAxis, plot->yAxis);
+    plot->graph(4)->setPen(QPen(Qt::darkGreen));
+    plot->graph(4)->setName("Fit mag.");
+
+    plot->addGraph(plot->xAxis2, plot->yAxis2);
+    plot->graph(5)->setPen(QPen(Qt::darkMagenta));
+    plot->graph(5)->setName("Fit phs.");
+}
+
+QCustomPlot *FLySMPS::measurePlot(int32_t target)
+{
+    return (target == MF_POWER_STAGE) ? ui->PSMGraph : ui->OptoGraph;
 }
 
 void FLySMPS::initOutDCData()
@@ -468,7 +808,7 @@ void FLySMPS::initTransCoreValues()
 
     m_psolve->m_cs.core_vol = convertToValues(static_cast<QString>(ui->VE->text()));
     m_psolve->m_cs.mean_leng_per_turn = convertToValues(static_cast<QString>(ui->MLT->text()));
-    m_psolve->m_cs.mean_mag_path_leng = convertToValues(static_cast<QString>(ui->AE->text()));
+    m_psolve->m_cs.mean_mag_path_leng = convertToValues(static_cast<QString>(ui->MPL->text()));
     m_psolve->m_cs.core_permeal = convertToValues(static_cast<QString>(ui->MUE->text()));
     m_psolve->m_md.D = convertToValues(static_cast<QString>(ui->Dsize->text()));
     m_psolve->m_md.C = convertToValues(static_cast<QString>(ui->Csize->text()));
@@ -536,7 +876,7 @@ void FLySMPS::initTransCoreValuesById(int id)
     m_psolve->m_md.E = core->geometry().E;
     ui->VE->setText(QString::number(core->effectiveMagneticVolume()));
     ui->MLT->setText(QString::number(core->lengthTurn()));
-    ui->AE->setText(QString::number(core->effectiveMagneticPathLength()));
+    ui->MPL->setText(QString::number(core->effectiveMagneticPathLength()));
     ui->MUE->setText(QString::number(core->coreGapping().actualRelativePermeability));
     ui->Dsize->setText(QString::number(core->geometry().D));
     ui->Csize->setText(QString::number(core->geometry().C));
@@ -577,6 +917,11 @@ void FLySMPS::initTransWireds()
     auto af_4 = convertToValues(static_cast<QString>(ui->AFOut4->text()));
     auto af_5 = convertToValues(static_cast<QString>(ui->AFAux->text()));
 
+    /** The coefficients are indexed from zero, the previous run is dropped */
+    m_psolve->m_psw.m_af.clear();
+    m_psolve->m_psw.m_ins.clear();
+    m_psolve->m_psw.m_npw.clear();
+
     m_psolve->m_psw.m_af.push_back(static_cast<float>(af_0));
     m_psolve->m_psw.m_af.push_back(static_cast<float>(af_1));
     m_psolve->m_psw.m_af.push_back(static_cast<float>(af_2));
@@ -700,20 +1045,7 @@ void FLySMPS::initMosfetValues()
     m_psolve->m_mospr.m_coss = convertToValues(static_cast<QString>(ui->COss->text()));
     m_psolve->m_mospr.m_rdson = convertToValues(static_cast<QString>(ui->RdsOn->text()));
 
-    m_psolve->m_ccsp.cl_first_out_volt = m_psolve->m_indata.volt_out_one;
-
-    // Determine the turns ratio
-    // See Ayachit A.-Magnetising inductance of multiple-output flyback dc–dc convertor for dcm.
-    auto commTR =
-            [=](double amdc, int32_t nump)
-    {
-        double n_frst = amdc/((1-amdc)*(m_psolve->m_indata.volt_out_one/
-                                       (M_SQRT2*m_psolve->m_indata.input_volt_ac_min)));
-        return static_cast<float>(nump/n_frst);
-    };
-
-    m_psolve->m_ccsp.cl_turn_rat = commTR(m_psolve->m_ptpe->actual_max_duty_cycle, m_psolve->m_ptpe->actual_num_primary);
-    m_psolve->m_ccsp.leakage_induct = m_psolve->m_indata.leakage_induct;
+    m_psolve->deriveSwitchNetwork();
     m_psolve->m_ccsp.cl_vol_rip = convertToValues(static_cast<QString>(ui->SnubbVoltRipp->text()));
 
     m_psolve->m_ccsp.cs_volt = convertToValues(static_cast<QString>(ui->CSVolt->text()));
@@ -782,6 +1114,7 @@ void FLySMPS::setSolveOutDiode()
 
 void FLySMPS::initOutCapValues()
 {
+    m_psolve->m_cop.clear();
     m_psolve->m_cop.reserve(5);
 
     CapOutProp co_first;
@@ -793,37 +1126,28 @@ void FLySMPS::initOutCapValues()
     co_first.co_volts_rippl = static_cast<float>(convertToValues(static_cast<QString>(ui->Out1VRip->text())));
     co_first.co_esr_perc = static_cast<float>(convertToValues(static_cast<QString>(ui->Out1ESRPerc->text())));
     co_first.co_cros_frq_start_val = static_cast<float>(convertToValues(static_cast<QString>(ui->Out1ZFC->text())));
-    co_first.co_volts_out = m_psolve->m_indata.volt_out_one;
-    co_first.co_curr_peak_out = m_psolve->m_indata.curr_out_one;
     m_psolve->m_cop.push_back(co_first);
 
     co_sec.co_volts_rippl = static_cast<float>(convertToValues(static_cast<QString>(ui->Out2VRip->text())));
     co_sec.co_esr_perc = static_cast<float>(convertToValues(static_cast<QString>(ui->Out2ESRPerc->text())));
     co_sec.co_cros_frq_start_val = static_cast<float>(convertToValues(static_cast<QString>(ui->Out2ZFC->text())));
-    co_sec.co_volts_out = m_psolve->m_indata.volt_out_two;
-    co_sec.co_curr_peak_out = m_psolve->m_indata.curr_out_two;
     m_psolve->m_cop.push_back(co_sec);
 
     co_thr.co_volts_rippl = static_cast<float>(convertToValues(static_cast<QString>(ui->Out3VRip->text())));
     co_thr.co_esr_perc = static_cast<float>(convertToValues(static_cast<QString>(ui->Out3ESRPerc->text())));
     co_thr.co_cros_frq_start_val = static_cast<float>(convertToValues(static_cast<QString>(ui->Out3ZFC->text())));
-    co_thr.co_volts_out = m_psolve->m_indata.volt_out_three;
-    co_thr.co_curr_peak_out = m_psolve->m_indata.curr_out_three;
     m_psolve->m_cop.push_back(co_thr);
 
     co_four.co_volts_rippl = static_cast<float>(convertToValues(static_cast<QString>(ui->Out4VRip->text())));
     co_four.co_esr_perc = static_cast<float>(convertToValues(static_cast<QString>(ui->Out4ESRPerc->text())));
     co_four.co_cros_frq_start_val = static_cast<float>(convertToValues(static_cast<QString>(ui->Out4ZFC->text())));
-    co_four.co_volts_out = m_psolve->m_indata.volt_out_four;
-    co_four.co_curr_peak_out = m_psolve->m_indata.curr_out_four;
     m_psolve->m_cop.push_back(co_four);
 
     co_fifth.co_volts_rippl = static_cast<float>(convertToValues(static_cast<QString>(ui->AuxVRip->text())));
     co_fifth.co_esr_perc = static_cast<float>(convertToValues(static_cast<QString>(ui->AuxESRPerc->text())));
     co_fifth.co_cros_frq_start_val = static_cast<float>(convertToValues(static_cast<QString>(ui->AuxZFC->text())));
-    co_fifth.co_volts_out = m_psolve->m_indata.volt_out_aux;
-    co_fifth.co_curr_peak_out = m_psolve->m_indata.curr_out_aux;
     m_psolve->m_cop.push_back(co_fifth);
+    m_psolve->deriveOutCap();
 
     emit initOutCapValuesComplete();
 }
@@ -886,57 +1210,62 @@ void FLySMPS::setSolveLCFilter(QHash<QString, double> h_data)
     ui->LCOutRippVolt->setNum(h_data.value("ORV "));
 }
 
-void FLySMPS::setLCPlot(QVector<double> mg_data, QVector<double> ph_data)
+void FLySMPS::setLCPlot(BodePlotData pl_data)
 {
     //pass data points to graphs:
-    ui->LCFilterGraph->graph(0)->setData(m_psolve->m_offrq, mg_data);
-    ui->LCFilterGraph->graph(1)->setData(m_psolve->m_offrq, ph_data);
+    PlotDecimatorLink::pdAttach(ui->LCFilterGraph->graph(0), pl_data.mag);
+    PlotDecimatorLink::pdAttach(ui->LCFilterGraph->graph(1), pl_data.phs);
 
     ui->LCFilterGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
     ui->LCFilterGraph->legend->setVisible(true);
     ui->LCFilterGraph->legend->setBrush(QBrush(QColor(255,255,255,150)));
     ui->LCFilterGraph->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft|Qt::AlignBottom);
     ui->LCFilterGraph->replot();
-    //
-    //m_psolve->m_offrq.clear();
-    //m_psolve->m_ofmag.clear();
-    //m_psolve->m_ofphs.clear();
 }
 
-void FLySMPS::initPowerStageModel()
+void FLySMPS::initFilterDesign()
 {
-    // External ramp slope compensation(S_e)
-    // Basso C.-The TL431 in Switch-Mode Power Supplies loops: part V
-    auto rsc = [=](int16_t p_vout, float p_diode_drop, float p_rsense,
-                     float p_turns_ratio, double p_prim_ind)
-    {
-        return 0.5 * ((p_vout + p_diode_drop)/(p_turns_ratio * p_prim_ind) * p_rsense);
-    };
+    m_psolve->m_lfs.stages = qBound(1, static_cast<int>(convertToValues(static_cast<QString>(ui->LcdStages->text()))), LF_MAX_STAGES);
+    m_psolve->m_lfs.atten_min = convertToValues(static_cast<QString>(ui->LcdAttMin->text()));
+    m_psolve->m_lfs.peak_max = convertToValues(static_cast<QString>(ui->LcdPeakMax->text()));
+    m_psolve->m_lfs.phase_max = convertToValues(static_cast<QString>(ui->LcdPhaseMax->text()));
+    m_psolve->m_lfs.nominal.ind_res = convertToValues(static_cast<QString>(ui->LcdIndRes->text()));
+    m_psolve->m_lfs.nominal.cap_esr = convertToValues(static_cast<QString>(ui->LcdCapEsr->text()));
+    m_psolve->m_lfs.nominal.cap_esl = convertToValues(static_cast<QString>(ui->LcdCapEsl->text()));
+    emit initFilterDesignComplete();
+}
 
-    // Determine the turns ratio
-    // See Ayachit A.-Magnetising inductance of multiple-output flyback dc–dc convertor for dcm.
-    auto commTR = [=](double amdc, int32_t nump)
-    {
-        double n_frst = amdc/((1-amdc)*(m_psolve->m_indata.volt_out_one/
-                                       (M_SQRT2*m_psolve->m_indata.input_volt_ac_min)));
-        return static_cast<float>(nump/n_frst);
-    };
-
-    m_psolve->m_ssm.input_voltage = m_psolve->m_indata.input_volt_ac_max;
-    m_psolve->m_ssm.freq_switch = m_psolve->m_indata.freq_switch;
-    m_psolve->m_ssm.actual_duty = m_psolve->m_ptpe->actual_max_duty_cycle;
-    m_psolve->m_ssm.primary_ind = m_psolve->m_ptpe->primary_induct;
-    m_psolve->m_ssm.res_sense = m_psolve->m_pm->curr_sense_res;
-    m_psolve->m_ssm.output_voltage = m_psolve->m_indata.volt_out_one;
-    m_psolve->m_ssm.output_full_load_res = m_psolve->m_indata.volt_out_one/m_psolve->m_indata.curr_out_one;
-    m_psolve->m_ssm.turn_ratio = commTR(m_psolve->m_ptpe->actual_max_duty_cycle, m_psolve->m_ptpe->actual_num_primary) /*m_psolve->m_ptpe->number_primary/m_psolve->m_ptsw->out_one_wind.value("NSEC")*/;
-    m_psolve->m_ssm.output_cap = m_psolve->m_foc->out_cap_first["CVO"];
-    m_psolve->m_ssm.output_cap_esr = m_psolve->m_foc->out_cap_first["CESRO"];
-    m_psolve->m_ssm.sawvolt = rsc(m_psolve->m_indata.volt_out_one,
-                                  m_psolve->m_indata.volt_diode_drop_sec,
-                                  m_psolve->m_pm->curr_sense_res,
-                                  commTR(m_psolve->m_ptpe->actual_max_duty_cycle, m_psolve->m_ptpe->actual_num_primary),
-                                  m_psolve->m_ptpe->primary_induct);
+void FLySMPS::setFilterDesign(QHash<QString, double> h_data)
+{
+    ui->LcdInd->setNum(h_data.value("LFL"));
+    ui->LcdCap->setNum(h_data.value("LFC"));
+    ui->LcdDampRes->setNum(h_data.value("LFRD"));
+    ui->LcdDampCap->setNum(h_data.value("LFCD"));
+    ui->LcdAtten->setNum(h_data.value("LFAT"));
+    ui->LcdPeak->setNum(h_data.value("LFPK"));
+    ui->LcdPeakFreq->setNum(h_data.value("LFFP"));
+    ui->LcdZoutPeak->setNum(h_data.value("LFZO"));
+    ui->LcdPhaseCross->setNum(h_data.value("LFPH"));
+
+    /** The cheapest candidate is shown even when none of the sweep meets the targets */
+    ui->groupBox_41->setStyleSheet(h_data.value("LFOK") > 0. ? QString() : QString("QLabel{color: red;}"));
+}
+
+void FLySMPS::setFilterDesignPlot(BodePlotData pl_data)
+{
+    PlotDecimatorLink::pdAttach(ui->LcdGraph->graph(0), pl_data.mag);
+    PlotDecimatorLink::pdAttach(ui->LcdGraph->graph(1), pl_data.phs);
+
+    ui->LcdGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
+    ui->LcdGraph->legend->setVisible(true);
+    ui->LcdGraph->legend->setBrush(QBrush(QColor(255,255,255,150)));
+    ui->LcdGraph->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft|Qt::AlignBottom);
+    ui->LcdGraph->replot();
+}
+
+void FLySMPS::initPowerStageModel()
+{
+    m_psolve->derivePowerStageModel();
     emit initPowerStageModelComplete();
 }
 
@@ -953,49 +1282,95 @@ void FLySMPS::setPowerStageModel(QHash<QString, double> h_data)
     ui->PSMGf->setNum(h_data.value("GCMC"));
 }
 
-void FLySMPS::setPowerStagePlot(QVector<double> mg_data, QVector<double> ph_data)
+void FLySMPS::setPowerStagePlot(BodePlotData pl_data)
 {
 
     //pass data points to graphs:
-    ui->PSMGraph->graph(0)->setData(m_psolve->m_ssmfrq, mg_data);
-    ui->PSMGraph->graph(1)->setData(m_psolve->m_ssmfrq, ph_data);
+    PlotDecimatorLink::pdAttach(ui->PSMGraph->graph(0), pl_data.mag);
+    PlotDecimatorLink::pdAttach(ui->PSMGraph->graph(1), pl_data.phs);
 
     ui->PSMGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
     ui->PSMGraph->legend->setVisible(true);
     ui->PSMGraph->legend->setBrush(QBrush(QColor(255,255,255,150)));
     ui->PSMGraph->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft|Qt::AlignBottom);
     ui->PSMGraph->replot();
-    //
-    //m_psolve->m_ssmfrq.clear();
-    //m_psolve->m_ssmmag.clear();
-    //m_psolve->m_ssmphs.clear();
+}
+
+void FLySMPS::setModeMap(QHash<QString, double> h_data)
+{
+    ui->MmCcmShare->setNum(h_data.value("MMCCM"));
+    ui->MmIndCritMin->setNum(h_data.value("MMLC"));
+    ui->MmBoundLow->setNum(h_data.value("MMPBL"));
+    ui->MmBoundHigh->setNum(h_data.value("MMPBH"));
+
+    /** The DCM small-signal model does not hold in the CCM part of the map */
+    ui->groupBox_44->setStyleSheet(h_data.value("MMOK") > 0. ? QString() : QString("QLabel{color: red;}"));
+}
+
+void FLySMPS::setModeMapPlot(ModeMapPlotData pl_data)
+{
+    m_modemap = pl_data;
+    plSetCurve(qobject_cast<QCPCurve*>(ui->ModeMapGraph->plottable(1)), pl_data.bound);
+    showModeMap(ui->ModeMapView->currentIndex());
+}
+
+void FLySMPS::showModeMap(int view)
+{
+    if(m_modemap.mode.cell.isEmpty())
+        return;
+
+    QCPColorMap *map = qobject_cast<QCPColorMap*>(ui->ModeMapGraph->plottable(0));
+    QCPColorScale *scale = map->colorScale();
+    if(view == 1)
+    {
+        //critical inductance spans decades over the load:
+        plSetColorMap(map, m_modemap.ind_crit);
+        map->setGradient(QCPColorGradient::gpThermal);
+        map->setInterpolate(true);
+        scale->setDataScaleType(QCPAxis::stLogarithmic);
+        map->rescaleDataRange(true);
+        scale->axis()->setLabel(QString("L crit uH, Lp %1").arg(m_modemap.ind_prim, 0, 'f', 0));
+    }
+    else if(view == 2)
+    {
+        plSetColorMap(map, m_modemap.margin);
+        map->setGradient(QCPColorGradient::gpPolar);
+        map->setInterpolate(true);
+        scale->setDataScaleType(QCPAxis::stLinear);
+        map->setDataRange(QCPRange(-100, 100));
+        scale->axis()->setLabel("Margin %, DCM above zero");
+    }
+    else
+    {
+        //one flat level for each of CCM, BCM and DCM:
+        QCPColorGradient grad;
+        grad.setColorStopAt(0, Qt::red);
+        grad.setColorStopAt(0.5, Qt::yellow);
+        grad.setColorStopAt(1, Qt::green);
+        grad.setLevelCount(3);
+        plSetColorMap(map, m_modemap.mode);
+        map->setGradient(grad);
+        map->setInterpolate(false);
+        scale->setDataScaleType(QCPAxis::stLinear);
+        map->setDataRange(QCPRange(0, 2));
+        scale->axis()->setLabel("CCM - BCM - DCM");
+    }
+    map->rescaleAxes();
+
+    ui->ModeMapGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    ui->ModeMapGraph->replot();
 }
 
 void FLySMPS::initOptoFeedbStage()
 {
-    m_psolve->m_fc.out_voltage = m_psolve->m_indata.volt_out_one;
-    m_psolve->m_fc.out_current = m_psolve->m_indata.curr_out_one;
     m_psolve->m_fc.res_pull_up = convertToValues(static_cast<QString>(ui->ResPullUp->text()));
     m_psolve->m_fc.res_down = convertToValues(static_cast<QString>(ui->ResDown->text()));
     m_psolve->m_fc.phase_rotate = convertToValues(static_cast<QString>(ui->PhaseMarg->text()));//M
     m_psolve->m_fc.phase_marg = convertToValues(static_cast<QString>(ui->GainMarg->text()));//P
     m_psolve->m_fc.opto_ctr = convertToValues(static_cast<QString>(ui->OptoCTR->text()));
-    m_psolve->m_fc.freq_sw = m_psolve->m_indata.freq_switch;
     m_psolve->m_fc.opto_inner_cap = convertToValues(static_cast<QString>(ui->OptoInnerCap->text()));
-    m_psolve->m_fc.out_sm_cap =  m_psolve->m_foc->out_cap_first.value("CVO");
-    m_psolve->m_fc.out_sm_cap_esr = m_psolve->m_foc->out_cap_first.value("CESRO");
-
-    m_psolve->m_rs.inp_voltage = m_psolve->m_indata.input_volt_ac_min;
-    m_psolve->m_rs.prim_turns = m_psolve->m_ptpe->actual_num_primary;
-    m_psolve->m_rs.sec_turns_to_control = m_psolve->m_ptsw->out_one_wind["NSEC"];
-    m_psolve->m_rs.actual_duty = m_psolve->m_ptpe->actual_max_duty_cycle;
-    m_psolve->m_rs.out_pwr_tot = m_psolve->m_indata.power_out_max;
-    m_psolve->m_rs.primary_ind = m_psolve->m_ptpe->primary_induct;
-    m_psolve->m_rs.res_sense = m_psolve->m_pm->curr_sense_res;
-
-    m_psolve->m_lc.lcf_ind = m_psolve->m_ofhshdata.value("CAP");
-    m_psolve->m_lc.lcf_cap = m_psolve->m_ofhshdata.value("IND");
     m_psolve->m_lc.lcf_cap_esr = convertToValues(static_cast<QString>(ui->CapFilterESR->text()));
+    m_psolve->deriveOptocouplerFeedback();
     emit initOptoFeedbStageComplete();
 }
 
@@ -1019,21 +1394,372 @@ void FLySMPS::setOptoFeedbStage(QHash<QString, double> h_data)
     ui->CapZero->setNum(h_data.value("CAPERR"));
 }
 
-void FLySMPS::setOptoFeedbPlot(QVector<double> mg_data, QVector<double> ph_data)
+void FLySMPS::setOptoFeedbPlot(BodePlotData pl_data)
 {
     //pass data points to graphs:
-    ui->OptoGraph->graph(0)->setData(m_psolve->m_ofsfrq, mg_data);
-    ui->OptoGraph->graph(1)->setData(m_psolve->m_ofsfrq, ph_data);
+    PlotDecimatorLink::pdAttach(ui->OptoGraph->graph(0), pl_data.mag);
+    PlotDecimatorLink::pdAttach(ui->OptoGraph->graph(1), pl_data.phs);
 
     ui->OptoGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
     ui->OptoGraph->legend->setVisible(true);
     ui->OptoGraph->legend->setBrush(QBrush(QColor(255,255,255,150)));
     ui->OptoGraph->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft|Qt::AlignBottom);
     ui->OptoGraph->replot();
-    //
-    //m_psolve->m_ofsfrq.clear();
-    //m_psolve->m_ofsmag.clear();
-    //m_psolve->m_ofsphs.clear();
+}
+
+void FLySMPS::initMeasureImport(int32_t target)
+{
+    QString path = QFileDialog::getOpenFileName(this, tr("Import measured response"), QString(),
+                                                tr("Bode data (*.csv *.txt *.s1p *.s2p);;All files (*)"));
+    if(path.isEmpty())
+        return;
+    emit initMeasureImportComplete(target, path);
+}
+
+void FLySMPS::setMeasurePlot(int32_t target, BodePlotData pl_data)
+{
+    QCustomPlot *plot = measurePlot(target);
+    PlotDecimatorLink::pdAttach(plot->graph(2), pl_data.mag);
+    PlotDecimatorLink::pdAttach(plot->graph(3), pl_data.phs);
+
+    //the fit of the previous measure does not belong to the new one:
+    for(int32_t gr = 4; gr <= 5; ++gr)
+    {
+        PlotDecimatorLink::pdAttach(plot->graph(gr), QSharedPointer<const PlotDecimator>());
+        plot->graph(gr)->data()->clear();
+    }
+    ((target == MF_POWER_STAGE) ? ui->PsmFitResult : ui->OptoFitResult)->clear();
+
+    plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
+    plot->legend->setVisible(true);
+    plot->legend->setBrush(QBrush(QColor(255,255,255,150)));
+    plot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft|Qt::AlignBottom);
+    plot->replot();
+}
+
+void FLySMPS::setMeasureFit(int32_t target, QHash<QString, double> h_data)
+{
+    QLabel *res = (target == MF_POWER_STAGE) ? ui->PsmFitResult : ui->OptoFitResult;
+    if(h_data.value("MFN") <= 0.)
+    {
+        res->setText("Import failed");
+        res->setStyleSheet("QLabel{color: red;}");
+        return;
+    }
+
+    QString text;
+    if(target == MF_POWER_STAGE)
+    {
+        text = QString("ESR %1\nLp %2\n").arg(h_data.value("MFP0"), 0, 'g', 3).arg(h_data.value("MFP1"), 0, 'g', 3);
+    }
+    else
+    {
+        text = QString("CTR %1\nFp %2\n").arg(h_data.value("MFP0"), 0, 'g', 3).arg(h_data.value("MFP1"), 0, 'g', 3);
+    }
+    text += QString("%1 dB\n%2 deg\n%3 iter.").arg(h_data.value("MFRM"), 0, 'f', 2)
+                                              .arg(h_data.value("MFRP"), 0, 'f', 1)
+                                              .arg(static_cast<int>(h_data.value("MFIT")));
+    if(h_data.value("MFST") > 0.)
+        text += QString("\nstalled");
+    res->setText(text);
+
+    /** The values of the stopped fit are shown as well */
+    res->setStyleSheet(h_data.value("MFOK") > 0. ? QString() : QString("QLabel{color: red;}"));
+}
+
+void FLySMPS::setMeasureFitPlot(int32_t target, BodePlotData pl_data)
+{
+    QCustomPlot *plot = measurePlot(target);
+    PlotDecimatorLink::pdAttach(plot->graph(4), pl_data.mag);
+    PlotDecimatorLink::pdAttach(plot->graph(5), pl_data.phs);
+    plot->replot();
+}
+
+void FLySMPS::setLoopGain(QHash<QString, double> h_data)
+{
+    ui->LoopFc->setNum(h_data.value("FC"));
+    ui->LoopPm->setNum(h_data.value("PM"));
+    ui->LoopF180->setNum(h_data.value("F180"));
+    ui->LoopGm->setNum(h_data.value("GM"));
+    ui->LoopEnc->setNum(h_data.value("ENC"));
+    ui->LoopOrhp->setNum(h_data.value("ORHP"));
+    ui->LoopCrhp->setNum(h_data.value("CRHP"));
+}
+
+void FLySMPS::setLoopPlot(LoopPlotData pl_data)
+{
+    //pass data points to graphs:
+    PlotDecimatorLink::pdAttach(ui->LoopBodeGraph->graph(0), pl_data.bode.mag);
+    PlotDecimatorLink::pdAttach(ui->LoopBodeGraph->graph(1), pl_data.bode.phs);
+    plSetCurve(qobject_cast<QCPCurve*>(ui->LoopNyquistGraph->plottable(0)), pl_data.nyquist);
+    plSetCurve(qobject_cast<QCPCurve*>(ui->LoopNicholsGraph->plottable(0)), pl_data.nichols);
+
+    ui->LoopBodeGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
+    ui->LoopBodeGraph->legend->setVisible(true);
+    ui->LoopBodeGraph->legend->setBrush(QBrush(QColor(255,255,255,150)));
+    ui->LoopBodeGraph->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft|Qt::AlignBottom);
+    ui->LoopBodeGraph->replot();
+
+    ui->LoopNyquistGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    ui->LoopNyquistGraph->replot();
+    ui->LoopNicholsGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    ui->LoopNicholsGraph->replot();
+}
+
+void FLySMPS::setCompTuner(QHash<QString, double> h_data)
+{
+    ui->TuneWorstPm->setNum(h_data.value("TPM"));
+    ui->TuneWorstGm->setNum(h_data.value("TGM"));
+    ui->TuneWorstPm->setStyleSheet(h_data.value("TOK") > 0. ? QString() : QString("color: red"));
+    ui->TuneWorstGm->setStyleSheet(h_data.value("TOK") > 0. ? QString() : QString("color: red"));
+}
+
+void FLySMPS::initDigitalComp()
+{
+    m_psolve->m_dzs.method = static_cast<DZ_METHOD>(ui->DzMethod->currentIndex());
+    m_psolve->m_dzs.freq_smp = convertToValues(static_cast<QString>(ui->DzFreqSmp->text()));
+    m_psolve->m_dzs.freq_warp = convertToValues(static_cast<QString>(ui->DzFreqWarp->text()));
+    m_psolve->m_dzs.fmt.int_bits = qBound(0, static_cast<int>(convertToValues(static_cast<QString>(ui->DzIntBits->text()))), DZ_WORD_BITS_MAX);
+    m_psolve->m_dzs.fmt.frac_bits = qBound(1, static_cast<int>(convertToValues(static_cast<QString>(ui->DzFracBits->text()))),
+                                           DZ_WORD_BITS_MAX - m_psolve->m_dzs.fmt.int_bits);
+    emit initDigitalCompComplete();
+}
+
+void FLySMPS::setDigitalComp(QHash<QString, double> h_data)
+{
+    ui->DzFreqCross->setNum(h_data.value("DZFC"));
+    ui->DzPhaseMarg->setNum(h_data.value("DZPM"));
+    ui->DzGainMarg->setNum(h_data.value("DZGM"));
+    ui->DzPhaseLoss->setNum(h_data.value("DZPL"));
+    ui->DzGainLoss->setNum(h_data.value("DZGL"));
+    ui->DzQuantLoss->setNum(h_data.value("DZQL"));
+    ui->DzPoleRadius->setNum(h_data.value("DZPR"));
+    ui->DzSections->setNum(h_data.value("DZNS"));
+
+    /** The saturated word or the pole moved out of the unit circle needs the other format */
+    bool fit = h_data.value("DZSAT") <= 0. && h_data.value("DZPR") <= 1.;
+    ui->groupBox_43->setStyleSheet(fit ? QString() : QString("QLabel{color: red;}"));
+}
+
+void FLySMPS::setDigitalCompPlot(DigitalCompData pl_data)
+{
+    PlotDecimatorLink::pdAttach(ui->DzGraph->graph(0), pl_data.analog.mag);
+    PlotDecimatorLink::pdAttach(ui->DzGraph->graph(1), pl_data.analog.phs);
+    PlotDecimatorLink::pdAttach(ui->DzGraph->graph(2), pl_data.digital.mag);
+    PlotDecimatorLink::pdAttach(ui->DzGraph->graph(3), pl_data.digital.phs);
+
+    ui->DzGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
+    ui->DzGraph->legend->setVisible(true);
+    ui->DzGraph->legend->setBrush(QBrush(QColor(255,255,255,150)));
+    ui->DzGraph->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignLeft|Qt::AlignBottom);
+    ui->DzGraph->replot();
+
+    PlotDecimatorLink::pdAttach(ui->LoopBodeGraph->graph(2), pl_data.loop.mag);
+    PlotDecimatorLink::pdAttach(ui->LoopBodeGraph->graph(3), pl_data.loop.phs);
+    ui->LoopBodeGraph->replot();
+
+    //listing of the words in the order of the difference equation:
+    const DzQuantized &qnt = pl_data.coeff;
+    QString text = QString("// Q%1.%2, a0 = %3\n").arg(qnt.fmt.int_bits).arg(qnt.fmt.frac_bits).arg(qint64(1) << qnt.fmt.frac_bits);
+    text += QString("// y[k] = b0 x[k] + b1 x[k-1] + b2 x[k-2] - a1 y[k-1] - a2 y[k-2]\n");
+    text += QString("// out = gain * 2^(shift - %1) * sections\n").arg(qnt.fmt.frac_bits);
+    text += QString("gain %1, shift %2\n").arg(qnt.gain_mant).arg(qnt.gain_shift);
+    for(int32_t sec = 0; sec < qnt.coeff.size() / DZ_SECTION_COEFF; ++sec)
+    {
+        const int32_t *cf = qnt.coeff.constData() + sec * DZ_SECTION_COEFF;
+        text += QString("s%1: %2, %3, %4, %5, %6\n").arg(sec).arg(cf[0]).arg(cf[1]).arg(cf[2]).arg(cf[3]).arg(cf[4]);
+    }
+    ui->DzCoeffText->setPlainText(text);
+}
+
+void FLySMPS::setClosedLoop(QHash<QString, double> h_data)
+{
+    ui->ClBandwidth->setNum(h_data.value("CLBW"));
+    ui->ClPeaking->setNum(h_data.value("CLPK"));
+    ui->ClZoutPeak->setNum(h_data.value("ZOPK"));
+    ui->ClZoutFreq->setNum(h_data.value("ZOPF"));
+    ui->ClAudioPeak->setNum(h_data.value("ASPK"));
+    ui->ClAudioFreq->setNum(h_data.value("ASPF"));
+}
+
+void FLySMPS::setClosedLoopPlot(ClosedLoopPlotData pl_data)
+{
+    QCustomPlot *plots[] = {ui->ClosedGraph, ui->ZoutGraph, ui->AudioGraph};
+    const BodePlotData *bode[] = {&pl_data.closed, &pl_data.zout, &pl_data.audio};
+    for(int32_t indx = 0; indx < 3; ++indx)
+    {
+        PlotDecimatorLink::pdAttach(plots[indx]->graph(0), bode[indx]->mag);
+        PlotDecimatorLink::pdAttach(plots[indx]->graph(1), bode[indx]->phs);
+        plots[indx]->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
+        plots[indx]->replot();
+    }
+}
+
+void FLySMPS::setLocusGain(QHash<QString, double> h_data)
+{
+    ui->LocusKmin->setNum(h_data.value("KMIN"));
+    ui->LocusKmax->setNum(h_data.value("KMAX"));
+    ui->LocusCtrMin->setNum(h_data.value("CTRMIN"));
+    ui->LocusCtrMax->setNum(h_data.value("CTRMAX"));
+}
+
+void FLySMPS::setLocusPlot(RootLocusPlotData pl_data)
+{
+    m_locus = pl_data;
+    ui->LocusGraph->clearPlottables();
+
+    for(int32_t branch = 0; branch < pl_data.branch.size(); ++branch)
+    {
+        QCPCurve *crv = new QCPCurve(ui->LocusGraph->xAxis, ui->LocusGraph->yAxis);
+        crv->setPen(QPen(QColor::fromHsv((branch * 360) / pl_data.branch.size(), 255, 200)));
+        plSetCurve(crv, pl_data.branch.at(branch));
+    }
+
+    QCPCurve *pls = new QCPCurve(ui->LocusGraph->xAxis, ui->LocusGraph->yAxis);
+    pls->setLineStyle(QCPCurve::lsNone);
+    pls->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCross, Qt::black, 8));
+    plSetCurve(pls, pl_data.poles);
+
+    QCPCurve *zrs = new QCPCurve(ui->LocusGraph->xAxis, ui->LocusGraph->yAxis);
+    zrs->setLineStyle(QCPCurve::lsNone);
+    zrs->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, Qt::black, 8));
+    plSetCurve(zrs, pl_data.zeros);
+
+    //marker of the selected multiplier is the last plottable
+    QCPCurve *mrk = new QCPCurve(ui->LocusGraph->xAxis, ui->LocusGraph->yAxis);
+    mrk->setLineStyle(QCPCurve::lsNone);
+    mrk->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, Qt::red, 7));
+
+    ui->LocusGraph->xAxis->setRange(-pl_data.span, 0.25 * pl_data.span);
+    ui->LocusGraph->yAxis->setRange(-pl_data.span, pl_data.span);
+    ui->LocusGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+
+    //start the marker at the nominal loop, unit multiplier
+    const QVector<double> &gain = pl_data.locus->gain;
+    int nom = static_cast<int>(std::lower_bound(gain.constBegin(), gain.constEnd(), 1.) - gain.constBegin());
+    ui->LocusGainSlider->blockSignals(true);
+    ui->LocusGainSlider->setRange(0, qMax(gain.size() - 1, 0));
+    ui->LocusGainSlider->setValue(qMin(nom, gain.size() - 1));
+    ui->LocusGainSlider->blockSignals(false);
+    ui->LocusGainSlider->setEnabled(!gain.isEmpty());
+    setLocusMarker(ui->LocusGainSlider->value());
+}
+
+void FLySMPS::setLocusMarker(int step)
+{
+    if(m_locus.locus.isNull() || step < 0 || step >= m_locus.locus->gain.size())
+        return;
+
+    const RootLocus &rl = *m_locus.locus;
+    QVector<double> re, im;
+    for(int32_t branch = 0; branch < rl.branches; ++branch)
+    {
+        re.push_back(rl.rlRoot(step, branch).real());
+        im.push_back(rl.rlRoot(step, branch).imag());
+    }
+    QCPCurve *mrk = qobject_cast<QCPCurve*>(ui->LocusGraph->plottable(ui->LocusGraph->plottableCount() - 1));
+    mrk->setData(re, im);
+
+    ui->LocusGain->setNum(rl.gain.at(step));
+    ui->LocusCtr->setNum(rl.gain.at(step) * m_locus.ctr);
+    ui->LocusGraph->replot();
+}
+
+void FLySMPS::setTransient(QHash<QString, double> h_data)
+{
+    ui->TranLoadOs->setNum(h_data.value("LDOS"));
+    ui->TranLoadUs->setNum(h_data.value("LDUS"));
+    ui->TranLoadSt->setNum(h_data.value("LDST"));
+    ui->TranLineOs->setNum(h_data.value("LNOS"));
+    ui->TranLineUs->setNum(h_data.value("LNUS"));
+    ui->TranLineSt->setNum(h_data.value("LNST"));
+}
+
+void FLySMPS::setTransientPlot(TransientPlotData pl_data)
+{
+    //the whole simulated time is shown, the min/max points keep the peaks
+    ui->TransientGraph->xAxis->setRange(0, pl_data.span);
+    PlotDecimatorLink::pdAttach(ui->TransientGraph->graph(0), pl_data.load);
+    PlotDecimatorLink::pdAttach(ui->TransientGraph->graph(1), pl_data.line);
+    ui->TransientGraph->yAxis->rescale();
+    ui->TransientGraph->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iMultiSelect);
+    ui->TransientGraph->legend->setVisible(true);
+    ui->TransientGraph->legend->setBrush(QBrush(QColor(255,255,255,150)));
+    ui->TransientGraph->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignRight|Qt::AlignBottom);
+    ui->TransientGraph->replot();
+}
+
+void FLySMPS::setMonteCarlo(QHash<QString, double> h_data)
+{
+    ui->McSamples->setNum(h_data.value("SMP"));
+    ui->McYield->setNum(h_data.value("YLD"));
+    ui->McPmLow->setNum(h_data.value("PMLO"));
+    ui->McGmLow->setNum(h_data.value("GMLO"));
+    ui->McFcLow->setNum(h_data.value("FCLO"));
+    ui->McFcHigh->setNum(h_data.value("FCHI"));
+    ui->McYield->setStyleSheet(h_data.value("YLD") < 100. ? QString("color: red") : QString());
+}
+
+void FLySMPS::setMonteCarloPlot(MonteCarloPlotData pl_data)
+{
+    plotHistogram(ui->McPmGraph, pl_data.phase_marg, pl_data.phase_limit);
+    plotHistogram(ui->McGmGraph, pl_data.gain_marg, pl_data.gain_limit);
+    plotHistogram(ui->McFcGraph, pl_data.freq_cross, qQNaN());
+}
+
+void FLySMPS::setSensitivity(SensTableData tb_data)
+{
+    QTableWidget *table = ui->SensTable;
+    table->clear();
+    table->setRowCount(tb_data.rows.size());
+    table->setColumnCount(tb_data.cols.size() + 1);
+    table->setHorizontalHeaderLabels(QStringList(QString("Value")) + tb_data.cols);
+    table->setVerticalHeaderLabels(tb_data.rows);
+    for(int32_t row = 0; row < tb_data.rows.size(); ++row)
+    {
+        table->setItem(row, 0, new QTableWidgetItem(QString::number(tb_data.value[row], 'g', 4)));
+        for(int32_t col = 0; col < tb_data.cols.size(); ++col)
+        {
+            double elast = tb_data.elast[row][col];
+            QTableWidgetItem *item = new QTableWidgetItem(QString::number(elast, 'f', 2));
+            /** The inputs moving the output more than its own share are marked */
+            if(qAbs(elast) >= 1.)
+                item->setForeground(QBrush(Qt::red));
+            table->setItem(row, col + 1, item);
+        }
+    }
+    table->resizeColumnsToContents();
+}
+
+void FLySMPS::plotHistogram(QCustomPlot *plot, const McHistogram &hist, double limit)
+{
+    plot->clearPlottables();
+    plot->clearItems();
+
+    QVector<double> key(hist.count.size());
+    for(int32_t indx = 0; indx < key.size(); ++indx)
+    {
+        key[indx] = hist.lower + (indx + 0.5) * hist.width;
+    }
+    QCPBars *bars = new QCPBars(plot->xAxis, plot->yAxis);
+    bars->setWidth(hist.width);
+    bars->setPen(QPen(Qt::blue));
+    bars->setBrush(QBrush(QColor(0, 0, 255, 80)));
+    bars->setData(key, hist.count, true);
+    plot->rescaleAxes();
+
+    //the samples left of the line miss the margin target
+    if(qIsFinite(limit))
+    {
+        QCPItemStraightLine *line = new QCPItemStraightLine(plot);
+        line->setPen(QPen(Qt::red, 1, Qt::DashLine));
+        line->point1->setCoords(limit, 0);
+        line->point2->setCoords(limit, 1);
+        if(limit < plot->xAxis->range().lower)
+            plot->xAxis->setRangeLower(limit - hist.width);
+    }
+    plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    plot->replot();
 }
 
 /**
@@ -1340,12 +2066,3 @@ double FLySMPS::convertToValues(const QString &input)
     }
     return 0;
 }
-
-double FLySMPS::outPwr(const float mrg)
-{
-    return static_cast<double>(((m_psolve->m_indata.volt_out_one * m_psolve->m_indata.curr_out_one)
-                    +(m_psolve->m_indata.volt_out_two * m_psolve->m_indata.curr_out_two)
-                    +(m_psolve->m_indata.volt_out_three * m_psolve->m_indata.curr_out_three)
-                    +(m_psolve->m_indata.volt_out_four * m_psolve->m_indata.curr_out_four)
-                    +(m_psolve->m_indata.volt_out_aux * m_psolve->m_indata.curr_out_aux)) * mrg);
-}
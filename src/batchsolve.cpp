@@ -0,0 +1,808 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "inc/batchsolve.h"
+#include "inc/powsuppsolve.h"
+#include "inc/poolrunner.h"
+#include <QThread>
+#include <QElapsedTimer>
+#include <QFileDevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSharedPointer>
+#include <limits>
+
+#define BS_I16  32767.      //Limit of the int16_t field
+#define BS_U16  65535.      //Limit of the uint16_t field
+#define BS_I32  2147483647. //Limit of the int32_t field, the switching frequency goes to the int32_t too
+#define BS_DBL  std::numeric_limits<double>::max()
+
+typedef void (*BsSetter)(PowSuppSolve &ps, double val);
+typedef double (*BsGetter)(const PowSuppSolve &ps);
+
+/**
+ * @brief The BsField struct - input field of the form and its place in the solver
+ */
+struct BsField
+{
+    const char *key; //Object name of the field
+    const char *def; //Default text of the field
+    double lim; //Highest magnitude the solver type holds
+    BsSetter set;
+};
+
+/**
+ * @brief bsSetPrecision - BK_PREC of the one analysis, the negative value keeps the one of SweepPrec
+ */
+template<SWEEP_ID ID>
+static void bsSetPrecision(PowSuppSolve &ps, double val)
+{
+    if(val >= 0.)
+        ps.setSweepPrecision(ID, (val > 0.) ? BK_PREC_FAST : BK_PREC_EXACT);
+}
+
+/** The order of the form, DzFracBits is bound by DzIntBits set before it */
+static const BsField bs_field[] =
+{
+    {"VACmax", "230", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.input_volt_ac_max = static_cast<int16_t>(val);}},
+    {"VACmin", "90", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.input_volt_ac_min = static_cast<int16_t>(val);}},
+    {"FLine", "50", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.freq_line = static_cast<int16_t>(val);}},
+    {"FSw", "50K", BS_I32, [](PowSuppSolve &ps, double val){ps.m_indata.freq_switch = static_cast<uint32_t>(val);}},
+    {"Tamb", "50", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.temp_amb = static_cast<int16_t>(val);}},
+    {"VOut1", "12", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.volt_out_one = static_cast<int16_t>(val);}},
+    {"IOut1", "1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.curr_out_one = static_cast<float>(val);}},
+    {"VOut2", "5", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.volt_out_two = static_cast<int16_t>(val);}},
+    {"IOut2", "0.5", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.curr_out_two = static_cast<float>(val);}},
+    {"VOut3", "5", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.volt_out_three = static_cast<int16_t>(val);}},
+    {"IOut3", "0.5", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.curr_out_three = static_cast<float>(val);}},
+    {"VOut4", "0", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.volt_out_four = static_cast<int16_t>(val);}},
+    {"IOut4", "0", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.curr_out_four = static_cast<float>(val);}},
+    {"VAux", "15", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.volt_out_aux = static_cast<int16_t>(val);}},
+    {"IAux", "0.2", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.curr_out_aux = static_cast<float>(val);}},
+    {"Eff", "0.95", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.eff = val;}},
+    {"OutPwrMrg", "5", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.mrgn = static_cast<float>(val);}},
+    {"ReflVoltage", "110", BS_I16, [](PowSuppSolve &ps, double val){ps.m_indata.refl_volt_max = static_cast<int16_t>(val);}},
+    {"VSpike", "150", BS_U16, [](PowSuppSolve &ps, double val){ps.m_indata.voltage_spike = static_cast<uint16_t>(val);}},
+    {"KRF", "1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.ripple_fact = static_cast<float>(val);}},
+    {"EffTransf", "0.85", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.eff_transf = static_cast<float>(val);}},
+    {"VoltDropSec", "0.7", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.volt_diode_drop_sec = static_cast<float>(val);}},
+    {"VoltBridgeDrop", "0.9", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.volt_diode_drop_bridge = static_cast<float>(val);}},
+    {"LeakageInduct", "5u", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_indata.leakage_induct = val;}},
+
+    {"InputBMax", "0.2", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_ca.mag_flux_dens = val;}},
+    {"WinUtilFact", "0.3", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_ca.win_util_factor = val;}},
+    {"MaxCurrDens", "4", BS_I16, [](PowSuppSolve &ps, double val){ps.m_ca.max_curr_dens = static_cast<int16_t>(val);}},
+    /** FBPT_NUM_SETTING, 0 - AL factor, 1 - maximum flux density, 2 - area product */
+    {"NumSetting", "0", 2., [](PowSuppSolve &ps, double val){ps.m_fns = static_cast<FBPT_NUM_SETTING>(qMax(static_cast<int>(val), 0));}},
+    {"InductanceFact", "0.000000185", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cs.ind_fact = val;}},
+    /** FBPT_SHAPE_AIR_GAP, 0 - rectangular, 1 - round */
+    {"AirGap", "0", 1., [](PowSuppSolve &ps, double val){ps.m_fsag = static_cast<FBPT_SHAPE_AIR_GAP>(qMax(static_cast<int>(val), 0));}},
+    {"AE", "0.000052", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cs.core_cross_sect_area = val;}},
+    /** As the empty field of the form, zero or below leaves the window area to the solver */
+    {"WA", "0.000061", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cs.core_wind_area = (val > 0.) ? val : -1.0;}},
+    {"VE", "0.00000302", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cs.core_vol = val;}},
+    {"MLT", "0.05", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cs.mean_leng_per_turn = val;}},
+    {"MPL", "0.057", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cs.mean_mag_path_leng = val;}},
+    {"MUE", "1620", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cs.core_permeal = val;}},
+    {"Dsize", "0.007", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_md.D = static_cast<float>(val);}},
+    {"Csize", "0.007", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_md.C = static_cast<float>(val);}},
+    {"Fsize", "0.008", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_md.F = static_cast<float>(val);}},
+    {"Esize", "0.017", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_md.E = static_cast<float>(val);}},
+    {"RGDiam", "0", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_md.Diam = static_cast<float>(val);}},
+
+    {"AFNPm", "0.5", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_af[0] = static_cast<float>(val);}},
+    {"AFOut1", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_af[1] = static_cast<float>(val);}},
+    {"AFOut2", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_af[2] = static_cast<float>(val);}},
+    {"AFOut3", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_af[3] = static_cast<float>(val);}},
+    {"AFOut4", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_af[4] = static_cast<float>(val);}},
+    {"AFAux", "0.05", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_af[5] = static_cast<float>(val);}},
+    {"INSPm", "0.02", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_ins[0] = static_cast<float>(val);}},
+    {"INSOut1", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_ins[1] = static_cast<float>(val);}},
+    {"INSOut2", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_ins[2] = static_cast<float>(val);}},
+    {"INSOut3", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_ins[3] = static_cast<float>(val);}},
+    {"INSOut4", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_ins[4] = static_cast<float>(val);}},
+    {"INSAux", "0.1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_ins[5] = static_cast<float>(val);}},
+    {"NPWPrim", "1", BS_I16, [](PowSuppSolve &ps, double val){ps.m_psw.m_npw[0] = static_cast<int16_t>(val);}},
+    {"NPWOut1", "4", BS_I16, [](PowSuppSolve &ps, double val){ps.m_psw.m_npw[1] = static_cast<int16_t>(val);}},
+    {"NPWOut2", "2", BS_I16, [](PowSuppSolve &ps, double val){ps.m_psw.m_npw[2] = static_cast<int16_t>(val);}},
+    {"NPWOut3", "2", BS_I16, [](PowSuppSolve &ps, double val){ps.m_psw.m_npw[3] = static_cast<int16_t>(val);}},
+    {"NPWOut4", "1", BS_I16, [](PowSuppSolve &ps, double val){ps.m_psw.m_npw[4] = static_cast<int16_t>(val);}},
+    {"NPWAux", "1", BS_I16, [](PowSuppSolve &ps, double val){ps.m_psw.m_npw[5] = static_cast<int16_t>(val);}},
+    {"Fcu", "0.4", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_fcu = static_cast<float>(val);}},
+    {"InM", "0.003", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_psw.m_mcd = static_cast<float>(val);}},
+
+    {"VGS", "10", BS_I16, [](PowSuppSolve &ps, double val){ps.m_mospr.m_vgs = static_cast<int16_t>(val);}},
+    {"CurrDrv", "0.25", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_idr = static_cast<float>(val);}},
+    {"CurrDSMax", "6", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_fet_cur_max = static_cast<float>(val);}},
+    {"CurrDSMin", "10", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_fet_cur_min = static_cast<float>(val);}},
+    {"QGate", "16n", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_qg = val;}},
+    {"QGD", "10n", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_qgd = val;}},
+    {"QGS", "6n", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_qgs = val;}},
+    {"RGate", "15", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_rgate = val;}},
+    {"Vmill", "4.4", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_vmill = val;}},
+    {"COss", "100p", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_coss = val;}},
+    {"RdsOn", "1.0", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_mospr.m_rdson = static_cast<float>(val);}},
+    {"SnubbVoltRipp", "45", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_ccsp.cl_vol_rip = val;}},
+    {"CSVolt", "1", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_ccsp.cs_volt = val;}},
+
+    {"Out1VRip", "0.03", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[0].co_volts_rippl = static_cast<float>(val);}},
+    {"Out1ESRPerc", "0.9", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[0].co_esr_perc = static_cast<float>(val);}},
+    {"Out1ZFC", "5000", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[0].co_cros_frq_start_val = static_cast<float>(val);}},
+    {"Out2VRip", "0.03", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[1].co_volts_rippl = static_cast<float>(val);}},
+    {"Out2ESRPerc", "0.9", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[1].co_esr_perc = static_cast<float>(val);}},
+    {"Out2ZFC", "5000", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[1].co_cros_frq_start_val = static_cast<float>(val);}},
+    {"Out3VRip", "0.03", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[2].co_volts_rippl = static_cast<float>(val);}},
+    {"Out3ESRPerc", "0.9", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[2].co_esr_perc = static_cast<float>(val);}},
+    {"Out3ZFC", "5000", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[2].co_cros_frq_start_val = static_cast<float>(val);}},
+    {"Out4VRip", "0.03", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[3].co_volts_rippl = static_cast<float>(val);}},
+    {"Out4ESRPerc", "0.9", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[3].co_esr_perc = static_cast<float>(val);}},
+    {"Out4ZFC", "5000", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[3].co_cros_frq_start_val = static_cast<float>(val);}},
+    {"AuxVRip", "0.03", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[4].co_volts_rippl = static_cast<float>(val);}},
+    {"AuxESRPerc", "0.9", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[4].co_esr_perc = static_cast<float>(val);}},
+    {"AuxZFC", "5000", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_cop[4].co_cros_frq_start_val = static_cast<float>(val);}},
+
+    {"LCF_Freq", "50000", BS_I32, [](PowSuppSolve &ps, double val){ps.m_indata.fl_freq = static_cast<int32_t>(val);}},
+    {"LCF_ResLoad", "100", BS_I32, [](PowSuppSolve &ps, double val){ps.m_indata.fl_lres = static_cast<int32_t>(val);}},
+
+    {"ResPullUp", "4700", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_fc.res_pull_up = val;}},
+    {"ResDown", "10000", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_fc.res_down = val;}},
+    {"PhaseMarg", "70", BS_I32, [](PowSuppSolve &ps, double val){ps.m_fc.phase_rotate = static_cast<int32_t>(val);}},
+    {"GainMarg", "-16", BS_I32, [](PowSuppSolve &ps, double val){ps.m_fc.phase_marg = static_cast<int32_t>(val);}},
+    {"OptoCTR", "0.8", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_fc.opto_ctr = val;}},
+    {"OptoInnerCap", "5.2p", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_fc.opto_inner_cap = val;}},
+    {"CapFilterESR", "0.02", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_lc.lcf_cap_esr = val;}},
+
+    /** DZ_METHOD, the digital compensator is solved only with the sample rate above zero */
+    {"DzMethod", "0", 2., [](PowSuppSolve &ps, double val){ps.m_dzs.method = static_cast<DZ_METHOD>(qMax(static_cast<int>(val), 0));}},
+    {"DzFreqSmp", "0", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_dzs.freq_smp = val;}},
+    {"DzFreqWarp", "0", BS_DBL, [](PowSuppSolve &ps, double val){ps.m_dzs.freq_warp = val;}},
+    {"DzIntBits", "2", BS_I32, [](PowSuppSolve &ps, double val){ps.m_dzs.fmt.int_bits = qBound(0, static_cast<int>(val), DZ_WORD_BITS_MAX);}},
+    {"DzFracBits", "13", BS_I32, [](PowSuppSolve &ps, double val){ps.m_dzs.fmt.frac_bits = qBound(1, static_cast<int>(val),
+                                                                                                  DZ_WORD_BITS_MAX - ps.m_dzs.fmt.int_bits);}},
+
+    /** BK_PREC of all sweeps, not a field of the form, the fast functions for the exploratory batches */
+    {"SweepPrec", "0", 1., [](PowSuppSolve &ps, double val)
+     {
+         for(int32_t id = 0; id < SW_COUNT; ++id)
+             ps.setSweepPrecision(static_cast<SWEEP_ID>(id), (val > 0.) ? BK_PREC_FAST : BK_PREC_EXACT);
+     }},
+    /** BK_PREC of the one analysis over SweepPrec, set after it */
+    {"SweepPrecOutFilter", "-1", 1., bsSetPrecision<SW_OUT_FILTER>},
+    {"SweepPrecPowerStage", "-1", 1., bsSetPrecision<SW_POWER_STAGE>},
+    {"SweepPrecOptoFeedb", "-1", 1., bsSetPrecision<SW_OPTO_FEEDB>},
+    {"SweepPrecLoopGain", "-1", 1., bsSetPrecision<SW_LOOP_GAIN>},
+    {"SweepPrecLCDesign", "-1", 1., bsSetPrecision<SW_LC_DESIGN>},
+    {"SweepPrecClosedLoop", "-1", 1., bsSetPrecision<SW_CLOSED_LOOP>},
+    {"SweepPrecOutImp", "-1", 1., bsSetPrecision<SW_OUT_IMP>},
+    {"SweepPrecAudioSusc", "-1", 1., bsSetPrecision<SW_AUDIO_SUSC>},
+    {"SweepPrecCompAnalog", "-1", 1., bsSetPrecision<SW_COMP_ANALOG>},
+    {"SweepPrecCompDigital", "-1", 1., bsSetPrecision<SW_COMP_DIGITAL>},
+    {"SweepPrecLoopDigital", "-1", 1., bsSetPrecision<SW_LOOP_DIGITAL>},
+};
+
+/**
+ * @brief The BsColumn struct - result value outside of the result hashes
+ */
+struct BsColumn
+{
+    const char *key;
+    BsGetter get;
+};
+
+static const BsColumn bs_column[] =
+{
+    {"in.PO", [](const PowSuppSolve &ps){return ps.m_indata.power_out_max;}},
+    {"bcap.CAP", [](const PowSuppSolve &ps){return ps.m_bc->bcapacitor_value;}},
+    {"bcap.VDCMIN", [](const PowSuppSolve &ps){return ps.m_bc->input_dc_min_voltage;}},
+    {"bcap.IRMS", [](const PowSuppSolve &ps){return ps.m_bc->bcapacitor_rms_curr;}},
+    {"bridge.IPK", [](const PowSuppSolve &ps){return ps.m_db->diode_peak_curr;}},
+    {"prim.DMAX", [](const PowSuppSolve &ps){return ps.m_ptpe->max_duty_cycle;}},
+    {"prim.LP", [](const PowSuppSolve &ps){return ps.m_ptpe->primary_induct;}},
+    {"prim.IPK", [](const PowSuppSolve &ps){return ps.m_ptpe->curr_primary_peak;}},
+    {"prim.IRMS", [](const PowSuppSolve &ps){return ps.m_ptpe->curr_primary_rms;}},
+    {"prim.AP", [](const PowSuppSolve &ps){return ps.m_ptpe->core_area_product;}},
+    {"prim.NP", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_ptpe->actual_num_primary);}},
+    {"prim.LG", [](const PowSuppSolve &ps){return ps.m_ptpe->length_air_gap;}},
+    {"prim.BPK", [](const PowSuppSolve &ps){return ps.m_ptpe->actual_flux_dens_peak;}},
+    {"prim.VR", [](const PowSuppSolve &ps){return ps.m_ptpe->actual_volt_reflected;}},
+    {"prim.DACT", [](const PowSuppSolve &ps){return ps.m_ptpe->actual_max_duty_cycle;}},
+    {"prim.AWG", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_ptsw->primary_wind.value("AWGP", qQNaN()));}},
+    {"mosfet.VDS", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_pm->mosfet_voltage_max);}},
+    {"mosfet.PTOT", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_pm->mosfet_total_loss);}},
+    {"mosfet.VCL", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_pm->snubber_voltage_max);}},
+    {"mosfet.RCL", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_pm->snubber_res_value);}},
+    {"mosfet.CCL", [](const PowSuppSolve &ps){return ps.m_pm->snubber_cap_value;}},
+    {"mosfet.PCL", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_pm->snubber_pwr_diss);}},
+    {"mosfet.RCS", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_pm->curr_sense_res);}},
+    {"mosfet.PCS", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_pm->curr_sense_res_loss);}},
+    {"out1.NSEC", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_ptsw->out_one_wind.value("NSEC", qQNaN()));}},
+    {"out1.AWG", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_ptsw->out_one_wind.value("AWGNS", qQNaN()));}},
+    {"out1.DRV", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_fod->out_diode_first.value("DRV", qQNaN()));}},
+    {"out1.CVO", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_foc->out_cap_first.value("CVO", qQNaN()));}},
+    {"out1.CESRO", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_foc->out_cap_first.value("CESRO", qQNaN()));}},
+    {"out1.CCRMS", [](const PowSuppSolve &ps){return static_cast<double>(ps.m_foc->out_cap_first.value("CCRMS", qQNaN()));}},
+};
+
+/**
+ * @brief The BsSection struct - result hash with the keys written out, see PowSuppSolve
+ */
+struct BsSection
+{
+    const char *name;
+    QHash<QString, double> PowSuppSolve::*hash;
+    const char *keys;
+};
+
+static const BsSection bs_section[] =
+{
+    {"of", &PowSuppSolve::m_ofhshdata, "ACF CAP IND QFCT DAMP CFRQ ORV"},
+    {"psm", &PowSuppSolve::m_ssmhshdata, "ZONE PONE DCMZT DCMPT GCMC"},
+    {"mm", &PowSuppSolve::m_mmhshdata, "MMCCM MMLC MMPBL MMPBH MMOK"},
+    {"ocf", &PowSuppSolve::m_ofshshdata, "RESOPTLED RESOPTBIAS RESUPDIV QUAL RS IOS FCS OFSZ OFSP CAPOPTO RESERR CAPERR"},
+    {"loop", &PowSuppSolve::m_loophshdata, "FC PM F180 GM ENC ORHP CRHP"},
+    {"cl", &PowSuppSolve::m_clhshdata, "CLBW CLPK ZOPK ZOPF ASPK ASPF"},
+    {"locus", &PowSuppSolve::m_locushshdata, "KMIN KMAX CTRMIN CTRMAX"},
+    {"trans", &PowSuppSolve::m_transhshdata, "LDOS LDUS LDST LNOS LNUS LNST"},
+    {"dz", &PowSuppSolve::m_dzhshdata, "DZFC DZPM DZGM DZPL DZGL DZQL DZPR DZNS DZSAT"},
+};
+
+static const int32_t bs_field_num = static_cast<int32_t>(sizeof(bs_field)/sizeof(bs_field[0]));
+static const int32_t bs_column_num = static_cast<int32_t>(sizeof(bs_column)/sizeof(bs_column[0]));
+static const int32_t bs_col_id = -1; //CSV column of the spec id
+
+/**
+ * @brief The BsContext struct - tables of the run shared by the workers, read only during the batch
+ */
+struct BsContext
+{
+    QHash<QString, int32_t> index; //Key to the position in bs_field
+    QVector<double> def; //Defaults of the form
+    QVector<QByteArray> col_key; //Result columns, bs_column first and the hash sections after
+    QVector<QPair<QHash<QString, double> PowSuppSolve::*, QString>> hash_col;
+    QVector<int32_t> csv_col; //Field of the each input CSV column or bs_col_id
+    bool json_in = true;
+    BS_FORMAT out_fmt = BS_FORMAT_JSON;
+};
+
+static BsContext bsContext()
+{
+    BsContext ctx;
+    ctx.def.resize(bs_field_num);
+    for(int32_t fld = 0; fld < bs_field_num; ++fld)
+    {
+        ctx.index.insert(QString::fromLatin1(bs_field[fld].key), fld);
+        bsParseValue(QString::fromLatin1(bs_field[fld].def), ctx.def[fld]);
+    }
+    for(const BsColumn &col : bs_column)
+    {
+        ctx.col_key.push_back(QByteArray(col.key));
+    }
+    for(const BsSection &sec : bs_section)
+    {
+        for(const QString &key : QString::fromLatin1(sec.keys).split(' '))
+        {
+            ctx.col_key.push_back(QByteArray(sec.name) + '.' + key.toLatin1());
+            ctx.hash_col.push_back(qMakePair(sec.hash, key));
+        }
+    }
+    return ctx;
+}
+
+QStringList bsSpecKeys()
+{
+    QStringList out;
+    for(const BsField &fld : bs_field)
+    {
+        out.push_back(QString::fromLatin1(fld.key));
+    }
+    return out;
+}
+
+QString bsSpecDefault(const QString &key)
+{
+    for(const BsField &fld : bs_field)
+    {
+        if(key == QLatin1String(fld.key))
+            return QString::fromLatin1(fld.def);
+    }
+    return QString();
+}
+
+QStringList bsResultKeys()
+{
+    QStringList out;
+    for(const QByteArray &key : bsContext().col_key)
+    {
+        out.push_back(QString::fromLatin1(key));
+    }
+    return out;
+}
+
+bool bsParseValue(const QString &text, double &value)
+{
+    QString str = text.trimmed();
+    if(str.isEmpty())
+        return false;
+
+    double scale = 1.;
+    switch(str.at(str.size() - 1).unicode())
+    {
+    case 'p': scale = 1e-12; break;
+    case 'n': scale = 1e-9; break;
+    case 'u':
+    case 0x03BC: scale = 1e-6; break; //μ
+    case 'm': scale = 1e-3; break;
+    case 'K': scale = 1e3; break;
+    case 'M': scale = 1e6; break;
+    default: break;
+    }
+    if(scale != 1.)
+        str.chop(1);
+
+    bool ok = false;
+    const double num = str.toDouble(&ok);
+    if(!ok)
+        return false;
+    value = num * scale;
+    return true;
+}
+
+/**
+ * @brief bsSplitCsv - fields of the CSV line, the double quoted field may hold the comma
+ */
+static QStringList bsSplitCsv(const QByteArray &line)
+{
+    QStringList out;
+    QString field;
+    bool quoted = false;
+    const QString str = QString::fromUtf8(line);
+    for(int32_t pos = 0; pos < str.size(); ++pos)
+    {
+        const QChar ch = str.at(pos);
+        if(quoted)
+        {
+            if(ch == '"' && pos + 1 < str.size() && str.at(pos + 1) == '"')
+            {
+                field += ch;
+                ++pos;
+            }
+            else if(ch == '"')
+            {
+                quoted = false;
+            }
+            else
+            {
+                field += ch;
+            }
+        }
+        else if(ch == '"')
+        {
+            quoted = true;
+        }
+        else if(ch == ',')
+        {
+            out.push_back(field.trimmed());
+            field.clear();
+        }
+        else
+        {
+            field += ch;
+        }
+    }
+    out.push_back(field.trimmed());
+    return out;
+}
+
+static QString bsReadHeader(BsContext &ctx, const QByteArray &line)
+{
+    ctx.csv_col.clear();
+    for(const QString &key : bsSplitCsv(line))
+    {
+        if(key == QLatin1String(BS_KEY_ID))
+        {
+            ctx.csv_col.push_back(bs_col_id);
+            continue;
+        }
+        const int32_t fld = ctx.index.value(key, -1);
+        if(fld < 0)
+            return QString("unknown key \"%1\" in the CSV header").arg(key);
+        ctx.csv_col.push_back(fld);
+    }
+    return QString();
+}
+
+static QString bsReadCsv(const BsContext &ctx, const QByteArray &line, QVector<double> &val, QString &id)
+{
+    const QStringList field = bsSplitCsv(line);
+    if(field.size() > ctx.csv_col.size())
+        return QString("%1 fields against %2 keys of the header").arg(field.size()).arg(ctx.csv_col.size());
+
+    /** The empty field keeps the default */
+    for(int32_t col = 0; col < field.size(); ++col)
+    {
+        if(ctx.csv_col[col] == bs_col_id)
+        {
+            id = field[col];
+            continue;
+        }
+        if(field[col].isEmpty())
+            continue;
+        if(!bsParseValue(field[col], val[ctx.csv_col[col]]))
+            return QString("bad value \"%1\" of \"%2\"").arg(field[col], QLatin1String(bs_field[ctx.csv_col[col]].key));
+    }
+    return QString();
+}
+
+static QString bsReadJson(const BsContext &ctx, const QByteArray &line, QVector<double> &val, QString &id)
+{
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &err);
+    if(err.error != QJsonParseError::NoError || !doc.isObject())
+        return QString("not a JSON object, %1").arg(err.errorString());
+
+    const QJsonObject obj = doc.object();
+    for(auto it = obj.constBegin(); it != obj.constEnd(); ++it)
+    {
+        const QJsonValue jv = it.value();
+        if(it.key() == QLatin1String(BS_KEY_ID))
+        {
+            id = jv.isDouble() ? QString::number(jv.toDouble(), 'g', 15) : jv.toString();
+            continue;
+        }
+        const int32_t fld = ctx.index.value(it.key(), -1);
+        if(fld < 0)
+            return QString("unknown key \"%1\"").arg(it.key());
+
+        /** The null keeps the default, the string is typed as into the form */
+        if(jv.isDouble())
+            val[fld] = jv.toDouble();
+        else if(jv.isBool())
+            val[fld] = jv.toBool() ? 1. : 0.;
+        else if(!jv.isNull() && !(jv.isString() && bsParseValue(jv.toString(), val[fld])))
+            return QString("bad value of \"%1\"").arg(it.key());
+    }
+    return QString();
+}
+
+/**
+ * @brief bsCheck - values the solver types hold and the chain is defined for
+ */
+static QString bsCheck(const BsContext &ctx, const QVector<double> &val)
+{
+    for(int32_t fld = 0; fld < bs_field_num; ++fld)
+    {
+        if(!qIsFinite(val[fld]) || qAbs(val[fld]) > bs_field[fld].lim)
+            return QString("\"%1\" is out of range").arg(QLatin1String(bs_field[fld].key));
+    }
+
+    auto at = [&ctx, &val](const char *key)
+    {
+        return val[ctx.index.value(QLatin1String(key))];
+    };
+    if(at("VACmin") <= 0. || at("VACmax") < at("VACmin"))
+        return QString("\"VACmin\" must be above zero and below \"VACmax\"");
+    if(at("FLine") <= 0. || at("FSw") <= 0.)
+        return QString("\"FLine\" and \"FSw\" must be above zero");
+    if(at("VOut1") <= 0. || at("IOut1") <= 0.)
+        return QString("\"VOut1\" and \"IOut1\" must be above zero");
+    if(at("Eff") <= 0. || at("Eff") > 1. || at("OutPwrMrg") <= 0.)
+        return QString("\"Eff\" must be in (0, 1] and \"OutPwrMrg\" above zero");
+    return QString();
+}
+
+static void bsApply(PowSuppSolve &ps, const QVector<double> &val)
+{
+    ps.m_psw.m_af.resize(6);
+    ps.m_psw.m_ins.resize(6);
+    ps.m_psw.m_npw.resize(6);
+    ps.m_cop.resize(5);
+    for(int32_t fld = 0; fld < bs_field_num; ++fld)
+    {
+        bs_field[fld].set(ps, val[fld]);
+    }
+
+    /** The form reads the diameter of the round kern only */
+    if(ps.m_fsag != FBPT_SHAPE_AIR_GAP::ROUND_AIR_GAP)
+        ps.m_md.Diam = 0.f;
+}
+
+static QByteArray bsJsonString(const QString &str)
+{
+    QByteArray out("\"");
+    for(const char ch : str.toUtf8())
+    {
+        if(ch == '"' || ch == '\\')
+        {
+            out += '\\';
+            out += ch;
+        }
+        else if(static_cast<unsigned char>(ch) < 0x20)
+        {
+            out += "\\u00";
+            out += QByteArray::number(static_cast<int>(ch), 16).rightJustified(2, '0');
+        }
+        else
+        {
+            out += ch;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+static QByteArray bsCsvString(const QString &str)
+{
+    QByteArray out = str.toUtf8();
+    if(out.contains(',') || out.contains('"') || out.contains('\n'))
+    {
+        out.replace("\"", "\"\"");
+        out = '"' + out + '"';
+    }
+    return out;
+}
+
+/**
+ * @brief bsPutNumber - the value without the result is null in JSON and the empty CSV field
+ */
+static void bsPutNumber(QByteArray &out, double val, bool json)
+{
+    if(qIsFinite(val))
+        out += QByteArray::number(val, 'g', BS_DIGITS);
+    else if(json)
+        out += "null";
+}
+
+static QByteArray bsCsvHeader(const BsContext &ctx)
+{
+    QByteArray out("line,id,ok,error");
+    for(const QByteArray &key : ctx.col_key)
+    {
+        out += ',';
+        out += key;
+    }
+    out += '\n';
+    return out;
+}
+
+static void bsWriteRecord(const BsContext &ctx, const PowSuppSolve &ps, int64_t num,
+                          const QString &id, const QString &err, QByteArray &out)
+{
+    const bool json = (ctx.out_fmt == BS_FORMAT_JSON);
+    const bool ok = err.isEmpty();
+    out.clear();
+    if(json)
+    {
+        out += "{\"line\":";
+        out += QByteArray::number(num);
+        if(!id.isEmpty())
+        {
+            out += ",\"id\":";
+            out += bsJsonString(id);
+        }
+        if(!ok)
+        {
+            out += ",\"ok\":false,\"error\":";
+            out += bsJsonString(err);
+            out += "}\n";
+            return;
+        }
+        out += ",\"ok\":true";
+    }
+    else
+    {
+        out += QByteArray::number(num);
+        out += ',';
+        out += bsCsvString(id);
+        out += ok ? ",1," : ",0,";
+        out += bsCsvString(err);
+    }
+
+    for(int32_t col = 0; col < ctx.col_key.size(); ++col)
+    {
+        if(json)
+        {
+            out += ",\"";
+            out += ctx.col_key[col];
+            out += "\":";
+        }
+        else
+        {
+            out += ',';
+        }
+        if(!ok)
+            continue;
+        if(col < bs_column_num)
+        {
+            bsPutNumber(out, bs_column[col].get(ps), json);
+        }
+        else
+        {
+            const auto &hc = ctx.hash_col[col - bs_column_num];
+            bsPutNumber(out, (ps.*hc.first).value(hc.second, qQNaN()), json);
+        }
+    }
+    out += json ? "}\n" : "\n";
+}
+
+/**
+ * @brief bsSolve - read, check and solve the spec of the line
+ * @return false if the spec is not solved
+ */
+static bool bsSolve(PowSuppSolve &ps, const BsContext &ctx, const QByteArray &line, int64_t num,
+                    QVector<double> &val, QByteArray &out)
+{
+    val = ctx.def;
+    QString id;
+    QString err = ctx.json_in ? bsReadJson(ctx, line, val, id) : bsReadCsv(ctx, line, val, id);
+    if(err.isEmpty())
+        err = bsCheck(ctx, val);
+    if(err.isEmpty())
+    {
+        bsApply(ps, val);
+        ps.calcDesign();
+    }
+    bsWriteRecord(ctx, ps, num, id, err, out);
+    return err.isEmpty();
+}
+
+/**
+ * @brief The BsJob struct - slices of the batch shared by the workers
+ */
+struct BsJob
+{
+    const BsContext *ctx;
+    const QByteArray *line;
+    const int64_t *num;
+    QByteArray *res;
+    uint8_t *ok;
+    int32_t specs;
+    QSharedPointer<PowSuppSolve> *solver;
+    int32_t solvers;
+    QAtomicInt taken; //Solvers handed out to the runners of the batch
+    PoolSlices slices;
+
+    /**
+     * @brief prRunSlices - take the slices one by one until nothing left, each runner
+     *        takes its own solver, the extra runner leaves the slices to the others
+     */
+    void prRunSlices()
+    {
+        const int32_t slot = taken.fetchAndAddOrdered(1);
+        if(slot >= solvers)
+            return;
+        PowSuppSolve &ps = *solver[slot];
+        QVector<double> val;
+        int32_t chunk;
+        while(slices.prTake(chunk))
+        {
+            const int32_t begin = chunk * BS_CHUNK_SPECS;
+            const int32_t end = qMin(begin + BS_CHUNK_SPECS, specs);
+            for(int32_t spec = begin; spec < end; ++spec)
+            {
+                ok[spec] = bsSolve(ps, *ctx, line[spec], num[spec], val, res[spec]);
+            }
+        }
+    }
+};
+
+BsStats bsRun(QIODevice &in, QIODevice &out, const BsOptions &opt)
+{
+    BsStats stats;
+    QElapsedTimer timer;
+    timer.start();
+
+    BsContext ctx = bsContext();
+    ctx.out_fmt = opt.out_fmt;
+    const int32_t threads = (opt.threads > 0) ? opt.threads : qMax(QThread::idealThreadCount(), 1);
+    const int32_t batch = qMax(opt.batch, 1);
+
+    /** The solver is reused by its thread from spec to spec, the sweep buffers stay allocated */
+    QVector<QSharedPointer<PowSuppSolve>> solver;
+    for(int32_t thr = 0; thr < threads; ++thr)
+    {
+        solver.push_back(QSharedPointer<PowSuppSolve>(new PowSuppSolve()));
+        solver.last()->setPlotOutput(false);
+    }
+    /** The own pool keeps the thread count of the run off the global pool of the other solvers */
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(threads - 1, 1));
+
+    if(opt.out_fmt == BS_FORMAT_CSV && out.write(bsCsvHeader(ctx)) < 0)
+    {
+        stats.error = QString("output failed, %1").arg(out.errorString());
+        return stats;
+    }
+
+    QVector<QByteArray> line, res;
+    QVector<int64_t> num;
+    QVector<uint8_t> ok;
+    int64_t line_num = 0;
+    bool known = false;
+    bool eof = false;
+    while(!eof)
+    {
+        line.clear();
+        num.clear();
+        while(line.size() < batch)
+        {
+            QByteArray raw = in.readLine();
+            if(raw.isEmpty())
+            {
+                eof = true;
+                break;
+            }
+            ++line_num;
+            raw = raw.trimmed();
+            if(raw.isEmpty() || raw.startsWith('#'))
+                continue;
+
+            /** The first line tells the format, the CSV one is the header */
+            if(!known)
+            {
+                known = true;
+                ctx.json_in = raw.startsWith('{');
+                if(!ctx.json_in)
+                {
+                    stats.error = bsReadHeader(ctx, raw);
+                    if(!stats.error.isEmpty())
+                        return stats;
+                    continue;
+                }
+            }
+            line.push_back(raw);
+            num.push_back(line_num);
+        }
+        if(line.isEmpty())
+            continue;
+
+        res.resize(line.size());
+        ok.fill(0, line.size());
+        BsJob job;
+        job.ctx = &ctx;
+        job.line = line.constData();
+        job.num = num.constData();
+        job.res = res.data();
+        job.ok = ok.data();
+        job.specs = line.size();
+        job.solver = solver.data();
+        job.solvers = solver.size();
+        job.slices.count = (job.specs + BS_CHUNK_SPECS - 1) / BS_CHUNK_SPECS;
+
+        prRunPool(job, &pool);
+
+        /** The results go out in the input order */
+        for(int32_t spec = 0; spec < job.specs; ++spec)
+        {
+            if(out.write(res[spec]) < 0)
+            {
+                stats.error = QString("output failed, %1").arg(out.errorString());
+                return stats;
+            }
+            stats.failed += ok[spec] ? 0 : 1;
+        }
+        stats.specs += job.specs;
+        QFileDevice *file = qobject_cast<QFileDevice*>(&out);
+        if(file)
+            file->flush();
+    }
+
+    stats.elapsed = timer.nsecsElapsed() * 1E-9;
+    return stats;
+}
@@ -0,0 +1,225 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/bodekernel.h"
+#include <atomic>
+
+#define BK_DB_COEFF     10.
+#define BK_DEG_COEFF    (180./M_PI)
+
+static std::atomic<int> s_isa(-1);
+
+/**
+ * @brief bkDetectIsa - best instruction set of the running cpu
+ * @return
+ */
+static BK_ISA bkDetectIsa()
+{
+#if defined(BK_HAVE_AVX)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+        return BK_ISA_AVX512;
+    if(__builtin_cpu_supports("avx2"))
+        return BK_ISA_AVX2;
+#endif
+#if defined(BK_HAVE_X86)
+    return BK_ISA_SSE2;
+#else
+    return BK_ISA_SCALAR;
+#endif
+}
+
+BK_ISA bkActiveIsa()
+{
+    int isa = s_isa.load(std::memory_order_relaxed);
+    if(isa < 0)
+    {
+        isa = static_cast<int>(bkDetectIsa());
+        s_isa.store(isa, std::memory_order_relaxed);
+    }
+    return static_cast<BK_ISA>(isa);
+}
+
+void bkSetIsa(BK_ISA isa)
+{
+    s_isa.store(static_cast<int>(qMin(isa, bkDetectIsa())), std::memory_order_relaxed);
+}
+
+void bkEvalScalar(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode)
+{
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        const double omega = 2*M_PI*freq[indx];
+        const double omega2 = omega * omega;
+        double n_re = 1., n_im = 0., d_re = 1., d_im = 0., tmp = 0.;
+
+        for(int32_t ord = 0; ord < bf.order; ++ord)
+        {
+            tmp = n_re;
+            n_re = -n_im * omega;
+            n_im = tmp * omega;
+        }
+        for(int32_t ord = 0; ord < -bf.order; ++ord)
+        {
+            tmp = d_re;
+            d_re = -d_im * omega;
+            d_im = tmp * omega;
+        }
+        for(int32_t fct = 0; fct < bf.tz.size(); ++fct)
+        {
+            const double wt = omega * bf.tz[fct];
+            tmp = n_re - n_im * wt;
+            n_im = n_im + n_re * wt;
+            n_re = tmp;
+        }
+        for(int32_t fct = 0; fct < bf.az.size(); ++fct)
+        {
+            const double fr = 1. - omega2 * bf.az[fct];
+            const double fi = omega * bf.bz[fct];
+            tmp = n_re * fr - n_im * fi;
+            n_im = n_im * fr + n_re * fi;
+            n_re = tmp;
+        }
+        for(int32_t fct = 0; fct < bf.tp.size(); ++fct)
+        {
+            const double wt = omega * bf.tp[fct];
+            tmp = d_re - d_im * wt;
+            d_im = d_im + d_re * wt;
+            d_re = tmp;
+        }
+        for(int32_t fct = 0; fct < bf.ap.size(); ++fct)
+        {
+            const double fr = 1. - omega2 * bf.ap[fct];
+            const double fi = omega * bf.bp[fct];
+            tmp = d_re * fr - d_im * fi;
+            d_im = d_im * fr + d_re * fi;
+            d_re = tmp;
+        }
+
+        /** H = gain * N * conj(D) / |D|^2 */
+        const double scl = bf.gain / (d_re * d_re + d_im * d_im);
+        const double h_re = (n_re * d_re + n_im * d_im) * scl;
+        const double h_im = (n_im * d_re - n_re * d_im) * scl;
+
+        if(mode == BK_OUT_COMPLEX)
+        {
+            out_a[indx] = h_re;
+            out_b[indx] = h_im;
+        }
+        else
+        {
+            out_a[indx] = BK_DB_COEFF * std::log10(h_re * h_re + h_im * h_im);
+            out_b[indx] = BK_DEG_COEFF * std::atan2(h_im, h_re);
+        }
+    }
+}
+
+void bkPolarScalar(const double *re, const double *im, int32_t num, double *mag, double *phs)
+{
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        mag[indx] = BK_DB_COEFF * std::log10(re[indx] * re[indx] + im[indx] * im[indx]);
+        phs[indx] = BK_DEG_COEFF * std::atan2(im[indx], re[indx]);
+    }
+}
+
+static void bkEvalDispatch(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode)
+{
+    switch(bkActiveIsa())
+    {
+#if defined(BK_HAVE_AVX)
+    case BK_ISA_AVX512:
+        bkEvalAVX512(bf, freq, num, out_a, out_b, mode);
+        break;
+    case BK_ISA_AVX2:
+        bkEvalAVX2(bf, freq, num, out_a, out_b, mode);
+        break;
+#endif
+#if defined(BK_HAVE_X86)
+    case BK_ISA_SSE2:
+        bkEvalSSE2(bf, freq, num, out_a, out_b, mode);
+        break;
+#endif
+    default:
+        bkEvalScalar(bf, freq, num, out_a, out_b, mode);
+        break;
+    }
+}
+
+void bkEvalBode(const BodeFactors &bf, const double *freq, int32_t num, double *mag, double *phs, BK_PREC prec)
+{
+    bkEvalDispatch(bf, freq, num, mag, phs, (prec == BK_PREC_FAST) ? BK_OUT_BODE_FAST : BK_OUT_BODE);
+}
+
+void bkEvalComplex(const BodeFactors &bf, const double *freq, int32_t num, double *re, double *im)
+{
+    bkEvalDispatch(bf, freq, num, re, im, BK_OUT_COMPLEX);
+}
+
+void bkComplexToBode(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_PREC prec)
+{
+    const BK_OUT mode = (prec == BK_PREC_FAST) ? BK_OUT_BODE_FAST : BK_OUT_BODE;
+    switch(bkActiveIsa())
+    {
+#if defined(BK_HAVE_AVX)
+    case BK_ISA_AVX512:
+        bkPolarAVX512(re, im, num, mag, phs, mode);
+        break;
+    case BK_ISA_AVX2:
+        bkPolarAVX2(re, im, num, mag, phs, mode);
+        break;
+#endif
+#if defined(BK_HAVE_X86)
+    case BK_ISA_SSE2:
+        bkPolarSSE2(re, im, num, mag, phs, mode);
+        break;
+#endif
+    default:
+        bkPolarScalar(re, im, num, mag, phs);
+        break;
+    }
+}
+
+void bkUnwrapPhase(double *phs, int32_t num)
+{
+    double offset = 0.;
+    for(int32_t indx = 1; indx < num; ++indx)
+    {
+        double phase = phs[indx] + offset;
+        while(phase - phs[indx-1] > 180.)
+        {
+            phase -= 360.;
+            offset -= 360.;
+        }
+        while(phase - phs[indx-1] < -180.)
+        {
+            phase += 360.;
+            offset += 360.;
+        }
+        phs[indx] = phase;
+    }
+}
+
+void bkEvalBode(const BodeFactors &bf, const QVector<double> &freq, QVector<double> &mag, QVector<double> &phs, BK_PREC prec)
+{
+    mag.resize(freq.size());
+    phs.resize(freq.size());
+    bkEvalBode(bf, freq.constData(), freq.size(), mag.data(), phs.data(), prec);
+    bkUnwrapPhase(phs.data(), phs.size());
+}
@@ -0,0 +1,84 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/bodekernel.h"
+
+#if defined(BK_HAVE_AVX)
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+#include <immintrin.h>
+
+struct BKOpsAVX2
+{
+    typedef __m256d V;
+    typedef __m256d M;
+    static const int32_t W = 4;
+
+    static inline V set1(double a) {return _mm256_set1_pd(a);}
+    static inline V loadu(const double *p) {return _mm256_loadu_pd(p);}
+    static inline void storeu(double *p, V a) {_mm256_storeu_pd(p, a);}
+    static inline V add(V a, V b) {return _mm256_add_pd(a, b);}
+    static inline V sub(V a, V b) {return _mm256_sub_pd(a, b);}
+    static inline V mul(V a, V b) {return _mm256_mul_pd(a, b);}
+    static inline V div(V a, V b) {return _mm256_div_pd(a, b);}
+    static inline V abs(V a) {return _mm256_andnot_pd(_mm256_set1_pd(-0.), a);}
+    static inline M gt(V a, V b) {return _mm256_cmp_pd(a, b, _CMP_GT_OQ);}
+    static inline M lt(V a, V b) {return _mm256_cmp_pd(a, b, _CMP_LT_OQ);}
+    static inline M nge(V a, V b) {return _mm256_cmp_pd(a, b, _CMP_NGE_UQ);}
+    static inline M mand(M a, M b) {return _mm256_and_pd(a, b);}
+    static inline M mandnot(M a, M b) {return _mm256_andnot_pd(a, b);}
+    static inline M mor(M a, M b) {return _mm256_or_pd(a, b);}
+    static inline bool any(M a) {return _mm256_movemask_pd(a) != 0;}
+    static inline V sel(M m, V a, V b) {return _mm256_blendv_pd(b, a, m);}
+    static inline V orsign(V a, V b) {return _mm256_or_pd(a, _mm256_and_pd(b, _mm256_set1_pd(-0.)));}
+    static inline void frexp2(V x, V &mant, V &expo)
+    {
+        const __m256i bits = _mm256_castpd_si256(x);
+        const __m256i ebits = _mm256_srli_epi64(bits, 52);
+        const __m256i mbits = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                              _mm256_set1_epi64x(0x3FF0000000000000LL));
+        mant = _mm256_castsi256_pd(mbits);
+        /** 2^52 + e as double, the exponent field is below 2^11 */
+        expo = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(ebits, _mm256_set1_epi64x(0x4330000000000000LL))),
+                             _mm256_set1_pd(4503599627370496. + 1023.));
+    }
+};
+
+#include "src/bodekernel_simd.h"
+
+void bkEvalAVX2(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode)
+{
+    bkEvalImpl<BKOpsAVX2>(bf, freq, num, out_a, out_b, mode);
+}
+
+void bkPolarAVX2(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_OUT mode)
+{
+    bkPolarImpl<BKOpsAVX2>(re, im, num, mag, phs, mode);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
@@ -0,0 +1,93 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/bodekernel.h"
+
+#if defined(BK_HAVE_AVX)
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+/** Keep the rounding of the scalar path, no fused multiply-add */
+#pragma GCC optimize("fp-contract=off")
+#endif
+#include <immintrin.h>
+
+struct BKOpsAVX512
+{
+    typedef __m512d V;
+    typedef __mmask8 M;
+    static const int32_t W = 8;
+
+    static inline V set1(double a) {return _mm512_set1_pd(a);}
+    static inline V loadu(const double *p) {return _mm512_loadu_pd(p);}
+    static inline void storeu(double *p, V a) {_mm512_storeu_pd(p, a);}
+    static inline V add(V a, V b) {return _mm512_add_pd(a, b);}
+    static inline V sub(V a, V b) {return _mm512_sub_pd(a, b);}
+    static inline V mul(V a, V b) {return _mm512_mul_pd(a, b);}
+    static inline V div(V a, V b) {return _mm512_div_pd(a, b);}
+    static inline V abs(V a)
+    {
+        return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(0x7FFFFFFFFFFFFFFFLL)));
+    }
+    static inline M gt(V a, V b) {return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ);}
+    static inline M lt(V a, V b) {return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);}
+    static inline M nge(V a, V b) {return _mm512_cmp_pd_mask(a, b, _CMP_NGE_UQ);}
+    static inline M mand(M a, M b) {return static_cast<M>(a & b);}
+    static inline M mandnot(M a, M b) {return static_cast<M>(~a & b);}
+    static inline M mor(M a, M b) {return static_cast<M>(a | b);}
+    static inline bool any(M a) {return a != 0;}
+    static inline V sel(M m, V a, V b) {return _mm512_mask_blend_pd(m, b, a);}
+    static inline V orsign(V a, V b)
+    {
+        const __m512i sign = _mm512_and_si512(_mm512_castpd_si512(b), _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL)));
+        return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(a), sign));
+    }
+    static inline void frexp2(V x, V &mant, V &expo)
+    {
+        const __m512i bits = _mm512_castpd_si512(x);
+        const __m512i ebits = _mm512_srli_epi64(bits, 52);
+        const __m512i mbits = _mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL)),
+                                              _mm512_set1_epi64(0x3FF0000000000000LL));
+        mant = _mm512_castsi512_pd(mbits);
+        /** 2^52 + e as double, the exponent field is below 2^11 */
+        expo = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(ebits, _mm512_set1_epi64(0x4330000000000000LL))),
+                             _mm512_set1_pd(4503599627370496. + 1023.));
+    }
+};
+
+#include "src/bodekernel_simd.h"
+
+void bkEvalAVX512(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode)
+{
+    bkEvalImpl<BKOpsAVX512>(bf, freq, num, out_a, out_b, mode);
+}
+
+void bkPolarAVX512(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_OUT mode)
+{
+    bkPolarImpl<BKOpsAVX512>(re, im, num, mag, phs, mode);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
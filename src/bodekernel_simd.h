@@ -0,0 +1,324 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+/**
+ * Vector body of the Bode kernel, included by the instruction set
+ * specific sources after the Ops traits are defined. Everything here has
+ * internal linkage, so each source gets its own copy compiled for its target.
+ *
+ * Ops provide: V, M, W, set1, loadu, storeu, add, sub, mul, div, abs,
+ *              gt, lt, nge, mand, mandnot, mor, any, sel(m, a, b) = m ? a : b,
+ *              orsign(a, b) - sign of b to positive a,
+ *              frexp2(x, mant, expo) - mant in [1, 2) and expo for positive normal x.
+ */
+
+#ifndef BODEKERNEL_SIMD_H
+#define BODEKERNEL_SIMD_H
+#include "inc/bodekernel.h"
+#include <cfloat>
+
+namespace {
+
+/** fdlibm e_log.c */
+const double BK_LG1 = 6.666666666666735130e-01;
+const double BK_LG2 = 3.999999999940941908e-01;
+const double BK_LG3 = 2.857142874366239149e-01;
+const double BK_LG4 = 2.222219843214978396e-01;
+const double BK_LG5 = 1.818357216161805012e-01;
+const double BK_LG6 = 1.531383769920937332e-01;
+const double BK_LG7 = 1.479819860511658591e-01;
+const double BK_LN2_HI = 6.93147180369123816490e-01;
+const double BK_LN2_LO = 1.90821492927058770002e-10;
+
+/** Cephes atan.c */
+const double BK_AP0 = -8.750608600031904122785E-1;
+const double BK_AP1 = -1.615753718733365076637E1;
+const double BK_AP2 = -7.500855792314704667340E1;
+const double BK_AP3 = -1.228866684490136173410E2;
+const double BK_AP4 = -6.485021904942025371773E1;
+const double BK_AQ0 = 2.485846490142306297962E1;
+const double BK_AQ1 = 1.650270098316988542046E2;
+const double BK_AQ2 = 4.328810604912902668951E2;
+const double BK_AQ3 = 4.853903996359136964868E2;
+const double BK_AQ4 = 1.945506571482613964425E2;
+const double BK_MOREBITS = 6.123233995736765886130E-17;
+const double BK_T3P8 = 2.41421356237309504880;
+
+/** Abramowitz & Stegun 4.4.47, |e| <= 1E-5 rad on [-1, 1] */
+const double BK_FA1 = 0.9998660;
+const double BK_FA3 = -0.3302995;
+const double BK_FA5 = 0.1801410;
+const double BK_FA7 = -0.0851330;
+const double BK_FA9 = 0.0208351;
+
+const double BK_DB_LN = 4.3429448190325182765; //10/ln(10)
+const double BK_DEG = 57.295779513082320877; //180/pi
+
+template<class Ops>
+struct BKMath
+{
+    typedef typename Ops::V V;
+    typedef typename Ops::M M;
+
+    /**
+     * @brief log - natural logarithm of the positive normal value
+     */
+    static inline V log(V x)
+    {
+        V mant, expo;
+        Ops::frexp2(x, mant, expo);
+        /** Bring mantissa to [sqrt(2)/2, sqrt(2)) */
+        M hi = Ops::gt(mant, Ops::set1(M_SQRT2));
+        mant = Ops::sel(hi, Ops::mul(mant, Ops::set1(0.5)), mant);
+        expo = Ops::sel(hi, Ops::add(expo, Ops::set1(1.)), expo);
+
+        V f = Ops::sub(mant, Ops::set1(1.));
+        V s = Ops::div(f, Ops::add(Ops::set1(2.), f));
+        V z = Ops::mul(s, s);
+        V w = Ops::mul(z, z);
+        V t1 = Ops::mul(w, Ops::add(Ops::set1(BK_LG2), Ops::mul(w, Ops::add(Ops::set1(BK_LG4), Ops::mul(w, Ops::set1(BK_LG6))))));
+        V t2 = Ops::mul(z, Ops::add(Ops::set1(BK_LG1), Ops::mul(w, Ops::add(Ops::set1(BK_LG3),
+                        Ops::mul(w, Ops::add(Ops::set1(BK_LG5), Ops::mul(w, Ops::set1(BK_LG7))))))));
+        V r = Ops::add(t2, t1);
+        V hfsq = Ops::mul(Ops::set1(0.5), Ops::mul(f, f));
+        V inner = Ops::add(Ops::mul(s, Ops::add(hfsq, r)), Ops::mul(expo, Ops::set1(BK_LN2_LO)));
+        return Ops::sub(Ops::mul(expo, Ops::set1(BK_LN2_HI)), Ops::sub(Ops::sub(hfsq, inner), f));
+    }
+
+    /**
+     * @brief logFast - ln(1+f) = 2atanh(s) truncated after s^5, |e| < 1.3E-6
+     *        for the mantissa in [sqrt(2)/2, sqrt(2)), the positive normal value only
+     */
+    static inline V logFast(V x)
+    {
+        V mant, expo;
+        Ops::frexp2(x, mant, expo);
+        M hi = Ops::gt(mant, Ops::set1(M_SQRT2));
+        mant = Ops::sel(hi, Ops::mul(mant, Ops::set1(0.5)), mant);
+        expo = Ops::sel(hi, Ops::add(expo, Ops::set1(1.)), expo);
+
+        V f = Ops::sub(mant, Ops::set1(1.));
+        V s = Ops::div(f, Ops::add(Ops::set1(2.), f));
+        V z = Ops::mul(s, s);
+        V r = Ops::mul(Ops::add(s, s), Ops::add(Ops::set1(1.), Ops::mul(z, Ops::add(Ops::set1(1./3.),
+                       Ops::mul(z, Ops::set1(1./5.))))));
+        return Ops::add(Ops::mul(expo, Ops::set1(M_LN2)), r);
+    }
+
+    /**
+     * @brief atan2Fast - four quadrant arctangent by the one division to [0, 1]
+     *        and the odd polynomial of 9th degree, |e| < 1.1E-5 rad, (0, 0) is not handled
+     */
+    static inline V atan2Fast(V y, V x)
+    {
+        V ax = Ops::abs(x);
+        V ay = Ops::abs(y);
+        M swap = Ops::gt(ay, ax);
+
+        V xr = Ops::div(Ops::sel(swap, ax, ay), Ops::sel(swap, ay, ax));
+        V z = Ops::mul(xr, xr);
+        V r = Ops::mul(xr, Ops::add(Ops::set1(BK_FA1), Ops::mul(z, Ops::add(Ops::set1(BK_FA3), Ops::mul(z,
+                       Ops::add(Ops::set1(BK_FA5), Ops::mul(z, Ops::add(Ops::set1(BK_FA7), Ops::mul(z, Ops::set1(BK_FA9))))))))));
+
+        r = Ops::sel(swap, Ops::sub(Ops::set1(M_PI_2), r), r);
+        r = Ops::sel(Ops::lt(x, Ops::set1(0.)), Ops::sub(Ops::set1(M_PI), r), r);
+        return Ops::orsign(r, y);
+    }
+
+    /**
+     * @brief atan2 - four quadrant arctangent, (0, 0) is not handled
+     */
+    static inline V atan2(V y, V x)
+    {
+        V ax = Ops::abs(x);
+        V ay = Ops::abs(y);
+        M big = Ops::gt(ay, Ops::mul(Ops::set1(BK_T3P8), ax));
+        M mid = Ops::mandnot(big, Ops::gt(ay, Ops::mul(Ops::set1(0.66), ax)));
+
+        V num = Ops::sel(big, Ops::sub(Ops::set1(0.), ax), Ops::sel(mid, Ops::sub(ay, ax), ay));
+        V dnm = Ops::sel(big, ay, Ops::sel(mid, Ops::add(ay, ax), ax));
+        V base = Ops::sel(big, Ops::set1(M_PI_2), Ops::sel(mid, Ops::set1(M_PI_4), Ops::set1(0.)));
+        V more = Ops::sel(big, Ops::set1(BK_MOREBITS), Ops::sel(mid, Ops::set1(0.5 * BK_MOREBITS), Ops::set1(0.)));
+
+        V xr = Ops::div(num, dnm);
+        V z = Ops::mul(xr, xr);
+        V pz = Ops::add(Ops::mul(Ops::add(Ops::mul(Ops::add(Ops::mul(Ops::add(Ops::mul(Ops::set1(BK_AP0), z),
+                        Ops::set1(BK_AP1)), z), Ops::set1(BK_AP2)), z), Ops::set1(BK_AP3)), z), Ops::set1(BK_AP4));
+        V qz = Ops::add(Ops::mul(Ops::add(Ops::mul(Ops::add(Ops::mul(Ops::add(Ops::mul(Ops::add(z,
+                        Ops::set1(BK_AQ0)), z), Ops::set1(BK_AQ1)), z), Ops::set1(BK_AQ2)), z), Ops::set1(BK_AQ3)), z), Ops::set1(BK_AQ4));
+        V r = Ops::add(Ops::mul(xr, Ops::div(Ops::mul(z, pz), qz)), xr);
+        r = Ops::add(base, Ops::add(r, more));
+
+        r = Ops::sel(Ops::lt(x, Ops::set1(0.)), Ops::sub(Ops::set1(M_PI), r), r);
+        return Ops::orsign(r, y);
+    }
+
+    /**
+     * @brief polar - magnitude in dB and phase in degree, the zero, subnormal
+     *        and non-finite lanes are recomputed by the scalar path
+     * @tparam FAST - logFast and atan2Fast in place of the exact ones
+     */
+    template<bool FAST>
+    static inline void polar(V re, V im, double *mag, double *phs, int32_t cnt)
+    {
+        V pwr = Ops::add(Ops::mul(re, re), Ops::mul(im, im));
+        M special = Ops::mor(Ops::nge(pwr, Ops::set1(DBL_MIN)), Ops::gt(pwr, Ops::set1(DBL_MAX)));
+
+        double buf_m[Ops::W], buf_p[Ops::W];
+        Ops::storeu(buf_m, Ops::mul(Ops::set1(BK_DB_LN), FAST ? logFast(pwr) : log(pwr)));
+        Ops::storeu(buf_p, Ops::mul(Ops::set1(BK_DEG), FAST ? atan2Fast(im, re) : atan2(im, re)));
+
+        if(Ops::any(special))
+        {
+            double buf_re[Ops::W], buf_im[Ops::W];
+            Ops::storeu(buf_re, re);
+            Ops::storeu(buf_im, im);
+            bkPolarScalar(buf_re, buf_im, Ops::W, buf_m, buf_p);
+        }
+        for(int32_t ln = 0; ln < cnt; ++ln)
+        {
+            mag[ln] = buf_m[ln];
+            phs[ln] = buf_p[ln];
+        }
+    }
+};
+
+template<class Ops>
+inline void bkEvalImpl(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode)
+{
+    typedef typename Ops::V V;
+    const int32_t width = Ops::W;
+    double buf_f[Ops::W];
+
+    for(int32_t indx = 0; indx < num; indx += width)
+    {
+        const int32_t cnt = qMin(width, num - indx);
+        const double *src = freq + indx;
+        if(cnt < width)
+        {
+            for(int32_t ln = 0; ln < width; ++ln)
+                buf_f[ln] = (ln < cnt) ? src[ln] : 1.;
+            src = buf_f;
+        }
+
+        const V omega = Ops::mul(Ops::set1(2*M_PI), Ops::loadu(src));
+        const V omega2 = Ops::mul(omega, omega);
+        V n_re = Ops::set1(1.), n_im = Ops::set1(0.), d_re = Ops::set1(1.), d_im = Ops::set1(0.), tmp;
+
+        for(int32_t ord = 0; ord < bf.order; ++ord)
+        {
+            tmp = n_re;
+            n_re = Ops::sub(Ops::set1(0.), Ops::mul(n_im, omega));
+            n_im = Ops::mul(tmp, omega);
+        }
+        for(int32_t ord = 0; ord < -bf.order; ++ord)
+        {
+            tmp = d_re;
+            d_re = Ops::sub(Ops::set1(0.), Ops::mul(d_im, omega));
+            d_im = Ops::mul(tmp, omega);
+        }
+        for(int32_t fct = 0; fct < bf.tz.size(); ++fct)
+        {
+            const V wt = Ops::mul(omega, Ops::set1(bf.tz[fct]));
+            tmp = Ops::sub(n_re, Ops::mul(n_im, wt));
+            n_im = Ops::add(n_im, Ops::mul(n_re, wt));
+            n_re = tmp;
+        }
+        for(int32_t fct = 0; fct < bf.az.size(); ++fct)
+        {
+            const V fr = Ops::sub(Ops::set1(1.), Ops::mul(omega2, Ops::set1(bf.az[fct])));
+            const V fi = Ops::mul(omega, Ops::set1(bf.bz[fct]));
+            tmp = Ops::sub(Ops::mul(n_re, fr), Ops::mul(n_im, fi));
+            n_im = Ops::add(Ops::mul(n_im, fr), Ops::mul(n_re, fi));
+            n_re = tmp;
+        }
+        for(int32_t fct = 0; fct < bf.tp.size(); ++fct)
+        {
+            const V wt = Ops::mul(omega, Ops::set1(bf.tp[fct]));
+            tmp = Ops::sub(d_re, Ops::mul(d_im, wt));
+            d_im = Ops::add(d_im, Ops::mul(d_re, wt));
+            d_re = tmp;
+        }
+        for(int32_t fct = 0; fct < bf.ap.size(); ++fct)
+        {
+            const V fr = Ops::sub(Ops::set1(1.), Ops::mul(omega2, Ops::set1(bf.ap[fct])));
+            const V fi = Ops::mul(omega, Ops::set1(bf.bp[fct]));
+            tmp = Ops::sub(Ops::mul(d_re, fr), Ops::mul(d_im, fi));
+            d_im = Ops::add(Ops::mul(d_im, fr), Ops::mul(d_re, fi));
+            d_re = tmp;
+        }
+
+        /** H = gain * N * conj(D) / |D|^2 */
+        const V scl = Ops::div(Ops::set1(bf.gain), Ops::add(Ops::mul(d_re, d_re), Ops::mul(d_im, d_im)));
+        const V h_re = Ops::mul(Ops::add(Ops::mul(n_re, d_re), Ops::mul(n_im, d_im)), scl);
+        const V h_im = Ops::mul(Ops::sub(Ops::mul(n_im, d_re), Ops::mul(n_re, d_im)), scl);
+
+        if(mode == BK_OUT_COMPLEX)
+        {
+            double buf_re[Ops::W], buf_im[Ops::W];
+            Ops::storeu(buf_re, h_re);
+            Ops::storeu(buf_im, h_im);
+            for(int32_t ln = 0; ln < cnt; ++ln)
+            {
+                out_a[indx + ln] = buf_re[ln];
+                out_b[indx + ln] = buf_im[ln];
+            }
+        }
+        else if(mode == BK_OUT_BODE_FAST)
+        {
+            BKMath<Ops>::template polar<true>(h_re, h_im, out_a + indx, out_b + indx, cnt);
+        }
+        else
+        {
+            BKMath<Ops>::template polar<false>(h_re, h_im, out_a + indx, out_b + indx, cnt);
+        }
+    }
+}
+
+template<class Ops>
+inline void bkPolarImpl(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_OUT mode)
+{
+    const int32_t width = Ops::W;
+    double buf_re[Ops::W], buf_im[Ops::W];
+
+    for(int32_t indx = 0; indx < num; indx += width)
+    {
+        const int32_t cnt = qMin(width, num - indx);
+        const double *src_re = re + indx;
+        const double *src_im = im + indx;
+        if(cnt < width)
+        {
+            for(int32_t ln = 0; ln < width; ++ln)
+            {
+                buf_re[ln] = (ln < cnt) ? src_re[ln] : 1.;
+                buf_im[ln] = (ln < cnt) ? src_im[ln] : 0.;
+            }
+            src_re = buf_re;
+            src_im = buf_im;
+        }
+        if(mode == BK_OUT_BODE_FAST)
+            BKMath<Ops>::template polar<true>(Ops::loadu(src_re), Ops::loadu(src_im), mag + indx, phs + indx, cnt);
+        else
+            BKMath<Ops>::template polar<false>(Ops::loadu(src_re), Ops::loadu(src_im), mag + indx, phs + indx, cnt);
+    }
+}
+
+} //namespace
+
+#endif // BODEKERNEL_SIMD_H
@@ -0,0 +1,84 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/bodekernel.h"
+
+#if defined(BK_HAVE_X86)
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+#include <emmintrin.h>
+
+struct BKOpsSSE2
+{
+    typedef __m128d V;
+    typedef __m128d M;
+    static const int32_t W = 2;
+
+    static inline V set1(double a) {return _mm_set1_pd(a);}
+    static inline V loadu(const double *p) {return _mm_loadu_pd(p);}
+    static inline void storeu(double *p, V a) {_mm_storeu_pd(p, a);}
+    static inline V add(V a, V b) {return _mm_add_pd(a, b);}
+    static inline V sub(V a, V b) {return _mm_sub_pd(a, b);}
+    static inline V mul(V a, V b) {return _mm_mul_pd(a, b);}
+    static inline V div(V a, V b) {return _mm_div_pd(a, b);}
+    static inline V abs(V a) {return _mm_andnot_pd(_mm_set1_pd(-0.), a);}
+    static inline M gt(V a, V b) {return _mm_cmpgt_pd(a, b);}
+    static inline M lt(V a, V b) {return _mm_cmplt_pd(a, b);}
+    static inline M nge(V a, V b) {return _mm_cmpnge_pd(a, b);}
+    static inline M mand(M a, M b) {return _mm_and_pd(a, b);}
+    static inline M mandnot(M a, M b) {return _mm_andnot_pd(a, b);}
+    static inline M mor(M a, M b) {return _mm_or_pd(a, b);}
+    static inline bool any(M a) {return _mm_movemask_pd(a) != 0;}
+    static inline V sel(M m, V a, V b) {return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));}
+    static inline V orsign(V a, V b) {return _mm_or_pd(a, _mm_and_pd(b, _mm_set1_pd(-0.)));}
+    static inline void frexp2(V x, V &mant, V &expo)
+    {
+        const __m128i bits = _mm_castpd_si128(x);
+        const __m128i ebits = _mm_srli_epi64(bits, 52);
+        const __m128i mbits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                           _mm_set1_epi64x(0x3FF0000000000000LL));
+        mant = _mm_castsi128_pd(mbits);
+        /** 2^52 + e as double, the exponent field is below 2^11 */
+        expo = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(ebits, _mm_set1_epi64x(0x4330000000000000LL))),
+                          _mm_set1_pd(4503599627370496. + 1023.));
+    }
+};
+
+#include "src/bodekernel_simd.h"
+
+void bkEvalSSE2(const BodeFactors &bf, const double *freq, int32_t num, double *out_a, double *out_b, BK_OUT mode)
+{
+    bkEvalImpl<BKOpsSSE2>(bf, freq, num, out_a, out_b, mode);
+}
+
+void bkPolarSSE2(const double *re, const double *im, int32_t num, double *mag, double *phs, BK_OUT mode)
+{
+    bkPolarImpl<BKOpsSSE2>(re, im, num, mag, phs, mode);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
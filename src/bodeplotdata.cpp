@@ -0,0 +1,226 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/bodeplotdata.h"
+
+BodePlotData bpdFromSweep(const SweepBuffer &buf)
+{
+    return bpdFromPoints(buf.sbFreq(), buf.sbMag(), buf.sbPhase(), buf.sbSize());
+}
+
+BodePlotData bpdFromPoints(const double *freq, const double *mag, const double *phs, int32_t num)
+{
+    QVector<PdPoint> gmag(num), gphs(num);
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        gmag[indx].key = freq[indx];
+        gmag[indx].value = mag[indx];
+        gphs[indx].key = freq[indx];
+        gphs[indx].value = phs[indx];
+    }
+
+    BodePlotData out;
+    out.mag.reset(new PlotDecimator(gmag));
+    out.phs.reset(new PlotDecimator(gphs));
+    return out;
+}
+
+LoopPlotData lpdFromSweep(const SweepBuffer &buf)
+{
+    const int32_t num = buf.sbSize();
+    LoopPlotData out;
+    out.bode = bpdFromSweep(buf);
+    out.nyquist.key.resize(num);
+    out.nyquist.value.resize(num);
+    out.nichols.key.resize(num);
+    out.nichols.value.resize(num);
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        out.nyquist.key[indx] = buf.sbReal()[indx];
+        out.nyquist.value[indx] = buf.sbImag()[indx];
+        out.nichols.key[indx] = buf.sbPhase()[indx];
+        out.nichols.value[indx] = buf.sbMag()[indx];
+    }
+    return out;
+}
+
+ClosedLoopPlotData cpdFromSweep(const SweepBuffer &closed, const SweepBuffer &zout, const SweepBuffer &audio)
+{
+    ClosedLoopPlotData out;
+    out.closed = bpdFromSweep(closed);
+    out.zout = bpdFromSweep(zout);
+    out.audio = bpdFromSweep(audio);
+    return out;
+}
+
+/**
+ * @brief rpdRoots - points of the root sequence, the parameter is the index
+ */
+static CurvePlotData rpdRoots(const QVector<TransferFunction::Root> &roots)
+{
+    CurvePlotData out;
+    out.key.resize(roots.size());
+    out.value.resize(roots.size());
+    for(int32_t indx = 0; indx < roots.size(); ++indx)
+    {
+        out.key[indx] = roots[indx].real();
+        out.value[indx] = roots[indx].imag();
+    }
+    return out;
+}
+
+RootLocusPlotData rpdFromLocus(const QSharedPointer<const RootLocus> &rl)
+{
+    RootLocusPlotData out;
+    out.locus = rl;
+    out.poles = rpdRoots(rl->open_poles);
+    out.zeros = rpdRoots(rl->open_zeros);
+
+    const int32_t steps = rl->gain.size();
+    out.branch.resize(rl->branches);
+    for(int32_t branch = 0; branch < rl->branches; ++branch)
+    {
+        CurvePlotData &crv = out.branch[branch];
+        crv.key.resize(steps);
+        crv.value.resize(steps);
+        for(int32_t step = 0; step < steps; ++step)
+        {
+            const TransferFunction::Root &rt = rl->rlRoot(step, branch);
+            crv.key[step] = rt.real();
+            crv.value[step] = rt.imag();
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief tpdTrace - samples of the response on the time axis in ms
+ */
+static QSharedPointer<const PlotDecimator> tpdTrace(const StepResponse &resp)
+{
+    const int32_t num = resp.out.size();
+    QVector<PdPoint> pts(num);
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        pts[indx].key = 1E3 * indx * resp.step_time;
+        pts[indx].value = resp.out[indx];
+    }
+    return QSharedPointer<const PlotDecimator>(new PlotDecimator(pts));
+}
+
+TransientPlotData tpdFromStep(const StepResponse &load, const StepResponse &line)
+{
+    TransientPlotData out;
+    out.load = tpdTrace(load);
+    out.line = tpdTrace(line);
+    out.span = 1E3 * load.out.size() * load.step_time;
+    return out;
+}
+
+MonteCarloPlotData mpdFromRun(const McResult &res, const McLimits &lim)
+{
+    MonteCarloPlotData out;
+    out.phase_marg = mcHistogram(res.phase_marg);
+    out.gain_marg = mcHistogram(res.gain_marg);
+    QVector<double> fck(res.freq_cross.size());
+    for(int32_t indx = 0; indx < fck.size(); ++indx)
+    {
+        fck[indx] = 1E-3 * res.freq_cross[indx];
+    }
+    out.freq_cross = mcHistogram(fck);
+    out.phase_limit = lim.phase_marg;
+    out.gain_limit = lim.gain_marg;
+    return out;
+}
+
+SensTableData spdFromRun(const DsResult &res)
+{
+    SensTableData out;
+    for(int32_t col = 0; col < DS_INPUT_NUM; ++col)
+    {
+        out.cols.push_back(QString::fromLatin1(dsInputName(col)));
+    }
+    out.elast.resize(DS_OUTPUT_NUM);
+    for(int32_t row = 0; row < DS_OUTPUT_NUM; ++row)
+    {
+        out.rows.push_back(QString::fromLatin1(dsOutputName(row)));
+        out.value.push_back(res.value[row]);
+        out.elast[row].resize(DS_INPUT_NUM);
+        for(int32_t col = 0; col < DS_INPUT_NUM; ++col)
+        {
+            out.elast[row][col] = res.dsElasticity(row, col);
+        }
+    }
+    return out;
+}
+
+DigitalCompData dpdFromRun(const SweepBuffer &analog, const SweepBuffer &digital, const SweepBuffer &loop,
+                           const DzQuantized &qnt)
+{
+    DigitalCompData out;
+    out.analog = bpdFromSweep(analog);
+    out.digital = bpdFromSweep(digital);
+    out.loop = bpdFromSweep(loop);
+    out.coeff = qnt;
+    return out;
+}
+
+/**
+ * @brief mmpdCells - cells of the map over its line and load steps
+ */
+static ColorMapPlotData mmpdCells(const MmMap &map)
+{
+    ColorMapPlotData out;
+    out.key_num = map.volt_num;
+    out.value_num = map.load_num;
+    out.key_min = map.volt_min;
+    out.key_max = map.volt_max;
+    out.value_min = map.load_min;
+    out.value_max = map.load_max;
+    out.cell.resize(map.volt_num * map.load_num);
+    return out;
+}
+
+ModeMapPlotData mmpdFromMap(const MmMap &map, double ind_prim)
+{
+    ModeMapPlotData out;
+    out.ind_prim = 1E6 * ind_prim;
+    out.mode = mmpdCells(map);
+    out.ind_crit = mmpdCells(map);
+    out.margin = mmpdCells(map);
+    for(int32_t row = 0; row < map.load_num; ++row)
+    {
+        for(int32_t col = 0; col < map.volt_num; ++col)
+        {
+            const int32_t indx = row * map.volt_num + col;
+            out.mode.cell[indx] = static_cast<double>(map.mmMode(col, row));
+            out.ind_crit.cell[indx] = 1E6 * map.ind_crit[indx];
+            out.margin.cell[indx] = map.margin[indx];
+        }
+    }
+
+    out.bound.key.resize(map.volt_num);
+    out.bound.value.resize(map.volt_num);
+    for(int32_t col = 0; col < map.volt_num; ++col)
+    {
+        out.bound.key[col] = map.mmVolt(col);
+        out.bound.value[col] = map.bound[col];
+    }
+    return out;
+}
@@ -0,0 +1,212 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/bodesweep.h"
+#include "inc/poolrunner.h"
+#include <algorithm>
+#include <complex>
+
+/**
+ * @brief The BodeSweepJob struct - slices of the family sweep shared by the workers
+ */
+struct BodeSweepJob
+{
+    const BodeFactors *family;
+    const double *freq;
+    BK_OUT mode;
+    int32_t num;
+    int32_t chunks;
+    QVector<double*> mag; //Real part for the complex output
+    QVector<double*> phs; //Imaginary part for the complex output
+    PoolSlices slices; //Operating point major, the chunks of each one
+
+    /**
+     * @brief prRunSlices - take the slices one by one until nothing left
+     */
+    void prRunSlices()
+    {
+        int32_t task;
+        while(slices.prTake(task))
+        {
+            const int32_t op = task / chunks;
+            const int32_t begin = (task % chunks) * BS_CHUNK_POINTS;
+            const int32_t cnt = qMin(BS_CHUNK_POINTS, num - begin);
+            if(mode == BK_OUT_COMPLEX)
+                bkEvalComplex(family[op], freq + begin, cnt, mag[op] + begin, phs[op] + begin);
+            else
+                bkEvalBode(family[op], freq + begin, cnt, mag[op] + begin, phs[op] + begin,
+                           (mode == BK_OUT_BODE_FAST) ? BK_PREC_FAST : BK_PREC_EXACT);
+        }
+    }
+};
+
+/**
+ * @brief The BodeClosedJob struct - slices of the loop and its closed loop paths shared by the workers
+ */
+struct BodeClosedJob
+{
+    const BodeFactors *loop;
+    const BodeFactors *path;
+    const double *freq;
+    BK_PREC prec;
+    int32_t num;
+    double *loop_re;
+    double *loop_im;
+    double *loop_mag;
+    double *loop_phs;
+    QVector<double*> mag; //T/(1 + T) first, then each path
+    QVector<double*> phs;
+    PoolSlices slices;
+
+    /**
+     * @brief prRunSlices - the loop of the slice stays in cache for all closed loop responses
+     */
+    void prRunSlices()
+    {
+        double c_re[BS_CHUNK_POINTS], c_im[BS_CHUNK_POINTS];
+        int32_t task;
+        while(slices.prTake(task))
+        {
+            const int32_t begin = task * BS_CHUNK_POINTS;
+            const int32_t cnt = qMin(BS_CHUNK_POINTS, num - begin);
+            const double *t_re = loop_re + begin;
+            const double *t_im = loop_im + begin;
+            bkEvalComplex(*loop, freq + begin, cnt, loop_re + begin, loop_im + begin);
+            bkComplexToBode(t_re, t_im, cnt, loop_mag + begin, loop_phs + begin, prec);
+
+            for(int32_t out = 0; out < mag.size(); ++out)
+            {
+                if(out == 0)
+                {
+                    std::copy(t_re, t_re + cnt, c_re);
+                    std::copy(t_im, t_im + cnt, c_im);
+                }
+                else
+                {
+                    bkEvalComplex(path[out-1], freq + begin, cnt, c_re, c_im);
+                }
+                for(int32_t indx = 0; indx < cnt; ++indx)
+                {
+                    const std::complex<double> hcl = std::complex<double>(c_re[indx], c_im[indx])
+                            / std::complex<double>(1. + t_re[indx], t_im[indx]);
+                    c_re[indx] = hcl.real();
+                    c_im[indx] = hcl.imag();
+                }
+                bkComplexToBode(c_re, c_im, cnt, mag[out] + begin, phs[out] + begin, prec);
+            }
+        }
+    }
+};
+
+/**
+ * @brief bsRunJob - evaluate the slices on the pool and unwrap the phase of each operating point,
+ *        the complex output is left as is
+ */
+static void bsRunJob(BodeSweepJob &job, int32_t ops)
+{
+    job.chunks = (job.num + BS_CHUNK_POINTS - 1) / BS_CHUNK_POINTS;
+    job.slices.count = ops * job.chunks;
+    prRunPool(job);
+
+    if(job.mode != BK_OUT_COMPLEX)
+    {
+        for(int32_t op = 0; op < ops; ++op)
+        {
+            bkUnwrapPhase(job.phs[op], job.num);
+        }
+    }
+}
+
+void bsSweepFamily(const QVector<BodeFactors> &family, const QVector<double> &freq,
+                   QVector<QVector<double>> &mag, QVector<QVector<double>> &phs, BK_PREC prec)
+{
+    BodeSweepJob job;
+    job.family = family.constData();
+    job.freq = freq.constData();
+    job.mode = (prec == BK_PREC_FAST) ? BK_OUT_BODE_FAST : BK_OUT_BODE;
+    job.num = freq.size();
+
+    mag.resize(family.size());
+    phs.resize(family.size());
+    for(int32_t op = 0; op < family.size(); ++op)
+    {
+        mag[op].resize(job.num);
+        phs[op].resize(job.num);
+        job.mag.push_back(mag[op].data());
+        job.phs.push_back(phs[op].data());
+    }
+    bsRunJob(job, family.size());
+}
+
+void bsSweepBode(const BodeFactors &bf, const double *freq, int32_t num, double *mag, double *phs, BK_PREC prec)
+{
+    BodeSweepJob job;
+    job.family = &bf;
+    job.freq = freq;
+    job.mode = (prec == BK_PREC_FAST) ? BK_OUT_BODE_FAST : BK_OUT_BODE;
+    job.num = num;
+    job.mag.push_back(mag);
+    job.phs.push_back(phs);
+    bsRunJob(job, 1);
+}
+
+void bsSweepComplex(const BodeFactors &bf, const double *freq, int32_t num, double *re, double *im)
+{
+    BodeSweepJob job;
+    job.family = &bf;
+    job.freq = freq;
+    job.mode = BK_OUT_COMPLEX;
+    job.num = num;
+    job.mag.push_back(re);
+    job.phs.push_back(im);
+    bsRunJob(job, 1);
+}
+
+void bsSweepBode(const BodeFactors &bf, const QVector<double> &freq, QVector<double> &mag, QVector<double> &phs, BK_PREC prec)
+{
+    mag.resize(freq.size());
+    phs.resize(freq.size());
+    bsSweepBode(bf, freq.constData(), freq.size(), mag.data(), phs.data(), prec);
+}
+
+void bsSweepClosedLoop(const BodeFactors &loop, const QVector<BodeFactors> &path, const double *freq, int32_t num,
+                       double *loop_re, double *loop_im, double *loop_mag, double *loop_phs,
+                       const QVector<double*> &mag, const QVector<double*> &phs, BK_PREC prec)
+{
+    BodeClosedJob job;
+    job.loop = &loop;
+    job.path = path.constData();
+    job.freq = freq;
+    job.prec = prec;
+    job.num = num;
+    job.slices.count = (num + BS_CHUNK_POINTS - 1) / BS_CHUNK_POINTS;
+    job.loop_re = loop_re;
+    job.loop_im = loop_im;
+    job.loop_mag = loop_mag;
+    job.loop_phs = loop_phs;
+    job.mag = mag.mid(0, path.size() + 1);
+    job.phs = phs.mid(0, path.size() + 1);
+    prRunPool(job);
+
+    /** The phase of the loop is unwrapped by the caller together with the winding */
+    for(int32_t out = 0; out < job.mag.size(); ++out)
+    {
+        bkUnwrapPhase(job.phs[out], num);
+    }
+}
@@ -0,0 +1,120 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QFile>
+#include <QTextStream>
+#include "inc/batchsolve.h"
+
+#define CLI_EXIT_OK      0 //All specs solved
+#define CLI_EXIT_FAILED  1 //Some specs are not solved, see the error records
+#define CLI_EXIT_USAGE   2 //Bad option or the input/output failure
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("flysmps-cli");
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Batch solver of the flyback design specs, "
+                                     "one JSON object or CSV record per line in, one result per line out.");
+    parser.addHelpOption();
+    QCommandLineOption in_opt({"i", "input"}, "Spec file, stdin if not set or \"-\".", "file", "-");
+    QCommandLineOption out_opt({"o", "output"}, "Result file, stdout if not set or \"-\".", "file", "-");
+    QCommandLineOption fmt_opt({"f", "format"}, "Result format, json or csv.", "format", "json");
+    QCommandLineOption thr_opt({"j", "threads"}, "Solver threads, the ideal thread count if not set.", "num", "0");
+    QCommandLineOption bat_opt({"b", "batch"}, "Specs solved between the writes of the results.", "num",
+                               QString::number(BS_BATCH_SPECS));
+    QCommandLineOption key_opt("keys", "List the spec keys with the defaults and the result columns.");
+    QCommandLineOption vrb_opt({"v", "verbose"}, "Keep the debug and info log of the solver.");
+    parser.addOptions({in_opt, out_opt, fmt_opt, thr_opt, bat_opt, key_opt, vrb_opt});
+    parser.process(app);
+
+    if(parser.isSet(key_opt))
+    {
+        QTextStream out(stdout);
+        out << "# spec keys and defaults\n";
+        for(const QString &key : bsSpecKeys())
+        {
+            out << key << '\t' << bsSpecDefault(key) << '\n';
+        }
+        out << "# result columns\n";
+        for(const QString &key : bsResultKeys())
+        {
+            out << key << '\n';
+        }
+        return CLI_EXIT_OK;
+    }
+
+    /** The solver logs each step, the batch keeps the warnings only */
+    if(!parser.isSet(vrb_opt))
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+
+    BsOptions opt;
+    const QString fmt = parser.value(fmt_opt).toLower();
+    if(fmt == "csv")
+        opt.out_fmt = BS_FORMAT_CSV;
+    else if(fmt != "json")
+    {
+        err << "flysmps-cli: unknown format \"" << fmt << "\"\n";
+        return CLI_EXIT_USAGE;
+    }
+    bool thr_ok = false, bat_ok = false;
+    opt.threads = parser.value(thr_opt).toInt(&thr_ok);
+    opt.batch = parser.value(bat_opt).toInt(&bat_ok);
+    if(!thr_ok || opt.threads < 0 || !bat_ok || opt.batch < 1)
+    {
+        err << "flysmps-cli: bad number of threads or batch size\n";
+        return CLI_EXIT_USAGE;
+    }
+
+    /** "-" is the standard stream */
+    QFile in_file(parser.value(in_opt));
+    const bool in_ok = (in_file.fileName() == "-") ? in_file.open(stdin, QIODevice::ReadOnly)
+                                                  : in_file.open(QIODevice::ReadOnly);
+    if(!in_ok)
+    {
+        err << "flysmps-cli: " << in_file.fileName() << ": " << in_file.errorString() << '\n';
+        return CLI_EXIT_USAGE;
+    }
+    QFile out_file(parser.value(out_opt));
+    const bool out_ok = (out_file.fileName() == "-") ? out_file.open(stdout, QIODevice::WriteOnly)
+                                                    : out_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if(!out_ok)
+    {
+        err << "flysmps-cli: " << out_file.fileName() << ": " << out_file.errorString() << '\n';
+        return CLI_EXIT_USAGE;
+    }
+
+    const BsStats stats = bsRun(in_file, out_file, opt);
+    out_file.flush();
+    if(!stats.error.isEmpty())
+    {
+        err << "flysmps-cli: " << stats.error << '\n';
+        return CLI_EXIT_USAGE;
+    }
+    err << "flysmps-cli: " << stats.specs << " specs, " << stats.failed << " failed, "
+        << QString::number(stats.elapsed, 'f', 3) << " s, "
+        << QString::number((stats.elapsed > 0.) ? stats.specs/stats.elapsed : 0., 'f', 0) << " designs/s\n";
+    return (stats.failed > 0) ? CLI_EXIT_FAILED : CLI_EXIT_OK;
+}
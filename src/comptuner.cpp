@@ -0,0 +1,243 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/comptuner.h"
+#include <cmath>
+#include <limits>
+
+static const double s_e6[]  = {1.0, 1.5, 2.2, 3.3, 4.7, 6.8};
+static const double s_e12[] = {1.0, 1.2, 1.5, 1.8, 2.2, 2.7, 3.3, 3.9, 4.7, 5.6, 6.8, 8.2};
+static const double s_e24[] = {1.0, 1.1, 1.2, 1.3, 1.5, 1.6, 1.8, 2.0, 2.2, 2.4, 2.7, 3.0,
+                               3.3, 3.6, 3.9, 4.3, 4.7, 5.1, 5.6, 6.2, 6.8, 7.5, 8.2, 9.1};
+
+/**
+ * @brief ctMantissa - value of the index inside the decade, the series up to E24
+ *        are tabulated, E48 and E96 follow the geometric rule rounded to three digits
+ */
+static double ctMantissa(int32_t indx, CT_SERIES series)
+{
+    switch(series)
+    {
+    case CT_E6:
+        return s_e6[indx];
+    case CT_E12:
+        return s_e12[indx];
+    case CT_E24:
+        return s_e24[indx];
+    default:
+        return std::round(100. * std::pow(10., static_cast<double>(indx) / series)) / 100.;
+    }
+}
+
+double ctSeriesValue(int32_t step, CT_SERIES series)
+{
+    const int32_t num = static_cast<int32_t>(series);
+    int32_t dec = step / num;
+    int32_t indx = step % num;
+    if(indx < 0)
+    {
+        indx += num;
+        --dec;
+    }
+    return ctMantissa(indx, series) * std::pow(10., dec);
+}
+
+int32_t ctSeriesStep(double value, CT_SERIES series)
+{
+    const int32_t num = static_cast<int32_t>(series);
+    const int32_t dec = static_cast<int32_t>(std::floor(std::log10(value)));
+    const double mant = value / std::pow(10., dec);
+
+    /** The first value of the next decade closes the search */
+    int32_t best = 0;
+    double dist = std::numeric_limits<double>::infinity();
+    for(int32_t indx = 0; indx <= num; ++indx)
+    {
+        const double cand = (indx == num) ? 10. : ctMantissa(indx, series);
+        const double cdist = std::abs(std::log(mant / cand));
+        if(cdist < dist)
+        {
+            dist = cdist;
+            best = indx;
+        }
+    }
+    return dec * num + best;
+}
+
+BodeFactors ctCompFactors(const BodeFactors &plant, const TunerNetwork &net, double ctr,
+                          double res_zero, double cap_zero, double cap_pole)
+{
+    /** K(R_{f} + 1/(sC_{f})) = (K/C_{f})(1 + sR_{f}C_{f})/s, the same as type 2 of FCCD */
+    BodeFactors bf = plant;
+    bf.gain *= ctr * net.gain_per_res / cap_zero;
+    bf.order -= 1;
+    bf.bfAddZero(1. / (res_zero * cap_zero));
+    bf.bfAddPole(1. / (net.res_pull_up * cap_pole));
+    return bf;
+}
+
+/**
+ * @brief The TunerStep struct - candidate on the lattice of the series
+ */
+struct TunerStep
+{
+    int32_t res_zero;
+    int32_t cap_zero;
+    int32_t cap_pole;
+};
+
+/**
+ * @brief ctEvaluate - margins of the candidate on all corners and CTR ends
+ * @param evals - count of the margin solutions
+ * @return cost and margins of the candidate
+ */
+static TunerResult ctEvaluate(const QVector<BodeFactors> &plant, const TunerNetwork &net, const TunerTarget &tg,
+                              const TunerStep &stp, int32_t &evals)
+{
+    TunerResult res;
+    res.res_zero = ctSeriesValue(stp.res_zero, net.res_series);
+    res.cap_zero = ctSeriesValue(stp.cap_zero, net.cap_series);
+    res.cap_pole = ctSeriesValue(stp.cap_pole, net.cap_series);
+    res.phase_marg = std::numeric_limits<double>::infinity();
+    res.gain_marg = std::numeric_limits<double>::infinity();
+
+    const double ctr[2] = {1., net.ctr_spread};
+    const int32_t num_ctr = (net.ctr_spread > 1.) ? 2 : 1;
+    bool cross = true;
+    for(int32_t crn = 0; crn < plant.size(); ++crn)
+    {
+        for(int32_t kc = 0; kc < num_ctr; ++kc)
+        {
+            LoopMargins lm = lmSolveMargins(ctCompFactors(plant[crn], net, ctr[kc], res.res_zero, res.cap_zero, res.cap_pole),
+                                            tg.freq_begin, tg.freq_end);
+            ++evals;
+            if(!lm.has_cross)
+            {
+                res.cost += CT_NO_CROSS_COST;
+                cross = false;
+                continue;
+            }
+            if(crn == 0 && kc == 0)
+                res.freq_cross = lm.freq_cross;
+            res.phase_marg = qMin(res.phase_marg, lm.phase_marg);
+            if(lm.has_180)
+                res.gain_marg = qMin(res.gain_marg, lm.gain_marg);
+        }
+    }
+
+    if(res.freq_cross > 0.)
+        res.cost += CT_CROSS_WEIGHT * qPow(std::log10(res.freq_cross / tg.freq_cross), 2);
+    const double pm_def = qMax(tg.phase_marg - res.phase_marg, 0.);
+    const double gm_def = qMax(tg.gain_marg - res.gain_marg, 0.);
+    res.cost += pm_def * pm_def + gm_def * gm_def;
+    res.feasible = cross && pm_def == 0. && gm_def == 0.;
+    return res;
+}
+
+TunerResult ctTune(const QVector<TransferFunction> &corners, const TunerNetwork &net, const TunerTarget &tg)
+{
+    TunerResult best;
+    best.cost = std::numeric_limits<double>::infinity();
+    if(corners.isEmpty() || !(tg.freq_cross > 0.))
+        return best;
+
+    QVector<BodeFactors> plant;
+    for(const TransferFunction &tf : corners)
+    {
+        plant.push_back(tf.tfBodeFactors());
+    }
+    int32_t evals = 0;
+    TunerStep best_stp = {0, 0, 0};
+    auto tryStep = [&](const TunerStep &stp) -> bool
+    {
+        const double res = ctSeriesValue(stp.res_zero, net.res_series);
+        const double cap_zero = ctSeriesValue(stp.cap_zero, net.cap_series);
+        const double cap_pole = ctSeriesValue(stp.cap_pole, net.cap_series);
+        if(res < CT_RES_MIN || res > CT_RES_MAX)
+            return false;
+        if(cap_zero < CT_CAP_MIN || cap_zero > CT_CAP_MAX || cap_pole < CT_CAP_MIN || cap_pole > CT_CAP_MAX)
+            return false;
+        TunerResult cand = ctEvaluate(plant, net, tg, stp, evals);
+        if(cand.cost >= best.cost)
+            return false;
+        best = cand;
+        best_stp = stp;
+        return true;
+    };
+
+    /**
+     * The pole is placed from the crossover up to CT_RATIO_SPAN times of it.
+     * |H_{c}(j\omega_{c})P(j\omega_{c})| = 1 gives |R_{f} - j/(\omega_{c}C_{f})| = M,
+     * R_{f} is solved for each C_{f} and both series values around it are tried.
+     * The zero capacitor is taken from the mid-band estimate R_{f} ~ M.
+     */
+    const double omega = 2*M_PI*tg.freq_cross;
+    const double pmag = std::abs(corners.first().tfEval(omega));
+    const int32_t cap_min = ctSeriesStep(CT_CAP_MIN, net.cap_series);
+    const int32_t cap_max = ctSeriesStep(CT_CAP_MAX, net.cap_series);
+    const int32_t co_lo = qBound(cap_min, ctSeriesStep(1. / (omega * net.res_pull_up * CT_RATIO_SPAN), net.cap_series), cap_max);
+    const int32_t co_hi = qBound(cap_min, ctSeriesStep(1. / (omega * net.res_pull_up), net.cap_series), cap_max);
+    for(int32_t co = co_lo; co <= co_hi; ++co)
+    {
+        const double cap_pole = ctSeriesValue(co, net.cap_series);
+        const double mag = std::abs(std::complex<double>(1., omega * net.res_pull_up * cap_pole)) / (net.gain_per_res * pmag);
+        const int32_t cf_lo = qBound(cap_min, ctSeriesStep(1. / (omega * mag * CT_CAP_WIDEN), net.cap_series), cap_max);
+        const int32_t cf_hi = qBound(cap_min, ctSeriesStep(CT_RATIO_SPAN * CT_CAP_WIDEN / (omega * mag), net.cap_series), cap_max);
+        for(int32_t cf = cf_lo; cf <= cf_hi; ++cf)
+        {
+            const double reac = 1. / (omega * ctSeriesValue(cf, net.cap_series));
+            if(reac >= mag)
+                continue;
+            /** Out of the range the nearest end gives the closest crossover */
+            const double res = qBound(CT_RES_MIN, std::sqrt(mag * mag - reac * reac), CT_RES_MAX);
+            const int32_t rf = ctSeriesStep(res, net.res_series);
+            const int32_t rn = (ctSeriesValue(rf, net.res_series) > res) ? rf - 1 : rf + 1;
+            tryStep({rf, cf, co});
+            tryStep({rn, cf, co});
+        }
+    }
+    if(!qIsFinite(best.cost))
+    {
+        best.evals = evals;
+        return best;
+    }
+
+    /** Descent to the best of the neighbour values, one step of each part */
+    for(int32_t iter = 0; iter < CT_REFINE_ITER_MAX; ++iter)
+    {
+        const TunerStep cur = best_stp;
+        bool moved = false;
+        for(int32_t dr = -1; dr <= 1; ++dr)
+        {
+            for(int32_t dz = -1; dz <= 1; ++dz)
+            {
+                for(int32_t dp = -1; dp <= 1; ++dp)
+                {
+                    if(dr == 0 && dz == 0 && dp == 0)
+                        continue;
+                    moved = tryStep({cur.res_zero + dr, cur.cap_zero + dz, cur.cap_pole + dp}) || moved;
+                }
+            }
+        }
+        if(!moved)
+            break;
+    }
+    best.evals = evals;
+    return best;
+}
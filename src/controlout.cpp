@@ -4,247 +4,246 @@ PCSSM::PCSSM(SSMPreDesign &ssmvar, PS_MODE mode)
 {
     qSwap(m_ssmvar, ssmvar);
     m_mode = mode;
+    m_coeff = coCompile();
 }
 
-inline double PCSSM::coZeroOneAngFreq() const
+void PCSSM::coRecompile(const SSMPreDesign &ssmvar)
 {
-    return 1/(m_ssmvar.output_cap * m_ssmvar.output_cap_esr);
+    m_ssmvar = ssmvar;
+    m_coeff = coCompile();
 }
 
-inline double PCSSM::coPoleOneAngFreq() const
+double PCSSM::coMagCCMDutyToInductCurrTrasfFunct(const double freq)
 {
-    return 2/(static_cast<double>(m_ssmvar.output_full_load_res) * m_ssmvar.output_cap);
-}
+    double num = qSqrt(1 + qPow((freq/coPoleOneAngFreq()), 2));
 
-inline double PCSSM::coDCMZeroTwoAngFreq() const
-{
-    double voltrat = static_cast<double>(m_ssmvar.output_voltage)/m_ssmvar.input_voltage;
-    double tmp = qPow(m_ssmvar.turn_ratio, 2) * static_cast<double>(m_ssmvar.output_full_load_res);
+    double dnm = qSqrt(1 - qPow((freq/coCCMPoleTwoAngFreq()), 2) + qPow((freq/(coCCMQualityFact()*coCCMPoleTwoAngFreq())), 2));
 
-    return tmp/(m_ssmvar.primary_ind * voltrat*(voltrat+1));
+    return coCCMCurrGainCoeff() * (num/dnm);
 }
 
-inline double PCSSM::coDCMPoleTwoAngFreq() const
+double PCSSM::coPhsCCMDutyToInductCurrTrasfFunct(const double freq)
 {
-    double voltrat = static_cast<double>(m_ssmvar.output_voltage)/m_ssmvar.input_voltage;
-
-    return (qPow(m_ssmvar.turn_ratio, 2) * static_cast<double>(m_ssmvar.output_full_load_res))
-            /(m_ssmvar.primary_ind * qPow((voltrat+1),2));
+    double farg = qAtan(freq/coPoleOneAngFreq());
+    double sarg = qAtan(
+                        (freq/(coCCMQualityFact()*coCCMPoleTwoAngFreq())) *
+                        (1/(1 - qPow((freq/coCCMPoleTwoAngFreq()), 2)))
+                       );
+    return farg - sarg;
 }
 
-inline double PCSSM::coDCMCriticValue() const
+/**
+ * @brief skRatio - k(n_re + jn_im)/(d_re + jd_im) in the real form
+ */
+static inline void skRatio(double k, double n_re, double n_im, double d_re, double d_im, double &re, double &im)
 {
-    double ktmp = (2. * m_ssmvar.primary_ind * static_cast<double>(m_ssmvar.freq_switch))
-            /static_cast<double>(m_ssmvar.output_full_load_res);
-
-    return static_cast<double>(m_ssmvar.input_voltage)
-            /(static_cast<double>(m_ssmvar.turn_ratio) * qSqrt(ktmp));
+    const double scl = k / (d_re * d_re + d_im * d_im);
+    re = (n_re * d_re + n_im * d_im) * scl;
+    im = (n_im * d_re - n_re * d_im) * scl;
 }
 
-inline double PCSSM::coCCMZeroTwoAngFreq() const
-{
-    double tmp = qPow(m_ssmvar.turn_ratio, 2) * qPow((1-m_ssmvar.actual_duty), 2)
-            * static_cast<double>(m_ssmvar.output_full_load_res);
-
-    return tmp/(2 * M_PI * m_ssmvar.actual_duty * m_ssmvar.primary_ind);
-}
+/**
+ * @brief The SSMKernel struct - power stage response of the conduction mode,
+ *        one specialization per PS_MODE, the mode is fixed at compile time.
+ *        The point functions are the reference of the factors of SSMModelT::coFactors.
+ */
+template<PS_MODE M> struct SSMKernel;
 
-inline double PCSSM::coCCMPoleTwoAngFreq() const
+/**
+ * DCM - G_{vd}(s) = K_{vd}(1+s/\omega_{zc})(1-s/\omega_{zrhp})/((1+s/\omega_{rc})(1+s/\omega_{p2}))
+ */
+template<> struct SSMKernel<DCM_MODE>
 {
-    double tmp = static_cast<double>(m_ssmvar.turn_ratio)
-            /(2 * M_PI * qSqrt(m_ssmvar.output_cap * m_ssmvar.primary_ind));
-
-    double num = qPow((1-m_ssmvar.actual_duty), 2);
+    static inline void skDutyToOut(const SSMCoeff &cf, double omega, double &re, double &im)
+    {
+        const double wzc = omega * (1./cf.omega_zc), wzr = omega * (1./cf.omega_zrhp);
+        const double wrc = omega * (1./cf.omega_rc), wp2 = omega * (1./cf.omega_p2);
+        skRatio(cf.gain_vd, 1. + wzc * wzr, wzc - wzr, 1. - wrc * wp2, wrc + wp2, re, im);
+    }
 
-    double ld = qSqrt((num*static_cast<double>(m_ssmvar.output_full_load_res))
-                      /(static_cast<double>(m_ssmvar.output_full_load_res)+m_ssmvar.output_cap_esr));
-    return tmp*ld;
-}
+    static inline void skControlToOut(const SSMCoeff &cf, double omega, double &re, double &im)
+    {
+        skDutyToOut(cf, omega, re, im);
+        re *= cf.gain_fm;
+        im *= cf.gain_fm;
+    }
 
-inline double PCSSM::coCCMVoltGainCoeff() const
-{
-    return static_cast<double>(m_ssmvar.input_voltage)
-            /(static_cast<double>(m_ssmvar.turn_ratio) * (qPow((1-m_ssmvar.actual_duty),2)));
-}
+    static void skFillGrid(const SSMCoeff &cf, FreqGrid &grid)
+    {
+        grid.fgAddCorner(cf.omega_zc/(2*M_PI));
+        grid.fgAddCorner(cf.omega_rc/(2*M_PI));
+        grid.fgAddCorner(cf.omega_zrhp/(2*M_PI));
+        grid.fgAddCorner(cf.omega_p2/(2*M_PI));
+    }
+};
 
-inline double PCSSM::coCCMCurrGainCoeff() const
+/**
+ * CCM - G_{vd}(s) = K_{vd}(1-s/\omega_{zrhp})(1+s/\omega_{zc})/(1+s/(Q\omega_{o})+s^2/\omega_{o}^2),
+ * the current loop closes over the double pole:
+ * F_{m}G_{vd}/(1+F_{m}R_{s}G_{id}) = F_{m}K_{vd}N_{vd}/(D + F_{m}R_{s}K_{id}(1+s/\omega_{rc}))
+ */
+template<> struct SSMKernel<CCM_MODE>
 {
-    double tmp = 1.+(2.*m_ssmvar.actual_duty/(1.-m_ssmvar.actual_duty));
-
-    double dnm = qPow((1-m_ssmvar.actual_duty), 2);
+    static inline void skDutyToOut(const SSMCoeff &cf, double omega, double &re, double &im)
+    {
+        const double wzc = omega * (1./cf.omega_zc), wzr = omega * (1./cf.omega_zrhp);
+        const double wo = omega * (1./cf.omega_o);
+        skRatio(cf.gain_vd, 1. + wzc * wzr, wzc - wzr, 1. - wo * wo, wo * (1./cf.qual), re, im);
+    }
 
-    double mult = m_ssmvar.input_voltage
-            /(static_cast<double>(m_ssmvar.turn_ratio) * dnm * static_cast<double>(m_ssmvar.output_full_load_res));
+    static inline void skControlToOut(const SSMCoeff &cf, double omega, double &re, double &im)
+    {
+        const double kil = cf.gain_ri * cf.gain_id;
+        const double wzc = omega * (1./cf.omega_zc), wzr = omega * (1./cf.omega_zrhp);
+        const double wo = omega * (1./cf.omega_o);
+        skRatio(cf.gain_fm * cf.gain_vd, 1. + wzc * wzr, wzc - wzr,
+                1. + kil - wo * wo, wo * (1./cf.qual) + omega * (kil/cf.omega_rc), re, im);
+    }
 
-    return tmp*mult;
-}
+    static void skFillGrid(const SSMCoeff &cf, FreqGrid &grid)
+    {
+        grid.fgAddCorner(cf.omega_zc/(2*M_PI));
+        grid.fgAddCorner(cf.omega_rc/(2*M_PI));
+        grid.fgAddCorner(cf.omega_zrhp/(2*M_PI));
+        grid.fgAddResonance(cf.omega_o/(2*M_PI), cf.qual);
+    }
+};
 
-inline double PCSSM::coCCMQualityFact() const
+double PCSSM::coMagDutyToOutTrasfFunct(const double freq)
 {
-    double dnm1 = m_ssmvar.primary_ind
-            /(qPow(static_cast<double>(m_ssmvar.turn_ratio), 2)
-            * qPow((1-m_ssmvar.actual_duty), 2) * static_cast<double>(m_ssmvar.output_full_load_res));
-
-    double dnm2 = m_ssmvar.output_cap_esr * static_cast<double>(m_ssmvar.output_full_load_res);
-
-    return 1/(coCCMPoleTwoAngFreq()*(dnm1+dnm2));
+    return std::abs(coDutyToOutResponse(freq));
 }
 
-double PCSSM::coMagCCMDutyToInductCurrTrasfFunct(const double freq)
+double PCSSM::coPhsDutyToOutTrasfFunct(const double freq)
 {
-    double num = qSqrt(1 + qPow((freq/coPoleOneAngFreq()), 2));
-
-    double dnm = qSqrt(1 - qPow((freq/coCCMPoleTwoAngFreq()), 2) + qPow((freq/(coCCMQualityFact()*coCCMPoleTwoAngFreq())), 2));
-
-    return coCCMCurrGainCoeff() * (num/dnm);
+    return std::arg(coDutyToOutResponse(freq));
 }
 
-double PCSSM::coPhsCCMDutyToInductCurrTrasfFunct(const double freq)
+double PCSSM::coMagControlToOutTransfFunct(const double freq)
 {
-    double farg = qAtan(freq/coPoleOneAngFreq());
-    double sarg = qAtan(
-                        (freq/(coCCMQualityFact()*coCCMPoleTwoAngFreq())) *
-                        (1/(1 - qPow((freq/coCCMPoleTwoAngFreq()), 2)))
-                       );
-    return farg - sarg;
+    return 20 * log10(std::abs(coControlToOutResponse(freq)));
 }
 
-inline double PCSSM::coCurrDetectSlopeVolt() const
+double PCSSM::coPhsControlToOutTransfFunct(const double freq)
 {
-    return (m_ssmvar.input_voltage * m_ssmvar.res_sense)
-            / m_ssmvar.primary_ind;
+    return std::arg(coControlToOutResponse(freq)) * (M_PI_DEG/M_PI);
 }
 
-inline double PCSSM::coTimeConst() const
+SSMCoeff PCSSM::coCompile() const
 {
-    return (2 * m_ssmvar.primary_ind * static_cast<double>(m_ssmvar.freq_switch))
-            /(qPow(m_ssmvar.turn_ratio, 2) * static_cast<double>(m_ssmvar.output_full_load_res));
+    return SSMModelT<double, SSMPreDesign>::coCompile(m_mode);
 }
 
-inline double PCSSM::coGainCurrModeContrModulator() const
+std::complex<double> PCSSM::coDutyToInductCurrResponse(const double freq) const
 {
-    return 1/((coCurrDetectSlopeVolt()+m_ssmvar.sawvolt)*coTimeConst());
+    const SSMCoeff &cf = m_coeff;
+    const std::complex<double> sfr(0., 2*M_PI*freq);
+
+    std::complex<double> num = 1. + sfr/cf.omega_rc;
+    std::complex<double> dnm = 1. + sfr/(cf.qual*cf.omega_o) + (sfr*sfr)/(cf.omega_o*cf.omega_o);
+
+    return cf.gain_id * num/dnm;
 }
 
-double PCSSM::coMagDutyToOutTrasfFunct(const double freq)
+std::complex<double> PCSSM::coDutyToOutResponse(const double freq) const
 {
-    double result = 0.0;
-    double num1 = 0.0;
-    double num2 = 0.0;
-    double dnm1 = 0.0;
-    double dnm2 = 0.0;
-    if(m_mode == DCM_MODE)
-    {
-        num1 = qSqrt(1 + qPow((freq/coZeroOneAngFreq()), 2));
-        num2 = qSqrt(1 - qPow((freq/coDCMZeroTwoAngFreq()), 2));
-        dnm1 = qSqrt(1 + qPow((freq/coPoleOneAngFreq()), 2));
-        dnm2 = qSqrt(1 + qPow((freq/coDCMPoleTwoAngFreq()), 2));
-        result = coDCMCriticValue()*((num1*num2)/(dnm1*dnm2));
-    }
-    else if(m_mode == CCM_MODE)
+    const double omega = 2*M_PI*freq;
+    double re = 0., im = 0.;
+
+    switch(m_mode)
     {
-        num1 = qSqrt(1 + qPow((freq/coCCMZeroTwoAngFreq()), 2));
-        num2 = qSqrt(1 + qPow((freq/coZeroOneAngFreq()), 2));
-        dnm1 = qSqrt(
-                    qPow(1 - qPow((freq/coCCMPoleTwoAngFreq()), 2), 2) +
-                    qPow((freq/(coCCMQualityFact()*coCCMPoleTwoAngFreq())), 2)
-                    );
-        result = coCCMVoltGainCoeff()*((num1*num2)/(dnm1));
+    case CCM_MODE:
+        SSMKernel<CCM_MODE>::skDutyToOut(m_coeff, omega, re, im);
+        break;
+    default:
+        SSMKernel<DCM_MODE>::skDutyToOut(m_coeff, omega, re, im);
+        break;
     }
-    return result;
+    return std::complex<double>(re, im);
 }
 
-double PCSSM::coPhsDutyToOutTrasfFunct(const double freq)
+std::complex<double> PCSSM::coControlToOutResponse(const double freq) const
 {
-    double result = 0.0;
-    double farg = qAtan(freq/coCCMZeroTwoAngFreq());
-    double sarg = qAtan(freq/coZeroOneAngFreq());
-    double targ = 0.;
-    if(m_mode == DCM_MODE)
-    {
-        targ = qAtan(freq/coPoleOneAngFreq());
-        result = farg - sarg - targ - qAtan(freq/coDCMPoleTwoAngFreq());
-    }
-    else if(m_mode == CCM_MODE)
+    const double omega = 2*M_PI*freq;
+    double re = 0., im = 0.;
+
+    switch(m_mode)
     {
-        targ = qAtan((freq/(coCCMQualityFact()*coCCMPoleTwoAngFreq())) * (1/(1 - qPow((freq/coCCMPoleTwoAngFreq()), 2))));
-        result = farg - sarg - targ;
+    case CCM_MODE:
+        SSMKernel<CCM_MODE>::skControlToOut(m_coeff, omega, re, im);
+        break;
+    default:
+        SSMKernel<DCM_MODE>::skControlToOut(m_coeff, omega, re, im);
+        break;
     }
-    return result;
+    return std::complex<double>(re, im);
 }
 
-double PCSSM::coMagControlToOutTransfFunct(const double freq)
+BodeFactors PCSSM::coBodeFactors() const
 {
-    double result = 0.0;
-    double dnm = 0.0;
-    if(m_mode == DCM_MODE)
-    {
-        result = 20 * log10(coMagDutyToOutTrasfFunct(freq) * coGainCurrModeContrModulator());
-    }
-    else if(m_mode == CCM_MODE)
-    {
-        dnm = 20 * log10(coGainCurrModeContrModulator() * m_ssmvar.res_sense) * coMagCCMDutyToInductCurrTrasfFunct(freq);
-        result = ( 20 * log10(coGainCurrModeContrModulator()) * coMagDutyToOutTrasfFunct(freq))/(1+dnm);
-    }
-    return result;
-
+    return coFactors(m_coeff, m_mode);
 }
 
-double PCSSM::coPhsControlToOutTransfFunct(const double freq)
+void PCSSM::coControlToOutTransfFunct(SweepBuffer &buf)
 {
-    double result = 0.0;
-    double dnm = 0.0;
-    if(m_mode == DCM_MODE)
-    {
-        result = coPhsDutyToOutTrasfFunct(freq) * (M_PI_DEG/M_PI);
-    }
-    else if(m_mode == CCM_MODE)
-    {
-        dnm = qAtan(coGainCurrModeContrModulator() * m_ssmvar.res_sense) * coMagCCMDutyToInductCurrTrasfFunct(freq);
-        result = (qAtan(coGainCurrModeContrModulator()) * coMagDutyToOutTrasfFunct(freq))/(1+dnm);
-    }
-    return result;
-
+    /** The mode is resolved here once, the vector kernel runs on the fixed shape of the mode */
+    bsSweepBode(coBodeFactors(), buf.sbFreq(), buf.sbSize(), buf.sbMag(), buf.sbPhase(), buf.sbPrecision());
+    emit arraySSMComplete();
 }
 
-void PCSSM::coGainControlToOutTransfFunct(QVector<double> &in_freq, QVector<double> &out_mag)
+void PCSSM::coFillFreqGrid(FreqGrid &grid) const
 {
-    auto itr_freq = in_freq.begin();
-    out_mag.reserve(in_freq.size());
-    double frq = 0., result = 0.;
-
-    while(itr_freq != in_freq.end())
+    switch(m_mode)
     {
-        frq = *itr_freq;
-        result = coMagControlToOutTransfFunct(frq);
-        out_mag.push_back(result);
-        itr_freq++;
+    case CCM_MODE:
+        SSMKernel<CCM_MODE>::skFillGrid(m_coeff, grid);
+        break;
+    default:
+        SSMKernel<DCM_MODE>::skFillGrid(m_coeff, grid);
+        break;
     }
-    emit arrayMagSSMComplete();
 }
 
-void PCSSM::coPhaseControlToOutTransfFunct(QVector<double> &in_freq, QVector<double> &out_phase)
+TransferFunction PCSSM::coOutImpTransfFunc() const
 {
-    auto itr_freq = in_freq.begin();
-    out_phase.reserve(in_freq.size());
-    double frq = 0., result = 0.;
+    TransferFunction tf(1./(m_coeff.omega_rc * m_ssmvar.output_cap));
+    tf.tfAddZero(m_coeff.omega_zc);
+    tf.tfAddPole(m_coeff.omega_rc);
+    return tf;
+}
 
-    while(itr_freq != in_freq.end())
+TransferFunction PCSSM::coLineToOutTransfFunc() const
+{
+    /**
+     * The peak current is set by the control, the input reaches the output
+     * through the compensation ramp in DCM and through the duty in CCM.
+     */
+    double gain = 0.;
+    if(m_mode == CCM_MODE)
     {
-        frq = *itr_freq;
-        result = coPhsControlToOutTransfFunct(frq);
-        out_phase.push_back(result);
-        itr_freq++;
+        const double duty2 = qPow(m_ssmvar.actual_duty, 2);
+        gain = (duty2 / (1. - duty2)) / m_ssmvar.turn_ratio;
     }
-    emit arrayPhaseSSMComplete();
+    else
+    {
+        const double sn = coCurrDetectSlopeVolt();
+        gain = (static_cast<double>(m_ssmvar.output_voltage) / m_ssmvar.input_voltage)
+                * m_ssmvar.sawvolt / (sn + m_ssmvar.sawvolt);
+    }
+    TransferFunction tf(gain);
+    tf.tfAddZero(m_coeff.omega_zc);
+    tf.tfAddPole(m_coeff.omega_rc);
+    return tf;
 }
 
-FCCD::FCCD(FCPreDesign &fcvar, RampSlopePreDesign &rsvar, LCSecondStage &lcfvar, PS_MODE mode)
+FCCD::FCCD(FCPreDesign &fcvar, RampSlopePreDesign &rsvar, LCSecondStage &lcfvar, PS_MODE mode, FC_COMP comp)
 {
     qSwap(m_fcvar, fcvar);
     qSwap(m_rsvar, rsvar);
     qSwap(m_lcfvar, lcfvar);
     m_mode = mode;
+    m_comp = comp;
+    m_coeff = coCompile();
 }
 
 double FCCD::coFreqCrossSection() const
@@ -447,32 +446,118 @@ inline double FCCD::coPhsOptoFeedbTransfFunc(const double freq) const
     return qAtan(freq/coTransfZero())-qAtan(freq/coTransfPoleOne());
 }
 
-void FCCD::coGainOptoFeedbTransfFunc(QVector<double> &in_freq, QVector<double> &out_mag)
+FCCoeff FCCD::coCompile() const
 {
-    auto itr_freq = in_freq.begin();
-    out_mag.reserve(in_freq.size());
-    double frq = 0., result = 0.;
+    FCCoeff cf;
+    cf.gain = coVoltageOptoGain() * coResDivideGain();
+    cf.omega_z = 2*M_PI*coTransfZero();
+    cf.omega_p1 = 2*M_PI*coTransfPoleOne();
+    cf.omega_rc = 2*M_PI*coTranfRCZero();
+    cf.omega_lc = 2*M_PI*coTransfLCZero();
+    cf.qual_lc = coQualityLC();
+    return cf;
+}
 
-    while(itr_freq != in_freq.end())
-    {
-        frq = *itr_freq;
-        result = 20 * log10(coMagOptoFeedbTransfFunc(frq));
-        out_mag.push_back(result);
-        itr_freq++;
-    }
+double FCCD::coGainPerRes() const
+{
+    return coVoltageOptoGain() / coResUp();
+}
+
+void FCCD::coApplyNetwork(double res_zero, double cap_zero, double cap_pole)
+{
+    m_coeff.gain = coGainPerRes() * res_zero;
+    m_coeff.omega_z = 1/(res_zero * cap_zero);
+    m_coeff.omega_p1 = 1/(m_fcvar.res_pull_up * cap_pole);
 }
 
-void FCCD::coPhaseOptoFeedbTransfFunc(QVector<double> &in_freq, QVector<double> &out_phase)
+std::complex<double> FCCD::coLCResponse(const double freq) const
 {
-    auto itr_freq = in_freq.begin();
-    out_phase.reserve(in_freq.size());
-    double frq = 0., result = 0.;
+    const FCCoeff &cf = m_coeff;
+    const std::complex<double> sfr(0., 2*M_PI*freq);
 
-    while (itr_freq != in_freq.end())
+    std::complex<double> num = 1. + sfr/cf.omega_rc;
+    std::complex<double> dnm = 1. + sfr/(cf.qual_lc * cf.omega_lc) + (sfr*sfr)/(cf.omega_lc * cf.omega_lc);
+    return num/dnm;
+}
+
+/**
+ * @brief The FCKernel struct - compensator response of the type, one specialization per FC_COMP.
+ *        The LC second stage is the same for all types.
+ */
+template<FC_COMP C> struct FCKernel;
+
+/**
+ * Type 2 - H_{c}(s) = G_{0}(1+\omega_{z}/s)/(1+s/\omega_{p1})
+ */
+template<> struct FCKernel<FC_TYPE_2>
+{
+    static inline void fkComp(const FCCoeff &cf, double omega, double &re, double &im)
     {
-        frq = *itr_freq;
-        result = (coPhsOptoFeedbTransfFunc(frq) - coPhsLCTransfFunc(frq))  * (M_PI_DEG/M_PI);
-        out_phase.push_back(result);
-        itr_freq++;
+        skRatio(cf.gain, 1., -cf.omega_z / omega, 1., omega * (1./cf.omega_p1), re, im);
     }
+
+    static BodeFactors fkFactors(const FCCoeff &cf)
+    {
+        BodeFactors bf;
+        /** (1 + \omega_{z}/s) = \omega_{z}(1 + s/\omega_{z})/s */
+        bf.gain = cf.gain * cf.omega_z;
+        bf.order = -1;
+        bf.bfAddZero(cf.omega_z);
+        bf.bfAddPole(cf.omega_p1);
+        return bf;
+    }
+
+    static void fkFillGrid(const FCCoeff &cf, FreqGrid &grid)
+    {
+        grid.fgAddCorner(cf.omega_z/(2*M_PI));
+        grid.fgAddCorner(cf.omega_p1/(2*M_PI));
+    }
+};
+
+std::complex<double> FCCD::coOptoFeedbResponse(const double freq) const
+{
+    const double omega = 2*M_PI*freq;
+    double re = 0., im = 0.;
+
+    FCKernel<FC_TYPE_2>::fkComp(m_coeff, omega, re, im);
+    return std::complex<double>(re, im) * coLCResponse(freq);
+}
+
+BodeFactors FCCD::coCompFactors() const
+{
+    return coCompFactors(m_coeff, m_comp);
+}
+
+BodeFactors FCCD::coCompFactors(const FCCoeff &cf, FC_COMP comp)
+{
+    Q_UNUSED(comp);
+    return FCKernel<FC_TYPE_2>::fkFactors(cf);
+}
+
+BodeFactors FCCD::coBodeFactors() const
+{
+    return coBodeFactors(m_coeff, m_comp);
+}
+
+BodeFactors FCCD::coBodeFactors(const FCCoeff &cf, FC_COMP comp)
+{
+    BodeFactors bf = coCompFactors(cf, comp);
+
+    bf.bfAddZero(cf.omega_rc);
+    bf.bfAddPolePair(cf.omega_lc, cf.qual_lc);
+    return bf;
+}
+
+void FCCD::coOptoFeedbTransfFunc(SweepBuffer &buf)
+{
+    bsSweepBode(coBodeFactors(), buf.sbFreq(), buf.sbSize(), buf.sbMag(), buf.sbPhase(), buf.sbPrecision());
+}
+
+void FCCD::coFillFreqGrid(FreqGrid &grid) const
+{
+    const FCCoeff &cf = m_coeff;
+    grid.fgAddCrossover(coFreqCrossSection());
+    FCKernel<FC_TYPE_2>::fkFillGrid(cf, grid);
+    grid.fgAddCorner(cf.omega_rc/(2*M_PI));
+    grid.fgAddResonance(cf.omega_lc/(2*M_PI), cf.qual_lc);
 }
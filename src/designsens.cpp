@@ -0,0 +1,233 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/designsens.h"
+
+/**
+ * @brief dsFactorsOn - the factors on the scalar T, the derivatives of S are dropped
+ */
+template<typename T, typename S>
+static BodeFactorsT<T> dsFactorsOn(const BodeFactorsT<S> &bf)
+{
+    BodeFactorsT<T> out;
+    out.gain = T(dualValue(bf.gain));
+    out.order = bf.order;
+    for(const S &val : bf.tz)
+        out.tz.push_back(T(dualValue(val)));
+    for(const S &val : bf.tp)
+        out.tp.push_back(T(dualValue(val)));
+    for(const S &val : bf.bz)
+        out.bz.push_back(T(dualValue(val)));
+    for(const S &val : bf.az)
+        out.az.push_back(T(dualValue(val)));
+    for(const S &val : bf.bp)
+        out.bp.push_back(T(dualValue(val)));
+    for(const S &val : bf.ap)
+        out.ap.push_back(T(dualValue(val)));
+    return out;
+}
+
+/**
+ * @brief dsTangent - the value with the derivatives of the linearization at it
+ */
+static inline double dsTangent(double value, double) {return value;}
+template<int32_t N> static inline Dual<N> dsTangent(double value, const Dual<N> &lin) {return lin.dChain(value, 1.);}
+
+/**
+ * @brief dsLogSlope - derivatives of ln|T| and of the phase in degree along ln(omega)
+ */
+static void dsLogSlope(const BodeFactors &bf, double omega, double &lnm_slope, double &phs_slope)
+{
+    typedef Dual<1> DsOmega;
+    DsOmega lnm, phs;
+    lmLogMagPhase(dsFactorsOn<DsOmega>(bf), exp(DsOmega::dVar(std::log(omega), 0)), lnm, phs);
+    lnm_slope = lnm.der[0];
+    phs_slope = phs.der[0];
+}
+
+template<typename T>
+void dsLoopMargins(const BodeFactorsT<T> &loop, double freq_begin, double freq_end,
+                   T &freq_cross, T &phase_marg, T &gain_marg)
+{
+    const BodeFactors bf = dsFactorsOn<double>(loop);
+    const LoopMargins lm = lmSolveMargins(bf, freq_begin, freq_end);
+    freq_cross = phase_marg = gain_marg = T(0.);
+
+    /** At the root ln|T| is zero, the step of the linearization is the change of ln(omega) */
+    if(lm.has_cross)
+    {
+        const double omega = 2*M_PI*lm.freq_cross;
+        double lnm_slope, phs_slope;
+        dsLogSlope(bf, omega, lnm_slope, phs_slope);
+        T lnm, phs;
+        lmLogMagPhase(loop, T(omega), lnm, phs);
+        const T ustep = -lnm / lnm_slope;
+        freq_cross = dsTangent(lm.freq_cross, lm.freq_cross * ustep);
+        phase_marg = dsTangent(lm.phase_marg, phs + phs_slope * ustep);
+    }
+    if(lm.has_180)
+    {
+        const double omega = 2*M_PI*lm.freq_180;
+        double lnm_slope, phs_slope;
+        dsLogSlope(bf, omega, lnm_slope, phs_slope);
+        T lnm, phs;
+        lmLogMagPhase(loop, T(omega), lnm, phs);
+        const T ustep = -phs / phs_slope;
+        gain_marg = dsTangent(lm.gain_marg, -LM_DB_COEFF * (lnm + lnm_slope * ustep));
+    }
+}
+
+template void dsLoopMargins<double>(const BodeFactors&, double, double, double&, double&, double&);
+template void dsLoopMargins<DsScalar>(const BodeFactorsT<DsScalar>&, double, double, DsScalar&, DsScalar&, DsScalar&);
+
+template<typename T>
+void dsPipeline(const DsModel &model, const T in[DS_INPUT_NUM], T out[DS_OUTPUT_NUM])
+{
+    /** The steps and the storage types follow PowSuppSolve, the double instantiation gives its values */
+    const int16_t freq_line = static_cast<int16_t>(dualValue(in[DS_FREQ_LINE]));
+    const T eff = dualStore<float>(in[DS_EFF]);
+
+    /**< 1. Input network */
+    BulkCapT<T> b_cap(in[DS_VAC_MAX], in[DS_VAC_MIN], eff, dualStore<float>(in[DS_POUT]), in[DS_FREQ_LINE]);
+    T bcap_value = b_cap.CapValue();
+    T vdc_min = b_cap.VDCMin();
+
+    /**< 2. Primary side */
+    FBPTPrimaryT<T> t_prim(dualStore<float>(in[DS_RIPPLE_FACT]), in[DS_REFL_VOLT], in[DS_POUT], eff, in[DS_FREQ_SWITCH]);
+    t_prim.setInputVoltage(in[DS_VAC_MIN], t_prim.InputPower(), freq_line, bcap_value, b_cap.DeltaT());
+    T prim_ind = t_prim.PriInduct();
+    T curr_peak_peak = t_prim.CurrPriPeakToPeak();
+    T curr_peak = t_prim.CurrPriMax();
+    T curr_rms = t_prim.CurrPriRMS();
+
+    /**< 3. Core and the actual values, the turns are the counts of the nominal design */
+    CoreArea ca = model.ca;
+    CoreSelection cs = model.cs;
+    MechDimension md = model.md;
+    FBPT_SHAPE_AIR_GAP fsag = model.fsag;
+    FBPTCoreT<T> core(ca, prim_ind, curr_peak, curr_rms, curr_peak_peak, in[DS_POUT]);
+    auto num_prim = static_cast<uint32_t>(dualValue(core.numPrimary(cs, model.fns)));
+    T ag_length = core.agLength(cs, num_prim);
+    auto act_num_prim = static_cast<uint32_t>(core.actNumPrimary(cs, fsag, md, num_prim, prim_ind, curr_peak));
+    T flux_peak = core.actMagneticFluxPeak(cs, act_num_prim, curr_peak, ag_length);
+    T duty_max = core.actDutyCycle(model.out_vlcr, vdc_min, in[DS_FREQ_SWITCH], prim_ind);
+    T volt_refl = core.actReflVoltage(duty_max, dualStore<float>(in[DS_POUT]), prim_ind, in[DS_FREQ_SWITCH]);
+
+    /**< 4. Switch network */
+    SwMosfetT<T> sw_mos(dualStore<uint16_t>(in[DS_VAC_MAX] * M_SQRT2), in[DS_VOLT_SPIKE], in[DS_FREQ_SWITCH],
+                        volt_refl, prim_ind, curr_peak_peak);
+    sw_mos.setCurrValues(curr_rms, curr_peak);
+
+    /**< 5. Output capacitor of the first output */
+    CapOutProp cop = model.cop;
+    CapOutT<T> c_out(cop);
+    float trn_rat = (act_num_prim != 0 && model.num_sec != 0)
+            ? static_cast<float>(static_cast<double>(model.num_sec) / act_num_prim) : 0.f;
+    T cap_rms = dualStore<float>(c_out.ocCurrOurRMS(curr_peak, trn_rat));
+
+    /**< 6. Loop, the power stage of the chain with the compensator and the output filter,
+     *       the stage is compiled from the stored values without the storage types */
+    T freq_cross(0.), phase_marg(0.), gain_marg(0.);
+    if(model.has_loop)
+    {
+        const T n_frst = duty_max/((1 - duty_max)*(model.ssm.output_voltage/(M_SQRT2*dualStore<int16_t>(in[DS_VAC_MIN]))));
+        const T turn_ratio = dualStore<float>(act_num_prim/n_frst);
+        const T res_sense = dualStore<float>(sw_mos.csCurrRes(model.ccsp));
+
+        SSMPreDesignT<T> stage;
+        stage.input_voltage = dualStore<int16_t>(in[DS_VAC_MAX]);
+        stage.freq_switch = dualStore<int32_t>(in[DS_FREQ_SWITCH]);
+        stage.actual_duty = dualStore<float>(duty_max);
+        stage.primary_ind = prim_ind;
+        stage.res_sense = res_sense;
+        stage.output_voltage = model.ssm.output_voltage;
+        stage.output_full_load_res = model.ssm.output_full_load_res;
+        stage.turn_ratio = turn_ratio;
+        stage.output_cap = model.ssm.output_cap;
+        stage.output_cap_esr = model.ssm.output_cap_esr;
+        stage.sawvolt = 0.5 * (model.volt_ramp/(turn_ratio * prim_ind) * res_sense);
+
+        SSMModelT<T, SSMPreDesignT<T>> ssm(stage);
+        BodeFactorsT<T> loop = ssm.coFactors(ssm.coCompile(model.mode), model.mode);
+        loop.bfAppend(dsFactorsOn<T>(model.loop_rest));
+        dsLoopMargins(loop, model.freq_begin, model.freq_end, freq_cross, phase_marg, gain_marg);
+    }
+
+    out[DS_CAP_BULK] = bcap_value;
+    out[DS_VDC_MIN] = vdc_min;
+    out[DS_PRIM_IND] = prim_ind;
+    out[DS_CURR_PEAK] = curr_peak;
+    out[DS_CURR_RMS] = curr_rms;
+    out[DS_FLUX_PEAK] = flux_peak;
+    out[DS_DUTY_MAX] = duty_max;
+    out[DS_VOLT_REFL] = volt_refl;
+    out[DS_MOS_VOLT] = sw_mos.swMosfetVoltageMax();
+    out[DS_MOS_COND] = sw_mos.swMosfetConductLoss(model.mospr);
+    out[DS_MOS_SWITCH] = sw_mos.swMosfetSwitchLoss(model.mospr);
+    out[DS_MOS_TOTAL] = sw_mos.swMosfetTotalLoss(model.mospr);
+    out[DS_SNUB_DISS] = sw_mos.clPowerDiss(model.ccsp);
+    out[DS_SENSE_LOSS] = sw_mos.csCurrResLoss(model.ccsp);
+    out[DS_CAP_OUT_LOSS] = c_out.ocCapOutLoss(cap_rms);
+    out[DS_FREQ_CROSS] = freq_cross;
+    out[DS_PHASE_MARG] = phase_marg;
+    out[DS_GAIN_MARG] = gain_marg;
+}
+
+template void dsPipeline<double>(const DsModel&, const double[DS_INPUT_NUM], double[DS_OUTPUT_NUM]);
+template void dsPipeline<DsScalar>(const DsModel&, const DsScalar[DS_INPUT_NUM], DsScalar[DS_OUTPUT_NUM]);
+
+DsResult dsRun(const DsModel &model)
+{
+    DsScalar in[DS_INPUT_NUM];
+    DsScalar out[DS_OUTPUT_NUM];
+    for(int32_t indx = 0; indx < DS_INPUT_NUM; ++indx)
+        in[indx] = DsScalar::dVar(model.input[indx], indx);
+
+    dsPipeline(model, in, out);
+
+    DsResult res;
+    for(int32_t indx = 0; indx < DS_INPUT_NUM; ++indx)
+        res.input[indx] = model.input[indx];
+    for(int32_t row = 0; row < DS_OUTPUT_NUM; ++row)
+    {
+        res.value[row] = out[row].val;
+        for(int32_t col = 0; col < DS_INPUT_NUM; ++col)
+            res.grad[row][col] = out[row].der[col];
+    }
+    return res;
+}
+
+const char *dsInputName(int32_t in)
+{
+    static const char *name[DS_INPUT_NUM] =
+    {
+        "Vac max", "Vac min", "f line", "f sw", "Eff", "Pout", "Vro max", "Vspike", "Krf"
+    };
+    return (in >= 0 && in < DS_INPUT_NUM) ? name[in] : "";
+}
+
+const char *dsOutputName(int32_t out)
+{
+    static const char *name[DS_OUTPUT_NUM] =
+    {
+        "C bulk", "Vdc min", "Lp", "Ipk", "Irms", "Bpk", "D max", "Vro", "Vds max",
+        "P cond", "P sw", "P fet", "P snub", "P sense", "P cout", "fc", "PM", "GM"
+    };
+    return (out >= 0 && out < DS_OUTPUT_NUM) ? name[out] : "";
+}
@@ -0,0 +1,337 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/discretize.h"
+#include "inc/statespace.h"
+#include <algorithm>
+#include <cmath>
+
+typedef TransferFunction::Root Root;
+
+/**
+ * @brief The DzGroup struct - roots of one section, the real ones or the complex pair
+ */
+struct DzGroup
+{
+    Root root[2];
+    int32_t num;
+    int32_t zeros; //Zeros placed to the section of the pole group
+};
+
+/**
+ * @brief dzGroups - complex pairs and the real roots paired in the order of their magnitude,
+ *        the roots closest to the unit circle first
+ */
+static QVector<DzGroup> dzGroups(const QVector<Root> &roots)
+{
+    QVector<DzGroup> out;
+    QVector<Root> real;
+    for(const Root &rt : roots)
+    {
+        if(rt.imag() > 0.)
+            out.push_back({{rt, std::conj(rt)}, 2, 0});
+        else if(rt.imag() == 0.)
+            real.push_back(rt);
+    }
+    std::sort(real.begin(), real.end(), [](const Root &lhs, const Root &rhs){return std::abs(lhs) > std::abs(rhs);});
+    for(int32_t indx = 0; indx < real.size(); indx += 2)
+    {
+        if(indx + 1 < real.size())
+            out.push_back({{real[indx], real[indx+1]}, 2, 0});
+        else
+            out.push_back({{real[indx], Root()}, 1, 0});
+    }
+    std::stable_sort(out.begin(), out.end(), [](const DzGroup &lhs, const DzGroup &rhs)
+    {
+        return std::abs(lhs.root[0]) > std::abs(rhs.root[0]);
+    });
+    return out;
+}
+
+/**
+ * @brief dzMonic - coefficients of prod(z - r) in descending power of z
+ */
+static void dzMonic(const Root *root, int32_t num, double *poly)
+{
+    poly[0] = 1.;
+    if(num == 1)
+    {
+        poly[1] = -root[0].real();
+    }
+    else if(num == 2)
+    {
+        poly[1] = -(root[0] + root[1]).real();
+        poly[2] = (root[0] * root[1]).real();
+    }
+}
+
+/**
+ * @brief dzSections - the pole groups take the zeros closest to them, the complex zero pairs first,
+ *        the section with less zeros than poles gets the leading zeros of the numerator
+ */
+static QVector<DzSection> dzSections(const QVector<Root> &zeros, const QVector<Root> &poles)
+{
+    QVector<DzGroup> pgrp = dzGroups(poles);
+    QVector<QVector<Root>> zsect(pgrp.size());
+    auto place = [&pgrp, &zsect](const Root &zr, int32_t need)
+    {
+        int32_t best = -1;
+        double dist = 0.;
+        for(int32_t indx = 0; indx < pgrp.size(); ++indx)
+        {
+            if(pgrp[indx].num - pgrp[indx].zeros < need)
+                continue;
+            const double dd = std::abs(zr - pgrp[indx].root[0]);
+            if(best < 0 || dd < dist)
+            {
+                best = indx;
+                dist = dd;
+            }
+        }
+        if(best < 0)
+            return;
+        pgrp[best].zeros += need;
+        zsect[best].push_back(zr);
+        if(need == 2)
+            zsect[best].push_back(std::conj(zr));
+    };
+    for(const Root &zr : zeros)
+    {
+        if(zr.imag() > 0.)
+            place(zr, 2);
+    }
+    for(const Root &zr : zeros)
+    {
+        if(zr.imag() == 0.)
+            place(zr, 1);
+    }
+
+    QVector<DzSection> out(pgrp.size());
+    for(int32_t indx = 0; indx < pgrp.size(); ++indx)
+    {
+        double den[3] = {1., 0., 0.}, num[3] = {1., 0., 0.};
+        dzMonic(pgrp[indx].root, pgrp[indx].num, den);
+        dzMonic(zsect[indx].constData(), zsect[indx].size(), num);
+        const int32_t lead = pgrp[indx].num - zsect[indx].size();
+        for(int32_t cf = 0; cf + lead < 3; ++cf)
+        {
+            out[indx].b[cf + lead] = num[cf];
+        }
+        out[indx].a[1] = den[1];
+        out[indx].a[2] = den[2];
+    }
+    return out;
+}
+
+/**
+ * @brief dzZohZeros - zeros and gain of the zero order hold equivalent, the numerator is taken
+ *        from the step response at the samples, which the hold reproduces exactly
+ * @return false for the response without the realization
+ */
+static bool dzZohZeros(const TransferFunction &tf, const QVector<Root> &zpoles, double tsmp,
+                       QVector<Root> &zeros, double &gain)
+{
+    StateSpace ss(tf);
+    if(!ss.ssValid())
+        return false;
+    ss.ssDiscretize(tsmp);
+    const int32_t deg = zpoles.size();
+    QVector<double> step(deg + 1);
+    ss.ssStep(1., step.data(), deg + 1);
+
+    /** Denominator in z^{-1}, then b = d * h with the impulse response h of the step differences */
+    QVector<Root> den(deg + 1, Root());
+    den[0] = 1.;
+    for(int32_t pl = 0; pl < deg; ++pl)
+    {
+        for(int32_t cf = pl + 1; cf > 0; --cf)
+            den[cf] -= zpoles[pl] * den[cf - 1];
+    }
+    QVector<double> num(deg + 1, 0.);
+    double scale = 0.;
+    for(int32_t cf = 0; cf <= deg; ++cf)
+    {
+        for(int32_t indx = 0; indx <= cf; ++indx)
+        {
+            const double imp = step[cf - indx] - ((cf - indx > 0) ? step[cf - indx - 1] : 0.);
+            num[cf] += den[indx].real() * imp;
+        }
+        scale = qMax(scale, std::abs(num[cf]));
+    }
+    if(!(scale > 0.))
+        return false;
+
+    /** The leading zeros are the delay of the strictly proper response, the trailing ones the zeros at origin */
+    const double tol = scale * 1E-12;
+    int32_t first = 0, last = deg;
+    while(std::abs(num[first]) <= tol)
+        ++first;
+    while(std::abs(num[last]) <= tol)
+        --last;
+    gain = num[first];
+    zeros.fill(Root(), deg - last);
+    if(last > first)
+    {
+        /** N(z) in ascending power of z is the reversed b */
+        QVector<double> poly;
+        for(int32_t cf = last; cf >= first; --cf)
+            poly.push_back(num[cf] / gain);
+        zeros += TransferFunction::tfRoots(poly);
+    }
+    return true;
+}
+
+DzFilter dzDiscretize(const TransferFunction &tf, DZ_METHOD method, double freq_smp, double freq_warp)
+{
+    DzFilter out;
+    out.freq_smp = freq_smp;
+    QVector<Root> czeros = tf.tfZeros(), cpoles = tf.tfPoles();
+    czeros.insert(0, qMax(tf.tfOrder(), 0), Root());
+    cpoles.insert(0, qMax(-tf.tfOrder(), 0), Root());
+    if(!(freq_smp > 0.) || czeros.size() > cpoles.size())
+        return out;
+
+    const double tsmp = 1. / freq_smp;
+    const double omega_nyq = M_PI * freq_smp;
+    double omega = 2*M_PI * freq_warp;
+    double kbil = 2. / tsmp;
+    if(omega > 0. && omega < DZ_PREWARP_MAX * omega_nyq)
+        kbil = omega / std::tan(0.5 * omega * tsmp);
+    else
+        omega = 0.1 * omega_nyq;
+
+    QVector<Root> zzeros, zpoles;
+    for(const Root &pl : cpoles)
+    {
+        zpoles.push_back((method == DZ_TUSTIN) ? (kbil + pl) / (kbil - pl) : std::exp(pl * tsmp));
+    }
+    if(method == DZ_ZOH)
+    {
+        if(dzZohZeros(tf, zpoles, tsmp, zzeros, out.gain))
+            out.sect = dzSections(zzeros, zpoles);
+        return out;
+    }
+
+    for(const Root &zr : czeros)
+    {
+        zzeros.push_back((method == DZ_TUSTIN) ? (kbil + zr) / (kbil - zr) : std::exp(zr * tsmp));
+    }
+    zzeros.insert(zzeros.size(), cpoles.size() - czeros.size(), Root(-1., 0.));
+    out.sect = dzSections(zzeros, zpoles);
+
+    /** Tustin is exact at the prewarp frequency, the matched roots take their gain there */
+    out.gain = 1.;
+    const std::complex<double> ratio = tf.tfEval(omega) / out.dzEval(omega);
+    out.gain = std::abs(ratio) * ((ratio.real() < 0.) ? -1. : 1.);
+    return out;
+}
+
+std::complex<double> DzFilter::dzEval(double omega) const
+{
+    const std::complex<double> zinv = std::polar(1., -omega / freq_smp);
+    const std::complex<double> zinv2 = zinv * zinv;
+    std::complex<double> out(gain, 0.);
+    for(const DzSection &sc : sect)
+    {
+        out *= (sc.b[0] + sc.b[1] * zinv + sc.b[2] * zinv2) / (1. + sc.a[1] * zinv + sc.a[2] * zinv2);
+    }
+    return out;
+}
+
+double DzFilter::dzPoleRadius() const
+{
+    double out = 0.;
+    for(const DzSection &sc : sect)
+    {
+        /** Roots of z^2 + a1 z + a2, the complex pair has the radius sqrt(a2) */
+        const double disc = sc.a[1] * sc.a[1] - 4. * sc.a[2];
+        if(disc < 0.)
+        {
+            out = qMax(out, std::sqrt(sc.a[2]));
+        }
+        else
+        {
+            const double sq = std::sqrt(disc);
+            out = qMax(out, qMax(std::abs(-sc.a[1] + sq), std::abs(-sc.a[1] - sq)) / 2.);
+        }
+    }
+    return out;
+}
+
+DzQuantized dzQuantize(const DzFilter &filt, DzQFormat fmt)
+{
+    DzQuantized out;
+    fmt.int_bits = qBound(0, fmt.int_bits, DZ_WORD_BITS_MAX);
+    fmt.frac_bits = qBound(0, fmt.frac_bits, DZ_WORD_BITS_MAX - fmt.int_bits);
+    out.fmt = fmt;
+    out.filt.freq_smp = filt.freq_smp;
+
+    const double scale = std::ldexp(1., fmt.frac_bits);
+    const double qmax = std::ldexp(1., fmt.int_bits + fmt.frac_bits) - 1.;
+    const double qmin = -std::ldexp(1., fmt.int_bits + fmt.frac_bits);
+    auto quant = [&](double val, double &stored)
+    {
+        double qv = std::round(val * scale);
+        if(qv > qmax || qv < qmin)
+        {
+            out.saturated = true;
+            qv = qBound(qmin, qv, qmax);
+        }
+        stored = qv / scale;
+        return static_cast<int32_t>(qv);
+    };
+
+    for(const DzSection &sc : filt.sect)
+    {
+        DzSection qs;
+        out.coeff.push_back(quant(sc.b[0], qs.b[0]));
+        out.coeff.push_back(quant(sc.b[1], qs.b[1]));
+        out.coeff.push_back(quant(sc.b[2], qs.b[2]));
+        out.coeff.push_back(quant(sc.a[1], qs.a[1]));
+        out.coeff.push_back(quant(sc.a[2], qs.a[2]));
+        out.filt.sect.push_back(qs);
+    }
+
+    /** The gain mantissa is kept in [2^{m-1}, 2^m), the rounding up to 2^m moves it to the next exponent */
+    out.filt.gain = 0.;
+    if(filt.gain == 0. || !qIsFinite(filt.gain))
+        return out;
+    out.gain_shift = std::ilogb(filt.gain) - fmt.int_bits + 1;
+    double mant = std::round(std::ldexp(filt.gain, fmt.frac_bits - out.gain_shift));
+    if(std::abs(mant) > qmax)
+    {
+        ++out.gain_shift;
+        mant = std::round(std::ldexp(filt.gain, fmt.frac_bits - out.gain_shift));
+    }
+    out.gain_mant = static_cast<int32_t>(mant);
+    out.filt.gain = std::ldexp(mant, out.gain_shift - fmt.frac_bits);
+    return out;
+}
+
+void dzSweep(const std::function<std::complex<double>(double)> &resp, SweepBuffer &buf)
+{
+    const int32_t num = buf.sbSize();
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        const std::complex<double> val = resp(2*M_PI * buf.sbFreq()[indx]);
+        buf.sbMag()[indx] = 10. * std::log10(std::norm(val));
+        buf.sbPhase()[indx] = (180./M_PI) * std::arg(val);
+    }
+    bkUnwrapPhase(buf.sbPhase(), num);
+}
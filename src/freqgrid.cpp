@@ -0,0 +1,118 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/freqgrid.h"
+#include <algorithm>
+
+FreqGrid::FreqGrid(double begin, double end, int32_t ppd)
+    :m_begin(begin)
+    ,m_end(end)
+    ,m_ppd(ppd)
+{}
+
+void FreqGrid::fgAddBand(double freq, double span, double density)
+{
+    if(!qIsFinite(freq) || freq <= 0.)
+        return;
+    if(freq*span < m_begin || freq/span > m_end)
+        return;
+    m_feat.push_back({freq, span, qMin(density, static_cast<double>(FG_MAX_DENSITY))});
+}
+
+void FreqGrid::fgAddCorner(double freq)
+{
+    fgAddBand(qAbs(freq), FG_CORNER_SPAN, m_ppd * FG_CORNER_REFINE);
+}
+
+void FreqGrid::fgAddResonance(double freq, double qual)
+{
+    qual = qAbs(qual);
+    if(qual <= 0.5 || !qIsFinite(qual))
+    {
+        fgAddCorner(freq);
+        return;
+    }
+    /** The -3dB band of the pair is f0/Q wide, take the triple of it */
+    double span = 1. + 3./(2. * qual);
+    double density = FG_RES_POINTS / (2. * std::log10(span));
+    fgAddBand(qAbs(freq), span, qMax(density, static_cast<double>(m_ppd * FG_CORNER_REFINE)));
+    /** The skirts of the resonance are treated as usual corner */
+    fgAddCorner(freq);
+}
+
+void FreqGrid::fgAddCrossover(double freq)
+{
+    fgAddBand(qAbs(freq), FG_CROSS_SPAN, m_ppd * FG_CROSS_REFINE);
+}
+
+QVector<double> FreqGrid::fgBuild() const
+{
+    QVector<double> out = fgLogSpace(m_begin, m_end, m_ppd);
+
+    /**
+     * The base grid and each band are ascending already, the band is merged
+     * into the grid in linear time instead of sorting all points again,
+     * the grid is rebuilt on every tweak of the component value.
+     */
+    for(const Feature &ft : m_feat)
+    {
+        double lo = qMax(ft.freq/ft.span, m_begin);
+        double hi = qMin(ft.freq*ft.span, m_end);
+        double ldec = std::log10(hi/lo);
+        int32_t num = qMax(static_cast<int32_t>(std::ceil(ldec * ft.density)), 1);
+        double step = qPow(10., ldec / num);
+        int32_t mid = out.size();
+        double freq = lo;
+        for(int32_t indx = 0; indx <= num; ++indx)
+        {
+            out.push_back(freq);
+            freq *= step;
+        }
+        std::inplace_merge(out.begin(), out.begin() + mid, out.end());
+    }
+
+    /** Drop coincident points of the overlapped bands */
+    auto last = std::unique(out.begin(), out.end(), [](double a, double b)
+    {
+        return (b - a) <= a * 1E-9;
+    });
+    out.erase(last, out.end());
+    return out;
+}
+
+QVector<double> FreqGrid::fgLogSpace(double begin, double end, int32_t ppd)
+{
+    QVector<double> out;
+    if(begin <= 0. || end <= begin)
+        return out;
+
+    /** The recurrence drifts by the ulp per point, far below the point spacing */
+    double ldec = std::log10(end/begin);
+    int32_t num = static_cast<int32_t>(std::ceil(ldec * ppd));
+    double step = qPow(10., ldec / num);
+    double freq = begin;
+    out.reserve(num + 1);
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        out.push_back(freq);
+        freq *= step;
+    }
+    out.push_back(end);
+    return out;
+}
@@ -0,0 +1,354 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/lcfilter.h"
+#include "inc/poolrunner.h"
+#include <limits>
+
+#define LF_DEG_COEFF    (180./M_PI)
+#define LF_GOLDEN       0.6180339887498949 //Golden section ratio
+#define LF_RANGE_SPAN   30.   //Evaluated range, the resonance and crossover over it to the switching frequency times it
+
+typedef std::complex<double> LfComplex;
+
+/** Multipliers of sqrt(L/C) swept as R_d, zero is the filter without the damping leg */
+static const double s_damp_mul[] = {0., 0.35, 0.6, 1., 1.7};
+static const int32_t s_damp_num = sizeof(s_damp_mul)/sizeof(s_damp_mul[0]);
+
+LfComplex lfResponse(const LfFilter &flt, double omega, LfComplex *zout)
+{
+    const LfComplex jw(0., omega);
+    LfComplex a(1., 0.), b(0., 0.), c(0., 0.), d(1., 0.), tmp;
+    for(const LfStage &st : flt.stage)
+    {
+        /** [A B; C D] * [1 Z; 0 1] */
+        const LfComplex zs = st.ind_res + jw * st.ind;
+        b = a * zs + b;
+        d = c * zs + d;
+
+        /** [A B; C D] * [1 0; Y 1] */
+        LfComplex ysh = 1. / (st.cap_esr + jw * st.cap_esl + 1. / (jw * st.cap));
+        if(st.damp_res > 0.)
+            ysh += 1. / (st.damp_res + 1. / (jw * st.damp_cap));
+        a = a + b * ysh;
+        c = c + d * ysh;
+    }
+    if(zout != nullptr)
+        *zout = (d * flt.src_res + b) / (c * flt.src_res + a);
+    return 1. / (a + b / flt.load_res + flt.src_res * (c + d / flt.load_res));
+}
+
+/**
+ * @brief lfDcGain - the capacitors and the damping legs are open at dc
+ */
+static double lfDcGain(const LfFilter &flt)
+{
+    double res = flt.src_res;
+    for(const LfStage &st : flt.stage)
+    {
+        res += st.ind_res;
+    }
+    return flt.load_res / (flt.load_res + res);
+}
+
+/**
+ * @brief lfPeak - the highest value of the function of log10(f) on the grid,
+ *        refined by the golden section between the neighbours of the grid maximum
+ */
+template<typename F>
+static double lfPeak(const QVector<double> &freq, F func, double &freq_peak)
+{
+    int32_t top = 0;
+    double best = -std::numeric_limits<double>::infinity();
+    for(int32_t indx = 0; indx < freq.size(); ++indx)
+    {
+        const double val = func(freq[indx]);
+        if(val > best)
+        {
+            best = val;
+            top = indx;
+        }
+    }
+    freq_peak = freq.isEmpty() ? 0. : freq[top];
+    if(top == 0 || top == freq.size() - 1)
+        return best;
+
+    double lo = std::log10(freq[top - 1]), hi = std::log10(freq[top + 1]);
+    double x1 = hi - LF_GOLDEN * (hi - lo), x2 = lo + LF_GOLDEN * (hi - lo);
+    double f1 = func(qPow(10., x1)), f2 = func(qPow(10., x2));
+    for(int32_t iter = 0; iter < LF_PEAK_ITER; ++iter)
+    {
+        if(f1 > f2)
+        {
+            hi = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = hi - LF_GOLDEN * (hi - lo);
+            f1 = func(qPow(10., x1));
+        }
+        else
+        {
+            lo = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = lo + LF_GOLDEN * (hi - lo);
+            f2 = func(qPow(10., x2));
+        }
+    }
+    const double xm = 0.5 * (lo + hi);
+    const double fm = func(qPow(10., xm));
+    if(fm > best)
+    {
+        best = fm;
+        freq_peak = qPow(10., xm);
+    }
+    return best;
+}
+
+LfMetrics lfMetrics(const LfFilter &flt, double freq_switch, double freq_cross)
+{
+    LfMetrics met;
+    if(flt.stage.isEmpty())
+        return met;
+
+    /** The range covers the resonances of all stages, the crossover and the switching frequency */
+    double fmin = freq_cross, fmax = freq_switch;
+    for(const LfStage &st : flt.stage)
+    {
+        const double fres = 1. / (2 * M_PI * qSqrt(st.ind * st.cap));
+        fmin = qMin(fmin, fres);
+        fmax = qMax(fmax, fres);
+    }
+    const QVector<double> freq = FreqGrid::fgLogSpace(fmin / LF_RANGE_SPAN, fmax * LF_RANGE_SPAN, LF_EVAL_PPD);
+    const double gain_dc = lfDcGain(flt);
+
+    double peak = lfPeak(freq, [&flt](double fr){return std::abs(lfResponse(flt, 2 * M_PI * fr));}, met.freq_peak);
+    met.peak_db = qMax(0., 20. * std::log10(peak / gain_dc));
+    double freq_zout = 0.;
+    met.zout_peak = lfPeak(freq, [&flt](double fr)
+    {
+        LfComplex zout;
+        lfResponse(flt, 2 * M_PI * fr, &zout);
+        return std::abs(zout);
+    }, freq_zout);
+
+    met.atten_sw = -20. * std::log10(std::abs(lfResponse(flt, 2 * M_PI * freq_switch)) / gain_dc);
+    const LfComplex hc = lfResponse(flt, 2 * M_PI * freq_cross);
+    met.mag_cross = 20. * std::log10(std::abs(hc) / gain_dc);
+    met.phase_cross = LF_DEG_COEFF * std::arg(hc);
+    return met;
+}
+
+/** Polynomials in ascending power of s */
+static QVector<double> lfPolyMul(const QVector<double> &lhs, const QVector<double> &rhs)
+{
+    QVector<double> out(lhs.size() + rhs.size() - 1, 0.);
+    for(int32_t il = 0; il < lhs.size(); ++il)
+    {
+        for(int32_t ir = 0; ir < rhs.size(); ++ir)
+        {
+            out[il + ir] += lhs[il] * rhs[ir];
+        }
+    }
+    return out;
+}
+
+static QVector<double> lfPolyAdd(const QVector<double> &lhs, const QVector<double> &rhs, double scl = 1.)
+{
+    QVector<double> out(qMax(lhs.size(), rhs.size()), 0.);
+    for(int32_t indx = 0; indx < lhs.size(); ++indx)
+    {
+        out[indx] += lhs[indx];
+    }
+    for(int32_t indx = 0; indx < rhs.size(); ++indx)
+    {
+        out[indx] += scl * rhs[indx];
+    }
+    return out;
+}
+
+static QVector<double> lfPolyTrim(QVector<double> poly)
+{
+    while(poly.size() > 1 && poly.last() == 0.)
+    {
+        poly.removeLast();
+    }
+    return poly;
+}
+
+TransferFunction lfTransfFunc(const LfFilter &flt)
+{
+    /**
+     * The entries share the denominator, each shunt Y = Yn/Yd multiplies it by Yd.
+     * The common denominator is the numerator of H, its roots are known from the
+     * stages and kept factored, the identical stages give the multiple roots.
+     */
+    TransferFunction num(flt.load_res);
+    QVector<double> a{1.}, b{0.}, c{0.}, d{1.};
+    for(const LfStage &st : flt.stage)
+    {
+        const QVector<double> zs{st.ind_res, st.ind};
+        b = lfPolyAdd(lfPolyMul(a, zs), b);
+        d = lfPolyAdd(lfPolyMul(c, zs), d);
+
+        /** Y_{C} = sC/(1 + sC*ESR + s^2*C*ESL), Y_{d} = sC_{d}/(1 + sR_{d}C_{d}) */
+        const QVector<double> ycd{1., st.cap * st.cap_esr, st.cap * st.cap_esl};
+        QVector<double> yn{0., st.cap}, yd = ycd;
+        if(st.damp_res > 0.)
+        {
+            const QVector<double> ydd{1., st.damp_res * st.damp_cap};
+            yn = lfPolyAdd(lfPolyMul(yn, ydd), lfPolyMul(QVector<double>{0., st.damp_cap}, ycd));
+            yd = lfPolyMul(ycd, ydd);
+            num.tfAddZero(1. / (st.damp_res * st.damp_cap));
+        }
+        num.tfAddZeroQuad(ycd[1], ycd[2]);
+        a = lfPolyAdd(lfPolyMul(a, yd), lfPolyMul(b, yn));
+        c = lfPolyAdd(lfPolyMul(c, yd), lfPolyMul(d, yn));
+        b = lfPolyMul(b, yd);
+        d = lfPolyMul(d, yd);
+    }
+
+    /** H = R_{L}*den/(A*R_{L} + B + R_{s}*R_{L}*C + R_{s}*D) */
+    const double rl = flt.load_res, rs = flt.src_res;
+    QVector<double> dnm = lfPolyAdd(lfPolyAdd(lfPolyMul(a, QVector<double>{rl}), b),
+                                    lfPolyAdd(lfPolyMul(c, QVector<double>{rs * rl}), d, rs));
+    return (num * TransferFunction::tfFromPoly(1., 0, QVector<double>{1.}, lfPolyTrim(dnm))).tfCancel();
+}
+
+void lfFillFreqGrid(const TransferFunction &tf, FreqGrid &grid)
+{
+    for(const TransferFunction::Root &pl : tf.tfPoles())
+    {
+        /** The conjugate of the complex pole is registered once */
+        if(pl.imag() < 0.)
+            continue;
+        const double omega = std::abs(pl);
+        if(pl.imag() == 0.)
+            grid.fgAddCorner(omega / (2 * M_PI));
+        else
+            grid.fgAddResonance(omega / (2 * M_PI), omega / (2. * qAbs(pl.real())));
+    }
+}
+
+LfFilter lfBuild(const LfSpec &spec, double ind, double cap, double damp_res)
+{
+    LfStage st = spec.nominal;
+    st.ind = ind;
+    st.cap = cap;
+    st.damp_res = damp_res;
+    st.damp_cap = (damp_res > 0.) ? LF_DAMP_CAP_RATIO * cap : 0.;
+
+    LfFilter out;
+    out.stage = QVector<LfStage>(qBound(1, spec.stages, LF_MAX_STAGES), st);
+    out.src_res = spec.src_res;
+    out.load_res = spec.load_res;
+    return out;
+}
+
+/**
+ * @brief The LfJob struct - slices of the candidates shared by the workers
+ */
+struct LfJob
+{
+    const LfSpec *spec;
+    LfCandidate *cand;
+    int32_t num;
+    PoolSlices slices;
+
+    void prRunSlices()
+    {
+        int32_t chunk;
+        while(slices.prTake(chunk))
+        {
+            const int32_t end = qMin((chunk + 1) * LF_CHUNK, num);
+            for(int32_t indx = chunk * LF_CHUNK; indx < end; ++indx)
+            {
+                LfCandidate &cd = cand[indx];
+                cd.met = lfMetrics(lfBuild(*spec, cd.ind, cd.cap, cd.damp_res), spec->freq_switch, spec->freq_cross);
+                cd.feasible = (cd.met.atten_sw >= spec->atten_min)
+                        && (cd.met.peak_db <= spec->peak_max)
+                        && (-cd.met.phase_cross <= spec->phase_max);
+                /** The damping capacitor is counted with the filter capacitor */
+                const double cap_tot = cd.cap * ((cd.damp_res > 0.) ? 1. + LF_DAMP_CAP_RATIO : 1.);
+                cd.cost = cd.ind / spec->nominal.ind + cap_tot / spec->nominal.cap;
+            }
+        }
+    }
+};
+
+LfSweepResult lfSweep(const LfSpec &spec)
+{
+    LfSweepResult out;
+    if(spec.nominal.ind <= 0. || spec.nominal.cap <= 0. || spec.load_res <= 0.)
+        return out;
+
+    /** Scales nominal/span..nominal*span with the equal ratio of the steps */
+    QVector<double> scl(LF_SWEEP_STEPS);
+    for(int32_t indx = 0; indx < LF_SWEEP_STEPS; ++indx)
+    {
+        scl[indx] = qPow(LF_SWEEP_SPAN, 2. * indx / (LF_SWEEP_STEPS - 1) - 1.);
+    }
+    out.cand.reserve(LF_SWEEP_STEPS * LF_SWEEP_STEPS * s_damp_num);
+    for(double sl : scl)
+    {
+        for(double sc : scl)
+        {
+            const double ind = spec.nominal.ind * sl;
+            const double cap = spec.nominal.cap * sc;
+            for(int32_t dm = 0; dm < s_damp_num; ++dm)
+            {
+                LfCandidate cd;
+                cd.ind = ind;
+                cd.cap = cap;
+                cd.damp_res = s_damp_mul[dm] * qSqrt(ind / cap);
+                cd.feasible = false;
+                cd.cost = 0.;
+                out.cand.push_back(cd);
+            }
+        }
+    }
+
+    LfJob job;
+    job.spec = &spec;
+    job.cand = out.cand.data();
+    job.num = out.cand.size();
+    job.slices.count = (job.num + LF_CHUNK - 1) / LF_CHUNK;
+
+    prRunPool(job);
+
+    double best_cost = std::numeric_limits<double>::infinity();
+    double best_peak = std::numeric_limits<double>::infinity();
+    bool any_feasible = false;
+    for(int32_t indx = 0; indx < out.cand.size(); ++indx)
+    {
+        const LfCandidate &cd = out.cand[indx];
+        if(cd.feasible && (!any_feasible || cd.cost < best_cost))
+        {
+            any_feasible = true;
+            best_cost = cd.cost;
+            out.best = indx;
+        }
+        else if(!any_feasible && cd.met.peak_db < best_peak)
+        {
+            best_peak = cd.met.peak_db;
+            out.best = indx;
+        }
+    }
+    return out;
+}
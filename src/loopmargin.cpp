@@ -0,0 +1,389 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/loopmargin.h"
+#include <algorithm>
+
+/**
+ * @brief lmBrent - root of the function bracketed on [ua, ub]
+ */
+template<typename Func>
+static double lmBrent(Func func, double ua, double ub, double fa, double fb)
+{
+    double uc = ua, fc = fa, ud = ub - ua, ue = ud;
+
+    for(int32_t iter = 0; iter < LM_BRENT_ITER_MAX; ++iter)
+    {
+        if((fb > 0.) == (fc > 0.))
+        {
+            uc = ua;
+            fc = fa;
+            ud = ue = ub - ua;
+        }
+        if(std::abs(fc) < std::abs(fb))
+        {
+            ua = ub; ub = uc; uc = ua;
+            fa = fb; fb = fc; fc = fa;
+        }
+        const double tol = LM_BRENT_TOL * qMax(1., std::abs(ub));
+        const double um = 0.5 * (uc - ub);
+        if(std::abs(um) <= tol || fb == 0.)
+            return ub;
+
+        if(std::abs(ue) >= tol && std::abs(fa) > std::abs(fb))
+        {
+            /** Inverse quadratic or secant step */
+            double pp, qq, sb = fb / fa;
+            if(ua == uc)
+            {
+                pp = 2. * um * sb;
+                qq = 1. - sb;
+            }
+            else
+            {
+                const double qa = fa / fc, rb = fb / fc;
+                pp = sb * (2. * um * qa * (qa - rb) - (ub - ua) * (rb - 1.));
+                qq = (qa - 1.) * (rb - 1.) * (sb - 1.);
+            }
+            if(pp > 0.)
+                qq = -qq;
+            else
+                pp = -pp;
+            if(2. * pp < qMin(3. * um * qq - std::abs(tol * qq), std::abs(ue * qq)))
+            {
+                ue = ud;
+                ud = pp / qq;
+            }
+            else
+            {
+                ud = um;
+                ue = ud;
+            }
+        }
+        else
+        {
+            ud = um;
+            ue = ud;
+        }
+        ua = ub;
+        fa = fb;
+        ub += (std::abs(ud) > tol) ? ud : std::copysign(tol, um);
+        fb = func(ub);
+    }
+    return ub;
+}
+
+/**
+ * @brief lmSolveOnScan - refine the crossings bracketed by the scan points
+ * @param eval - ln|H| and continuous phase at ln(omega), eval(uw, ref, lnm, phs); the phase
+ *        is taken within 180 degree of ref, the phase of the bracket begin, if it has no other continuation
+ * @param scan - ln(omega) of the points, ascending
+ * @param lnm - ln|H| at the points
+ * @param phs - continuous phase at the points, may differ from the evaluated one by 360k
+ */
+template<typename Eval>
+static LoopMargins lmSolveOnScan(const Eval &eval, const double *scan, const double *lnm, const double *phs, int32_t num)
+{
+    LoopMargins out;
+    auto lnMag = [&eval](double uw)
+    {
+        double lnm, phs;
+        eval(uw, 0., lnm, phs);
+        return lnm;
+    };
+
+    for(int32_t indx = 1; indx < num; ++indx)
+    {
+        const double ref = phs[indx-1];
+
+        /** 0dB crossing, the worst phase margin is kept */
+        if((lnm[indx-1] > 0.) != (lnm[indx] > 0.))
+        {
+            const double uc = lmBrent(lnMag, scan[indx-1], scan[indx], lnm[indx-1], lnm[indx]);
+            double lnc, phc;
+            eval(uc, ref, lnc, phc);
+            const double pm = std::remainder(phc + 180., 360.);
+            if(!out.has_cross || pm < out.phase_marg)
+            {
+                out.has_cross = true;
+                out.freq_cross = std::exp(uc) / (2*M_PI);
+                out.phase_marg = pm;
+            }
+        }
+
+        /** Crossing of -180 + 360k degree, the smallest gain margin is kept */
+        const double lvl_prev = std::floor((phs[indx-1] + 180.) / 360.);
+        const double lvl = std::floor((phs[indx] + 180.) / 360.);
+        if(lvl_prev != lvl)
+        {
+            double lna, pha, lnb, phb;
+            eval(scan[indx-1], ref, lna, pha);
+            eval(scan[indx], ref, lnb, phb);
+            const double level = 360. * qMax(lvl_prev, lvl) - 180.
+                    + 360. * std::round((pha - phs[indx-1]) / 360.);
+            auto phsOff = [&eval, ref, level](double uw)
+            {
+                double lnm, phs;
+                eval(uw, ref, lnm, phs);
+                return phs - level;
+            };
+            if((pha - level > 0.) == (phb - level > 0.))
+                continue;
+            const double u180 = lmBrent(phsOff, scan[indx-1], scan[indx], pha - level, phb - level);
+            const double gm = -LM_DB_COEFF * lnMag(u180);
+            if(!out.has_180 || gm < out.gain_marg)
+            {
+                out.has_180 = true;
+                out.freq_180 = std::exp(u180) / (2*M_PI);
+                out.gain_marg = gm;
+            }
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief The LmFactorEval struct - evaluator of the factored response, its phase is continuous already
+ */
+struct LmFactorEval
+{
+    const BodeFactors &bf;
+
+    inline void operator()(double uw, double, double &lnm, double &phs) const
+    {
+        lmLogMagPhase(bf, std::exp(uw), lnm, phs);
+    }
+};
+
+LoopMargins lmSolveMargins(const BodeFactors &bf, double freq_begin, double freq_end)
+{
+    const double ulo = std::log(2*M_PI*freq_begin);
+    const double uhi = std::log(2*M_PI*freq_end);
+    if(!(uhi > ulo))
+        return LoopMargins();
+
+    /** Coarse scan on ln(omega), the corners and the resonances are added so the narrow crossing is not skipped */
+    QVector<double> scan;
+    const int32_t num = static_cast<int32_t>(std::ceil((uhi - ulo) / M_LN10 * LM_SCAN_PER_DECADE));
+    for(int32_t indx = 0; indx <= num; ++indx)
+    {
+        scan.push_back(ulo + (uhi - ulo) * indx / num);
+    }
+    auto addCorner = [&](double omega)
+    {
+        const double uc = std::log(omega);
+        if(qIsFinite(uc) && uc > ulo && uc < uhi)
+            scan.push_back(uc);
+    };
+    auto addQuad = [&](double b, double a)
+    {
+        if(a <= 0.)
+            return;
+        const double omega = 1. / std::sqrt(a);
+        const double hbw = 0.5 * std::abs(b) * omega; //1/(2Q)
+        addCorner(omega);
+        addCorner(omega * (1. - hbw));
+        addCorner(omega * (1. + hbw));
+    };
+    for(double tc : bf.tz)
+        addCorner(1. / std::abs(tc));
+    for(double tc : bf.tp)
+        addCorner(1. / std::abs(tc));
+    for(int32_t indx = 0; indx < bf.az.size(); ++indx)
+        addQuad(bf.bz[indx], bf.az[indx]);
+    for(int32_t indx = 0; indx < bf.ap.size(); ++indx)
+        addQuad(bf.bp[indx], bf.ap[indx]);
+    std::sort(scan.begin(), scan.end());
+
+    QVector<double> lnm(scan.size()), phs(scan.size());
+    for(int32_t indx = 0; indx < scan.size(); ++indx)
+    {
+        lmLogMagPhase(bf, std::exp(scan[indx]), lnm[indx], phs[indx]);
+    }
+    return lmSolveOnScan(LmFactorEval{bf}, scan.constData(), lnm.constData(), phs.constData(), scan.size());
+}
+
+LoopMargins lmSolveMargins(const BodeFactors &bf, const SweepBuffer &buf)
+{
+    const int32_t num = buf.sbSize();
+    QVector<double> scan(num), lnm(num);
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        scan[indx] = std::log(2*M_PI*buf.sbFreq()[indx]);
+        lnm[indx] = buf.sbMag()[indx] / LM_DB_COEFF;
+    }
+    return lmSolveOnScan(LmFactorEval{bf}, scan.constData(), lnm.constData(), buf.sbPhase(), num);
+}
+
+LoopMargins lmSolveMargins(const std::function<std::complex<double>(double)> &resp, const SweepBuffer &buf)
+{
+    const int32_t num = buf.sbSize();
+    QVector<double> scan(num), lnm(num);
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        scan[indx] = std::log(2*M_PI*buf.sbFreq()[indx]);
+        lnm[indx] = buf.sbMag()[indx] / LM_DB_COEFF;
+    }
+
+    /** The principal phase is continued from the bracket begin, the sweep is dense enough for it */
+    auto eval = [&resp](double uw, double ref, double &lnm, double &phs)
+    {
+        const std::complex<double> val = resp(std::exp(uw));
+        lnm = std::log(std::abs(val));
+        phs = ref + std::remainder(LM_DEG_COEFF * std::arg(val) - ref, 360.);
+    };
+    return lmSolveOnScan(eval, scan.constData(), lnm.constData(), buf.sbPhase(), num);
+}
+
+/**
+ * @brief lmWindLoop - unwrap the principal phase of the swept loop and count the encirclements
+ */
+static LoopNyquist lmWindLoop(const TransferFunction &tf, const BodeFactors &bf, SweepBuffer &buf)
+{
+    LoopNyquist out;
+    const int32_t num = buf.sbSize();
+    const double *re = buf.sbReal();
+    const double *im = buf.sbImag();
+    double *phs = buf.sbPhase();
+
+    /** One pass: phase unwrapping and the winding of 1 + T around origin */
+    double offset = 0., wind = 0.;
+    for(int32_t indx = 1; indx < num; ++indx)
+    {
+        double phase = phs[indx] + offset;
+        while(phase - phs[indx-1] > 180.)
+        {
+            phase -= 360.;
+            offset -= 360.;
+        }
+        while(phase - phs[indx-1] < -180.)
+        {
+            phase += 360.;
+            offset += 360.;
+        }
+        phs[indx] = phase;
+
+        const std::complex<double> prev(1. + re[indx-1], im[indx-1]);
+        const std::complex<double> curr(1. + re[indx], im[indx]);
+        wind += std::arg(curr * std::conj(prev));
+    }
+
+    /**
+     * The negative frequencies mirror the sweep, the indentation around the
+     * integrators at origin turns 1 + T by order*pi, the far arc does not turn it
+     * for the proper loop. The D contour is clockwise, Z = N + P.
+     */
+    wind = 2. * wind + ((bf.order < 0) ? bf.order * M_PI : 0.);
+    out.encircle = -static_cast<int32_t>(std::round(wind / (2. * M_PI)));
+    for(const TransferFunction::Root &pl : tf.tfPoles())
+    {
+        if(pl.real() > 0.)
+            ++out.open_rhp;
+    }
+    out.closed_rhp = out.encircle + out.open_rhp;
+    return out;
+}
+
+LoopNyquist lmSweepLoop(const TransferFunction &tf, SweepBuffer &buf)
+{
+    const BodeFactors bf = tf.tfBodeFactors();
+    const int32_t num = buf.sbSize();
+    if(!buf.sbIsComplex() || num == 0)
+        return LoopNyquist();
+
+    bsSweepComplex(bf, buf.sbFreq(), num, buf.sbReal(), buf.sbImag());
+    bkComplexToBode(buf.sbReal(), buf.sbImag(), num, buf.sbMag(), buf.sbPhase(), buf.sbPrecision());
+    return lmWindLoop(tf, bf, buf);
+}
+
+LoopNyquist lmSweepLoop(const TransferFunction &tf, const QVector<TransferFunction> &path,
+                        SweepBuffer &buf, const QVector<SweepBuffer*> &closed)
+{
+    const BodeFactors bf = tf.tfBodeFactors();
+    const int32_t num = buf.sbSize();
+    if(!buf.sbIsComplex() || num == 0 || closed.size() != path.size() + 1)
+        return LoopNyquist();
+
+    QVector<BodeFactors> path_bf;
+    QVector<double*> mag, phs;
+    for(const TransferFunction &pt : path)
+    {
+        path_bf.push_back(pt.tfBodeFactors());
+    }
+    for(SweepBuffer *cl : closed)
+    {
+        if(!cl->sbAssignFreq(buf))
+            return LoopNyquist();
+        mag.push_back(cl->sbMag());
+        phs.push_back(cl->sbPhase());
+    }
+
+    bsSweepClosedLoop(bf, path_bf, buf.sbFreq(), num, buf.sbReal(), buf.sbImag(), buf.sbMag(), buf.sbPhase(),
+                      mag, phs, buf.sbPrecision());
+    return lmWindLoop(tf, bf, buf);
+}
+
+LoopMargins lmSolveMargins(const TransferFunction &tf, double freq_begin, double freq_end)
+{
+    return lmSolveMargins(tf.tfBodeFactors(), freq_begin, freq_end);
+}
+
+/**
+ * @brief lmSweepPeak - highest magnitude of the sweep in dB and its frequency
+ */
+static double lmSweepPeak(const SweepBuffer &buf, double &freq)
+{
+    const double *mag = buf.sbMag();
+    const int32_t num = buf.sbSize();
+    if(num == 0)
+    {
+        freq = 0.;
+        return 0.;
+    }
+    const int32_t top = static_cast<int32_t>(std::max_element(mag, mag + num) - mag);
+    freq = buf.sbFreq()[top];
+    return mag[top];
+}
+
+ClosedLoopFigures lmClosedFigures(const SweepBuffer &closed, const SweepBuffer &zout, const SweepBuffer &audio)
+{
+    ClosedLoopFigures out;
+    double freq = 0.;
+    if(closed.sbSize() > 0)
+    {
+        const double *mag = closed.sbMag();
+        const double ref = mag[0];
+        out.peaking = lmSweepPeak(closed, freq) - ref;
+        for(int32_t indx = 1; indx < closed.sbSize(); ++indx)
+        {
+            if(mag[indx] < ref - 3.)
+            {
+                /** Linear in log frequency between the bracketing points */
+                const double frac = (ref - 3. - mag[indx-1]) / (mag[indx] - mag[indx-1]);
+                const double lf0 = std::log(closed.sbFreq()[indx-1]);
+                const double lf1 = std::log(closed.sbFreq()[indx]);
+                out.bandwidth = std::exp(lf0 + frac * (lf1 - lf0));
+                break;
+            }
+        }
+    }
+    out.zout_peak = qPow(10., lmSweepPeak(zout, out.zout_freq) / 20.);
+    out.audio_peak = lmSweepPeak(audio, out.audio_freq);
+    return out;
+}
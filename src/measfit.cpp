@@ -0,0 +1,707 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "inc/measfit.h"
+#include <QFile>
+#include <QFileInfo>
+#include "inc/poolrunner.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#define MF_DB_TO_NP   (M_LN10/20.) //dB to the natural log of the magnitude
+#define MF_LINE_VALS  9            //Numbers read from one line, the two port touchstone line
+
+static const double s_pow10[] =
+{
+    1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11,
+    1E12, 1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22
+};
+
+/**
+ * @brief The MF_TS_FORMAT enum - pair format of the touchstone data
+ */
+enum MF_TS_FORMAT
+{
+    MF_TS_DB = 0, //dB and degree
+    MF_TS_MA = 1, //Magnitude and degree
+    MF_TS_RI = 2  //Real and imaginary part
+};
+
+static inline bool mfIsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline bool mfIsSep(char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+/**
+ * @brief mfParseNumber - decimal number with the dot, the cursor is moved past it.
+ *        Up to 19 significant digits are kept, the scaling by the exact power
+ *        of ten is within the ulp of the strtod for the usual measured values.
+ */
+static bool mfParseNumber(const char *&cur, const char *end, double &out)
+{
+    const char *p = cur;
+    bool neg = false;
+    if(p < end && (*p == '+' || *p == '-'))
+    {
+        neg = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mant = 0;
+    int32_t exp10 = 0, digits = 0;
+    bool any = false;
+    for(; p < end && mfIsDigit(*p); ++p)
+    {
+        if(digits < 19)
+        {
+            mant = mant * 10 + static_cast<uint64_t>(*p - '0');
+            digits += (mant != 0);
+        }
+        else
+        {
+            ++exp10;
+        }
+        any = true;
+    }
+    if(p < end && *p == '.')
+    {
+        for(++p; p < end && mfIsDigit(*p); ++p)
+        {
+            if(digits < 19)
+            {
+                mant = mant * 10 + static_cast<uint64_t>(*p - '0');
+                digits += (mant != 0);
+                --exp10;
+            }
+            any = true;
+        }
+    }
+    if(!any)
+        return false;
+
+    if(p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        bool eneg = false;
+        if(q < end && (*q == '+' || *q == '-'))
+        {
+            eneg = (*q == '-');
+            ++q;
+        }
+        if(q < end && mfIsDigit(*q))
+        {
+            int32_t ev = 0;
+            for(; q < end && mfIsDigit(*q); ++q)
+            {
+                if(ev < 10000)
+                    ev = ev * 10 + (*q - '0');
+            }
+            exp10 += eneg ? -ev : ev;
+            p = q;
+        }
+    }
+
+    double val = static_cast<double>(mant);
+    if(exp10 >= 0)
+        val = (exp10 <= 22) ? val * s_pow10[exp10] : val * std::pow(10., exp10);
+    else
+        val = (exp10 >= -22) ? val / s_pow10[-exp10] : val * std::pow(10., exp10);
+    out = neg ? -val : val;
+    cur = p;
+    return true;
+}
+
+/**
+ * @brief mfParseLine - leading numbers of the line up to the first other token or the comment
+ * @return number of the values
+ */
+static int32_t mfParseLine(const char *p, const char *end, double *val)
+{
+    int32_t cnt = 0;
+    while(cnt < MF_LINE_VALS)
+    {
+        while(p < end && mfIsSep(*p))
+            ++p;
+        if(p >= end || *p == '!' || !mfParseNumber(p, end, val[cnt]))
+            break;
+        ++cnt;
+        if(p < end && !mfIsSep(*p))
+            break;
+    }
+    return cnt;
+}
+
+/**
+ * @brief The MfParseJob struct - slices of the file shared by the workers. The first pass
+ *        counts the lines of each slice, the second one writes the points of the slice
+ *        from the line count of the slices before it.
+ */
+struct MfParseJob
+{
+    const char *text;
+    bool touchstone;
+    bool counting;
+    MF_TS_FORMAT format;
+    double freq_scl;
+    QVector<int64_t> bound; //Begin of each slice and the end of the text
+    QVector<int32_t> offset; //Line count of the slice, then the first point of it
+    QVector<int32_t> valid; //Points of the slice
+    double *freq;
+    double *mag;
+    double *phs;
+    PoolSlices slices;
+
+    /**
+     * @brief mfCountSlice - lines of the slice, the last one may have no line end
+     */
+    static int32_t mfCountSlice(const char *p, const char *end)
+    {
+        int32_t cnt = 0;
+        while(p < end)
+        {
+            const char *eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            ++cnt;
+            if(eol == nullptr)
+                break;
+            p = eol + 1;
+        }
+        return cnt;
+    }
+
+    /**
+     * @brief mfParseSlice - lines of the slice, each one is the point or skipped
+     * @return number of the points
+     */
+    int32_t mfParseSlice(const char *p, const char *end, int32_t first) const
+    {
+        double val[MF_LINE_VALS];
+        int32_t pnt = first;
+        while(p < end)
+        {
+            const char *eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if(eol == nullptr)
+                eol = end;
+            const int32_t cnt = mfParseLine(p, eol, val);
+            p = eol + 1;
+            if(cnt < 3)
+                continue;
+
+            /** S21 of the two port line, S11 of the one port line */
+            double fr = val[0] * freq_scl, va = val[1], vb = val[2];
+            if(touchstone && cnt >= MF_LINE_VALS)
+            {
+                va = val[3];
+                vb = val[4];
+            }
+            if(!(fr > 0.) || !qIsFinite(fr))
+                continue;
+
+            double mg = va, ph = vb;
+            if(touchstone && format == MF_TS_MA)
+            {
+                mg = 20. * std::log10(va);
+            }
+            else if(touchstone && format == MF_TS_RI)
+            {
+                mg = 10. * std::log10(va * va + vb * vb);
+                ph = (180./M_PI) * std::atan2(vb, va);
+            }
+            if(!qIsFinite(mg) || !qIsFinite(ph))
+                continue;
+            freq[pnt] = fr;
+            mag[pnt] = mg;
+            phs[pnt] = ph;
+            ++pnt;
+        }
+        return pnt - first;
+    }
+
+    void prRunSlices()
+    {
+        int32_t chunk;
+        while(slices.prTake(chunk))
+        {
+            if(counting)
+                offset[chunk] = mfCountSlice(text + bound[chunk], text + bound[chunk + 1]);
+            else
+                valid[chunk] = mfParseSlice(text + bound[chunk], text + bound[chunk + 1], offset[chunk]);
+        }
+    }
+};
+
+/**
+ * @brief The MfNormal struct - normal equations of the fit summed over one slice
+ */
+struct MfNormal
+{
+    double jtj[MF_PARAM_NUM][MF_PARAM_NUM];
+    double jtr[MF_PARAM_NUM];
+    double cost_mag; //Sum of the squared residual of ln|H|
+    double cost_phs; //Sum of the squared residual of the phase in radian
+};
+
+/**
+ * @brief The MfFitJob struct - slices of the measure shared by the workers, the first response
+ *        is at the parameters and the next ones at the forward difference of each parameter
+ */
+struct MfFitJob
+{
+    const BodeFactors *resp;
+    int32_t resps; //1 for the cost only
+    const double *freq;
+    const double *lnm; //ln|H| of the measure
+    const double *phs; //Phase of the measure, radian
+    int32_t num;
+    QVector<MfNormal> part;
+    PoolSlices slices;
+
+    void prRunSlices()
+    {
+        QVector<double> scratch(2 * resps * MF_CHUNK_POINTS);
+        int32_t chunk;
+        while(slices.prTake(chunk))
+        {
+            const int32_t begin = chunk * MF_CHUNK_POINTS;
+            const int32_t cnt = qMin(MF_CHUNK_POINTS, num - begin);
+            for(int32_t rsp = 0; rsp < resps; ++rsp)
+            {
+                double *re = scratch.data() + 2 * rsp * MF_CHUNK_POINTS;
+                bkEvalComplex(resp[rsp], freq + begin, cnt, re, re + MF_CHUNK_POINTS);
+            }
+
+            MfNormal &nrm = part[chunk];
+            std::memset(&nrm, 0, sizeof(MfNormal));
+            const double *re0 = scratch.constData();
+            const double *im0 = re0 + MF_CHUNK_POINTS;
+            for(int32_t indx = 0; indx < cnt; ++indx)
+            {
+                const std::complex<double> h0(re0[indx], im0[indx]);
+                const double r_mag = std::log(std::abs(h0)) - lnm[begin + indx];
+                const double r_phs = std::remainder(std::arg(h0) - phs[begin + indx], 2*M_PI);
+                nrm.cost_mag += r_mag * r_mag;
+                nrm.cost_phs += r_phs * r_phs;
+
+                /** The difference of ln(H) is ln(H_k/H_0), its phase has no wrapping for the small step */
+                double j_mag[MF_PARAM_NUM], j_phs[MF_PARAM_NUM];
+                for(int32_t prm = 0; prm + 1 < resps; ++prm)
+                {
+                    const double *rek = re0 + 2 * (prm + 1) * MF_CHUNK_POINTS;
+                    const std::complex<double> ratio = std::complex<double>(rek[indx], rek[indx + MF_CHUNK_POINTS]) / h0;
+                    j_mag[prm] = std::log(std::abs(ratio)) / MF_DIFF_STEP;
+                    j_phs[prm] = std::arg(ratio) / MF_DIFF_STEP;
+                }
+                for(int32_t row = 0; row + 1 < resps; ++row)
+                {
+                    for(int32_t col = 0; col + 1 < resps; ++col)
+                    {
+                        nrm.jtj[row][col] += j_mag[row] * j_mag[col] + j_phs[row] * j_phs[col];
+                    }
+                    nrm.jtr[row] += j_mag[row] * r_mag + j_phs[row] * r_phs;
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @brief mfTokenIs - case insensitive compare of the token with the upper case word
+ */
+static bool mfTokenIs(const char *tok, const char *end, const char *word)
+{
+    for(; tok < end && *word != '\0'; ++tok, ++word)
+    {
+        if(std::toupper(static_cast<unsigned char>(*tok)) != *word)
+            return false;
+    }
+    return tok == end && *word == '\0';
+}
+
+/**
+ * @brief mfParseOptions - the option line of the touchstone file before the first data line
+ */
+static void mfParseOptions(const char *text, int64_t size, MF_TS_FORMAT &format, double &freq_scl)
+{
+    const char *p = text;
+    const char *end = text + size;
+    while(p < end)
+    {
+        const char *eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if(eol == nullptr)
+            eol = end;
+        const char *tok = p;
+        while(tok < eol && mfIsSep(*tok))
+            ++tok;
+        if(tok < eol && (mfIsDigit(*tok) || *tok == '.' || *tok == '-' || *tok == '+'))
+            return;
+        if(tok < eol && *tok == '#')
+        {
+            for(++tok; tok < eol;)
+            {
+                while(tok < eol && mfIsSep(*tok))
+                    ++tok;
+                const char *tend = tok;
+                while(tend < eol && !mfIsSep(*tend))
+                    ++tend;
+                if(mfTokenIs(tok, tend, "HZ"))
+                    freq_scl = 1.;
+                else if(mfTokenIs(tok, tend, "KHZ"))
+                    freq_scl = 1E3;
+                else if(mfTokenIs(tok, tend, "MHZ"))
+                    freq_scl = 1E6;
+                else if(mfTokenIs(tok, tend, "GHZ"))
+                    freq_scl = 1E9;
+                else if(mfTokenIs(tok, tend, "DB"))
+                    format = MF_TS_DB;
+                else if(mfTokenIs(tok, tend, "MA"))
+                    format = MF_TS_MA;
+                else if(mfTokenIs(tok, tend, "RI"))
+                    format = MF_TS_RI;
+                tok = tend;
+            }
+            return;
+        }
+        p = eol + 1;
+    }
+}
+
+MfMeasure mfParseText(const char *text, int64_t size, bool touchstone)
+{
+    MfParseJob job;
+    job.text = text;
+    job.touchstone = touchstone;
+    /** Touchstone defaults to GHz and MA without the option line */
+    job.format = touchstone ? MF_TS_MA : MF_TS_DB;
+    job.freq_scl = touchstone ? 1E9 : 1.;
+    if(touchstone)
+        mfParseOptions(text, size, job.format, job.freq_scl);
+
+    /** The slices begin after the line end, the line is never cut */
+    job.bound.push_back(0);
+    for(int64_t pos = MF_CHUNK_BYTES; pos < size; pos += MF_CHUNK_BYTES)
+    {
+        const int64_t from = qMax(pos, job.bound.last());
+        const char *eol = static_cast<const char*>(std::memchr(text + from, '\n', static_cast<size_t>(size - from)));
+        if(eol == nullptr)
+            break;
+        job.bound.push_back(eol - text + 1);
+        pos = job.bound.last();
+    }
+    job.bound.push_back(size);
+    job.slices.count = job.bound.size() - 1;
+    job.offset.resize(job.slices.count);
+    job.valid.resize(job.slices.count);
+    job.counting = true;
+    prRunPool(job);
+
+    MfMeasure out;
+    int32_t lines = 0;
+    for(int32_t &off : job.offset)
+    {
+        const int32_t cnt = off;
+        off = lines;
+        lines += cnt;
+    }
+    out.freq.resize(lines);
+    out.mag.resize(lines);
+    out.phs.resize(lines);
+    job.freq = out.freq.data();
+    job.mag = out.mag.data();
+    job.phs = out.phs.data();
+    job.counting = false;
+    job.slices.next.storeRelease(0);
+    prRunPool(job);
+
+    /** The skipped lines leave the gaps at the end of their slices */
+    int32_t num = 0;
+    for(int32_t chunk = 0; chunk < job.slices.count; ++chunk)
+    {
+        const int32_t off = job.offset[chunk];
+        const int32_t cnt = job.valid[chunk];
+        if(num != off)
+        {
+            std::memmove(job.freq + num, job.freq + off, static_cast<size_t>(cnt) * sizeof(double));
+            std::memmove(job.mag + num, job.mag + off, static_cast<size_t>(cnt) * sizeof(double));
+            std::memmove(job.phs + num, job.phs + off, static_cast<size_t>(cnt) * sizeof(double));
+        }
+        num += cnt;
+    }
+    out.freq.resize(num);
+    out.mag.resize(num);
+    out.phs.resize(num);
+    if(num == 0)
+    {
+        out.error = "No measured points found";
+        return out;
+    }
+
+    /** The analyzer may sweep downwards or in the segments */
+    if(!std::is_sorted(out.freq.constBegin(), out.freq.constEnd()))
+    {
+        QVector<int32_t> order(num);
+        for(int32_t indx = 0; indx < num; ++indx)
+        {
+            order[indx] = indx;
+        }
+        std::stable_sort(order.begin(), order.end(), [&out](int32_t a, int32_t b)
+        {
+            return out.freq[a] < out.freq[b];
+        });
+        MfMeasure srt;
+        srt.freq.resize(num);
+        srt.mag.resize(num);
+        srt.phs.resize(num);
+        for(int32_t indx = 0; indx < num; ++indx)
+        {
+            srt.freq[indx] = out.freq[order[indx]];
+            srt.mag[indx] = out.mag[order[indx]];
+            srt.phs[indx] = out.phs[order[indx]];
+        }
+        out = srt;
+    }
+    bkUnwrapPhase(out.phs.data(), num);
+    return out;
+}
+
+MfMeasure mfLoad(const QString &path)
+{
+    MfMeasure out;
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        out.error = file.errorString();
+        return out;
+    }
+
+    /** The touchstone suffix is .snp, n is the number of the ports */
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    const bool touchstone = suffix.size() >= 3 && suffix.startsWith("s") && suffix.endsWith("p");
+    const int64_t size = file.size();
+    uchar *map = (size > 0) ? file.map(0, size) : nullptr;
+    if(map != nullptr)
+    {
+        out = mfParseText(reinterpret_cast<const char*>(map), size, touchstone);
+        file.unmap(map);
+    }
+    else
+    {
+        /** The pipe and the empty file have no mapping */
+        const QByteArray text = file.readAll();
+        out = mfParseText(text.constData(), text.size(), touchstone);
+    }
+    return out;
+}
+
+BodeFactors mfModelFactors(const MfFitModel &model, const double *param)
+{
+    if(model.target == MF_POWER_STAGE)
+    {
+        SSMPreDesign ssm = model.ssm;
+        ssm.output_cap_esr = param[0];
+        ssm.primary_ind = param[1];
+        PCSSM pcssm(ssm, model.mode);
+        return pcssm.coBodeFactors();
+    }
+
+    /** G_{0} ~ CTR, \omega_{p1} is the optocoupler pole */
+    FCCoeff cf = model.comp;
+    cf.gain *= param[0] / model.opto_ctr;
+    cf.omega_p1 = 2*M_PI * param[1];
+    return FCCD::coBodeFactors(cf, model.comp_type);
+}
+
+/**
+ * @brief mfNormal - cost and the normal equations of the log parameters, summed in the slice order
+ */
+static MfNormal mfNormal(const MfFitModel &model, const double *lprm, bool jac,
+                         const QVector<double> &freq, const QVector<double> &lnm, const QVector<double> &phs)
+{
+    BodeFactors resp[MF_PARAM_NUM + 1];
+    double prm[MF_PARAM_NUM];
+    for(int32_t rsp = 0; rsp < (jac ? MF_PARAM_NUM + 1 : 1); ++rsp)
+    {
+        for(int32_t indx = 0; indx < MF_PARAM_NUM; ++indx)
+        {
+            prm[indx] = std::exp(lprm[indx] + ((indx + 1 == rsp) ? MF_DIFF_STEP : 0.));
+        }
+        resp[rsp] = mfModelFactors(model, prm);
+    }
+
+    MfFitJob job;
+    job.resp = resp;
+    job.resps = jac ? MF_PARAM_NUM + 1 : 1;
+    job.freq = freq.constData();
+    job.lnm = lnm.constData();
+    job.phs = phs.constData();
+    job.num = freq.size();
+    job.slices.count = (job.num + MF_CHUNK_POINTS - 1) / MF_CHUNK_POINTS;
+    job.part.resize(job.slices.count);
+    prRunPool(job);
+
+    MfNormal out;
+    std::memset(&out, 0, sizeof(MfNormal));
+    for(const MfNormal &nrm : job.part)
+    {
+        for(int32_t row = 0; row < MF_PARAM_NUM; ++row)
+        {
+            for(int32_t col = 0; col < MF_PARAM_NUM; ++col)
+            {
+                out.jtj[row][col] += nrm.jtj[row][col];
+            }
+            out.jtr[row] += nrm.jtr[row];
+        }
+        out.cost_mag += nrm.cost_mag;
+        out.cost_phs += nrm.cost_phs;
+    }
+    return out;
+}
+
+/**
+ * @brief mfSolveStep - (J^T J + lambda diag(J^T J)) d = -J^T r by the elimination with the pivot
+ * @return false for the singular system
+ */
+static bool mfSolveStep(const MfNormal &nrm, double lambda, double *step)
+{
+    double a[MF_PARAM_NUM][MF_PARAM_NUM + 1];
+    for(int32_t row = 0; row < MF_PARAM_NUM; ++row)
+    {
+        for(int32_t col = 0; col < MF_PARAM_NUM; ++col)
+        {
+            a[row][col] = nrm.jtj[row][col];
+        }
+        a[row][row] += lambda * qMax(nrm.jtj[row][row], 1E-12);
+        a[row][MF_PARAM_NUM] = -nrm.jtr[row];
+    }
+    for(int32_t piv = 0; piv < MF_PARAM_NUM; ++piv)
+    {
+        int32_t best = piv;
+        for(int32_t row = piv + 1; row < MF_PARAM_NUM; ++row)
+        {
+            if(qAbs(a[row][piv]) > qAbs(a[best][piv]))
+                best = row;
+        }
+        if(a[best][piv] == 0.)
+            return false;
+        for(int32_t col = 0; col <= MF_PARAM_NUM; ++col)
+        {
+            std::swap(a[piv][col], a[best][col]);
+        }
+        for(int32_t row = piv + 1; row < MF_PARAM_NUM; ++row)
+        {
+            const double fct = a[row][piv] / a[piv][piv];
+            for(int32_t col = piv; col <= MF_PARAM_NUM; ++col)
+            {
+                a[row][col] -= fct * a[piv][col];
+            }
+        }
+    }
+    for(int32_t row = MF_PARAM_NUM - 1; row >= 0; --row)
+    {
+        double sum = a[row][MF_PARAM_NUM];
+        for(int32_t col = row + 1; col < MF_PARAM_NUM; ++col)
+        {
+            sum -= a[row][col] * step[col];
+        }
+        step[row] = sum / a[row][row];
+    }
+    return true;
+}
+
+MfFitResult mfFit(const MfFitModel &model, const MfMeasure &meas)
+{
+    MfFitResult out;
+    if(model.target == MF_POWER_STAGE)
+    {
+        out.nominal[0] = model.ssm.output_cap_esr;
+        out.nominal[1] = model.ssm.primary_ind;
+    }
+    else
+    {
+        out.nominal[0] = model.opto_ctr;
+        out.nominal[1] = model.comp.omega_p1 / (2*M_PI);
+    }
+    std::copy(out.nominal, out.nominal + MF_PARAM_NUM, out.fitted);
+    const int32_t num = meas.freq.size();
+    if(num < MF_PARAM_NUM || !(out.nominal[0] > 0.) || !(out.nominal[1] > 0.))
+    {
+        out.fit = mfModelFactors(model, out.fitted);
+        return out;
+    }
+
+    QVector<double> lnm(num), phs(num);
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        lnm[indx] = meas.mag[indx] * MF_DB_TO_NP;
+        phs[indx] = meas.phs[indx] * (M_PI/180.);
+    }
+
+    double lprm[MF_PARAM_NUM], trial[MF_PARAM_NUM], step[MF_PARAM_NUM];
+    for(int32_t indx = 0; indx < MF_PARAM_NUM; ++indx)
+    {
+        lprm[indx] = std::log(out.nominal[indx]);
+    }
+    MfNormal nrm = mfNormal(model, lprm, true, meas.freq, lnm, phs);
+    double cost = nrm.cost_mag + nrm.cost_phs;
+    double lambda = MF_LAMBDA_INIT;
+    for(out.iter = 0; out.iter < MF_ITER_MAX && !out.converged; ++out.iter)
+    {
+        if(!mfSolveStep(nrm, lambda, step))
+            break;
+        double step_max = 0.;
+        for(int32_t indx = 0; indx < MF_PARAM_NUM; ++indx)
+        {
+            trial[indx] = lprm[indx] + step[indx];
+            step_max = qMax(step_max, qAbs(step[indx]));
+        }
+        const MfNormal trl = mfNormal(model, trial, false, meas.freq, lnm, phs);
+        const double trl_cost = trl.cost_mag + trl.cost_phs;
+        if(qIsFinite(trl_cost) && trl_cost < cost)
+        {
+            out.converged = (cost - trl_cost) < MF_COST_TOL * cost || step_max < MF_STEP_TOL;
+            std::copy(trial, trial + MF_PARAM_NUM, lprm);
+            nrm = out.converged ? trl : mfNormal(model, lprm, true, meas.freq, lnm, phs);
+            cost = trl_cost;
+            lambda = qMax(lambda / 10., 1E-12);
+        }
+        else
+        {
+            /** No descent even along the short gradient step, the fit is stalled unless the step is below the tolerance */
+            lambda *= 10.;
+            out.converged = step_max < MF_STEP_TOL;
+            out.stalled = !out.converged && lambda > MF_LAMBDA_MAX;
+            if(out.stalled)
+                break;
+        }
+    }
+
+    for(int32_t indx = 0; indx < MF_PARAM_NUM; ++indx)
+    {
+        out.fitted[indx] = std::exp(lprm[indx]);
+    }
+    out.rms_mag = std::sqrt(nrm.cost_mag / num) / MF_DB_TO_NP;
+    out.rms_phs = std::sqrt(nrm.cost_phs / num) * (180./M_PI);
+    out.fit = mfModelFactors(model, out.fitted);
+    return out;
+}
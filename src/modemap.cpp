@@ -0,0 +1,116 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "inc/modemap.h"
+#include "inc/poolrunner.h"
+#include <limits>
+
+/**
+ * @brief mmCriticProduct - (V_{in}D)^2 of the CCM duty at the peak of the line
+ */
+static double mmCriticProduct(const MmSpec &spec, double volt_ac)
+{
+    const double volt_in = M_SQRT2 * volt_ac;
+    const double vd = volt_in * spec.volt_refl / (volt_in + spec.volt_refl);
+    return vd * vd;
+}
+
+double mmCriticInd(const MmSpec &spec, double volt_ac, double load)
+{
+    const double power_in = 1E-2 * load * spec.power_max / spec.eff;
+    return mmCriticProduct(spec, volt_ac) / (2. * power_in * spec.freq_switch);
+}
+
+/**
+ * @brief The MmJob struct - slices of the load rows shared by the workers
+ */
+struct MmJob
+{
+    const MmSpec *spec;
+    MmMap *map;
+    const double *prod; //(V_{in}D)^2 of each column
+    PoolSlices slices;
+
+    void prRunSlices()
+    {
+        const int32_t cols = map->volt_num;
+        int32_t chunk;
+        while(slices.prTake(chunk))
+        {
+            const int32_t end = qMin((chunk + 1) * MM_CHUNK_ROWS, map->load_num);
+            for(int32_t row = chunk * MM_CHUNK_ROWS; row < end; ++row)
+            {
+                const double scl = 1. / (2. * 1E-2 * map->mmLoad(row) * spec->power_max / spec->eff * spec->freq_switch);
+                double *ind = map->ind_crit.data() + row * cols;
+                double *mrg = map->margin.data() + row * cols;
+                for(int32_t col = 0; col < cols; ++col)
+                {
+                    ind[col] = prod[col] * scl;
+                    mrg[col] = 1E2 * (1. - spec->prim_ind / ind[col]);
+                }
+            }
+        }
+    }
+};
+
+MmMap mmSolveMap(const MmSpec &spec, int32_t volt_num, int32_t load_num)
+{
+    MmMap out;
+    if(spec.volt_ac_min <= 0. || spec.volt_ac_max < spec.volt_ac_min || spec.power_max <= 0.
+            || spec.eff <= 0. || spec.prim_ind <= 0. || spec.freq_switch <= 0. || volt_num < 1 || load_num < 1)
+        return out;
+
+    out.volt_num = volt_num;
+    out.load_num = load_num;
+    out.volt_min = spec.volt_ac_min;
+    out.volt_max = spec.volt_ac_max;
+    out.load_min = MM_LOAD_MIN;
+    out.load_max = 100.;
+    out.ind_crit.resize(volt_num * load_num);
+    out.margin.resize(volt_num * load_num);
+
+    /** The line term is shared by the rows, the boundary load follows from it directly */
+    QVector<double> prod(volt_num);
+    out.bound.resize(volt_num);
+    for(int32_t col = 0; col < volt_num; ++col)
+    {
+        prod[col] = mmCriticProduct(spec, out.mmVolt(col));
+        out.bound[col] = 1E2 * prod[col] * spec.eff / (2. * spec.prim_ind * spec.freq_switch * spec.power_max);
+    }
+
+    MmJob job;
+    job.spec = &spec;
+    job.map = &out;
+    job.prod = prod.constData();
+    job.slices.count = (load_num + MM_CHUNK_ROWS - 1) / MM_CHUNK_ROWS;
+
+    prRunPool(job);
+
+    int32_t ccm = 0;
+    out.ind_crit_min = std::numeric_limits<double>::infinity();
+    for(int32_t indx = 0; indx < out.margin.size(); ++indx)
+    {
+        if(out.margin[indx] <= -MM_BCM_BAND)
+            ++ccm;
+        out.ind_crit_min = qMin(out.ind_crit_min, out.ind_crit[indx]);
+    }
+    out.ccm_share = 1E2 * ccm / out.margin.size();
+    return out;
+}
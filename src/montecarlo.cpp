@@ -0,0 +1,268 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/montecarlo.h"
+#include "inc/poolrunner.h"
+#include <algorithm>
+#include <limits>
+
+#define MC_GOLDEN       0x9E3779B97F4A7C15ULL //Increment of the splitmix64 sequence
+#define MC_UNIT_53      (1./9007199254740992.) //2^-53
+#define MC_NORMAL_CLIP  3.    //Draws of the normal distribution past 3 sigma are repeated
+
+/**
+ * @brief mcMix - finalizer of the splitmix64 generator
+ */
+static inline uint64_t mcMix(uint64_t val)
+{
+    val = (val ^ (val >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    val = (val ^ (val >> 27)) * 0x94D049BB133111EBULL;
+    return val ^ (val >> 31);
+}
+
+/**
+ * @brief mcStream - start of the stream of the sample, the hash of the index moves the
+ *        streams of the neighbour samples far apart on the period of the generator
+ */
+static inline uint64_t mcStream(uint64_t seed, int32_t sample)
+{
+    return mcMix(seed ^ mcMix((static_cast<uint64_t>(sample) + 1) * MC_GOLDEN));
+}
+
+/**
+ * @brief mcUniform - next number of the stream, 0..1 with the upper end excluded
+ */
+static inline double mcUniform(uint64_t &state)
+{
+    state += MC_GOLDEN;
+    return (mcMix(state) >> 11) * MC_UNIT_53;
+}
+
+/**
+ * @brief mcDraw - multiplier of the nominal value
+ */
+static double mcDraw(const McTolerance &tl, uint64_t &state)
+{
+    switch(tl.dist)
+    {
+    case MC_DIST_UNIFORM:
+        return tl.lower + (tl.upper - tl.lower) * mcUniform(state);
+    case MC_DIST_NORMAL:
+    {
+        /** Box-Muller, the part out of the range is rejected as the supplier does */
+        double gs;
+        do
+        {
+            const double rad = std::sqrt(-2. * std::log(1. - mcUniform(state)));
+            gs = rad * std::cos(2*M_PI*mcUniform(state));
+        }
+        while(qAbs(gs) > MC_NORMAL_CLIP);
+        return 0.5 * (tl.lower + tl.upper) + gs * (tl.upper - tl.lower) / (2. * MC_NORMAL_CLIP);
+    }
+    case MC_DIST_LOG:
+        return tl.lower * qPow(tl.upper / tl.lower, mcUniform(state));
+    default:
+        return 1.;
+    }
+}
+
+/**
+ * @brief The McJob struct - slices of the samples shared by the workers
+ */
+struct McJob
+{
+    const McModel *model;
+    const McTolerance *tol;
+    uint64_t seed;
+    double freq_begin;
+    double freq_end;
+    int32_t samples;
+    double *freq_cross;
+    double *phase_marg;
+    double *gain_marg;
+    PoolSlices slices;
+
+    /**
+     * @brief prRunSlices - take the slices one by one until nothing left,
+     *        the power stage model of the worker is compiled again for each sample
+     */
+    void prRunSlices()
+    {
+        SSMPreDesign ssm = model->ssm;
+        PCSSM pcssm(ssm, model->mode);
+        LfFilter filter = model->filter;
+        double mul[MC_PARAM_NUM];
+        int32_t chunk;
+        while(slices.prTake(chunk))
+        {
+            const int32_t begin = chunk * MC_CHUNK_SAMPLES;
+            const int32_t end = qMin(begin + MC_CHUNK_SAMPLES, samples);
+            for(int32_t smp = begin; smp < end; ++smp)
+            {
+                uint64_t state = mcStream(seed, smp);
+                for(int32_t prm = 0; prm < MC_PARAM_NUM; ++prm)
+                {
+                    mul[prm] = mcDraw(tol[prm], state);
+                }
+
+                ssm = model->ssm;
+                ssm.primary_ind *= mul[MC_PRIMARY_IND];
+                ssm.res_sense *= mul[MC_RES_SENSE];
+                ssm.output_cap *= mul[MC_OUTPUT_CAP];
+                ssm.output_cap_esr *= mul[MC_OUTPUT_CAP_ESR];
+                ssm.output_full_load_res *= static_cast<float>(mul[MC_LOAD_RES]);
+                ssm.sawvolt *= mul[MC_SAW_VOLT];
+                pcssm.coRecompile(ssm);
+
+                /** G_{0} ~ CTR*R_{pullup}*R_{f}, \omega_{z} = 1/(R_{f}C_{f}), \omega_{p1} = 1/(R_{pullup}C_{opto}) */
+                FCCoeff cf = model->comp;
+                cf.gain *= mul[MC_OPTO_CTR] * mul[MC_RES_PULL_UP] * mul[MC_RES_ZERO];
+                cf.omega_z /= mul[MC_RES_ZERO] * mul[MC_CAP_ZERO];
+                cf.omega_p1 /= mul[MC_RES_PULL_UP] * mul[MC_CAP_POLE];
+
+                BodeFactors bf = pcssm.coBodeFactors();
+                bf.bfAppend(FCCD::coCompFactors(cf, model->comp_type));
+                /** The peaking follows sqrt(C/L) and the ESR zero follows C, the response is built from the parts */
+                if(!filter.stage.isEmpty())
+                {
+                    for(int32_t st = 0; st < filter.stage.size(); ++st)
+                    {
+                        const LfStage &nom = model->filter.stage[st];
+                        filter.stage[st].ind = nom.ind * mul[MC_LC_IND];
+                        filter.stage[st].cap = nom.cap * mul[MC_LC_CAP];
+                        filter.stage[st].damp_cap = nom.damp_cap * mul[MC_LC_CAP];
+                    }
+                    filter.load_res = model->filter.load_res * mul[MC_LOAD_RES];
+                    bf.bfAppend(lfTransfFunc(filter).tfBodeFactors());
+                }
+
+                LoopMargins lm = lmSolveMargins(bf, freq_begin, freq_end);
+                freq_cross[smp] = lm.has_cross ? lm.freq_cross : std::numeric_limits<double>::quiet_NaN();
+                phase_marg[smp] = lm.has_cross ? lm.phase_marg : std::numeric_limits<double>::quiet_NaN();
+                gain_marg[smp] = lm.has_180 ? lm.gain_marg : std::numeric_limits<double>::infinity();
+            }
+        }
+    }
+};
+
+QVector<McTolerance> mcDefaultTolerances()
+{
+    QVector<McTolerance> out(MC_PARAM_NUM, {MC_DIST_NONE, 1., 1.});
+    out[MC_PRIMARY_IND]    = {MC_DIST_UNIFORM, 0.9, 1.1};
+    out[MC_RES_SENSE]      = {MC_DIST_UNIFORM, 0.99, 1.01};
+    out[MC_OUTPUT_CAP]     = {MC_DIST_UNIFORM, 0.8, 1.2};
+    out[MC_OUTPUT_CAP_ESR] = {MC_DIST_NORMAL, 0.5, 1.5};
+    out[MC_SAW_VOLT]       = {MC_DIST_UNIFORM, 0.95, 1.05};
+    out[MC_OPTO_CTR]       = {MC_DIST_LOG, 1., 3.};
+    out[MC_RES_PULL_UP]    = {MC_DIST_UNIFORM, 0.99, 1.01};
+    out[MC_RES_ZERO]       = {MC_DIST_UNIFORM, 0.99, 1.01};
+    out[MC_CAP_ZERO]       = {MC_DIST_UNIFORM, 0.9, 1.1};
+    out[MC_CAP_POLE]       = {MC_DIST_UNIFORM, 0.9, 1.1};
+    out[MC_LC_IND]         = {MC_DIST_UNIFORM, 0.8, 1.2};
+    out[MC_LC_CAP]         = {MC_DIST_UNIFORM, 0.8, 1.2};
+    return out;
+}
+
+McResult mcRun(const McModel &model, const QVector<McTolerance> &tol, const McLimits &lim,
+               int32_t samples, uint64_t seed, double freq_begin, double freq_end)
+{
+    McResult out;
+    if(samples <= 0 || tol.size() != MC_PARAM_NUM)
+        return out;
+    out.samples = samples;
+    out.freq_cross.resize(samples);
+    out.phase_marg.resize(samples);
+    out.gain_marg.resize(samples);
+
+    McJob job;
+    job.model = &model;
+    job.tol = tol.constData();
+    job.seed = seed;
+    job.freq_begin = freq_begin;
+    job.freq_end = freq_end;
+    job.samples = samples;
+    job.slices.count = (samples + MC_CHUNK_SAMPLES - 1) / MC_CHUNK_SAMPLES;
+    job.freq_cross = out.freq_cross.data();
+    job.phase_marg = out.phase_marg.data();
+    job.gain_marg = out.gain_marg.data();
+
+    prRunPool(job);
+
+    for(int32_t smp = 0; smp < samples; ++smp)
+    {
+        if(qIsNaN(out.freq_cross[smp]))
+        {
+            ++out.no_cross;
+            continue;
+        }
+        if(out.phase_marg[smp] >= lim.phase_marg && out.gain_marg[smp] >= lim.gain_marg)
+            ++out.passed;
+    }
+    return out;
+}
+
+McHistogram mcHistogram(const QVector<double> &val, int32_t bins)
+{
+    McHistogram out;
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+    for(double vl : val)
+    {
+        if(!qIsFinite(vl))
+            continue;
+        lo = qMin(lo, vl);
+        hi = qMax(hi, vl);
+    }
+    if(bins <= 0 || lo > hi)
+        return out;
+
+    /** All values in one point still give the bar of the visible width */
+    out.width = (hi - lo) / bins;
+    if(out.width <= 0.)
+    {
+        out.width = qMax(qAbs(lo), 1.) * 1E-3;
+        lo -= 0.5 * bins * out.width;
+    }
+    out.lower = lo;
+    out.count.fill(0., bins);
+    for(double vl : val)
+    {
+        if(!qIsFinite(vl))
+            continue;
+        const int32_t bin = static_cast<int32_t>((vl - lo) / out.width);
+        out.count[qBound(0, bin, bins - 1)] += 1.;
+    }
+    return out;
+}
+
+double mcPercentile(const QVector<double> &val, double part)
+{
+    QVector<double> fin;
+    fin.reserve(val.size());
+    for(double vl : val)
+    {
+        if(qIsFinite(vl))
+            fin.push_back(vl);
+    }
+    if(fin.isEmpty())
+        return std::numeric_limits<double>::quiet_NaN();
+    const int32_t pos = qBound(0, static_cast<int32_t>(part * (fin.size() - 1) + 0.5), fin.size() - 1);
+    std::nth_element(fin.begin(), fin.begin() + pos, fin.end());
+    return fin[pos];
+}
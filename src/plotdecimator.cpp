@@ -0,0 +1,122 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/plotdecimator.h"
+#include <algorithm>
+#include <cmath>
+
+PlotDecimator::PlotDecimator(const QVector<PdPoint> &data)
+    :m_data(data)
+{
+    /** The first level is built from the points, each next one from the previous */
+    int32_t span = 2;
+    while(span <= m_data.size())
+    {
+        QVector<Node> level(m_data.size() / span);
+        for(int32_t indx = 0; indx < level.size(); ++indx)
+        {
+            int32_t imin, imax;
+            if(m_level.isEmpty())
+            {
+                imin = imax = 2 * indx;
+                pdMerge(imin, imax, Node{2 * indx + 1, 2 * indx + 1});
+            }
+            else
+            {
+                const QVector<Node> &prev = m_level.last();
+                imin = prev[2 * indx].imin;
+                imax = prev[2 * indx].imax;
+                pdMerge(imin, imax, prev[2 * indx + 1]);
+            }
+            level[indx] = Node{imin, imax};
+        }
+        m_level.push_back(level);
+        span *= 2;
+    }
+}
+
+void PlotDecimator::pdMerge(int32_t &imin, int32_t &imax, const Node &node) const
+{
+    if(m_data[node.imin].value < m_data[imin].value)
+        imin = node.imin;
+    if(m_data[node.imax].value > m_data[imax].value)
+        imax = node.imax;
+}
+
+void PlotDecimator::pdRangeExtremes(int32_t begin, int32_t end, int32_t &imin, int32_t &imax) const
+{
+    imin = imax = begin++;
+    while(begin < end)
+    {
+        /** The largest aligned block from begin which is inside the range */
+        int32_t lvl = 0;
+        while(lvl < m_level.size() && (begin & ((2 << lvl) - 1)) == 0 && begin + (2 << lvl) <= end)
+            ++lvl;
+        if(lvl == 0)
+        {
+            pdMerge(imin, imax, Node{begin, begin});
+            ++begin;
+        }
+        else
+        {
+            pdMerge(imin, imax, m_level[lvl-1][begin >> lvl]);
+            begin += 1 << lvl;
+        }
+    }
+}
+
+int32_t PlotDecimator::pdLowerBound(double key, int32_t from) const
+{
+    return static_cast<int32_t>(std::lower_bound(m_data.constBegin() + from, m_data.constEnd(), key,
+                                [](const PdPoint &dt, double ky){return dt.key < ky;}) - m_data.constBegin());
+}
+
+QVector<PdPoint> PlotDecimator::pdDecimate(double lower, double upper, int32_t columns, bool logscale) const
+{
+    if(m_data.isEmpty() || columns <= 0 || !(upper > lower) || (logscale && lower <= 0.))
+        return QVector<PdPoint>();
+
+    /** One point beyond each edge keeps the line running to the border of the plot */
+    const int32_t first = qMax(pdLowerBound(lower, 0) - 1, 0);
+    const int32_t last = qMin(pdLowerBound(upper, first) + 1, m_data.size());
+    if(last - first <= PD_RAW_PER_COLUMN * columns)
+        return m_data.mid(first, last - first);
+
+    QVector<PdPoint> pts;
+    pts.reserve(2 * columns + 2);
+    pts.push_back(m_data[first]);
+    int32_t begin = first + 1;
+    for(int32_t col = 1; col <= columns && begin < last - 1; ++col)
+    {
+        const double edge = logscale ? lower * std::pow(upper / lower, static_cast<double>(col) / columns)
+                                     : lower + (upper - lower) * col / columns;
+        const int32_t end = (col == columns) ? last - 1 : qMin(pdLowerBound(edge, begin), last - 1);
+        if(end > begin)
+        {
+            int32_t imin, imax;
+            pdRangeExtremes(begin, end, imin, imax);
+            pts.push_back(m_data[qMin(imin, imax)]);
+            if(imin != imax)
+                pts.push_back(m_data[qMax(imin, imax)]);
+        }
+        begin = qMax(begin, end);
+    }
+    pts.push_back(m_data[last - 1]);
+    return pts;
+}
@@ -0,0 +1,79 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "inc/plotlink.h"
+
+PlotDecimatorLink::PlotDecimatorLink(QCPGraph *graph)
+    :QObject(graph)
+    ,m_graph(graph)
+{
+    connect(graph->keyAxis(), static_cast<void (QCPAxis::*)(const QCPRange&)>(&QCPAxis::rangeChanged),
+            this, &PlotDecimatorLink::pdRefresh);
+}
+
+void PlotDecimatorLink::pdAttach(QCPGraph *graph, const QSharedPointer<const PlotDecimator> &dec)
+{
+    PlotDecimatorLink *link = graph->findChild<PlotDecimatorLink*>(QString(), Qt::FindDirectChildrenOnly);
+    if(link == nullptr)
+        link = new PlotDecimatorLink(graph);
+    link->m_dec = dec;
+    link->pdRefresh();
+}
+
+void PlotDecimatorLink::pdRefresh()
+{
+    if(m_graph.isNull())
+        return;
+    /** The empty payload clears the graph of the previous run */
+    if(m_dec.isNull())
+    {
+        m_graph->data()->clear();
+        return;
+    }
+    QCPAxis *axis = m_graph->keyAxis();
+    const QVector<PdPoint> pts = m_dec->pdDecimate(axis->range().lower, axis->range().upper,
+                                                   qMax(axis->axisRect()->width(), PD_MIN_COLUMNS),
+                                                   axis->scaleType() == QCPAxis::stLogarithmic);
+    QVector<QCPGraphData> data(pts.size());
+    for(int32_t indx = 0; indx < pts.size(); ++indx)
+    {
+        data[indx] = QCPGraphData(pts[indx].key, pts[indx].value);
+    }
+    m_graph->data()->set(data, true);
+}
+
+void plSetCurve(QCPCurve *curve, const CurvePlotData &data)
+{
+    curve->setData(data.key, data.value);
+}
+
+void plSetColorMap(QCPColorMap *map, const ColorMapPlotData &data)
+{
+    QCPColorMapData *cells = map->data();
+    cells->setSize(data.key_num, data.value_num);
+    cells->setRange(QCPRange(data.key_min, data.key_max), QCPRange(data.value_min, data.value_max));
+    for(int32_t row = 0; row < data.value_num; ++row)
+    {
+        for(int32_t col = 0; col < data.key_num; ++col)
+        {
+            cells->setCell(col, row, data.cell[row * data.key_num + col]);
+        }
+    }
+}
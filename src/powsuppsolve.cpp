@@ -18,12 +18,22 @@
 */
 
 #include "inc/powsuppsolve.h"
+#include "inc/loggercategories.h"
 
 PowSuppSolve::PowSuppSolve(QObject *parent)
     :QObject(parent)
 {
     qRegisterMetaType<QVector<double>>("QVector<double>");
     qRegisterMetaType<QHash<QString, double>>("QHash<QString, double>");
+    qRegisterMetaType<BodePlotData>("BodePlotData");
+    qRegisterMetaType<LoopPlotData>("LoopPlotData");
+    qRegisterMetaType<ClosedLoopPlotData>("ClosedLoopPlotData");
+    qRegisterMetaType<RootLocusPlotData>("RootLocusPlotData");
+    qRegisterMetaType<TransientPlotData>("TransientPlotData");
+    qRegisterMetaType<MonteCarloPlotData>("MonteCarloPlotData");
+    qRegisterMetaType<SensTableData>("SensTableData");
+    qRegisterMetaType<DigitalCompData>("DigitalCompData");
+    qRegisterMetaType<ModeMapPlotData>("ModeMapPlotData");
     
     m_bc.reset(new BCap);
     m_db.reset(new DBridge);
@@ -33,15 +43,6 @@ PowSuppSolve::PowSuppSolve(QObject *parent)
     m_fod.reset(new FullOutDiode);
     m_foc.reset(new FullOutCap);
 
-    m_ssmfrq.reserve(SET_FREQ_SIZE/100);
-    m_ofsfrq.reserve(SET_FREQ_SIZE/100);
-
-    for(int32_t indx =0; indx<SET_FREQ_SIZE; indx +=100)
-    {
-        m_ssmfrq.push_back(indx);
-        m_ofsfrq.push_back(indx);
-    }
-
     //m_working = false;
     //m_abort = false;
 }
@@ -120,7 +121,9 @@ void PowSuppSolve::calcElectricalPrimarySide()
 
 void PowSuppSolve::calcArea()
 {
-    m_core.reset(new FBPTCore(m_ca, m_ptpe->primary_induct,
+    /** The core takes over the copy, m_ca is kept for the sensitivity run */
+    CoreArea ca = m_ca;
+    m_core.reset(new FBPTCore(ca, m_ptpe->primary_induct,
                               m_ptpe->curr_primary_peak, m_ptpe->curr_primary_rms,
                               m_ptpe->curr_primary_peak_peak, m_indata.power_out_max));
 
@@ -179,6 +182,10 @@ void PowSuppSolve::calcElectroMagProperties()
 
 void PowSuppSolve::calcTransformerWired()
 {
+    /** The recalculation starts from the empty sequences, the indices below are fixed */
+    m_sec.clear();
+    m_wind.clear();
+
     // Make secondary side objects
     QSharedPointer<FBPTSecondary> sec_one = QSharedPointer<FBPTSecondary>(new FBPTSecondary(m_indata.curr_out_one,
                                                                                             m_indata.volt_out_one,
@@ -476,11 +483,13 @@ void PowSuppSolve::calcOtputNetwork()
                                                     turnRatio(m_ptpe->actual_num_primary, m_ptsw->out_aux_wind.value("NAUX"))));
 
     //Construct output capacitor objects
-    QScopedPointer<CapOut> c_out_one(new CapOut(m_cop[0]));
-    QScopedPointer<CapOut> c_out_two(new CapOut(m_cop[1]));
-    QScopedPointer<CapOut> c_out_three(new CapOut(m_cop[2]));
-    QScopedPointer<CapOut> c_out_four(new CapOut(m_cop[3]));
-    QScopedPointer<CapOut> c_out_aux(new CapOut(m_cop[4]));
+    /** The capacitors take over the copies, m_cop is kept for the sensitivity run */
+    QVector<CapOutProp> cop(m_cop);
+    QScopedPointer<CapOut> c_out_one(new CapOut(cop[0]));
+    QScopedPointer<CapOut> c_out_two(new CapOut(cop[1]));
+    QScopedPointer<CapOut> c_out_three(new CapOut(cop[2]));
+    QScopedPointer<CapOut> c_out_four(new CapOut(cop[3]));
+    QScopedPointer<CapOut> c_out_aux(new CapOut(cop[4]));
 
     //Packing output diode values
     m_fod->out_diode_first.insert("SOP", outPwr(m_indata.curr_out_one,
@@ -600,10 +609,22 @@ void PowSuppSolve::calcOutputFilter()
     m_ofhshdata.insert("CFRQ", out_fl->ofAngularCutFreq());
     m_ofhshdata.insert("ORV", out_fl->ofOutRipplVolt());
 
-    out_fl->ofPlotArray(m_offrq, m_ofmag, m_ofphs, 10, 1000000, 10);
+    FreqGrid of_grid(SET_FREQ_BEGIN, SET_OF_FREQ_END);
+    out_fl->ofFillFreqGrid(of_grid);
+    m_oftf = out_fl->ofTransfFunc();
+    m_ofnet = LfFilter();
+    m_ofnet.stage = {LfStage()};
+    m_ofnet.stage[0].ind = out_fl->ofInductor();
+    m_ofnet.stage[0].cap = out_fl->ofCapacitor();
+    m_ofnet.load_res = m_indata.fl_lres;
         
     emit newOFDataHash(m_ofhshdata);
-    emit newOFDataPlot(m_ofmag, m_ofphs);
+    if(m_plot_out && sweepGrid(SW_OUT_FILTER, of_grid))
+    {
+        SweepBuffer &buf = m_sweep.sbpBuffer(SW_OUT_FILTER);
+        out_fl->ofPlotArray(buf);
+        emit newOFDataPlot(bpdFromSweep(buf));
+    }
 
     emit finishedCalcOutputFilter();
 }
@@ -620,18 +641,53 @@ void PowSuppSolve::calcPowerStageModel()
     //m_ssmhshdata.insert("CCMPT", );
     m_ssmhshdata.insert("GCMC", m_pcssm->coGainCurrModeContrModulator());
 
-    m_ssmmag.reserve(SET_FREQ_SIZE/100);
-    m_ssmphs.reserve(SET_FREQ_SIZE/100);
-
-    m_pcssm->coGainControlToOutTransfFunct(m_ssmfrq, m_ssmmag);
-    m_pcssm->coPhaseControlToOutTransfFunct(m_ssmfrq, m_ssmphs);
+    FreqGrid ssm_grid(SET_FREQ_BEGIN, SET_FREQ_END);
+    m_pcssm->coFillFreqGrid(ssm_grid);
 
     emit newPSMDataHash(m_ssmhshdata);
-    emit newPSMDataPlot(m_ssmmag, m_ssmphs);
+    if(m_plot_out && sweepGrid(SW_POWER_STAGE, ssm_grid))
+    {
+        SweepBuffer &buf = m_sweep.sbpBuffer(SW_POWER_STAGE);
+        m_pcssm->coControlToOutTransfFunct(buf);
+        emit newPSMDataPlot(bpdFromSweep(buf));
+    }
+
+    calcModeMap();
 
     emit finishedCalcPowerStageModel();
 }
 
+void PowSuppSolve::calcModeMap()
+{
+    const SSMPreDesign &ssm = m_pcssm->coPreDesign();
+    MmSpec spec;
+    spec.volt_ac_min = m_indata.input_volt_ac_min;
+    spec.volt_ac_max = m_indata.input_volt_ac_max;
+    spec.power_max = m_indata.power_out_max;
+    spec.eff = m_indata.eff;
+    spec.prim_ind = ssm.primary_ind;
+    /** V_{r} of the design maximum duty at the low line, ssm.turn_ratio is the secondary turns and not N_{p}/N_{s} */
+    const double duty = m_ptpe->max_duty_cycle;
+    if(!(duty > 0. && duty < 1.))
+        return;
+    spec.volt_refl = M_SQRT2 * m_indata.input_volt_ac_min * duty/(1. - duty);
+    spec.freq_switch = ssm.freq_switch;
+
+    MmMap map = mmSolveMap(spec);
+    if(map.margin.isEmpty())
+        return;
+
+    m_mmhshdata.insert("MMCCM", map.ccm_share);
+    m_mmhshdata.insert("MMLC", map.ind_crit_min);
+    m_mmhshdata.insert("MMPBL", map.bound.first());
+    m_mmhshdata.insert("MMPBH", map.bound.last());
+    m_mmhshdata.insert("MMOK", (m_pcssm->coMode() != DCM_MODE) || (map.ccm_share <= 0.));
+
+    emit newMMDataHash(m_mmhshdata);
+    if(m_plot_out)
+        emit newMMDataPlot(mmpdFromMap(map, spec.prim_ind));
+}
+
 void PowSuppSolve::calcOptocouplerFeedback()
 {
     m_fccd.reset(new FCCD(m_fc, m_rs, m_lc));
@@ -649,14 +705,622 @@ void PowSuppSolve::calcOptocouplerFeedback()
     m_ofshshdata.insert("RESERR", m_fccd->coResZero());
     m_ofshshdata.insert("CAPERR", m_fccd->coCapZero());
 
-    m_ofsmag.reserve(SET_FREQ_SIZE/100);
-    m_ofsphs.reserve(SET_FREQ_SIZE/100);
-
-    m_fccd->coGainOptoFeedbTransfFunc(m_ofsfrq, m_ofsmag);
-    m_fccd->coPhaseOptoFeedbTransfFunc(m_ofsfrq, m_ofsphs);
+    FreqGrid ofs_grid(SET_FREQ_BEGIN, SET_FREQ_END);
+    m_fccd->coFillFreqGrid(ofs_grid);
 
     emit newOCFDataHash(m_ofshshdata);
-    emit newOCFDataPlot(m_ofsmag, m_ofsphs);
+    if(m_plot_out && sweepGrid(SW_OPTO_FEEDB, ofs_grid))
+    {
+        SweepBuffer &buf = m_sweep.sbpBuffer(SW_OPTO_FEEDB);
+        m_fccd->coOptoFeedbTransfFunc(buf);
+        emit newOCFDataPlot(bpdFromSweep(buf));
+    }
+
+    calcLoopGain();
 
     emit finishedCalcOptocouplerFeedback();
 }
+
+void PowSuppSolve::calcCompTuner()
+{
+    if(m_pcssm.isNull() || m_fccd.isNull())
+        return;
+
+    /** The nominal power stage is the first corner, the others are at the line and load ends */
+    QVector<TransferFunction> corners;
+    corners.push_back(m_pcssm->coTransfFunc() * m_oftf);
+    const int16_t vin[2] = {m_indata.input_volt_ac_min, m_indata.input_volt_ac_max};
+    const double load[2] = {1., CT_LIGHT_LOAD};
+    for(int32_t iv = 0; iv < 2; ++iv)
+    {
+        for(int32_t il = 0; il < 2; ++il)
+        {
+            SSMPreDesign crn = m_pcssm->coPreDesign();
+            if(crn.input_voltage == vin[iv] && il == 0)
+                continue;
+            crn.input_voltage = vin[iv];
+            crn.output_full_load_res /= load[il];
+            PCSSM crn_ssm(crn, m_pcssm->coMode());
+            corners.push_back(crn_ssm.coTransfFunc() * m_oftf);
+        }
+    }
+
+    TunerNetwork net{m_fccd->coGainPerRes(), m_fccd->coResPullUp(), CT_CTR_SPREAD, CT_E24, CT_E12};
+    TunerTarget tg{m_fccd->coFreqCrossSection(), m_fccd->coPhaseMarg(), CT_GAIN_MARG, SET_FREQ_BEGIN, SET_FREQ_END};
+    TunerResult res = ctTune(corners, net, tg);
+
+    m_tunehshdata.insert("TFC", res.freq_cross);
+    m_tunehshdata.insert("TPM", res.phase_marg);
+    m_tunehshdata.insert("TGM", res.gain_marg);
+    m_tunehshdata.insert("TOK", res.feasible);
+    emit newTuneDataHash(m_tunehshdata);
+    if(!qIsFinite(res.cost))
+        return;
+
+    /** The chosen values replace the heuristic ones in the network and in the loop */
+    m_fccd->coApplyNetwork(res.res_zero, res.cap_zero, res.cap_pole);
+    m_ofshshdata.insert("OFSZ", 1/(2*M_PI * res.res_zero * res.cap_zero));
+    m_ofshshdata.insert("OFSP", 1/(2*M_PI * m_fccd->coResPullUp() * res.cap_pole));
+    m_ofshshdata.insert("CAPOPTO", res.cap_pole);
+    m_ofshshdata.insert("RESERR", res.res_zero);
+    m_ofshshdata.insert("CAPERR", res.cap_zero);
+
+    FreqGrid ofs_grid(SET_FREQ_BEGIN, SET_FREQ_END);
+    m_fccd->coFillFreqGrid(ofs_grid);
+
+    emit newOCFDataHash(m_ofshshdata);
+    if(m_plot_out && sweepGrid(SW_OPTO_FEEDB, ofs_grid))
+    {
+        SweepBuffer &buf = m_sweep.sbpBuffer(SW_OPTO_FEEDB);
+        m_fccd->coOptoFeedbTransfFunc(buf);
+        emit newOCFDataPlot(bpdFromSweep(buf));
+    }
+
+    calcLoopGain();
+}
+
+void PowSuppSolve::calcMonteCarlo()
+{
+    if(m_pcssm.isNull() || m_fccd.isNull())
+        return;
+
+    /** The plant is the one of the loop gain, the output filter is absent until it is calculated */
+    McModel model{m_pcssm->coPreDesign(), m_pcssm->coMode(), m_fccd->coCoeff(), m_fccd->coComp(), m_ofnet};
+    McLimits lim{m_fccd->coPhaseMarg(), CT_GAIN_MARG};
+    McResult res = mcRun(model, mcDefaultTolerances(), lim, MC_SAMPLES, MC_SEED, SET_FREQ_BEGIN, SET_FREQ_END);
+
+    m_mchshdata.insert("SMP", res.samples);
+    m_mchshdata.insert("YLD", 100. * res.mcYield());
+    m_mchshdata.insert("NOCR", res.no_cross);
+    m_mchshdata.insert("PMLO", mcPercentile(res.phase_marg, 0.01));
+    m_mchshdata.insert("GMLO", mcPercentile(res.gain_marg, 0.));
+    m_mchshdata.insert("FCLO", mcPercentile(res.freq_cross, 0.01));
+    m_mchshdata.insert("FCHI", mcPercentile(res.freq_cross, 0.99));
+    emit newMCDataHash(m_mchshdata);
+    emit newMCDataPlot(mpdFromRun(res, lim));
+}
+
+void PowSuppSolve::calcSensitivity()
+{
+    if(m_core.isNull() || m_cop.isEmpty())
+        return;
+
+    DsModel model;
+    model.input[DS_VAC_MAX] = m_indata.input_volt_ac_max;
+    model.input[DS_VAC_MIN] = m_indata.input_volt_ac_min;
+    model.input[DS_FREQ_LINE] = m_indata.freq_line;
+    model.input[DS_FREQ_SWITCH] = m_indata.freq_switch;
+    model.input[DS_EFF] = m_indata.eff;
+    model.input[DS_POUT] = m_indata.power_out_max;
+    model.input[DS_REFL_VOLT] = m_indata.refl_volt_max;
+    model.input[DS_VOLT_SPIKE] = m_indata.voltage_spike;
+    model.input[DS_RIPPLE_FACT] = static_cast<double>(m_indata.ripple_fact);
+    model.out_vlcr = {qMakePair(static_cast<float>(m_indata.volt_out_one), m_indata.curr_out_one),
+                      qMakePair(static_cast<float>(m_indata.volt_out_two), m_indata.curr_out_two),
+                      qMakePair(static_cast<float>(m_indata.volt_out_three), m_indata.curr_out_three),
+                      qMakePair(static_cast<float>(m_indata.volt_out_four), m_indata.curr_out_four)};
+    model.ca = m_ca;
+    model.cs = m_cs;
+    model.md = m_md;
+    model.fns = m_fns;
+    model.fsag = m_fsag;
+    model.mospr = m_mospr;
+    model.ccsp = m_ccsp;
+    model.cop = m_cop[0];
+    model.num_sec = static_cast<uint32_t>(m_ptsw->out_one_wind.value("NSEC"));
+    if(!m_pcssm.isNull() && !m_fccd.isNull())
+    {
+        model.has_loop = true;
+        model.ssm = m_pcssm->coPreDesign();
+        model.mode = m_pcssm->coMode();
+        model.volt_ramp = m_indata.volt_out_one + m_indata.volt_diode_drop_sec;
+        model.loop_rest = m_fccd->coCompFactors();
+        model.loop_rest.bfAppend(m_oftf.tfBodeFactors());
+        model.freq_begin = SET_FREQ_BEGIN;
+        model.freq_end = SET_FREQ_END;
+    }
+
+    emit newSensDataTable(spdFromRun(dsRun(model)));
+}
+
+void PowSuppSolve::calcFilterDesign()
+{
+    if(m_foc.isNull() || !m_ofhshdata.contains("IND") || m_indata.fl_lres <= 0)
+        return;
+
+    /** The sweep is centred on the single stage of the output filter, the source is the output capacitor */
+    m_lfs.nominal.ind = m_ofhshdata.value("IND");
+    m_lfs.nominal.cap = m_ofhshdata.value("CAP");
+    m_lfs.src_res = m_foc->out_cap_first.value("CESRO");
+    m_lfs.load_res = m_indata.fl_lres;
+    m_lfs.freq_switch = m_indata.freq_switch;
+    if(m_loopmrg.has_cross)
+        m_lfs.freq_cross = m_loopmrg.freq_cross;
+    else if(!m_fccd.isNull())
+        m_lfs.freq_cross = m_fccd->coFreqCrossSection();
+    else
+        m_lfs.freq_cross = SET_LF_CROSS_RATIO * m_indata.freq_switch;
+
+    LfSweepResult res = lfSweep(m_lfs);
+    if(res.best < 0)
+        return;
+    const LfCandidate &best = res.cand[res.best];
+    LfFilter flt = lfBuild(m_lfs, best.ind, best.cap, best.damp_res);
+
+    m_lfdhshdata.insert("LFN", flt.stage.size());
+    m_lfdhshdata.insert("LFL", best.ind);
+    m_lfdhshdata.insert("LFC", best.cap);
+    m_lfdhshdata.insert("LFRD", best.damp_res);
+    m_lfdhshdata.insert("LFCD", flt.stage.first().damp_cap);
+    m_lfdhshdata.insert("LFAT", best.met.atten_sw);
+    m_lfdhshdata.insert("LFPK", best.met.peak_db);
+    m_lfdhshdata.insert("LFFP", best.met.freq_peak);
+    m_lfdhshdata.insert("LFZO", best.met.zout_peak);
+    m_lfdhshdata.insert("LFPH", best.met.phase_cross);
+    m_lfdhshdata.insert("LFOK", best.feasible);
+    emit newLFDDataHash(m_lfdhshdata);
+
+    /** The designed filter replaces the single stage in the loop */
+    m_oftf = lfTransfFunc(flt);
+    m_ofnet = flt;
+    FreqGrid lfd_grid(SET_FREQ_BEGIN, SET_OF_FREQ_END);
+    lfFillFreqGrid(m_oftf, lfd_grid);
+    lfd_grid.fgAddCorner(m_lfs.freq_switch);
+    if(sweepGrid(SW_LC_DESIGN, lfd_grid))
+    {
+        SweepBuffer &buf = m_sweep.sbpBuffer(SW_LC_DESIGN);
+        m_oftf.tfSweep(buf);
+        emit newLFDDataPlot(bpdFromSweep(buf));
+    }
+
+    calcLoopGain();
+}
+
+void PowSuppSolve::calcMeasureImport(int32_t target, QString path)
+{
+    if(target != MF_POWER_STAGE && target != MF_OPTO_FEEDB)
+        return;
+
+    MfMeasure &meas = m_meas[target];
+    meas = mfLoad(path);
+    if(!meas.error.isEmpty())
+    {
+        qInfo(logWarning()) << (QString("Measure import of \"%1\" failed: %2").arg(path).arg(meas.error)).toStdString().c_str();
+        m_mfhshdata.clear();
+        m_mfhshdata.insert("MFN", 0);
+        emit newFitDataHash(target, m_mfhshdata);
+        return;
+    }
+    qInfo(logInfo()) << (QString("Measure import of \"%1\" - %2 points").arg(path).arg(meas.freq.size())).toStdString().c_str();
+    emit newMeasDataPlot(target, bpdFromPoints(meas.freq.constData(), meas.mag.constData(),
+                                               meas.phs.constData(), meas.freq.size()));
+}
+
+void PowSuppSolve::calcMeasureFit(int32_t target)
+{
+    if(target != MF_POWER_STAGE && target != MF_OPTO_FEEDB)
+        return;
+    const MfMeasure &meas = m_meas[target];
+    if(meas.freq.isEmpty())
+        return;
+
+    MfFitModel model;
+    model.target = static_cast<MF_TARGET>(target);
+    if(model.target == MF_POWER_STAGE)
+    {
+        if(m_pcssm.isNull())
+            return;
+        model.ssm = m_pcssm->coPreDesign();
+        model.mode = m_pcssm->coMode();
+    }
+    else
+    {
+        if(m_fccd.isNull())
+            return;
+        model.comp = m_fccd->coCoeff();
+        model.comp_type = m_fccd->coComp();
+        model.opto_ctr = m_fccd->coOptoCtr();
+    }
+
+    /** The fitted values are reported only, the design models stay as calculated */
+    MfFitResult res = mfFit(model, meas);
+
+    m_mfhshdata.clear();
+    m_mfhshdata.insert("MFN", meas.freq.size());
+    m_mfhshdata.insert("MFN0", res.nominal[0]);
+    m_mfhshdata.insert("MFN1", res.nominal[1]);
+    m_mfhshdata.insert("MFP0", res.fitted[0]);
+    m_mfhshdata.insert("MFP1", res.fitted[1]);
+    m_mfhshdata.insert("MFRM", res.rms_mag);
+    m_mfhshdata.insert("MFRP", res.rms_phs);
+    m_mfhshdata.insert("MFIT", res.iter);
+    m_mfhshdata.insert("MFOK", res.converged);
+    m_mfhshdata.insert("MFST", res.stalled);
+    emit newFitDataHash(target, m_mfhshdata);
+
+    QVector<double> mag, phs;
+    bkEvalBode(res.fit, meas.freq, mag, phs);
+    emit newFitDataPlot(target, bpdFromPoints(meas.freq.constData(), mag.constData(), phs.constData(), mag.size()));
+}
+
+void PowSuppSolve::calcDigitalComp()
+{
+    if(m_pcssm.isNull() || m_fccd.isNull() || m_dzs.freq_smp <= 2. * SET_FREQ_BEGIN)
+        return;
+
+    /** The prewarp defaults to the crossover of the analog loop */
+    double freq_warp = m_dzs.freq_warp;
+    if(freq_warp <= 0.)
+        freq_warp = m_loopmrg.has_cross ? m_loopmrg.freq_cross : m_fccd->coFreqCrossSection();
+
+    const TransferFunction comp = m_fccd->coCompTransfFunc();
+    const DzFilter flt = dzDiscretize(comp, m_dzs.method, m_dzs.freq_smp, freq_warp);
+    if(flt.sect.isEmpty())
+    {
+        qInfo(logWarning()) << "Digital compensator has no sections, discretization skipped";
+        return;
+    }
+    const DzQuantized qnt = dzQuantize(flt, m_dzs.fmt);
+
+    /** The sampled compensator sees the rest of the loop through DZ_LOOP_DELAY samples of the delay */
+    const TransferFunction plant = m_pcssm->coTransfFunc() * m_oftf;
+    const double delay = DZ_LOOP_DELAY / m_dzs.freq_smp;
+    std::function<std::complex<double>(double)> ideal_loop = [&plant, &flt, delay](double omega)
+    {
+        return plant.tfEval(omega) * flt.dzEval(omega) * std::polar(1., -omega * delay);
+    };
+    std::function<std::complex<double>(double)> quant_loop = [&plant, &qnt, delay](double omega)
+    {
+        return plant.tfEval(omega) * qnt.filt.dzEval(omega) * std::polar(1., -omega * delay);
+    };
+
+    /** The sampled response is periodic, the sweep ends at the Nyquist frequency */
+    FreqGrid dz_grid(SET_FREQ_BEGIN, 0.5 * m_dzs.freq_smp);
+    m_pcssm->coFillFreqGrid(dz_grid);
+    m_fccd->coFillFreqGrid(dz_grid);
+    if(m_loopmrg.has_cross)
+        dz_grid.fgAddCrossover(m_loopmrg.freq_cross);
+    if(!sweepGrid(SW_LOOP_DIGITAL, dz_grid))
+        return;
+
+    SweepBuffer &loop_buf = m_sweep.sbpBuffer(SW_LOOP_DIGITAL);
+    SweepBuffer &ana_buf = m_sweep.sbpBuffer(SW_COMP_ANALOG);
+    SweepBuffer &dig_buf = m_sweep.sbpBuffer(SW_COMP_DIGITAL);
+    ana_buf.sbAssignFreq(loop_buf);
+    dig_buf.sbAssignFreq(loop_buf);
+
+    dzSweep(ideal_loop, loop_buf);
+    const LoopMargins ideal_mrg = lmSolveMargins(ideal_loop, loop_buf);
+    dzSweep(quant_loop, loop_buf);
+    const LoopMargins quant_mrg = lmSolveMargins(quant_loop, loop_buf);
+    comp.tfSweep(ana_buf);
+    dzSweep([&qnt](double omega){return qnt.filt.dzEval(omega);}, dig_buf);
+
+    /** The margin of the loop without the crossover or the -180 deg point is NaN, as are its losses */
+    m_dzhshdata.insert("DZFC", quant_mrg.has_cross ? quant_mrg.freq_cross : qQNaN());
+    m_dzhshdata.insert("DZPM", quant_mrg.has_cross ? quant_mrg.phase_marg : qQNaN());
+    m_dzhshdata.insert("DZGM", quant_mrg.has_180 ? quant_mrg.gain_marg : qQNaN());
+    m_dzhshdata.insert("DZPL", (m_loopmrg.has_cross && quant_mrg.has_cross) ? m_loopmrg.phase_marg - quant_mrg.phase_marg : qQNaN());
+    m_dzhshdata.insert("DZGL", (m_loopmrg.has_180 && quant_mrg.has_180) ? m_loopmrg.gain_marg - quant_mrg.gain_marg : qQNaN());
+    m_dzhshdata.insert("DZQL", (ideal_mrg.has_cross && quant_mrg.has_cross) ? ideal_mrg.phase_marg - quant_mrg.phase_marg : qQNaN());
+    m_dzhshdata.insert("DZPR", qnt.filt.dzPoleRadius());
+    m_dzhshdata.insert("DZNS", qnt.filt.sect.size());
+    m_dzhshdata.insert("DZSAT", qnt.saturated);
+
+    emit newDZDataHash(m_dzhshdata);
+    if(m_plot_out)
+        emit newDZDataPlot(dpdFromRun(ana_buf, dig_buf, loop_buf, qnt));
+}
+
+void PowSuppSolve::calcLoopGain()
+{
+    if(m_pcssm.isNull() || m_fccd.isNull())
+        return;
+
+    m_looptf = m_pcssm->coTransfFunc() * m_fccd->coCompTransfFunc() * m_oftf;
+    m_zoltf = m_pcssm->coOutImpTransfFunc() * m_oftf;
+    m_audtf = m_pcssm->coLineToOutTransfFunc() * m_oftf;
+    m_loopmrg = lmSolveMargins(m_looptf, SET_FREQ_BEGIN, SET_FREQ_END);
+
+    FreqGrid loop_grid(SET_FREQ_BEGIN, SET_FREQ_END);
+    m_pcssm->coFillFreqGrid(loop_grid);
+    m_fccd->coFillFreqGrid(loop_grid);
+    if(m_loopmrg.has_cross)
+        loop_grid.fgAddCrossover(m_loopmrg.freq_cross);
+
+    LoopNyquist loop_nyq;
+    bool swept = sweepGrid(SW_LOOP_GAIN, loop_grid);
+    if(swept)
+    {
+        /** Margins are bracketed by the same points the views are drawn from */
+        SweepBuffer &buf = m_sweep.sbpBuffer(SW_LOOP_GAIN);
+        loop_nyq = lmSweepLoop(m_looptf, {m_zoltf, m_audtf}, buf,
+                               {&m_sweep.sbpBuffer(SW_CLOSED_LOOP), &m_sweep.sbpBuffer(SW_OUT_IMP), &m_sweep.sbpBuffer(SW_AUDIO_SUSC)});
+        m_loopmrg = lmSolveMargins(m_looptf.tfBodeFactors(), buf);
+    }
+
+    m_loophshdata.insert("FC", m_loopmrg.freq_cross);
+    m_loophshdata.insert("PM", m_loopmrg.phase_marg);
+    m_loophshdata.insert("F180", m_loopmrg.freq_180);
+    m_loophshdata.insert("GM", m_loopmrg.gain_marg);
+    m_loophshdata.insert("ENC", loop_nyq.encircle);
+    m_loophshdata.insert("ORHP", loop_nyq.open_rhp);
+    m_loophshdata.insert("CRHP", loop_nyq.closed_rhp);
+
+    emit newLoopDataHash(m_loophshdata);
+    if(swept)
+    {
+        const SweepBuffer &cl_buf = m_sweep.sbpBuffer(SW_CLOSED_LOOP);
+        const SweepBuffer &zo_buf = m_sweep.sbpBuffer(SW_OUT_IMP);
+        const SweepBuffer &as_buf = m_sweep.sbpBuffer(SW_AUDIO_SUSC);
+
+        /** The unstable loop has no closed loop response, the figures are reported as NaN */
+        const bool cl_stable = (loop_nyq.closed_rhp == 0);
+        ClosedLoopFigures cl_fig;
+        if(cl_stable)
+        {
+            cl_fig = lmClosedFigures(cl_buf, zo_buf, as_buf);
+        }
+        else
+        {
+            cl_fig.bandwidth = cl_fig.peaking = qQNaN();
+            cl_fig.zout_peak = cl_fig.zout_freq = qQNaN();
+            cl_fig.audio_peak = cl_fig.audio_freq = qQNaN();
+        }
+        m_clhshdata.insert("CLBW", cl_fig.bandwidth);
+        m_clhshdata.insert("CLPK", cl_fig.peaking);
+        m_clhshdata.insert("ZOPK", cl_fig.zout_peak);
+        m_clhshdata.insert("ZOPF", cl_fig.zout_freq);
+        m_clhshdata.insert("ASPK", cl_fig.audio_peak);
+        m_clhshdata.insert("ASPF", cl_fig.audio_freq);
+
+        emit newCLDataHash(m_clhshdata);
+        if(m_plot_out)
+        {
+            emit newLoopDataPlot(lpdFromSweep(m_sweep.sbpBuffer(SW_LOOP_GAIN)));
+            emit newCLDataPlot(cl_stable ? cpdFromSweep(cl_buf, zo_buf, as_buf) : ClosedLoopPlotData());
+        }
+    }
+}
+
+void PowSuppSolve::calcRootLocus()
+{
+    if(m_pcssm.isNull() || m_fccd.isNull())
+        return;
+
+    const QVector<double> gain = rlGainSpace(RL_GAIN_MIN, RL_GAIN_MAX, RL_GAIN_STEPS);
+
+    /** The headless run needs the stable range only, the poles are not solved for it */
+    QSharedPointer<RootLocus> locus;
+    double kmin = 0., kmax = 0.;
+    bool stable;
+    if(m_plot_out)
+    {
+        locus.reset(new RootLocus(rlSolveLocus(m_looptf, gain)));
+        stable = rlStableRange(*locus, kmin, kmax);
+    }
+    else
+    {
+        stable = rlStableRange(m_looptf, gain, kmin, kmax);
+    }
+
+    /** No stable range is reported as zero for both ends */
+    if(!stable)
+        kmin = kmax = 0.;
+    m_locushshdata.insert("KMIN", kmin);
+    m_locushshdata.insert("KMAX", kmax);
+    m_locushshdata.insert("CTRMIN", kmin * m_fccd->coOptoCtr());
+    m_locushshdata.insert("CTRMAX", kmax * m_fccd->coOptoCtr());
+
+    emit newLocusDataHash(m_locushshdata);
+    if(m_plot_out)
+    {
+        RootLocusPlotData pl_data = rpdFromLocus(locus);
+        pl_data.ctr = m_fccd->coOptoCtr();
+        pl_data.span = m_loopmrg.has_cross ? 4. * 2*M_PI * m_loopmrg.freq_cross : 2*M_PI * SET_FREQ_END;
+        emit newLocusDataPlot(pl_data);
+    }
+}
+
+void PowSuppSolve::calcTransient()
+{
+    if(m_pcssm.isNull() || m_fccd.isNull())
+        return;
+
+    /** The disturbance reaches the output through its open loop path times 1/(1 + T) */
+    TransferFunction sens = TransferFunction::tfFeedback(TransferFunction(1.), m_looptf);
+    bool stable = m_loopmrg.has_cross;
+    for(const TransferFunction::Root &pl : sens.tfPoles())
+    {
+        stable = stable && (pl.real() < 0.);
+    }
+
+    /** The unstable loop has no steady state, all values are reported as NaN */
+    StepResponse load, line;
+    if(!stable)
+    {
+        load.overshoot = load.undershoot = load.settling = qQNaN();
+        line.overshoot = line.undershoot = line.settling = qQNaN();
+    }
+    else
+    {
+        const double dt = SET_TR_CROSS_PERIODS / (m_loopmrg.freq_cross * SET_TR_SAMPLES);
+        StateSpace zcl((m_zoltf * sens).tfCancel());
+        StateSpace gcl((m_audtf * sens).tfCancel());
+        /** v = -Z i, the load rises by the step */
+        load = zcl.ssStepResponse(-SET_TR_LOAD_STEP * m_pcssm->coLoadCurrent(), dt, SET_TR_SAMPLES);
+        line = gcl.ssStepResponse(SET_TR_LINE_STEP * m_pcssm->coInputVoltage(), dt, SET_TR_SAMPLES);
+    }
+
+    m_transhshdata.insert("LDOS", load.overshoot);
+    m_transhshdata.insert("LDUS", load.undershoot);
+    m_transhshdata.insert("LDST", load.settling);
+    m_transhshdata.insert("LNOS", line.overshoot);
+    m_transhshdata.insert("LNUS", line.undershoot);
+    m_transhshdata.insert("LNST", line.settling);
+
+    emit newTransDataHash(m_transhshdata);
+    if(m_plot_out)
+        emit newTransDataPlot(stable ? tpdFromStep(load, line) : TransientPlotData());
+}
+
+void PowSuppSolve::setSweepPrecision(SWEEP_ID id, BK_PREC prec)
+{
+    m_sweep.sbpBuffer(id).sbSetPrecision(prec);
+}
+
+void PowSuppSolve::setPlotOutput(bool enabled)
+{
+    m_plot_out = enabled;
+}
+
+void PowSuppSolve::deriveOutputPower()
+{
+    m_indata.power_out_max = static_cast<double>(((m_indata.volt_out_one * m_indata.curr_out_one)
+                                                  +(m_indata.volt_out_two * m_indata.curr_out_two)
+                                                  +(m_indata.volt_out_three * m_indata.curr_out_three)
+                                                  +(m_indata.volt_out_four * m_indata.curr_out_four)
+                                                  +(m_indata.volt_out_aux * m_indata.curr_out_aux)) * m_indata.mrgn);
+}
+
+void PowSuppSolve::deriveSwitchNetwork()
+{
+    m_ccsp.cl_first_out_volt = m_indata.volt_out_one;
+    m_ccsp.cl_turn_rat = commTurnRatio();
+    m_ccsp.leakage_induct = m_indata.leakage_induct;
+}
+
+void PowSuppSolve::deriveOutCap()
+{
+    m_cop.resize(5);
+    m_cop[0].co_volts_out = m_indata.volt_out_one;
+    m_cop[0].co_curr_peak_out = m_indata.curr_out_one;
+    m_cop[1].co_volts_out = m_indata.volt_out_two;
+    m_cop[1].co_curr_peak_out = m_indata.curr_out_two;
+    m_cop[2].co_volts_out = m_indata.volt_out_three;
+    m_cop[2].co_curr_peak_out = m_indata.curr_out_three;
+    m_cop[3].co_volts_out = m_indata.volt_out_four;
+    m_cop[3].co_curr_peak_out = m_indata.curr_out_four;
+    m_cop[4].co_volts_out = m_indata.volt_out_aux;
+    m_cop[4].co_curr_peak_out = m_indata.curr_out_aux;
+}
+
+void PowSuppSolve::derivePowerStageModel()
+{
+    const float turn_ratio = commTurnRatio();
+
+    m_ssm.input_voltage = m_indata.input_volt_ac_max;
+    m_ssm.freq_switch = m_indata.freq_switch;
+    m_ssm.actual_duty = m_ptpe->actual_max_duty_cycle;
+    m_ssm.primary_ind = m_ptpe->primary_induct;
+    m_ssm.res_sense = m_pm->curr_sense_res;
+    m_ssm.output_voltage = m_indata.volt_out_one;
+    m_ssm.output_full_load_res = m_indata.volt_out_one/m_indata.curr_out_one;
+    m_ssm.turn_ratio = turn_ratio /*m_ptpe->number_primary/m_ptsw->out_one_wind.value("NSEC")*/;
+    m_ssm.output_cap = m_foc->out_cap_first["CVO"];
+    m_ssm.output_cap_esr = m_foc->out_cap_first["CESRO"];
+    // External ramp slope compensation(S_e)
+    // Basso C.-The TL431 in Switch-Mode Power Supplies loops: part V
+    m_ssm.sawvolt = 0.5 * ((m_indata.volt_out_one + m_indata.volt_diode_drop_sec)/(turn_ratio * m_ptpe->primary_induct) * m_pm->curr_sense_res);
+}
+
+void PowSuppSolve::deriveOptocouplerFeedback()
+{
+    m_fc.out_voltage = m_indata.volt_out_one;
+    m_fc.out_current = m_indata.curr_out_one;
+    m_fc.freq_sw = m_indata.freq_switch;
+    m_fc.out_sm_cap = m_foc->out_cap_first.value("CVO");
+    m_fc.out_sm_cap_esr = m_foc->out_cap_first.value("CESRO");
+
+    m_rs.inp_voltage = m_indata.input_volt_ac_min;
+    m_rs.prim_turns = m_ptpe->actual_num_primary;
+    m_rs.sec_turns_to_control = m_ptsw->out_one_wind["NSEC"];
+    m_rs.actual_duty = m_ptpe->actual_max_duty_cycle;
+    m_rs.out_pwr_tot = m_indata.power_out_max;
+    m_rs.primary_ind = m_ptpe->primary_induct;
+    m_rs.res_sense = m_pm->curr_sense_res;
+
+    m_lc.lcf_ind = m_ofhshdata.value("CAP");
+    m_lc.lcf_cap = m_ofhshdata.value("IND");
+}
+
+void PowSuppSolve::calcDesign()
+{
+    /** The stage which is not reached by the design keeps no values of the previous one */
+    m_ofhshdata.clear();
+    m_ssmhshdata.clear();
+    m_ofshshdata.clear();
+    m_mmhshdata.clear();
+    m_loophshdata.clear();
+    m_clhshdata.clear();
+    m_locushshdata.clear();
+    m_transhshdata.clear();
+    m_dzhshdata.clear();
+
+    deriveOutputPower();
+    calcInputNetwork();
+    calcElectricalPrimarySide();
+    calcArea();
+    calcElectroMagProperties();
+    calcTransformerWired();
+    deriveSwitchNetwork();
+    calcSwitchNetwork();
+    deriveOutCap();
+    calcOtputNetwork();
+    calcOutputFilter();
+    derivePowerStageModel();
+    calcPowerStageModel();
+    deriveOptocouplerFeedback();
+    calcOptocouplerFeedback();
+    /** The analyses of the own tabs in the GUI, the digital loop only with the sample rate set */
+    if(m_dzs.freq_smp > 0.)
+        calcDigitalComp();
+    calcRootLocus();
+    calcTransient();
+
+    emit calcFinished();
+}
+
+float PowSuppSolve::commTurnRatio() const
+{
+    // Determine the turns ratio
+    // See Ayachit A.-Magnetising inductance of multiple-output flyback dc–dc convertor for dcm.
+    double n_frst = m_ptpe->actual_max_duty_cycle/((1-m_ptpe->actual_max_duty_cycle)*(m_indata.volt_out_one/
+                                                                                    (M_SQRT2*m_indata.input_volt_ac_min)));
+    return static_cast<float>(m_ptpe->actual_num_primary/n_frst);
+}
+
+bool PowSuppSolve::sweepGrid(SWEEP_ID id, const FreqGrid &grid)
+{
+    SweepBuffer &buf = m_sweep.sbpBuffer(id);
+    const size_t footprint = buf.sbFootprint();
+    if(!buf.sbAssignFreq(grid.fgBuild()))
+    {
+        qWarning(logWarning()) << "Sweep" << id << "is above" << SB_MAX_POINTS << "points, skipped";
+        return false;
+    }
+    /** The buffers are reused, the pool is reported only when one of them grows */
+    if(buf.sbFootprint() > footprint)
+        qDebug(logDebug()) << "Sweep buffers footprint" << m_sweep.sbpFootprint() << "bytes";
+    return true;
+}
@@ -0,0 +1,367 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "inc/rootlocus.h"
+#include "inc/poolrunner.h"
+#include <algorithm>
+#include <limits>
+
+typedef TransferFunction::Root Root;
+
+/**
+ * @brief rlMatch - branch order of the step poles along the previous step,
+ *        the closest pairs by the relative distance are taken first
+ * @param prev - poles of the previous step
+ * @param cur - poles of the step
+ * @param deg - number of poles
+ * @param perm - out index into cur for each branch
+ */
+static void rlMatch(const Root *prev, const Root *cur, int32_t deg, int32_t *perm)
+{
+    struct Pair
+    {
+        double dist;
+        int32_t from;
+        int32_t to;
+    };
+    QVector<Pair> pair;
+    pair.reserve(deg * deg);
+    for(int32_t from = 0; from < deg; ++from)
+    {
+        for(int32_t to = 0; to < deg; ++to)
+        {
+            double scl = std::abs(prev[from]) + std::abs(cur[to]);
+            double dist = std::abs(prev[from] - cur[to]) / qMax(scl, std::numeric_limits<double>::min());
+            if(qIsNaN(dist))
+                dist = std::numeric_limits<double>::infinity();
+            pair.push_back({dist, from, to});
+        }
+    }
+    std::sort(pair.begin(), pair.end(), [](const Pair &lhs, const Pair &rhs)
+    {
+        return lhs.dist < rhs.dist;
+    });
+
+    QVector<bool> used_from(deg, false), used_to(deg, false);
+    for(const Pair &pr : pair)
+    {
+        if(used_from[pr.from] || used_to[pr.to])
+            continue;
+        perm[pr.from] = pr.to;
+        used_from[pr.from] = true;
+        used_to[pr.to] = true;
+    }
+}
+
+/**
+ * @brief rlPermute - reorder the poles of the step by the branch permutation
+ */
+static void rlPermute(Root *cur, const int32_t *perm, int32_t deg)
+{
+    QVector<Root> tmp(cur, cur + deg);
+    for(int32_t branch = 0; branch < deg; ++branch)
+    {
+        cur[branch] = tmp[perm[branch]];
+    }
+}
+
+/**
+ * @brief rlPoles - roots of the characteristic polynomial, the roots at origin are
+ *        split off, the ones gone to infinity by the vanished leading coefficient are NaN
+ * @param poly - coefficients in ascending power of s
+ * @param guess - warm start, the roots of the previous step
+ * @param out - deg roots
+ */
+static void rlPoles(const QVector<double> &poly, const QVector<Root> &guess, Root *out, int32_t deg)
+{
+    int32_t lead = 0;
+    while(lead <= deg && poly[lead] == 0.)
+        ++lead;
+
+    int32_t cnt = 0;
+    for(; cnt < qMin(lead, deg); ++cnt)
+    {
+        out[cnt] = Root(0., 0.);
+    }
+    if(lead < deg)
+    {
+        for(const Root &rt : TransferFunction::tfRoots(poly.mid(lead), guess))
+        {
+            out[cnt++] = rt;
+        }
+    }
+    for(; cnt < deg; ++cnt)
+    {
+        out[cnt] = Root(std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+/**
+ * @brief rlCharParts - parts of the characteristic polynomial D(s) + k*N(s)
+ *        in ascending power of s, both of deg + 1 coefficients
+ * @return deg, the order of the closed loop
+ */
+static int32_t rlCharParts(const TransferFunction &tf, QVector<double> &den, QVector<double> &num)
+{
+    /** 1 + k*g*s^o*N/D = 0 -> D + k*g*s^o*N = 0, with the negative o both parts are multiplied by s^-o */
+    den = tf.tfDenominator();
+    num = tf.tfNumerator();
+    for(double &cf : num)
+    {
+        cf *= tf.tfGain();
+    }
+    if(tf.tfOrder() >= 0)
+        num.insert(0, tf.tfOrder(), 0.);
+    else
+        den.insert(0, -tf.tfOrder(), 0.);
+    const int32_t deg = qMax(num.size(), den.size()) - 1;
+    num.resize(qMax(deg + 1, 0));
+    den.resize(qMax(deg + 1, 0));
+    return deg;
+}
+
+/**
+ * @brief rlHurwitz - all the roots in the open lhp by the Routh array,
+ *        the vanished leading coefficients are the roots gone to infinity and are dropped
+ * @param poly - coefficients in ascending power of s
+ * @param deg - highest power
+ * @param upper - scratch of deg/2 + 1 elements
+ * @param lower - scratch of deg/2 + 1 elements
+ */
+static bool rlHurwitz(const double *poly, int32_t deg, double *upper, double *lower)
+{
+    while(deg > 0 && poly[deg] == 0.)
+        --deg;
+    if(deg <= 0)
+        return true;
+
+    /** The coefficients of the same sign are necessary, the root at origin and NaN fail here */
+    const double sgn = (poly[deg] > 0.) ? 1. : -1.;
+    for(int32_t cf = 0; cf <= deg; ++cf)
+    {
+        if(!(sgn * poly[cf] > 0.))
+            return false;
+    }
+
+    const int32_t width = deg/2 + 1;
+    for(int32_t col = 0; col < width; ++col)
+    {
+        upper[col] = poly[deg - 2*col];
+        lower[col] = (deg - 2*col - 1 >= 0) ? poly[deg - 2*col - 1] : 0.;
+    }
+
+    /** Any sign change or zero of the first column is the root on or right of the axis */
+    for(int32_t rw = 1; rw <= deg; ++rw)
+    {
+        if(!(sgn * lower[0] > 0.))
+            return false;
+        const double ratio = upper[0] / lower[0];
+        for(int32_t col = 0; col < width - 1; ++col)
+        {
+            const double next = upper[col + 1] - ratio * lower[col + 1];
+            upper[col] = lower[col];
+            lower[col] = next;
+        }
+        upper[width - 1] = lower[width - 1];
+        lower[width - 1] = 0.;
+    }
+    return true;
+}
+
+/**
+ * @brief The RootLocusJob struct - slices of the gain vector shared by the workers
+ */
+struct RootLocusJob
+{
+    QVector<double> den; //Denominator of T(s) with the integrators, deg + 1 coefficients
+    QVector<double> num; //Numerator of T(s) with the gain and the differentiators, deg + 1 coefficients
+    const double *gain;
+    int32_t steps;
+    int32_t deg;
+    Root *root;
+    PoolSlices slices;
+
+    /**
+     * @brief prRunSlices - take the slices one by one until nothing left
+     */
+    void prRunSlices()
+    {
+        QVector<double> poly(deg + 1);
+        QVector<Root> guess;
+        QVector<int32_t> perm(deg);
+        int32_t chunk;
+        while(slices.prTake(chunk))
+        {
+            const int32_t begin = chunk * RL_CHUNK_STEPS;
+            const int32_t end = qMin(begin + RL_CHUNK_STEPS, steps);
+            guess.clear();
+            for(int32_t step = begin; step < end; ++step)
+            {
+                for(int32_t cf = 0; cf <= deg; ++cf)
+                {
+                    poly[cf] = den[cf] + gain[step] * num[cf];
+                }
+                Root *out = root + step * deg;
+                rlPoles(poly, guess, out, deg);
+                if(step > begin)
+                {
+                    rlMatch(out - deg, out, deg, perm.data());
+                    rlPermute(out, perm.data(), deg);
+                }
+
+                /** The exactly real and conjugate start stays on the axis, tilt it */
+                guess.resize(deg);
+                for(int32_t branch = 0; branch < deg; ++branch)
+                {
+                    if(qIsNaN(out[branch].real()))
+                    {
+                        guess.clear();
+                        break;
+                    }
+                    guess[branch] = out[branch] * Root(1., RL_WARM_TILT);
+                }
+            }
+        }
+    }
+};
+
+QVector<double> rlGainSpace(double begin, double end, int32_t steps)
+{
+    QVector<double> out;
+    if(begin <= 0. || end < begin || steps <= 0)
+        return out;
+    out.reserve(steps);
+    for(int32_t indx = 0; indx < steps; ++indx)
+    {
+        out.push_back(begin * qPow(end/begin, (steps > 1) ? static_cast<double>(indx) / (steps - 1) : 0.));
+    }
+    return out;
+}
+
+RootLocus rlSolveLocus(const TransferFunction &tf, const QVector<double> &gain)
+{
+    RootLocus out;
+    out.gain = gain;
+    out.open_poles = tf.tfPoles();
+    out.open_zeros = tf.tfZeros();
+    out.open_poles.insert(0, qMax(-tf.tfOrder(), 0), Root(0., 0.));
+    out.open_zeros.insert(0, qMax(tf.tfOrder(), 0), Root(0., 0.));
+
+    RootLocusJob job;
+    job.deg = rlCharParts(tf, job.den, job.num);
+    if(job.deg <= 0 || gain.isEmpty())
+        return out;
+
+    job.gain = gain.constData();
+    job.steps = gain.size();
+    job.slices.count = (job.steps + RL_CHUNK_STEPS - 1) / RL_CHUNK_STEPS;
+    out.branches = job.deg;
+    out.root.resize(job.steps * job.deg);
+    job.root = out.root.data();
+
+    prRunPool(job);
+
+    /** The branches of the slice follow the last step of the previous slice */
+    QVector<int32_t> perm(job.deg);
+    for(int32_t chunk = 1; chunk < job.slices.count; ++chunk)
+    {
+        const int32_t begin = chunk * RL_CHUNK_STEPS;
+        const int32_t end = qMin(begin + RL_CHUNK_STEPS, job.steps);
+        rlMatch(job.root + (begin - 1) * job.deg, job.root + begin * job.deg, job.deg, perm.data());
+        for(int32_t step = begin; step < end; ++step)
+        {
+            rlPermute(job.root + step * job.deg, perm.data(), job.deg);
+        }
+    }
+    return out;
+}
+
+bool rlStableRange(const RootLocus &rl, double &kmin, double &kmax)
+{
+    kmin = 0.;
+    kmax = std::numeric_limits<double>::infinity();
+    if(rl.gain.isEmpty() || rl.branches == 0)
+        return false;
+
+    auto stable = [&rl](int32_t step)
+    {
+        for(int32_t branch = 0; branch < rl.branches; ++branch)
+        {
+            if(rl.rlRoot(step, branch).real() >= 0.)
+                return false;
+        }
+        return true;
+    };
+
+    const int32_t last = rl.gain.size() - 1;
+    int32_t nom = static_cast<int32_t>(std::lower_bound(rl.gain.constBegin(), rl.gain.constEnd(), 1.) - rl.gain.constBegin());
+    nom = qMin(nom, last);
+    if(!stable(nom))
+        return false;
+
+    int32_t lo = nom, hi = nom;
+    while(lo > 0 && stable(lo - 1))
+        --lo;
+    while(hi < last && stable(hi + 1))
+        ++hi;
+    if(lo > 0)
+        kmin = rl.gain[lo];
+    if(hi < last)
+        kmax = rl.gain[hi];
+    return true;
+}
+
+bool rlStableRange(const TransferFunction &tf, const QVector<double> &gain, double &kmin, double &kmax)
+{
+    kmin = 0.;
+    kmax = std::numeric_limits<double>::infinity();
+    QVector<double> den, num;
+    const int32_t deg = rlCharParts(tf, den, num);
+    if(gain.isEmpty() || deg <= 0)
+        return false;
+
+    QVector<double> poly(deg + 1), upper(deg/2 + 1), lower(deg/2 + 1);
+    auto stable = [&](int32_t step)
+    {
+        for(int32_t cf = 0; cf <= deg; ++cf)
+        {
+            poly[cf] = den[cf] + gain[step] * num[cf];
+        }
+        return rlHurwitz(poly.constData(), deg, upper.data(), lower.data());
+    };
+
+    /** The same walk from the unit multiplier as the locus form */
+    const int32_t last = gain.size() - 1;
+    int32_t nom = static_cast<int32_t>(std::lower_bound(gain.constBegin(), gain.constEnd(), 1.) - gain.constBegin());
+    nom = qMin(nom, last);
+    if(!stable(nom))
+        return false;
+
+    int32_t lo = nom, hi = nom;
+    while(lo > 0 && stable(lo - 1))
+        --lo;
+    while(hi < last && stable(hi + 1))
+        ++hi;
+    if(lo > 0)
+        kmin = gain[lo];
+    if(hi < last)
+        kmax = gain[hi];
+    return true;
+}
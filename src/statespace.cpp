@@ -0,0 +1,407 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include "inc/statespace.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+typedef TransferFunction::Root Root;
+
+/**
+ * @brief The SSSection struct - roots of one section, the complex root stands for its pair
+ */
+struct SSSection
+{
+    QVector<Root> pole;
+    QVector<Root> zero;
+    int32_t deg; //Order of the section
+    int32_t used; //Order of the zeros placed into the section
+};
+
+/**
+ * @brief ssMulRoot - multiply the polynomial by s, (1 - s/r) or the pair (1 - s*2Re(r)/|r|^2 + s^2/|r|^2)
+ * @param poly - coefficients in ascending power of s
+ * @param rt - root, the complex one stands for its pair
+ */
+static void ssMulRoot(QVector<double> &poly, const Root &rt)
+{
+    QVector<double> fct;
+    if(rt == Root(0., 0.))
+        fct = {0., 1.};
+    else if(rt.imag() == 0.)
+        fct = {1., -1./rt.real()};
+    else
+        fct = {1., -2. * rt.real() / std::norm(rt), 1. / std::norm(rt)};
+
+    QVector<double> out(poly.size() + fct.size() - 1, 0.);
+    for(int32_t indx = 0; indx < poly.size(); ++indx)
+    {
+        for(int32_t jndx = 0; jndx < fct.size(); ++jndx)
+        {
+            out[indx + jndx] += poly[indx] * fct[jndx];
+        }
+    }
+    poly.swap(out);
+}
+
+/**
+ * @brief ssMatMul - out = lhs * rhs of the row major square matrices
+ */
+static void ssMatMul(const double *lhs, const double *rhs, double *out, int32_t dim)
+{
+    std::fill(out, out + dim * dim, 0.);
+    for(int32_t row = 0; row < dim; ++row)
+    {
+        for(int32_t knd = 0; knd < dim; ++knd)
+        {
+            const double val = lhs[row * dim + knd];
+            if(val == 0.)
+                continue;
+            for(int32_t col = 0; col < dim; ++col)
+            {
+                out[row * dim + col] += val * rhs[knd * dim + col];
+            }
+        }
+    }
+}
+
+StateSpace::StateSpace(const TransferFunction &tf)
+{
+    QVector<Root> preal, pcplx, zreal, zcplx;
+    preal.insert(0, qMax(-tf.tfOrder(), 0), Root(0., 0.));
+    zreal.insert(0, qMax(tf.tfOrder(), 0), Root(0., 0.));
+    for(const Root &pl : tf.tfPoles())
+    {
+        if(pl.imag() == 0.)
+            preal.push_back(pl);
+        else if(pl.imag() > 0.)
+            pcplx.push_back(pl);
+    }
+    for(const Root &zr : tf.tfZeros())
+    {
+        if(zr.imag() == 0.)
+            zreal.push_back(zr);
+        else if(zr.imag() > 0.)
+            zcplx.push_back(zr);
+    }
+    if(zreal.size() + 2 * zcplx.size() > preal.size() + 2 * pcplx.size())
+        return;
+
+    /** The complex zero pair takes the second order section, the real poles are paired for it if needed */
+    QVector<SSSection> sect;
+    for(const Root &pl : pcplx)
+    {
+        sect.push_back({{pl}, {}, 2, 0});
+    }
+    for(int32_t extra = zcplx.size() - pcplx.size(); extra > 0; --extra)
+    {
+        sect.push_back({{preal[0], preal[1]}, {}, 2, 0});
+        preal.erase(preal.begin(), preal.begin() + 2);
+    }
+    for(const Root &pl : preal)
+    {
+        sect.push_back({{pl}, {}, 1, 0});
+    }
+    for(const Root &zr : zcplx)
+    {
+        auto it = std::find_if(sect.begin(), sect.end(), [](const SSSection &sc){return sc.deg == 2 && sc.used == 0;});
+        it->zero.push_back(zr);
+        it->used = 2;
+    }
+    for(const Root &zr : zreal)
+    {
+        auto it = std::find_if(sect.begin(), sect.end(), [](const SSSection &sc){return sc.used < sc.deg;});
+        it->zero.push_back(zr);
+        it->used += 1;
+    }
+
+    for(const SSSection &sc : sect)
+    {
+        m_order += sc.deg;
+    }
+    const int32_t dim = m_order;
+    m_a.fill(0., dim * dim);
+    m_b.fill(0., dim);
+    m_row_end.fill(0, dim);
+
+    /**
+     * The input of the section is the output of the previous one,
+     * y = crow*x + dval*u is the output of the sections placed so far.
+     */
+    QVector<double> crow(dim, 0.);
+    double dval = 1.;
+    int32_t off = 0;
+    for(const SSSection &sc : sect)
+    {
+        QVector<double> den{1.}, num{1.};
+        for(const Root &pl : sc.pole)
+            ssMulRoot(den, pl);
+        for(const Root &zr : sc.zero)
+            ssMulRoot(num, zr);
+        const int32_t deg = sc.deg;
+        num.resize(deg + 1);
+
+        /** Monic denominator, the second order state is scaled by the natural frequency */
+        double as[4] = {0., 0., 0., 0.}, bs[2] = {0., 1.}, cs[2] = {0., 0.}, ds;
+        const double a0 = den[0] / den[deg];
+        if(deg == 1)
+        {
+            as[0] = -a0;
+            bs[0] = 1.;
+            cs[0] = num[0] / den[1] - num[1] / den[1] * a0;
+            ds = num[1] / den[1];
+        }
+        else
+        {
+            const double a1 = den[1] / den[2];
+            const double b0 = num[0] / den[2], b1 = num[1] / den[2], b2 = num[2] / den[2];
+            double wn = std::sqrt(std::abs(a0));
+            if(wn == 0.)
+                wn = (a1 != 0.) ? std::abs(a1) : 1.;
+            as[1] = wn;
+            as[2] = -a0 / wn;
+            as[3] = -a1;
+            cs[0] = (b0 - b2 * a0) / wn;
+            cs[1] = b1 - b2 * a1;
+            ds = b2;
+        }
+
+        for(int32_t row = 0; row < deg; ++row)
+        {
+            for(int32_t col = 0; col < deg; ++col)
+            {
+                m_a[(off + row) * dim + off + col] = as[row * deg + col];
+            }
+            for(int32_t col = 0; col < off; ++col)
+            {
+                m_a[(off + row) * dim + col] = bs[row] * crow[col];
+            }
+            m_b[off + row] = bs[row] * dval;
+            m_row_end[off + row] = off + deg;
+        }
+        for(int32_t col = 0; col < off; ++col)
+        {
+            crow[col] *= ds;
+        }
+        for(int32_t row = 0; row < deg; ++row)
+        {
+            crow[off + row] = cs[row];
+        }
+        dval *= ds;
+        off += deg;
+    }
+
+    m_c = crow;
+    for(double &cf : m_c)
+    {
+        cf *= tf.tfGain();
+    }
+    m_d = dval * tf.tfGain();
+    if(tf.tfOrder() == 0)
+        m_dc = tf.tfGain();
+    else
+        m_dc = (tf.tfOrder() > 0) ? 0. : std::numeric_limits<double>::infinity();
+    m_valid = true;
+}
+
+void StateSpace::ssExpm(QVector<double> &mat, int32_t dim)
+{
+    double norm = 0.;
+    for(int32_t col = 0; col < dim; ++col)
+    {
+        double sum = 0.;
+        for(int32_t row = 0; row < dim; ++row)
+            sum += std::abs(mat[row * dim + col]);
+        norm = qMax(norm, sum);
+    }
+    int32_t squar = 0;
+    if(norm > SS_NORM_MAX)
+        squar = static_cast<int32_t>(std::ceil(std::log2(norm / SS_NORM_MAX)));
+    const double scl = std::ldexp(1., -squar);
+    for(double &val : mat)
+        val *= scl;
+
+    /** N = sum c_k X^k, D = sum (-1)^k c_k X^k */
+    const int32_t size = dim * dim;
+    QVector<double> pw(size, 0.), tmp(size), num(size, 0.), den(size, 0.);
+    for(int32_t indx = 0; indx < dim; ++indx)
+    {
+        pw[indx * dim + indx] = 1.;
+        num[indx * dim + indx] = 1.;
+        den[indx * dim + indx] = 1.;
+    }
+    double cf = 1.;
+    for(int32_t knd = 1; knd <= SS_PADE_ORDER; ++knd)
+    {
+        cf *= static_cast<double>(SS_PADE_ORDER - knd + 1) / (knd * (2 * SS_PADE_ORDER - knd + 1));
+        ssMatMul(pw.constData(), mat.constData(), tmp.data(), dim);
+        pw.swap(tmp);
+        const double sgn = (knd % 2) ? -cf : cf;
+        for(int32_t indx = 0; indx < size; ++indx)
+        {
+            num[indx] += cf * pw[indx];
+            den[indx] += sgn * pw[indx];
+        }
+    }
+
+    /** D R = N by the elimination with the partial pivoting */
+    for(int32_t col = 0; col < dim; ++col)
+    {
+        int32_t piv = col;
+        for(int32_t row = col + 1; row < dim; ++row)
+        {
+            if(std::abs(den[row * dim + col]) > std::abs(den[piv * dim + col]))
+                piv = row;
+        }
+        if(piv != col)
+        {
+            std::swap_ranges(den.begin() + piv * dim, den.begin() + (piv + 1) * dim, den.begin() + col * dim);
+            std::swap_ranges(num.begin() + piv * dim, num.begin() + (piv + 1) * dim, num.begin() + col * dim);
+        }
+        const double inv = 1. / den[col * dim + col];
+        for(int32_t row = 0; row < dim; ++row)
+        {
+            if(row == col)
+                continue;
+            const double fct = den[row * dim + col] * inv;
+            if(fct == 0.)
+                continue;
+            for(int32_t knd = 0; knd < dim; ++knd)
+            {
+                den[row * dim + knd] -= fct * den[col * dim + knd];
+                num[row * dim + knd] -= fct * num[col * dim + knd];
+            }
+        }
+    }
+    for(int32_t row = 0; row < dim; ++row)
+    {
+        const double inv = 1. / den[row * dim + row];
+        for(int32_t col = 0; col < dim; ++col)
+            num[row * dim + col] *= inv;
+    }
+
+    for(int32_t indx = 0; indx < squar; ++indx)
+    {
+        ssMatMul(num.constData(), num.constData(), tmp.data(), dim);
+        num.swap(tmp);
+    }
+    mat.swap(num);
+}
+
+void StateSpace::ssDiscretize(double dt)
+{
+    const int32_t dim = m_order + 1;
+    QVector<double> aug(dim * dim, 0.);
+    for(int32_t row = 0; row < m_order; ++row)
+    {
+        for(int32_t col = 0; col < m_order; ++col)
+            aug[row * dim + col] = m_a[row * m_order + col] * dt;
+        aug[row * dim + m_order] = m_b[row] * dt;
+    }
+    ssExpm(aug, dim);
+
+    m_ad.resize(m_order * m_order);
+    m_bd.resize(m_order);
+    for(int32_t row = 0; row < m_order; ++row)
+    {
+        for(int32_t col = 0; col < m_order; ++col)
+            m_ad[row * m_order + col] = aug[row * dim + col];
+        m_bd[row] = aug[row * dim + m_order];
+    }
+    m_dt = dt;
+}
+
+void StateSpace::ssStep(double amp, double *out, int32_t num) const
+{
+    const int32_t dim = m_order;
+    const double du = m_d * amp;
+    QVector<double> state(2 * dim, 0.), bu(dim);
+    for(int32_t row = 0; row < dim; ++row)
+        bu[row] = m_bd[row] * amp;
+
+    /** The exponential keeps the lower block triangular shape of the series sections */
+    double *xc = state.data(), *xn = state.data() + dim;
+    const double *ad = m_ad.constData();
+    const double *cc = m_c.constData();
+    const int32_t *rend = m_row_end.constData();
+    for(int32_t smp = 0; smp < num; ++smp)
+    {
+        double yv = du;
+        for(int32_t row = 0; row < dim; ++row)
+            yv += cc[row] * xc[row];
+        out[smp] = yv;
+
+        for(int32_t row = 0; row < dim; ++row)
+        {
+            const double *ar = ad + row * dim;
+            double acc = bu[row];
+            for(int32_t col = 0; col < rend[row]; ++col)
+                acc += ar[col] * xc[col];
+            xn[row] = acc;
+        }
+        std::swap(xc, xn);
+    }
+}
+
+void StateSpace::ssMeasure(StepResponse &resp, double final)
+{
+    const int32_t num = resp.out.size();
+    if(num == 0)
+        return;
+    const double *out = resp.out.constData();
+    resp.final = qIsFinite(final) ? final : out[num - 1];
+
+    double top = resp.final, bottom = resp.final, ref = 0.;
+    for(int32_t smp = 0; smp < num; ++smp)
+    {
+        top = qMax(top, out[smp]);
+        bottom = qMin(bottom, out[smp]);
+        ref = qMax(ref, std::abs(out[smp] - resp.final));
+    }
+    resp.overshoot = top - resp.final;
+    resp.undershoot = resp.final - bottom;
+
+    /** The band is taken around the final value, the last exit from it is the settling */
+    resp.settling = 0.;
+    const double band = SS_SETTLE_BAND * ref;
+    for(int32_t smp = num - 1; smp >= 0; --smp)
+    {
+        if(std::abs(out[smp] - resp.final) > band)
+        {
+            resp.settling = (smp + 1) * resp.step_time;
+            break;
+        }
+    }
+}
+
+StepResponse StateSpace::ssStepResponse(double amp, double dt, int32_t num)
+{
+    StepResponse resp;
+    resp.step_time = dt;
+    if(!m_valid || num <= 0 || !qIsFinite(dt) || dt <= 0.)
+        return resp;
+    if(dt != m_dt)
+        ssDiscretize(dt);
+    resp.out.resize(num);
+    ssStep(amp, resp.out.data(), num);
+    ssMeasure(resp, m_dc * amp);
+    return resp;
+}
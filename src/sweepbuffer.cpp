@@ -0,0 +1,118 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/sweepbuffer.h"
+#include <cstring>
+
+SweepBuffer::~SweepBuffer()
+{
+    sbRelease();
+}
+
+bool SweepBuffer::sbResize(int32_t num)
+{
+    if(num < 0 || num > SB_MAX_POINTS)
+    {
+        m_size = 0;
+        return false;
+    }
+    if(num > m_capacity)
+    {
+        sbRelease();
+        const int32_t cap = (num + SB_GRANULE - 1) / SB_GRANULE * SB_GRANULE;
+        const size_t bytes = static_cast<size_t>(cap) * sizeof(double);
+        m_freq = static_cast<double*>(qMallocAligned(bytes, SB_ALIGN));
+        m_mag = static_cast<double*>(qMallocAligned(bytes, SB_ALIGN));
+        m_phs = static_cast<double*>(qMallocAligned(bytes, SB_ALIGN));
+        if(m_complex)
+        {
+            m_re = static_cast<double*>(qMallocAligned(bytes, SB_ALIGN));
+            m_im = static_cast<double*>(qMallocAligned(bytes, SB_ALIGN));
+        }
+        if(m_freq == nullptr || m_mag == nullptr || m_phs == nullptr
+                || (m_complex && (m_re == nullptr || m_im == nullptr)))
+        {
+            sbRelease();
+            return false;
+        }
+        m_capacity = cap;
+    }
+    m_size = num;
+    return true;
+}
+
+bool SweepBuffer::sbAssignFreq(const QVector<double> &freq)
+{
+    if(!sbResize(freq.size()))
+        return false;
+    std::memcpy(m_freq, freq.constData(), static_cast<size_t>(m_size) * sizeof(double));
+    return true;
+}
+
+bool SweepBuffer::sbAssignFreq(const SweepBuffer &src)
+{
+    if(!sbResize(src.sbSize()))
+        return false;
+    std::memcpy(m_freq, src.sbFreq(), static_cast<size_t>(m_size) * sizeof(double));
+    return true;
+}
+
+void SweepBuffer::sbRelease()
+{
+    qFreeAligned(m_freq);
+    qFreeAligned(m_mag);
+    qFreeAligned(m_phs);
+    qFreeAligned(m_re);
+    qFreeAligned(m_im);
+    m_freq = m_mag = m_phs = m_re = m_im = nullptr;
+    m_size = m_capacity = 0;
+}
+
+void SweepBuffer::sbSetComplex(bool cplx)
+{
+    if(cplx != m_complex)
+    {
+        sbRelease();
+        m_complex = cplx;
+    }
+}
+
+SweepBufferPool::SweepBufferPool()
+{
+    /** The loop gain is analysed in the complex plane too */
+    m_buf[SW_LOOP_GAIN].sbSetComplex(true);
+}
+
+size_t SweepBufferPool::sbpFootprint() const
+{
+    size_t out = 0;
+    for(const SweepBuffer &buf : m_buf)
+    {
+        out += buf.sbFootprint();
+    }
+    return out;
+}
+
+void SweepBufferPool::sbpRelease()
+{
+    for(SweepBuffer &buf : m_buf)
+    {
+        buf.sbRelease();
+    }
+}
@@ -0,0 +1,395 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include "inc/transferfunc.h"
+#include <algorithm>
+#include <limits>
+
+TransferFunction::TransferFunction(double gain, int32_t order)
+    :m_gain(gain)
+    ,m_order(order)
+{}
+
+TransferFunction::TransferFunction(const BodeFactors &bf)
+    :m_gain(bf.gain)
+    ,m_order(bf.order)
+{
+    for(double tc : bf.tz)
+    {
+        if(tc != 0.)
+            m_zeros.push_back(Root(-1./tc, 0.));
+    }
+    for(double tc : bf.tp)
+    {
+        if(tc != 0.)
+            m_poles.push_back(Root(-1./tc, 0.));
+    }
+    for(int32_t indx = 0; indx < bf.az.size(); ++indx)
+    {
+        tfAddQuadRoots(m_zeros, bf.bz[indx], bf.az[indx]);
+    }
+    for(int32_t indx = 0; indx < bf.ap.size(); ++indx)
+    {
+        tfAddQuadRoots(m_poles, bf.bp[indx], bf.ap[indx]);
+    }
+}
+
+void TransferFunction::tfAddZero(double omega)
+{
+    m_zeros.push_back(Root(-omega, 0.));
+}
+
+void TransferFunction::tfAddPole(double omega)
+{
+    m_poles.push_back(Root(-omega, 0.));
+}
+
+void TransferFunction::tfAddZeroQuad(double b, double a)
+{
+    tfAddQuadRoots(m_zeros, b, a);
+}
+
+void TransferFunction::tfAddPoleQuad(double b, double a)
+{
+    tfAddQuadRoots(m_poles, b, a);
+}
+
+/**
+ * @brief TransferFunction::tfAddQuadRoots - roots of 1 + s*b + s^2*a
+ */
+void TransferFunction::tfAddQuadRoots(QVector<Root> &roots, double b, double a)
+{
+    if(a == 0.)
+    {
+        if(b != 0.)
+            roots.push_back(Root(-1./b, 0.));
+        return;
+    }
+    double disc = b * b - 4. * a;
+    if(disc >= 0.)
+    {
+        /** Cancellation free form of the real roots */
+        double qt = -0.5 * (b + std::copysign(std::sqrt(disc), b));
+        roots.push_back(Root(qt / a, 0.));
+        roots.push_back(Root(1. / qt, 0.));
+    }
+    else
+    {
+        double re = -b / (2. * a);
+        double im = std::abs(std::sqrt(-disc) / (2. * a));
+        roots.push_back(Root(re, im));
+        roots.push_back(Root(re, -im));
+    }
+}
+
+QVector<double> TransferFunction::tfExpand(const QVector<Root> &roots)
+{
+    QVector<Root> poly(1, Root(1., 0.));
+    for(const Root &rt : roots)
+    {
+        poly.push_back(Root(0., 0.));
+        for(int32_t indx = poly.size() - 1; indx > 0; --indx)
+        {
+            poly[indx] -= poly[indx-1] / rt;
+        }
+    }
+    QVector<double> out(poly.size());
+    for(int32_t indx = 0; indx < poly.size(); ++indx)
+    {
+        out[indx] = poly[indx].real();
+    }
+    return out;
+}
+
+QVector<double> TransferFunction::tfPolyMul(const QVector<double> &lhs, const QVector<double> &rhs)
+{
+    if(lhs.isEmpty() || rhs.isEmpty())
+        return QVector<double>();
+    QVector<double> out(lhs.size() + rhs.size() - 1, 0.);
+    for(int32_t il = 0; il < lhs.size(); ++il)
+    {
+        for(int32_t ir = 0; ir < rhs.size(); ++ir)
+        {
+            out[il + ir] += lhs[il] * rhs[ir];
+        }
+    }
+    return out;
+}
+
+QVector<double> TransferFunction::tfPolyAdd(const QVector<double> &lhs, const QVector<double> &rhs)
+{
+    QVector<double> out(qMax(lhs.size(), rhs.size()), 0.);
+    for(int32_t indx = 0; indx < lhs.size(); ++indx)
+    {
+        out[indx] += lhs[indx];
+    }
+    for(int32_t indx = 0; indx < rhs.size(); ++indx)
+    {
+        out[indx] += rhs[indx];
+    }
+    return out;
+}
+
+/**
+ * @brief TransferFunction::tfRoots - Aberth-Ehrlich iteration on the scaled polynomial
+ * @param poly - coefficients in ascending power of s, poly[0] is not zero
+ * @param guess - start of the iteration, the circle if it does not match the degree
+ * @return the roots, the complex ones with their conjugate
+ */
+QVector<TransferFunction::Root> TransferFunction::tfRoots(const QVector<double> &poly, const QVector<Root> &guess)
+{
+    int32_t deg = poly.size() - 1;
+    while(deg > 0 && poly[deg] == 0.)
+        --deg;
+
+    QVector<Root> out;
+    if(deg <= 0 || poly[0] == 0.)
+        return out;
+    if(deg <= 2)
+    {
+        tfAddQuadRoots(out, poly[1]/poly[0], (deg == 2) ? poly[2]/poly[0] : 0.);
+        return out;
+    }
+
+    /** The corners of the loop spread over decades, scale s to the geometric mean of the roots */
+    const double scl = std::pow(std::abs(poly[0]/poly[deg]), 1./deg);
+    QVector<double> mon(deg + 1);
+    for(int32_t indx = 0; indx <= deg; ++indx)
+    {
+        mon[indx] = poly[indx] * std::pow(scl, indx) / (poly[deg] * std::pow(scl, deg));
+    }
+
+    QVector<Root> zr(deg);
+    for(int32_t indx = 0; indx < deg; ++indx)
+    {
+        if(guess.size() == deg)
+            zr[indx] = guess[indx] / scl;
+        else
+            zr[indx] = std::polar(1., 2. * M_PI * indx / deg + 0.4);
+    }
+
+    for(int32_t iter = 0; iter < TF_ROOT_ITER_MAX; ++iter)
+    {
+        double step = 0.;
+        for(int32_t indx = 0; indx < deg; ++indx)
+        {
+            Root val = mon[deg], der = 0.;
+            for(int32_t cf = deg - 1; cf >= 0; --cf)
+            {
+                der = der * zr[indx] + val;
+                val = val * zr[indx] + mon[cf];
+            }
+            if(val == Root(0., 0.))
+                continue;
+            Root sum = 0.;
+            for(int32_t jndx = 0; jndx < deg; ++jndx)
+            {
+                if(jndx != indx)
+                    sum += 1. / (zr[indx] - zr[jndx]);
+            }
+            Root ratio = val / der;
+            Root corr = ratio / (1. - ratio * sum);
+            zr[indx] -= corr;
+            step = qMax(step, std::abs(corr) / qMax(std::abs(zr[indx]), TF_ROOT_TOL));
+        }
+        if(step < TF_ROOT_TOL)
+            break;
+    }
+
+    /** Real roots are made exactly real, the complex ones exactly conjugate */
+    QVector<Root> upper, lower;
+    for(const Root &rt : zr)
+    {
+        Root root = rt * scl;
+        if(std::abs(root.imag()) <= TF_REAL_TOL * std::abs(root))
+            out.push_back(Root(root.real(), 0.));
+        else if(root.imag() > 0.)
+            upper.push_back(root);
+        else
+            lower.push_back(root);
+    }
+    for(const Root &up : upper)
+    {
+        auto near = std::min_element(lower.begin(), lower.end(), [&up](const Root &lhs, const Root &rhs)
+        {
+            return std::abs(lhs - std::conj(up)) < std::abs(rhs - std::conj(up));
+        });
+        Root root = up;
+        if(near != lower.end())
+        {
+            root = 0.5 * (up + std::conj(*near));
+            lower.erase(near);
+        }
+        out.push_back(root);
+        out.push_back(std::conj(root));
+    }
+    for(const Root &lo : lower)
+    {
+        out.push_back(Root(lo.real(), 0.));
+    }
+    return out;
+}
+
+TransferFunction TransferFunction::tfFromPoly(double gain, int32_t order, const QVector<double> &num, const QVector<double> &den)
+{
+    QVector<double> nm = num, dn = den;
+    /** The leading zero coefficients are the roots at origin */
+    while(!nm.isEmpty() && nm.first() == 0.)
+    {
+        nm.removeFirst();
+        ++order;
+    }
+    while(!dn.isEmpty() && dn.first() == 0.)
+    {
+        dn.removeFirst();
+        --order;
+    }
+    if(nm.isEmpty() || dn.isEmpty())
+        return TransferFunction(nm.isEmpty() ? 0. : std::numeric_limits<double>::infinity(), 0);
+
+    TransferFunction out(gain * nm.first() / dn.first(), order);
+    out.m_zeros = tfRoots(nm);
+    out.m_poles = tfRoots(dn);
+    return out;
+}
+
+QVector<double> TransferFunction::tfNumerator() const
+{
+    return tfExpand(m_zeros);
+}
+
+QVector<double> TransferFunction::tfDenominator() const
+{
+    return tfExpand(m_poles);
+}
+
+std::complex<double> TransferFunction::tfEval(double omega) const
+{
+    const Root sfr(0., omega);
+    Root out = m_gain * std::pow(sfr, m_order);
+    for(const Root &zr : m_zeros)
+    {
+        out *= 1. - sfr / zr;
+    }
+    for(const Root &pl : m_poles)
+    {
+        out /= 1. - sfr / pl;
+    }
+    return out;
+}
+
+BodeFactors TransferFunction::tfBodeFactors() const
+{
+    BodeFactors bf;
+    bf.gain = m_gain;
+    bf.order = m_order;
+
+    /** (1 - s/r)(1 - s/conj(r)) = 1 - s*2Re(r)/|r|^2 + s^2/|r|^2 */
+    for(const Root &zr : m_zeros)
+    {
+        if(zr.imag() == 0.)
+            bf.bfAddZero(-zr.real());
+        else if(zr.imag() > 0.)
+            bf.bfAddZeroQuad(-2. * zr.real() / std::norm(zr), 1. / std::norm(zr));
+    }
+    for(const Root &pl : m_poles)
+    {
+        if(pl.imag() == 0.)
+            bf.bfAddPole(-pl.real());
+        else if(pl.imag() > 0.)
+            bf.bfAddPoleQuad(-2. * pl.real() / std::norm(pl), 1. / std::norm(pl));
+    }
+    return bf;
+}
+
+void TransferFunction::tfSweep(SweepBuffer &buf) const
+{
+    bsSweepBode(tfBodeFactors(), buf.sbFreq(), buf.sbSize(), buf.sbMag(), buf.sbPhase(), buf.sbPrecision());
+}
+
+TransferFunction TransferFunction::operator*(const TransferFunction &rhs) const
+{
+    TransferFunction out(m_gain * rhs.m_gain, m_order + rhs.m_order);
+    out.m_zeros = m_zeros + rhs.m_zeros;
+    out.m_poles = m_poles + rhs.m_poles;
+    return out;
+}
+
+TransferFunction TransferFunction::tfCancel() const
+{
+    TransferFunction out(m_gain, m_order);
+    out.m_poles = m_poles;
+    for(const Root &zr : m_zeros)
+    {
+        auto it = std::find_if(out.m_poles.begin(), out.m_poles.end(), [&zr](const Root &pl)
+        {
+            return std::abs(zr - pl) <= TF_CANCEL_TOL * std::abs(pl);
+        });
+        if(it != out.m_poles.end())
+            out.m_poles.erase(it);
+        else
+            out.m_zeros.push_back(zr);
+    }
+    return out;
+}
+
+TransferFunction TransferFunction::tfSeries(const TransferFunction &first, const TransferFunction &second)
+{
+    return first * second;
+}
+
+TransferFunction TransferFunction::tfFeedback(const TransferFunction &fwd, const TransferFunction &fbk)
+{
+    /**
+     * fwd = k_f s^o_f N_f/D_f, fwd*fbk = k s^o N/D, the D_f cancels:
+     * fwd/(1 + fwd*fbk) = k_f s^o_f N_f D_b / (D_f D_b + k s^o N_f N_b)
+     * with the negative o the both parts are multiplied by s^-o.
+     */
+    const double kl = fwd.m_gain * fbk.m_gain;
+    const int32_t ol = fwd.m_order + fbk.m_order;
+
+    QVector<double> dd = tfPolyMul(fwd.tfDenominator(), fbk.tfDenominator());
+    QVector<double> nn = tfPolyMul(fwd.tfNumerator(), fbk.tfNumerator());
+    for(double &cf : nn)
+    {
+        cf *= kl;
+    }
+    int32_t order = fwd.m_order;
+    if(ol >= 0)
+    {
+        nn.insert(0, ol, 0.);
+    }
+    else
+    {
+        dd.insert(0, -ol, 0.);
+        order -= ol;
+    }
+    QVector<double> den = tfPolyAdd(dd, nn);
+
+    int32_t lead = 0;
+    while(lead < den.size() && den[lead] == 0.)
+        ++lead;
+    if(lead == den.size())
+        return TransferFunction(std::numeric_limits<double>::infinity(), 0);
+
+    TransferFunction out(fwd.m_gain / den[lead], order - lead);
+    out.m_zeros = fwd.m_zeros + fbk.m_poles;
+    out.m_poles = tfRoots(den.mid(lead));
+    return out;
+}
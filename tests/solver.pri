@@ -0,0 +1,76 @@
+# The solver sources of the tests, the same set as the batch solver without its main
+
+QT        = core testlib
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/../src/batchsolve.cpp \
+    $$PWD/../src/bodekernel.cpp \
+    $$PWD/../src/bodekernel_sse2.cpp \
+    $$PWD/../src/bodekernel_avx2.cpp \
+    $$PWD/../src/bodekernel_avx512.cpp \
+    $$PWD/../src/bodeplotdata.cpp \
+    $$PWD/../src/bodesweep.cpp \
+    $$PWD/../src/bulkcap.cpp \
+    $$PWD/../src/capout.cpp \
+    $$PWD/../src/comptuner.cpp \
+    $$PWD/../src/controlout.cpp \
+    $$PWD/../src/designsens.cpp \
+    $$PWD/../src/diodebridge.cpp \
+    $$PWD/../src/diodeout.cpp \
+    $$PWD/../src/discretize.cpp \
+    $$PWD/../src/fbptransformer.cpp \
+    $$PWD/../src/freqgrid.cpp \
+    $$PWD/../src/lcfilter.cpp \
+    $$PWD/../src/loggercategories.cpp \
+    $$PWD/../src/loopmargin.cpp \
+    $$PWD/../src/measfit.cpp \
+    $$PWD/../src/modemap.cpp \
+    $$PWD/../src/montecarlo.cpp \
+    $$PWD/../src/outfilter.cpp \
+    $$PWD/../src/plotdecimator.cpp \
+    $$PWD/../src/powsuppsolve.cpp \
+    $$PWD/../src/rootlocus.cpp \
+    $$PWD/../src/statespace.cpp \
+    $$PWD/../src/sweepbuffer.cpp \
+    $$PWD/../src/swmosfet.cpp \
+    $$PWD/../src/transferfunc.cpp \
+
+HEADERS += \
+    $$PWD/../inc/batchsolve.h \
+    $$PWD/../inc/bodekernel.h \
+    $$PWD/../inc/bodeplotdata.h \
+    $$PWD/../inc/bodesweep.h \
+    $$PWD/../src/bodekernel_simd.h \
+    $$PWD/../inc/bulkcap.h \
+    $$PWD/../inc/capout.h \
+    $$PWD/../inc/comptuner.h \
+    $$PWD/../inc/controlout.h \
+    $$PWD/../inc/designsens.h \
+    $$PWD/../inc/diodebridge.h \
+    $$PWD/../inc/diodeout.h \
+    $$PWD/../inc/discretize.h \
+    $$PWD/../inc/dual.h \
+    $$PWD/../inc/fbptransformer.h \
+    $$PWD/../inc/freqgrid.h \
+    $$PWD/../inc/lcfilter.h \
+    $$PWD/../inc/loggercategories.h \
+    $$PWD/../inc/loopmargin.h \
+    $$PWD/../inc/measfit.h \
+    $$PWD/../inc/modemap.h \
+    $$PWD/../inc/montecarlo.h \
+    $$PWD/../inc/outfilter.h \
+    $$PWD/../inc/plotdecimator.h \
+    $$PWD/../inc/poolrunner.h \
+    $$PWD/../inc/powsuppsolve.h \
+    $$PWD/../inc/rootlocus.h \
+    $$PWD/../inc/statespace.h \
+    $$PWD/../inc/sweepbuffer.h \
+    $$PWD/../inc/swmosfet.h \
+    $$PWD/../inc/transferfunc.h \
@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Unit tests of the solver, qmake tests.pro && make check
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_bodekernel \
+    tst_loopmargin \
+    tst_dual \
+    tst_measfit \
+    tst_rootlocus \
+    tst_montecarlo \
+    tst_lcfilter \
+    tst_batchsolve \
+    tst_discretize \
+    tst_statespace
@@ -0,0 +1,160 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include <QBuffer>
+#include "inc/batchsolve.h"
+
+#define TB_SPECS       40     //Specs of the order run, several batches of several slices
+#define TB_BATCH       12     //Specs of one batch of the order run
+#define TB_THREADS     4      //Solvers of the order run
+#define TB_FAIL_EACH   3      //Each third spec of the order run is out of range
+
+class TstBatchSolve : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseSuffix();
+    void csvQuoted();
+    void headerUnknownKey();
+    void inputOrder();
+
+private:
+    BsStats tbRun(const QByteArray &input, const BsOptions &opt, QStringList &lines);
+};
+
+/**
+ * @brief tbRun - the batch of the input text, the output is split into its lines
+ */
+BsStats TstBatchSolve::tbRun(const QByteArray &input, const BsOptions &opt, QStringList &lines)
+{
+    QBuffer in, out;
+    in.setData(input);
+    in.open(QIODevice::ReadOnly);
+    out.open(QIODevice::WriteOnly);
+    const BsStats stats = bsRun(in, out, opt);
+    lines = QString::fromUtf8(out.data()).split('\n');
+    if(!lines.isEmpty() && lines.last().isEmpty())
+        lines.removeLast();
+    return stats;
+}
+
+/**
+ * @brief tbNear - relative error of the parsed value
+ */
+static bool tbNear(double val, double ref)
+{
+    return qAbs(val - ref) <= 1E-15 * qAbs(ref);
+}
+
+/**
+ * The SI suffixes of the form, the case of the suffix matters
+ */
+void TstBatchSolve::parseSuffix()
+{
+    double val = 0.;
+    QVERIFY(bsParseValue("100p", val) && tbNear(val, 100E-12));
+    QVERIFY(bsParseValue("4.7n", val) && tbNear(val, 4.7E-9));
+    QVERIFY(bsParseValue("22u", val) && tbNear(val, 22E-6));
+    QVERIFY(bsParseValue("15m", val) && tbNear(val, 15E-3));
+    QVERIFY(bsParseValue("2.2K", val) && tbNear(val, 2.2E3));
+    QVERIFY(bsParseValue("1.5M", val) && tbNear(val, 1.5E6));
+    QVERIFY(bsParseValue(" 65000 ", val) && tbNear(val, 65000.));
+    QVERIFY(bsParseValue("-0.5", val) && tbNear(val, -0.5));
+
+    /** The failed parse keeps the value */
+    val = 7.;
+    QVERIFY(!bsParseValue("", val));
+    QVERIFY(!bsParseValue("m", val));
+    QVERIFY(!bsParseValue("1k", val));
+    QVERIFY(!bsParseValue("1.5MM", val));
+    QVERIFY(!bsParseValue("abc", val));
+    QCOMPARE(val, 7.);
+}
+
+/**
+ * The double quoted field holds the comma and the doubled quote, the spare field is an error
+ */
+void TstBatchSolve::csvQuoted()
+{
+    BsOptions opt;
+    opt.threads = 1;
+    QStringList lines;
+    const BsStats stats = tbRun("id,SweepPrec\n"
+                                "\"a,\"\"b\"\"\",1\n"
+                                "\" c \",\"0\"\n"
+                                "d,1,2\n", opt, lines);
+    QVERIFY2(stats.error.isEmpty(), qPrintable(stats.error));
+    QCOMPARE(stats.specs, int64_t(3));
+    QCOMPARE(stats.failed, int64_t(1));
+    QCOMPARE(lines.size(), 3);
+    QVERIFY2(lines[0].startsWith("{\"line\":2,\"id\":\"a,\\\"b\\\"\",\"ok\":true"), qPrintable(lines[0].left(80)));
+    QVERIFY2(lines[1].startsWith("{\"line\":3,\"id\":\"c\",\"ok\":true"), qPrintable(lines[1].left(80)));
+    QVERIFY2(lines[2].startsWith("{\"line\":4,\"ok\":false,\"error\":\"3 fields against 2 keys"), qPrintable(lines[2]));
+}
+
+/**
+ * The unknown key of the CSV header stops the run before any spec
+ */
+void TstBatchSolve::headerUnknownKey()
+{
+    BsOptions opt;
+    opt.threads = 1;
+    QStringList lines;
+    const BsStats stats = tbRun("id,NoSuchKey\n"
+                                "a,1\n", opt, lines);
+    QVERIFY2(stats.error.contains("unknown key \"NoSuchKey\""), qPrintable(stats.error));
+    QCOMPARE(stats.specs, int64_t(0));
+    QVERIFY(lines.isEmpty());
+}
+
+/**
+ * The results of the several solvers go out in the input order, the failed specs included
+ */
+void TstBatchSolve::inputOrder()
+{
+    QByteArray input;
+    for(int32_t spec = 0; spec < TB_SPECS; ++spec)
+    {
+        input += (spec % TB_FAIL_EACH == 0)
+                ? QString("{\"id\":\"s%1\",\"SweepPrecLoopGain\":2}\n").arg(spec).toUtf8()
+                : QString("{\"id\":\"s%1\"}\n").arg(spec).toUtf8();
+    }
+    BsOptions opt;
+    opt.threads = TB_THREADS;
+    opt.batch = TB_BATCH;
+    QStringList lines;
+    const BsStats stats = tbRun(input, opt, lines);
+    QVERIFY2(stats.error.isEmpty(), qPrintable(stats.error));
+    QCOMPARE(stats.specs, int64_t(TB_SPECS));
+    QCOMPARE(stats.failed, int64_t((TB_SPECS + TB_FAIL_EACH - 1) / TB_FAIL_EACH));
+    QCOMPARE(lines.size(), TB_SPECS);
+    for(int32_t spec = 0; spec < TB_SPECS; ++spec)
+    {
+        const QString head = QString("{\"line\":%1,\"id\":\"s%2\",\"ok\":%3")
+                .arg(spec + 1).arg(spec).arg((spec % TB_FAIL_EACH == 0) ? "false" : "true");
+        QVERIFY2(lines[spec].startsWith(head), qPrintable(QString("%1: %2").arg(head, lines[spec].left(80))));
+    }
+}
+
+QTEST_APPLESS_MAIN(TstBatchSolve)
+
+#include "tst_batchsolve.moc"
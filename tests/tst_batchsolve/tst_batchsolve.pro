@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_batchsolve
+
+SOURCES += \
+    tst_batchsolve.cpp
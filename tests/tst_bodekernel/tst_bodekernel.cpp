@@ -0,0 +1,165 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+#include <QtTest>
+#include <cstring>
+#include "inc/bodekernel.h"
+
+#define TB_POINTS   4099  //Odd number, the tail of the vector paths is taken too
+
+class TstBodeKernel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void vectorAgreesWithScalar();
+    void fastWithinBound();
+    void complexAgreesWithScalar();
+
+private:
+    static BodeFactors tbLoop();
+    static QVector<double> tbFreq();
+    static int64_t tbUlpDistance(double a, double b);
+};
+
+/**
+ * @brief tbLoop - the loop of the flyback, integrator, rhp zero, the esr zero, the optocoupler pole
+ *        and the underdamped pole pair of the LC stage
+ */
+BodeFactors TstBodeKernel::tbLoop()
+{
+    BodeFactors bf;
+    bf.gain = 3.7E4;
+    bf.order = -1;
+    bf.bfAddZero(2*M_PI * 1.2E3);
+    bf.bfAddZero(-2*M_PI * 28E3);
+    bf.bfAddZero(2*M_PI * 9E3);
+    bf.bfAddPole(2*M_PI * 350.);
+    bf.bfAddPole(2*M_PI * 4.5E3);
+    bf.bfAddPolePair(2*M_PI * 12E3, 3.5);
+    bf.bfAddZeroPair(2*M_PI * 60E3, 0.4);
+    return bf;
+}
+
+QVector<double> TstBodeKernel::tbFreq()
+{
+    QVector<double> freq(TB_POINTS);
+    for(int32_t indx = 0; indx < TB_POINTS; ++indx)
+    {
+        freq[indx] = std::pow(10., 6. * indx / (TB_POINTS - 1));
+    }
+    return freq;
+}
+
+/**
+ * @brief tbUlpDistance - representable doubles between the values, the sign is ordered
+ */
+int64_t TstBodeKernel::tbUlpDistance(double a, double b)
+{
+    int64_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    if(ia < 0)
+        ia = std::numeric_limits<int64_t>::min() - ia;
+    if(ib < 0)
+        ib = std::numeric_limits<int64_t>::min() - ib;
+    return (ia > ib) ? ia - ib : ib - ia;
+}
+
+void TstBodeKernel::cleanup()
+{
+    /** The unsupported set is lowered to the best of the cpu */
+    bkSetIsa(BK_ISA_AVX512);
+}
+
+void TstBodeKernel::vectorAgreesWithScalar()
+{
+    const BodeFactors bf = tbLoop();
+    const QVector<double> freq = tbFreq();
+    QVector<double> ref_mag(TB_POINTS), ref_phs(TB_POINTS), mag(TB_POINTS), phs(TB_POINTS);
+    bkEvalScalar(bf, freq.constData(), TB_POINTS, ref_mag.data(), ref_phs.data(), BK_OUT_BODE);
+
+    for(BK_ISA isa : {BK_ISA_SSE2, BK_ISA_AVX2, BK_ISA_AVX512})
+    {
+        bkSetIsa(isa);
+        if(bkActiveIsa() != isa)
+            continue;
+        bkEvalBode(bf, freq.constData(), TB_POINTS, mag.data(), phs.data());
+        for(int32_t indx = 0; indx < TB_POINTS; ++indx)
+        {
+            QVERIFY2(tbUlpDistance(mag[indx], ref_mag[indx]) <= BK_ULP_BOUND,
+                     qPrintable(QString("isa %1, magnitude %2 dB at %3 Hz, scalar %4")
+                                .arg(isa).arg(mag[indx], 0, 'g', 17).arg(freq[indx]).arg(ref_mag[indx], 0, 'g', 17)));
+            QVERIFY2(tbUlpDistance(phs[indx], ref_phs[indx]) <= BK_ULP_BOUND,
+                     qPrintable(QString("isa %1, phase %2 deg at %3 Hz, scalar %4")
+                                .arg(isa).arg(phs[indx], 0, 'g', 17).arg(freq[indx]).arg(ref_phs[indx], 0, 'g', 17)));
+        }
+    }
+}
+
+void TstBodeKernel::fastWithinBound()
+{
+    const BodeFactors bf = tbLoop();
+    const QVector<double> freq = tbFreq();
+    QVector<double> ref_mag(TB_POINTS), ref_phs(TB_POINTS), mag(TB_POINTS), phs(TB_POINTS);
+    bkEvalScalar(bf, freq.constData(), TB_POINTS, ref_mag.data(), ref_phs.data(), BK_OUT_BODE);
+
+    for(BK_ISA isa : {BK_ISA_SCALAR, BK_ISA_SSE2, BK_ISA_AVX2, BK_ISA_AVX512})
+    {
+        bkSetIsa(isa);
+        if(bkActiveIsa() != isa)
+            continue;
+        bkEvalBode(bf, freq.constData(), TB_POINTS, mag.data(), phs.data(), BK_PREC_FAST);
+        for(int32_t indx = 0; indx < TB_POINTS; ++indx)
+        {
+            QVERIFY2(qAbs(mag[indx] - ref_mag[indx]) < BK_FAST_MAG_ERR,
+                     qPrintable(QString("isa %1, magnitude error %2 dB at %3 Hz").arg(isa).arg(mag[indx] - ref_mag[indx]).arg(freq[indx])));
+            QVERIFY2(qAbs(phs[indx] - ref_phs[indx]) < BK_FAST_PHS_ERR,
+                     qPrintable(QString("isa %1, phase error %2 deg at %3 Hz").arg(isa).arg(phs[indx] - ref_phs[indx]).arg(freq[indx])));
+        }
+    }
+}
+
+void TstBodeKernel::complexAgreesWithScalar()
+{
+    const BodeFactors bf = tbLoop();
+    const QVector<double> freq = tbFreq();
+    QVector<double> ref_re(TB_POINTS), ref_im(TB_POINTS), re(TB_POINTS), im(TB_POINTS);
+    bkEvalScalar(bf, freq.constData(), TB_POINTS, ref_re.data(), ref_im.data(), BK_OUT_COMPLEX);
+
+    for(BK_ISA isa : {BK_ISA_SSE2, BK_ISA_AVX2, BK_ISA_AVX512})
+    {
+        bkSetIsa(isa);
+        if(bkActiveIsa() != isa)
+            continue;
+        bkEvalComplex(bf, freq.constData(), TB_POINTS, re.data(), im.data());
+        for(int32_t indx = 0; indx < TB_POINTS; ++indx)
+        {
+            /** Only the order of the products differs, the error is relative to the modulus */
+            const double mod = std::hypot(ref_re[indx], ref_im[indx]);
+            QVERIFY2(std::hypot(re[indx] - ref_re[indx], im[indx] - ref_im[indx]) <= 1E-13 * mod,
+                     qPrintable(QString("isa %1 at %2 Hz").arg(isa).arg(freq[indx])));
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TstBodeKernel)
+
+#include "tst_bodekernel.moc"
@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_bodekernel
+
+SOURCES += \
+    tst_bodekernel.cpp
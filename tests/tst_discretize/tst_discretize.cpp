@@ -0,0 +1,183 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include "inc/discretize.h"
+
+#define TZ_FREQ_SMP    100E3  //Hz, sample rate of the compensator
+#define TZ_FREQ_WARP   2E3    //Hz, prewarp at the loop crossover
+#define TZ_FREQ_ZERO   300.   //Hz, zero of the type 2 compensator
+#define TZ_FREQ_POLE   20E3   //Hz, high frequency pole of the type 2 compensator
+#define TZ_FREQ_RES    5E3    //Hz, resonance of the second order plant
+#define TZ_FREQ_PLANT  3E3    //Hz, zero of the plant
+#define TZ_QUAL        2.     //Q of the plant
+#define TZ_STEP_NUM    200    //Samples of the step response
+#define TZ_TOL         1E-9   //Relative error of the exact forms
+
+class TstDiscretize : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void tustinAtWarp();
+    void zohStepSamples();
+    void quantizeSaturated();
+};
+
+/**
+ * @brief tzTypeTwo - K(1 + s/w_z)/(s(1 + s/w_p)), the integrator gives the pole at z = 1
+ */
+static TransferFunction tzTypeTwo()
+{
+    TransferFunction tf(2 * M_PI * TZ_FREQ_ZERO, -1);
+    tf.tfAddZero(2 * M_PI * TZ_FREQ_ZERO);
+    tf.tfAddPole(2 * M_PI * TZ_FREQ_POLE);
+    return tf;
+}
+
+/**
+ * @brief tzResonant - (1 + s/w_z)/(1 + s/(Q w_0) + s^2/w_0^2) in ascending power of s
+ */
+static void tzResonant(QVector<double> &num, QVector<double> &den)
+{
+    const double omega = 2 * M_PI * TZ_FREQ_RES;
+    num = {1., 1. / (2 * M_PI * TZ_FREQ_PLANT)};
+    den = {1., 1. / (TZ_QUAL * omega), 1. / (omega * omega)};
+}
+
+/**
+ * @brief tzPolyEval - polynomial in ascending power at the complex point
+ */
+static std::complex<double> tzPolyEval(const QVector<double> &poly, std::complex<double> pnt)
+{
+    std::complex<double> out;
+    for(int32_t cf = poly.size() - 1; cf >= 0; --cf)
+        out = out * pnt + poly[cf];
+    return out;
+}
+
+/**
+ * @brief tzFilterStep - output of the sections to the unit step, the direct form of each one
+ */
+static QVector<double> tzFilterStep(const DzFilter &filt, int32_t num)
+{
+    QVector<double> sig(num, filt.gain);
+    for(const DzSection &sc : filt.sect)
+    {
+        double x1 = 0., x2 = 0., y1 = 0., y2 = 0.;
+        for(int32_t indx = 0; indx < num; ++indx)
+        {
+            const double xv = sig[indx];
+            const double yv = sc.b[0] * xv + sc.b[1] * x1 + sc.b[2] * x2 - sc.a[1] * y1 - sc.a[2] * y2;
+            x2 = x1;
+            x1 = xv;
+            y2 = y1;
+            y1 = yv;
+            sig[indx] = yv;
+        }
+    }
+    return sig;
+}
+
+/**
+ * The prewarped bilinear map is exact at the prewarp frequency only
+ */
+void TstDiscretize::tustinAtWarp()
+{
+    const TransferFunction tf = tzTypeTwo();
+    const DzFilter filt = dzDiscretize(tf, DZ_TUSTIN, TZ_FREQ_SMP, TZ_FREQ_WARP);
+    QVERIFY(!filt.sect.isEmpty());
+    QVERIFY2(qAbs(filt.dzPoleRadius() - 1.) < TZ_TOL, qPrintable(QString("radius %1").arg(filt.dzPoleRadius(), 0, 'g', 12)));
+
+    const double omega = 2 * M_PI * TZ_FREQ_WARP;
+    const std::complex<double> ref = tf.tfEval(omega);
+    double err = std::abs(filt.dzEval(omega) - ref) / std::abs(ref);
+    QVERIFY2(err < TZ_TOL, qPrintable(QString("warp error %1").arg(err, 0, 'g', 6)));
+
+    /** The frequency warp is visible a decade above */
+    const std::complex<double> off = tf.tfEval(10. * omega);
+    err = std::abs(filt.dzEval(10. * omega) - off) / std::abs(off);
+    QVERIFY2(err > 1E-3, qPrintable(QString("off warp error %1").arg(err, 0, 'g', 6)));
+}
+
+/**
+ * The hold equivalent reproduces the continuous step response at the samples,
+ * y(t) = H(0) + sum(N(p)/(p D'(p)) e^{pt}) of the simple poles
+ */
+void TstDiscretize::zohStepSamples()
+{
+    QVector<double> num, den;
+    tzResonant(num, den);
+    const TransferFunction tf = TransferFunction::tfFromPoly(1., 0, num, den);
+    const DzFilter filt = dzDiscretize(tf, DZ_ZOH, TZ_FREQ_SMP, 0.);
+    QVERIFY(!filt.sect.isEmpty());
+
+    QVector<double> dden(den.size() - 1);
+    for(int32_t cf = 1; cf < den.size(); ++cf)
+        dden[cf - 1] = cf * den[cf];
+    const QVector<TransferFunction::Root> poles = TransferFunction::tfRoots(den);
+    QCOMPARE(poles.size(), 2);
+
+    const QVector<double> step = tzFilterStep(filt, TZ_STEP_NUM);
+    const double tsmp = 1. / TZ_FREQ_SMP;
+    for(int32_t indx = 0; indx < TZ_STEP_NUM; ++indx)
+    {
+        std::complex<double> ref(num[0] / den[0], 0.);
+        for(const TransferFunction::Root &pl : poles)
+            ref += tzPolyEval(num, pl) / (pl * tzPolyEval(dden, pl)) * std::exp(pl * (indx * tsmp));
+        QVERIFY2(qAbs(step[indx] - ref.real()) < TZ_TOL, qPrintable(QString("sample %1: hold %2, step %3")
+                                                                  .arg(indx).arg(step[indx], 0, 'g', 12)
+                                                                  .arg(ref.real(), 0, 'g', 12)));
+    }
+}
+
+/**
+ * The coefficient out of Qm.n is clamped and flagged, the one inside is not
+ */
+void TstDiscretize::quantizeSaturated()
+{
+    const DzFilter filt = dzDiscretize(tzTypeTwo(), DZ_TUSTIN, TZ_FREQ_SMP, TZ_FREQ_WARP);
+
+    /** Q2.13 holds a1 of the pole at z = 1 with the real pole, |a1| < 2 */
+    DzQFormat fmt;
+    DzQuantized qnt = dzQuantize(filt, fmt);
+    QVERIFY(!qnt.saturated);
+    QCOMPARE(qnt.coeff.size(), DZ_SECTION_COEFF * filt.sect.size());
+    const double omega = 2 * M_PI * TZ_FREQ_WARP;
+    const double err = std::abs(qnt.filt.dzEval(omega) / filt.dzEval(omega) - 1.);
+    QVERIFY2(err < 1E-2, qPrintable(QString("Q2.13 error %1").arg(err, 0, 'g', 6)));
+
+    /** Q0.15 is [-1, 1), a1 is clamped to -1 */
+    fmt.int_bits = 0;
+    fmt.frac_bits = 15;
+    qnt = dzQuantize(filt, fmt);
+    QVERIFY(qnt.saturated);
+    bool clamped = false;
+    for(int32_t cf = 0; cf < qnt.coeff.size(); ++cf)
+    {
+        QVERIFY(qnt.coeff[cf] >= -32768 && qnt.coeff[cf] <= 32767);
+        clamped = clamped || (qnt.coeff[cf] == -32768);
+    }
+    QVERIFY(clamped);
+}
+
+QTEST_APPLESS_MAIN(TstDiscretize)
+
+#include "tst_discretize.moc"
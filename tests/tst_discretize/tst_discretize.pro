@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_discretize
+
+SOURCES += \
+    tst_discretize.cpp
@@ -0,0 +1,318 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include "inc/dual.h"
+#include "inc/designsens.h"
+
+#define TD_STEP_FUNC     1E-6  //Relative step of the central difference on the plain functions
+#define TD_TOL_FUNC      1E-7  //Relative error of the derivative of the plain functions
+#define TD_STEP_CHAIN    1E-3  //Relative step on the chain, its values pass through the float storage
+#define TD_TOL_CHAIN     2E-3  //Relative error of the derivative of the chain
+#define TD_SW_INPUT_NUM  8     //Inputs of the switch network stage
+#define TD_SW_OUTPUT_NUM 3     //Total MOSFET loss, snubber and sense resistor dissipation
+#define TD_LOOP_INPUT_NUM 6    //Inputs of the power stage of the loop
+#define TD_LOOP_OUTPUT_NUM 3   //Crossover, phase and gain margin
+#define TD_FREQ_CROSS    1E3   //Hz, nominal crossover of the test loop
+#define TD_FREQ_BEGIN    1.    //Hz
+#define TD_FREQ_END      1E6   //Hz
+
+class TstDual : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void elementaryFunctions();
+    void designChain();
+    void switchStage();
+    void loopMargins();
+
+private:
+    static DsModel tdModel();
+};
+
+/**
+ * @brief tdFunc - every operator and function of Dual in one expression of two inputs
+ */
+template<typename T>
+static T tdFunc(const T &x, const T &y)
+{
+    using std::sqrt; using std::exp; using std::log; using std::log10; using std::sin; using std::cos;
+    using std::tan; using std::asin; using std::acos; using std::atan; using std::atan2; using std::pow;
+    using std::fabs;
+    return sqrt(x) * exp(y) / x + log(x * y) - log10(y) + sin(x) * cos(y) + tan(0.3 * y)
+            + asin(0.5 * x) + acos(0.4 * y) + atan(x - y) + atan2(y, x) + pow(x, 1.5)
+            + pow(x, y) + fabs(y - 2. * x) - (x - 1.) / (y + 2.);
+}
+
+void TstDual::elementaryFunctions()
+{
+    const double pts[][2] = {{0.7, 1.3}, {1.9, 0.4}, {0.2, 2.2}};
+    for(const auto &pt : pts)
+    {
+        typedef Dual<2> D2;
+        const D2 res = tdFunc(D2::dVar(pt[0], 0), D2::dVar(pt[1], 1));
+        QVERIFY(qAbs(res.val - tdFunc(pt[0], pt[1])) <= 1E-14 * qAbs(res.val));
+
+        for(int32_t in = 0; in < 2; ++in)
+        {
+            double lo[2] = {pt[0], pt[1]}, hi[2] = {pt[0], pt[1]};
+            const double step = TD_STEP_FUNC * pt[in];
+            lo[in] -= step;
+            hi[in] += step;
+            const double diff = (tdFunc(hi[0], hi[1]) - tdFunc(lo[0], lo[1])) / (2. * step);
+            QVERIFY2(qAbs(res.der[in] - diff) <= TD_TOL_FUNC * qMax(qAbs(diff), 1.),
+                     qPrintable(QString("d/d%1 at (%2, %3): dual %4, difference %5")
+                                .arg(in).arg(pt[0]).arg(pt[1]).arg(res.der[in], 0, 'g', 12).arg(diff, 0, 'g', 12)));
+        }
+    }
+}
+
+/**
+ * @brief tdModel - the design of the form defaults, a 12 V output on the EFD25 like core
+ */
+DsModel TstDual::tdModel()
+{
+    DsModel model;
+    model.input[DS_VAC_MAX] = 230.;
+    model.input[DS_VAC_MIN] = 90.;
+    model.input[DS_FREQ_LINE] = 50.;
+    model.input[DS_FREQ_SWITCH] = 65E3;
+    model.input[DS_EFF] = 0.85;
+    model.input[DS_POUT] = 18.;
+    model.input[DS_REFL_VOLT] = 110.;
+    model.input[DS_VOLT_SPIKE] = 150.;
+    model.input[DS_RIPPLE_FACT] = 0.8;
+    model.out_vlcr = {qMakePair(12.f, 1.5f), qMakePair(0.f, 0.f), qMakePair(0.f, 0.f), qMakePair(0.f, 0.f)};
+    model.ca = CoreArea{0.2, 0.3, 4};
+    model.cs.ind_fact = 185E-9;
+    model.cs.core_cross_sect_area = 52E-6;
+    model.cs.core_wind_area = 61E-6;
+    model.cs.core_vol = 3.02E-6;
+    model.cs.mean_leng_per_turn = 0.05;
+    model.cs.mean_mag_path_leng = 0.057;
+    model.cs.core_permeal = 1620.;
+    model.md = MechDimension{0.007f, 0.017f, 0.008f, 0.007f, 0.f};
+    model.fns = FBPT_NUM_SETTING::FBPT_INDUCT_FACTOR;
+    model.fsag = FBPT_SHAPE_AIR_GAP::RECT_AIR_GAP;
+    model.mospr = MosfetProp();
+    model.mospr.m_vgs = 10;
+    model.mospr.m_idr = 0.25f;
+    model.mospr.m_qg = 16E-9;
+    model.mospr.m_qgd = 10E-9;
+    model.mospr.m_qgs = 6E-9;
+    model.mospr.m_rgate = 15.;
+    model.mospr.m_vmill = 4.4;
+    model.mospr.m_fet_cur_max = 6.f;
+    model.mospr.m_fet_cur_min = 10.f;
+    model.mospr.m_coss = 100E-12;
+    model.mospr.m_rdson = 1.f;
+    model.ccsp = ClampCSProp{12, 0.1f, 5E-6, 45., 1.};
+    model.cop = CapOutProp{12, 1.5f, 0.03f, 0.9f, 5000.f};
+    model.num_sec = 8;
+
+    /** The type 2 compensator of the gain with the crossover near 2.7 kHz, the margins are in the value check */
+    model.has_loop = true;
+    model.ssm = SSMPreDesign{230, 65000, 0.4f, 600E-6, 0.5, 12, 8.f, 0.1f, 1000E-6, 0.03, 0.5};
+    model.mode = DCM_MODE;
+    model.volt_ramp = 12.6f;
+    model.loop_rest = FCCD::coCompFactors(FCCoeff{1E6, 2*M_PI * 100., 2*M_PI * 20E3, 0., 0., 0.}, FC_TYPE_2);
+    model.freq_begin = TD_FREQ_BEGIN;
+    model.freq_end = TD_FREQ_END;
+    return model;
+}
+
+/**
+ * The values of the dual chain are the ones of the double chain. The gradient is the one
+ * of the smooth model and passes the integer storage of the input voltage and of the
+ * reflected voltage where the double chain is flat, so the difference checks the outputs
+ * of the input network, that has none, along every input.
+ */
+void TstDual::designChain()
+{
+    const DsModel model = tdModel();
+    const DsResult res = dsRun(model);
+
+    double nom[DS_OUTPUT_NUM];
+    dsPipeline(model, model.input, nom);
+    for(int32_t out = 0; out < DS_OUTPUT_NUM; ++out)
+    {
+        QVERIFY2(qIsFinite(res.value[out]), dsOutputName(out));
+        QVERIFY2(qAbs(res.value[out] - nom[out]) <= 1E-12 * qAbs(nom[out]), dsOutputName(out));
+    }
+
+    const int32_t smooth_out[] = {DS_CAP_BULK, DS_VDC_MIN};
+    for(int32_t in = 0; in < DS_INPUT_NUM; ++in)
+    {
+        double lo[DS_INPUT_NUM], hi[DS_INPUT_NUM];
+        std::copy(model.input, model.input + DS_INPUT_NUM, lo);
+        std::copy(model.input, model.input + DS_INPUT_NUM, hi);
+        const double step = TD_STEP_CHAIN * model.input[in];
+        lo[in] -= step;
+        hi[in] += step;
+        double out_lo[DS_OUTPUT_NUM], out_hi[DS_OUTPUT_NUM];
+        dsPipeline(model, lo, out_lo);
+        dsPipeline(model, hi, out_hi);
+
+        for(int32_t out : smooth_out)
+        {
+            const double diff = (out_hi[out] - out_lo[out]) / (2. * step);
+            const double scale = qMax(qAbs(diff), 1E-9 * qAbs(nom[out]) / step);
+            QVERIFY2(qAbs(res.grad[out][in] - diff) <= TD_TOL_CHAIN * scale,
+                     qPrintable(QString("d %1 / d %2: dual %3, difference %4").arg(dsOutputName(out)).arg(dsInputName(in))
+                                .arg(res.grad[out][in], 0, 'g', 8).arg(diff, 0, 'g', 8)));
+        }
+    }
+}
+
+/**
+ * @brief tdSwitch - the losses of the switch network from the smooth stage inputs,
+ *        the input peak, the spike, the switching frequency, the reflected voltage,
+ *        the primary inductance, its peak to peak, RMS and peak currents
+ */
+template<typename T>
+static void tdSwitch(const DsModel &model, const T in[TD_SW_INPUT_NUM], T out[TD_SW_OUTPUT_NUM])
+{
+    SwMosfetT<T> sw_mos(in[0], in[1], in[2], in[3], in[4], in[5]);
+    sw_mos.setCurrValues(in[6], in[7]);
+    out[0] = sw_mos.swMosfetTotalLoss(model.mospr);
+    out[1] = sw_mos.clPowerDiss(model.ccsp);
+    out[2] = sw_mos.csCurrResLoss(model.ccsp);
+}
+
+/**
+ * The stages downstream of the integer storage against the difference of their own
+ * double instance, the gradient of the switch network along each of its inputs
+ */
+void TstDual::switchStage()
+{
+    typedef Dual<TD_SW_INPUT_NUM> DSw;
+    const DsModel model = tdModel();
+    const double val[TD_SW_INPUT_NUM] = {325., 150., 65E3, 110., 620E-6, 1.1, 0.52, 1.15};
+
+    DSw in[TD_SW_INPUT_NUM], res[TD_SW_OUTPUT_NUM];
+    for(int32_t idx = 0; idx < TD_SW_INPUT_NUM; ++idx)
+        in[idx] = DSw::dVar(val[idx], idx);
+    tdSwitch(model, in, res);
+
+    for(int32_t idx = 0; idx < TD_SW_INPUT_NUM; ++idx)
+    {
+        double lo[TD_SW_INPUT_NUM], hi[TD_SW_INPUT_NUM];
+        std::copy(val, val + TD_SW_INPUT_NUM, lo);
+        std::copy(val, val + TD_SW_INPUT_NUM, hi);
+        const double step = TD_STEP_CHAIN * val[idx];
+        lo[idx] -= step;
+        hi[idx] += step;
+        double out_lo[TD_SW_OUTPUT_NUM], out_hi[TD_SW_OUTPUT_NUM];
+        tdSwitch(model, lo, out_lo);
+        tdSwitch(model, hi, out_hi);
+
+        for(int32_t out = 0; out < TD_SW_OUTPUT_NUM; ++out)
+        {
+            const double diff = (out_hi[out] - out_lo[out]) / (2. * step);
+            const double scale = qMax(qAbs(diff), 1E-9 * qAbs(res[out].val) / step);
+            QVERIFY2(qAbs(res[out].der[idx] - diff) <= TD_TOL_CHAIN * scale,
+                     qPrintable(QString("output %1 along input %2: dual %3, difference %4").arg(out).arg(idx)
+                                .arg(res[out].der[idx], 0, 'g', 8).arg(diff, 0, 'g', 8)));
+        }
+    }
+}
+
+/**
+ * @brief tdLoopFactors - loop of the DCM or CCM stage of 12 V 1.5 A from the input voltage,
+ *        the switching frequency, the duty, the primary inductance, the sense resistor and
+ *        the ramp, with the type 2 compensator of the gain
+ */
+template<typename T>
+static BodeFactorsT<T> tdLoopFactors(double gain, PS_MODE mode, const T in[TD_LOOP_INPUT_NUM])
+{
+    SSMPreDesignT<T> stage{in[0], in[1], in[2], in[3], in[4], T(12.), T(8.), T(0.1), T(1000E-6), T(0.03), in[5]};
+    SSMModelT<T, SSMPreDesignT<T>> ssm(stage);
+    BodeFactorsT<T> loop = ssm.coFactors(ssm.coCompile(mode), mode);
+    loop.gain *= gain * 2*M_PI * 100.;
+    loop.order -= 1;
+    loop.bfAddZero(T(2*M_PI * 100.));
+    loop.bfAddPole(T(2*M_PI * 20E3));
+    return loop;
+}
+
+template<typename T>
+static void tdLoop(double gain, PS_MODE mode, const T in[TD_LOOP_INPUT_NUM], T out[TD_LOOP_OUTPUT_NUM])
+{
+    dsLoopMargins(tdLoopFactors(gain, mode, in), TD_FREQ_BEGIN, TD_FREQ_END, out[0], out[1], out[2]);
+}
+
+/**
+ * The margins of the loop against the difference of the margins solved again on the
+ * shifted stage, the crossover is put at TD_FREQ_CROSS by the compensator gain
+ */
+void TstDual::loopMargins()
+{
+    /** dsLoopMargins is built for DsScalar, the loop inputs take its first seeds */
+    typedef DsScalar DLoop;
+    const double val[TD_LOOP_INPUT_NUM] = {150., 65000., 0.4, 600E-6, 0.5, 0.5};
+    const PS_MODE modes[] = {DCM_MODE, CCM_MODE};
+
+    for(PS_MODE mode : modes)
+    {
+        double lnm, phs;
+        lmLogMagPhase(tdLoopFactors(1., mode, val), 2*M_PI * TD_FREQ_CROSS, lnm, phs);
+        const double gain = std::exp(-lnm);
+
+        DLoop in[TD_LOOP_INPUT_NUM], res[TD_LOOP_OUTPUT_NUM];
+        for(int32_t idx = 0; idx < TD_LOOP_INPUT_NUM; ++idx)
+            in[idx] = DLoop::dVar(val[idx], idx);
+        tdLoop(gain, mode, in, res);
+        QVERIFY(qAbs(res[0].val - TD_FREQ_CROSS) <= 1E-6 * TD_FREQ_CROSS);
+        QVERIFY(res[2].val != 0.);
+
+        double nom[TD_LOOP_OUTPUT_NUM];
+        tdLoop(gain, mode, val, nom);
+        for(int32_t out = 0; out < TD_LOOP_OUTPUT_NUM; ++out)
+            QCOMPARE(res[out].val, nom[out]);
+
+        for(int32_t idx = 0; idx < TD_LOOP_INPUT_NUM; ++idx)
+        {
+            double lo[TD_LOOP_INPUT_NUM], hi[TD_LOOP_INPUT_NUM];
+            std::copy(val, val + TD_LOOP_INPUT_NUM, lo);
+            std::copy(val, val + TD_LOOP_INPUT_NUM, hi);
+            const double step = TD_STEP_CHAIN * val[idx];
+            lo[idx] -= step;
+            hi[idx] += step;
+            double out_lo[TD_LOOP_OUTPUT_NUM], out_hi[TD_LOOP_OUTPUT_NUM];
+            tdLoop(gain, mode, lo, out_lo);
+            tdLoop(gain, mode, hi, out_hi);
+
+            for(int32_t out = 0; out < TD_LOOP_OUTPUT_NUM; ++out)
+            {
+                const double diff = (out_hi[out] - out_lo[out]) / (2. * step);
+                const double scale = qMax(qAbs(diff), 1E-9 * qAbs(res[out].val) / step);
+                QVERIFY2(qAbs(res[out].der[idx] - diff) <= TD_TOL_CHAIN * scale,
+                         qPrintable(QString("mode %1, margin %2 along input %3: dual %4, difference %5")
+                                    .arg(mode).arg(out).arg(idx)
+                                    .arg(res[out].der[idx], 0, 'g', 8).arg(diff, 0, 'g', 8)));
+            }
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TstDual)
+
+#include "tst_dual.moc"
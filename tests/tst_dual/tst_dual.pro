@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_dual
+
+SOURCES += \
+    tst_dual.cpp
@@ -0,0 +1,112 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include "inc/lcfilter.h"
+
+#define TL_FREQ_BEGIN  10.    //Hz
+#define TL_FREQ_END    10E6   //Hz
+#define TL_PPD         50     //Points per decade of the comparison
+#define TL_REL_TOL     1E-9   //Relative error of the rational form to the ABCD product
+
+class TstLcFilter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void singleStage();
+    void dampedStages();
+    void parasiticStages();
+
+private:
+    void tlCompare(const LfFilter &flt);
+};
+
+/**
+ * @brief tlSpec - 2.2 uH and 100 uF post-filter of a 5 Ohm load, the resonance is near 10.7 kHz
+ */
+static LfSpec tlSpec()
+{
+    LfSpec spec;
+    spec.nominal.ind = 2.2E-6;
+    spec.nominal.cap = 100E-6;
+    spec.src_res = 0.02;
+    spec.load_res = 5.;
+    return spec;
+}
+
+/**
+ * @brief tlCompare - lfTransfFunc and lfResponse over the log grid, the resonances are inside of it
+ */
+void TstLcFilter::tlCompare(const LfFilter &flt)
+{
+    const TransferFunction tf = lfTransfFunc(flt);
+    const int32_t num = static_cast<int32_t>(TL_PPD * std::log10(TL_FREQ_END / TL_FREQ_BEGIN)) + 1;
+    for(int32_t indx = 0; indx < num; ++indx)
+    {
+        const double freq = TL_FREQ_BEGIN * qPow(10., static_cast<double>(indx) / TL_PPD);
+        const std::complex<double> ref = lfResponse(flt, 2 * M_PI * freq);
+        const std::complex<double> val = tf.tfEval(2 * M_PI * freq);
+        const double err = std::abs(val - ref) / std::abs(ref);
+        QVERIFY2(err < TL_REL_TOL, qPrintable(QString("%1 Hz: rational %2%3j, ABCD %4%5j")
+                                              .arg(freq, 0, 'g', 8)
+                                              .arg(val.real(), 0, 'g', 12).arg(val.imag(), 0, 'g', 12)
+                                              .arg(ref.real(), 0, 'g', 12).arg(ref.imag(), 0, 'g', 12)));
+    }
+}
+
+/**
+ * The ideal parts, the second order low pass with the DCR of the inductor
+ */
+void TstLcFilter::singleStage()
+{
+    LfSpec spec = tlSpec();
+    spec.nominal.ind_res = 5E-3;
+    tlCompare(lfBuild(spec, spec.nominal.ind, spec.nominal.cap, 0.));
+}
+
+/**
+ * The R_d-C_d legs add the real zero of each stage
+ */
+void TstLcFilter::dampedStages()
+{
+    LfSpec spec = tlSpec();
+    spec.stages = 2;
+    spec.nominal.ind_res = 5E-3;
+    spec.nominal.cap_esr = 2E-3;
+    tlCompare(lfBuild(spec, spec.nominal.ind, spec.nominal.cap, qSqrt(spec.nominal.ind / spec.nominal.cap)));
+}
+
+/**
+ * The ESL of the capacitors gives the notch above the resonance, the identical stages the multiple roots
+ */
+void TstLcFilter::parasiticStages()
+{
+    LfSpec spec = tlSpec();
+    spec.stages = LF_MAX_STAGES;
+    spec.nominal.ind_res = 5E-3;
+    spec.nominal.cap_esr = 5E-3;
+    spec.nominal.cap_esl = 2E-9;
+    tlCompare(lfBuild(spec, spec.nominal.ind, spec.nominal.cap, 0.5 * qSqrt(spec.nominal.ind / spec.nominal.cap)));
+}
+
+QTEST_APPLESS_MAIN(TstLcFilter)
+
+#include "tst_lcfilter.moc"
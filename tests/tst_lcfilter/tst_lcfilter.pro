@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_lcfilter
+
+SOURCES += \
+    tst_lcfilter.cpp
@@ -0,0 +1,123 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include "inc/loopmargin.h"
+
+#define TL_FREQ_BEGIN   1.     //Hz
+#define TL_FREQ_END     1E7    //Hz
+#define TL_FREQ_TOL     1E-9   //Relative
+#define TL_MARG_TOL     1E-7   //Degree or dB
+
+class TstLoopMargin : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void integrator();
+    void integratorWithPole();
+    void thirdOrderLag();
+    void transferFunctionForm();
+};
+
+/**
+ * T(s) = omega_c/s, the crossover at omega_c with 90 deg margin and no -180 deg point
+ */
+void TstLoopMargin::integrator()
+{
+    const double omega_c = 2*M_PI * 2.5E3;
+    BodeFactors bf;
+    bf.gain = omega_c;
+    bf.order = -1;
+
+    const LoopMargins lm = lmSolveMargins(bf, TL_FREQ_BEGIN, TL_FREQ_END);
+    QVERIFY(lm.has_cross);
+    QVERIFY(!lm.has_180);
+    QVERIFY(qAbs(lm.freq_cross / (omega_c / (2*M_PI)) - 1.) < TL_FREQ_TOL);
+    QVERIFY(qAbs(lm.phase_marg - 90.) < TL_MARG_TOL);
+}
+
+/**
+ * T(s) = K/(s(1 + s/p)), |T| = 1 at omega^2 = p^2/2 (sqrt(1 + 4K^2/p^2) - 1),
+ * PM = 90 - atan(omega/p)
+ */
+void TstLoopMargin::integratorWithPole()
+{
+    const double gain = 2*M_PI * 8E3;
+    const double pole = 2*M_PI * 3E3;
+    BodeFactors bf;
+    bf.gain = gain;
+    bf.order = -1;
+    bf.bfAddPole(pole);
+
+    const double omega = pole * std::sqrt(0.5 * (std::sqrt(1. + 4. * gain * gain / (pole * pole)) - 1.));
+    const LoopMargins lm = lmSolveMargins(bf, TL_FREQ_BEGIN, TL_FREQ_END);
+    QVERIFY(lm.has_cross);
+    QVERIFY(!lm.has_180);
+    QVERIFY(qAbs(lm.freq_cross / (omega / (2*M_PI)) - 1.) < TL_FREQ_TOL);
+    QVERIFY(qAbs(lm.phase_marg - (90. - qRadiansToDegrees(std::atan(omega / pole)))) < TL_MARG_TOL);
+}
+
+/**
+ * T(s) = K/(1 + s/p)^3, -180 deg at omega = p*sqrt(3) where |T| = K/8,
+ * |T| = 1 at omega = p*sqrt(K^(2/3) - 1), PM = 180 - 3 atan(omega/p)
+ */
+void TstLoopMargin::thirdOrderLag()
+{
+    const double gain = 5.;
+    const double pole = 2*M_PI * 1E3;
+    BodeFactors bf;
+    bf.gain = gain;
+    for(int32_t indx = 0; indx < 3; ++indx)
+        bf.bfAddPole(pole);
+
+    const double omega_c = pole * std::sqrt(std::pow(gain, 2./3.) - 1.);
+    const LoopMargins lm = lmSolveMargins(bf, TL_FREQ_BEGIN, TL_FREQ_END);
+    QVERIFY(lm.has_cross);
+    QVERIFY(lm.has_180);
+    QVERIFY(qAbs(lm.freq_cross / (omega_c / (2*M_PI)) - 1.) < TL_FREQ_TOL);
+    QVERIFY(qAbs(lm.phase_marg - (180. - 3. * qRadiansToDegrees(std::atan(omega_c / pole)))) < TL_MARG_TOL);
+    QVERIFY(qAbs(lm.freq_180 / (pole * std::sqrt(3.) / (2*M_PI)) - 1.) < TL_FREQ_TOL);
+    QVERIFY(qAbs(lm.gain_marg - 20. * std::log10(8. / gain)) < TL_MARG_TOL);
+}
+
+/**
+ * The transfer function form of the same loop gives the same margins as its factors
+ */
+void TstLoopMargin::transferFunctionForm()
+{
+    BodeFactors bf;
+    bf.gain = 5.;
+    for(int32_t indx = 0; indx < 3; ++indx)
+        bf.bfAddPole(2*M_PI * 1E3);
+
+    const LoopMargins ref = lmSolveMargins(bf, TL_FREQ_BEGIN, TL_FREQ_END);
+    const LoopMargins lm = lmSolveMargins(TransferFunction(bf), TL_FREQ_BEGIN, TL_FREQ_END);
+    QCOMPARE(lm.has_cross, ref.has_cross);
+    QCOMPARE(lm.has_180, ref.has_180);
+    QVERIFY(qAbs(lm.freq_cross / ref.freq_cross - 1.) < TL_FREQ_TOL);
+    QVERIFY(qAbs(lm.phase_marg - ref.phase_marg) < TL_MARG_TOL);
+    QVERIFY(qAbs(lm.freq_180 / ref.freq_180 - 1.) < TL_FREQ_TOL);
+    QVERIFY(qAbs(lm.gain_marg - ref.gain_marg) < TL_MARG_TOL);
+}
+
+QTEST_APPLESS_MAIN(TstLoopMargin)
+
+#include "tst_loopmargin.moc"
@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_loopmargin
+
+SOURCES += \
+    tst_loopmargin.cpp
@@ -0,0 +1,131 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include "inc/measfit.h"
+
+#define TM_POINTS     40000 //Points of the synthetic sweep, the text spans several parse slices
+#define TM_FREQ_MIN   10.   //Hz
+#define TM_FREQ_MAX   1E6   //Hz
+#define TM_PARSE_TOL  1E-14 //Relative error of the parsed value printed with 17 digits
+#define TM_FIT_TOL    1E-6  //Relative error of the recovered parameters
+#define TM_CTR_TRUE   0.8   //CTR of the synthetic response, the design CTR is 1
+#define TM_POLE_TRUE  2500. //Hz, optocoupler pole of the synthetic response, the design pole is 4 kHz
+
+class TstMeasFit : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parseRoundTrip();
+    void fitRecoversParameters();
+    void fitFromMinimum();
+
+private:
+    MfFitModel m_model;
+    QVector<double> m_freq;
+    QVector<double> m_mag;
+    QVector<double> m_phs;
+    QByteArray m_text;
+};
+
+/**
+ * The response of the optocoupler feedback of the true parameters on the log grid,
+ * printed as the frequency, dB and degree lines of the measurement file
+ */
+void TstMeasFit::initTestCase()
+{
+    m_model.target = MF_OPTO_FEEDB;
+    m_model.comp = FCCoeff{2., 2*M_PI * 200., 2*M_PI * 4000., 2*M_PI * 20E3, 2*M_PI * 8000., 0.7};
+    m_model.comp_type = FC_TYPE_2;
+    m_model.opto_ctr = 1.;
+
+    m_freq.resize(TM_POINTS);
+    for(int32_t indx = 0; indx < TM_POINTS; ++indx)
+    {
+        m_freq[indx] = TM_FREQ_MIN * std::pow(TM_FREQ_MAX / TM_FREQ_MIN, indx / (TM_POINTS - 1.));
+    }
+    const double param[MF_PARAM_NUM] = {TM_CTR_TRUE, TM_POLE_TRUE};
+    bkEvalBode(mfModelFactors(m_model, param), m_freq, m_mag, m_phs);
+
+    m_text = "freq,mag,phase\n";
+    for(int32_t indx = 0; indx < TM_POINTS; ++indx)
+    {
+        m_text += QByteArray::number(m_freq[indx], 'g', 17) + ',' + QByteArray::number(m_mag[indx], 'g', 17)
+                + ',' + QByteArray::number(m_phs[indx], 'g', 17) + '\n';
+    }
+    QVERIFY(m_text.size() > MF_CHUNK_BYTES);
+}
+
+void TstMeasFit::parseRoundTrip()
+{
+    const MfMeasure meas = mfParseText(m_text.constData(), m_text.size(), false);
+    QVERIFY2(meas.error.isEmpty(), qPrintable(meas.error));
+    QCOMPARE(meas.freq.size(), TM_POINTS);
+    for(int32_t indx = 0; indx < TM_POINTS; ++indx)
+    {
+        QVERIFY(qAbs(meas.freq[indx] - m_freq[indx]) <= TM_PARSE_TOL * m_freq[indx]);
+        QVERIFY(qAbs(meas.mag[indx] - m_mag[indx]) <= TM_PARSE_TOL * qMax(qAbs(m_mag[indx]), 1.));
+        QVERIFY(qAbs(meas.phs[indx] - m_phs[indx]) <= TM_PARSE_TOL * qMax(qAbs(m_phs[indx]), 1.));
+    }
+}
+
+/**
+ * The fit starts from the design CTR and pole and converges on the parameters of the
+ * synthetic response with the vanishing residual
+ */
+void TstMeasFit::fitRecoversParameters()
+{
+    const MfMeasure meas = mfParseText(m_text.constData(), m_text.size(), false);
+    const MfFitResult res = mfFit(m_model, meas);
+    QVERIFY(res.converged);
+    QVERIFY(!res.stalled);
+    QCOMPARE(res.nominal[0], 1.);
+    QVERIFY(qAbs(res.nominal[1] - 4000.) <= 1E-12 * 4000.);
+    QVERIFY2(qAbs(res.fitted[0] - TM_CTR_TRUE) <= TM_FIT_TOL * TM_CTR_TRUE,
+             qPrintable(QString("CTR %1").arg(res.fitted[0], 0, 'g', 12)));
+    QVERIFY2(qAbs(res.fitted[1] - TM_POLE_TRUE) <= TM_FIT_TOL * TM_POLE_TRUE,
+             qPrintable(QString("pole %1 Hz").arg(res.fitted[1], 0, 'g', 12)));
+    QVERIFY(res.rms_mag < 1E-6);
+    QVERIFY(res.rms_phs < 1E-6);
+}
+
+/**
+ * The design values are the ones of the response, no step descends from the start
+ * and the fit ends on the step tolerance as converged, not as stalled
+ */
+void TstMeasFit::fitFromMinimum()
+{
+    MfMeasure meas = mfParseText(m_text.constData(), m_text.size(), false);
+    MfFitModel model = m_model;
+    model.opto_ctr = TM_CTR_TRUE;
+    model.comp.gain *= TM_CTR_TRUE;
+    model.comp.omega_p1 = 2*M_PI * TM_POLE_TRUE;
+    const MfFitResult res = mfFit(model, meas);
+    QVERIFY(res.converged);
+    QVERIFY(!res.stalled);
+    QVERIFY(qAbs(res.fitted[0] - TM_CTR_TRUE) <= TM_FIT_TOL * TM_CTR_TRUE);
+    QVERIFY(qAbs(res.fitted[1] - TM_POLE_TRUE) <= TM_FIT_TOL * TM_POLE_TRUE);
+}
+
+QTEST_APPLESS_MAIN(TstMeasFit)
+
+#include "tst_measfit.moc"
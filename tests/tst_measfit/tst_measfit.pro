@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_measfit
+
+SOURCES += \
+    tst_measfit.cpp
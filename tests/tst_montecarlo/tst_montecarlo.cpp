@@ -0,0 +1,143 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include <cstring>
+#include "inc/montecarlo.h"
+
+#define TM_SAMPLES     4000   //Samples of the run, several pool slices
+#define TM_FREQ_CROSS  1E3    //Hz, nominal crossover of the test loop
+#define TM_FREQ_BEGIN  1.     //Hz
+#define TM_FREQ_END    1E6    //Hz
+
+class TstMonteCarlo : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void threadCountInvariant();
+    void filterPartsApplied();
+
+private:
+    McModel m_model;
+    BodeFactors tmLoop(const LfFilter &filter) const;
+};
+
+/**
+ * @brief tmSame - bitwise equality of the sample vectors, NaN included
+ */
+static bool tmSame(const QVector<double> &lhs, const QVector<double> &rhs)
+{
+    return lhs.size() == rhs.size()
+            && std::memcmp(lhs.constData(), rhs.constData(), static_cast<size_t>(lhs.size()) * sizeof(double)) == 0;
+}
+
+BodeFactors TstMonteCarlo::tmLoop(const LfFilter &filter) const
+{
+    SSMPreDesign ssm = m_model.ssm;
+    PCSSM pcssm(ssm, m_model.mode);
+    BodeFactors bf = pcssm.coBodeFactors();
+    bf.bfAppend(FCCD::coCompFactors(m_model.comp, m_model.comp_type));
+    bf.bfAppend(lfTransfFunc(filter).tfBodeFactors());
+    return bf;
+}
+
+/**
+ * The DCM stage of 12 V 1.5 A with the second LC stage, the compensator gain
+ * puts the nominal crossover at TM_FREQ_CROSS
+ */
+void TstMonteCarlo::initTestCase()
+{
+    m_model.ssm = SSMPreDesign{150, 65000, 0.4f, 600E-6, 0.5, 12, 8.f, 0.1f, 1000E-6, 0.03, 0.5};
+    m_model.mode = DCM_MODE;
+    m_model.comp = FCCoeff{1., 2*M_PI * 100., 2*M_PI * 20E3, 0., 0., 0.};
+    m_model.comp_type = FC_TYPE_2;
+    m_model.filter.stage = {LfStage()};
+    m_model.filter.stage[0].ind = 1E-6;
+    m_model.filter.stage[0].cap = 220E-6;
+    m_model.filter.stage[0].cap_esr = 0.02;
+    m_model.filter.load_res = 8.;
+
+    QVector<double> freq{TM_FREQ_CROSS}, mag, phs;
+    bkEvalBode(tmLoop(m_model.filter), freq, mag, phs);
+    m_model.comp.gain = std::pow(10., -mag[0] / 20.);
+
+    const LoopMargins lm = lmSolveMargins(tmLoop(m_model.filter), TM_FREQ_BEGIN, TM_FREQ_END);
+    QVERIFY(lm.has_cross);
+    QVERIFY(qAbs(lm.freq_cross / TM_FREQ_CROSS - 1.) < 1E-6);
+}
+
+void TstMonteCarlo::cleanup()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount());
+}
+
+/**
+ * Each sample draws from its own stream, the run on the caller thread alone
+ * gives the same samples as the run on the whole pool
+ */
+void TstMonteCarlo::threadCountInvariant()
+{
+    const McLimits lim{45., 10.};
+    const McResult pool = mcRun(m_model, mcDefaultTolerances(), lim, TM_SAMPLES, MC_SEED, TM_FREQ_BEGIN, TM_FREQ_END);
+    QThreadPool::globalInstance()->setMaxThreadCount(1);
+    const McResult single = mcRun(m_model, mcDefaultTolerances(), lim, TM_SAMPLES, MC_SEED, TM_FREQ_BEGIN, TM_FREQ_END);
+
+    QCOMPARE(pool.samples, TM_SAMPLES);
+    QVERIFY(pool.no_cross < TM_SAMPLES);
+    QCOMPARE(pool.passed, single.passed);
+    QCOMPARE(pool.no_cross, single.no_cross);
+    QVERIFY(tmSame(pool.freq_cross, single.freq_cross));
+    QVERIFY(tmSame(pool.phase_marg, single.phase_marg));
+    QVERIFY(tmSame(pool.gain_marg, single.gain_marg));
+}
+
+/**
+ * The fixed multipliers of L and C give the loop of the filter built from the
+ * changed parts, the Q and the ESR zero move with them and not with sqrt(LC) only
+ */
+void TstMonteCarlo::filterPartsApplied()
+{
+    QVector<McTolerance> tol(MC_PARAM_NUM, {MC_DIST_NONE, 1., 1.});
+    tol[MC_LC_IND] = {MC_DIST_UNIFORM, 1.2, 1.2};
+    tol[MC_LC_CAP] = {MC_DIST_UNIFORM, 0.8, 0.8};
+    const McResult res = mcRun(m_model, tol, McLimits{45., 10.}, 1, MC_SEED, TM_FREQ_BEGIN, TM_FREQ_END);
+
+    LfFilter part = m_model.filter;
+    part.stage[0].ind *= 1.2;
+    part.stage[0].cap *= 0.8;
+    const LoopMargins lm = lmSolveMargins(tmLoop(part), TM_FREQ_BEGIN, TM_FREQ_END);
+    QVERIFY(lm.has_cross);
+    QVERIFY(qAbs(res.freq_cross[0] / lm.freq_cross - 1.) < 1E-9);
+    QVERIFY(qAbs(res.phase_marg[0] - lm.phase_marg) < 1E-7);
+
+    /** The same resonance with the nominal Q is another loop */
+    LfFilter stretch = m_model.filter;
+    stretch.stage[0].ind *= std::sqrt(1.2 * 0.8);
+    stretch.stage[0].cap *= std::sqrt(1.2 * 0.8);
+    const LoopMargins lm_str = lmSolveMargins(tmLoop(stretch), TM_FREQ_BEGIN, TM_FREQ_END);
+    QVERIFY(qAbs(res.phase_marg[0] - lm_str.phase_marg) > 1E-3);
+}
+
+QTEST_APPLESS_MAIN(TstMonteCarlo)
+
+#include "tst_montecarlo.moc"
@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_montecarlo
+
+SOURCES += \
+    tst_montecarlo.cpp
@@ -0,0 +1,142 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include "inc/rootlocus.h"
+
+class TstRootLocus : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void analyticRange();
+    void unboundedRange();
+    void unstableNominal();
+    void locusAgreesWithHurwitz();
+
+private:
+    QVector<double> m_gain;
+    double m_ratio = 1.;
+};
+
+/**
+ * @brief trLag - T(s) = K/(s(1 + s/p_1)(1 + s/p_2)), 1 + kT(s) = 0 is stable for k < (p_1 + p_2)/K
+ */
+static TransferFunction trLag(double gain, double pole1, double pole2)
+{
+    BodeFactors bf;
+    bf.gain = gain;
+    bf.order = -1;
+    bf.bfAddPole(pole1);
+    bf.bfAddPole(pole2);
+    return TransferFunction(bf);
+}
+
+void TstRootLocus::init()
+{
+    m_gain = rlGainSpace(RL_GAIN_MIN, RL_GAIN_MAX, RL_GAIN_STEPS);
+    m_ratio = m_gain[1] / m_gain[0];
+}
+
+/**
+ * Both forms end the range on the last grid step below the Routh bound
+ */
+void TstRootLocus::analyticRange()
+{
+    const double gain = 50., pole1 = 100., pole2 = 400.;
+    const double bound = (pole1 + pole2) / gain;
+    const TransferFunction tf = trLag(gain, pole1, pole2);
+
+    double kmin = -1., kmax = -1.;
+    QVERIFY(rlStableRange(rlSolveLocus(tf, m_gain), kmin, kmax));
+    QCOMPARE(kmin, 0.);
+    QVERIFY2(kmax <= bound && kmax * m_ratio > bound, qPrintable(QString("locus kmax %1").arg(kmax, 0, 'g', 12)));
+
+    QVERIFY(rlStableRange(tf, m_gain, kmin, kmax));
+    QCOMPARE(kmin, 0.);
+    QVERIFY2(kmax <= bound && kmax * m_ratio > bound, qPrintable(QString("Hurwitz kmax %1").arg(kmax, 0, 'g', 12)));
+}
+
+/**
+ * T(s) = K/(s(1 + s/p)) is stable for any k
+ */
+void TstRootLocus::unboundedRange()
+{
+    BodeFactors bf;
+    bf.gain = 2*M_PI * 8E3;
+    bf.order = -1;
+    bf.bfAddPole(2*M_PI * 3E3);
+    const TransferFunction tf(bf);
+
+    double kmin = -1., kmax = -1.;
+    QVERIFY(rlStableRange(rlSolveLocus(tf, m_gain), kmin, kmax));
+    QCOMPARE(kmin, 0.);
+    QVERIFY(qIsInf(kmax));
+
+    QVERIFY(rlStableRange(tf, m_gain, kmin, kmax));
+    QCOMPARE(kmin, 0.);
+    QVERIFY(qIsInf(kmax));
+}
+
+/**
+ * The nominal gain above the Routh bound, both forms report the unstable loop
+ */
+void TstRootLocus::unstableNominal()
+{
+    const TransferFunction tf = trLag(1000., 100., 400.);
+    double kmin = 0., kmax = 0.;
+    QVERIFY(!rlStableRange(rlSolveLocus(tf, m_gain), kmin, kmax));
+    QVERIFY(!rlStableRange(tf, m_gain, kmin, kmax));
+}
+
+/**
+ * The ranges of the locus roots and of the Hurwitz test on the loops of the compensator
+ * form, the phase boost zero and the LC pair, agree to the grid step
+ */
+void TstRootLocus::locusAgreesWithHurwitz()
+{
+    const double zero[] = {2*M_PI * 50., 2*M_PI * 300., 2*M_PI * 2E3};
+    for(double omega_z : zero)
+    {
+        BodeFactors bf;
+        bf.gain = 2*M_PI * 1E3;
+        bf.order = -1;
+        bf.bfAddZero(omega_z);
+        bf.bfAddPole(2*M_PI * 4E3);
+        bf.bfAddPolePair(2*M_PI * 8E3, 0.7);
+        const TransferFunction tf(bf);
+
+        double lmin = -1., lmax = -1., hmin = -1., hmax = -1.;
+        const bool lok = rlStableRange(rlSolveLocus(tf, m_gain), lmin, lmax);
+        const bool hok = rlStableRange(tf, m_gain, hmin, hmax);
+        QCOMPARE(lok, hok);
+        if(!lok)
+            continue;
+        QVERIFY2((lmin == 0. && hmin == 0.) || qAbs(lmin / hmin - 1.) <= m_ratio - 1.,
+                 qPrintable(QString("kmin %1 %2").arg(lmin).arg(hmin)));
+        QVERIFY2((qIsInf(lmax) && qIsInf(hmax)) || qAbs(lmax / hmax - 1.) <= m_ratio - 1.,
+                 qPrintable(QString("kmax %1 %2").arg(lmax).arg(hmax)));
+    }
+}
+
+QTEST_APPLESS_MAIN(TstRootLocus)
+
+#include "tst_rootlocus.moc"
@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_rootlocus
+
+SOURCES += \
+    tst_rootlocus.cpp
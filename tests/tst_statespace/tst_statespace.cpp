@@ -0,0 +1,137 @@
+/**
+  Copyright 2021 Anton Emeltsev
+
+  This file is part of FSMPS - asymmetrical converter model estimate.
+
+  FSMPS tools is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  FSMPS tools is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see http://www.gnu.org/licenses/.
+*/
+
+
+#include <QtTest>
+#include "inc/statespace.h"
+
+#define TS_FREQ_NAT    1E3    //Hz, natural frequency of the second order response
+#define TS_STEP_TIME   1E-6   //s, sample period of the step response
+#define TS_STEP_NUM    20000  //Samples of the step response, the response settles well before the end
+#define TS_OVER_TOL    1E-5   //Overshoot error of the sampled peak
+#define TS_EXPM_TOL    1E-12  //Error of the exponential over its largest entry
+
+class TstStateSpace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void secondOrderStep();
+    void expmRotation();
+    void expmJordan();
+
+private:
+    void tsStep(double zeta);
+    void tsExpm(QVector<double> mat, const QVector<double> &ref, int32_t dim);
+};
+
+/**
+ * @brief tsStep - w_0^2/(s^2 + 2 zeta w_0 s + w_0^2), the peak is exp(-pi zeta/sqrt(1 - zeta^2)) over the final value,
+ *        the settling is the last exit of y(t) = 1 - e^{-zeta w_0 t}(cos(w_d t) + zeta/sqrt(1 - zeta^2) sin(w_d t))
+ *        from the band at the samples
+ */
+void TstStateSpace::tsStep(double zeta)
+{
+    const double omega = 2 * M_PI * TS_FREQ_NAT;
+    TransferFunction tf;
+    tf.tfAddPoleQuad(2. * zeta / omega, 1. / (omega * omega));
+    StateSpace ss(tf);
+    QVERIFY(ss.ssValid());
+    QCOMPARE(ss.ssOrder(), 2);
+
+    const StepResponse resp = ss.ssStepResponse(1., TS_STEP_TIME, TS_STEP_NUM);
+    QCOMPARE(resp.out.size(), TS_STEP_NUM);
+    QVERIFY2(qAbs(resp.final - 1.) < 1E-12, qPrintable(QString("final %1").arg(resp.final, 0, 'g', 15)));
+
+    const double root = qSqrt(1. - zeta * zeta);
+    const double over = qExp(-M_PI * zeta / root);
+    QVERIFY2(qAbs(resp.overshoot - over) < TS_OVER_TOL,
+             qPrintable(QString("zeta %1: overshoot %2, analytic %3").arg(zeta).arg(resp.overshoot, 0, 'g', 8).arg(over, 0, 'g', 8)));
+
+    /** The largest excursion is the step itself at t = 0 */
+    const double band = SS_SETTLE_BAND;
+    double settling = 0.;
+    for(int32_t smp = TS_STEP_NUM - 1; smp >= 0; --smp)
+    {
+        const double time = smp * TS_STEP_TIME;
+        const double dev = qExp(-zeta * omega * time) * (qCos(root * omega * time) + zeta / root * qSin(root * omega * time));
+        if(qAbs(dev) > band)
+        {
+            settling = (smp + 1) * TS_STEP_TIME;
+            break;
+        }
+    }
+    QVERIFY2(qAbs(resp.settling - settling) <= TS_STEP_TIME * 1.5,
+             qPrintable(QString("zeta %1: settling %2, analytic %3").arg(zeta).arg(resp.settling, 0, 'g', 8).arg(settling, 0, 'g', 8)));
+
+    /** Within the envelope bound -ln(band sqrt(1 - zeta^2))/(zeta w_0) */
+    const double bound = -qLn(band * root) / (zeta * omega);
+    QVERIFY2(resp.settling <= bound + TS_STEP_TIME, qPrintable(QString("zeta %1: settling %2 over the envelope %3")
+                                                              .arg(zeta).arg(resp.settling, 0, 'g', 8).arg(bound, 0, 'g', 8)));
+}
+
+/**
+ * @brief tsExpm - the exponential against the closed form
+ */
+void TstStateSpace::tsExpm(QVector<double> mat, const QVector<double> &ref, int32_t dim)
+{
+    StateSpace::ssExpm(mat, dim);
+    double scale = 0.;
+    for(double val : ref)
+        scale = qMax(scale, qAbs(val));
+    for(int32_t indx = 0; indx < dim * dim; ++indx)
+    {
+        QVERIFY2(qAbs(mat[indx] - ref[indx]) <= TS_EXPM_TOL * scale,
+                 qPrintable(QString("entry %1: %2, closed form %3").arg(indx).arg(mat[indx], 0, 'g', 15).arg(ref[indx], 0, 'g', 15)));
+    }
+}
+
+/**
+ * The light and the heavy damping, the peak is sampled close to its top
+ */
+void TstStateSpace::secondOrderStep()
+{
+    tsStep(0.2);
+    tsStep(0.5);
+    tsStep(0.7);
+}
+
+/**
+ * expm([0 -t; t 0]) is the rotation by t, the norm of 10 takes the squaring
+ */
+void TstStateSpace::expmRotation()
+{
+    const double ang = 10.;
+    tsExpm({0., -ang, ang, 0.}, {qCos(ang), -qSin(ang), qSin(ang), qCos(ang)}, 2);
+}
+
+/**
+ * expm(lI + N) = e^l (I + N + N^2/2) for N nilpotent of the index 3
+ */
+void TstStateSpace::expmJordan()
+{
+    const double lam = -2., upr = 8., low = 5.;
+    const double el = qExp(lam);
+    tsExpm({lam, upr, 0., 0., lam, low, 0., 0., lam},
+           {el, el * upr, el * upr * low / 2., 0., el, el * low, 0., 0., el}, 3);
+}
+
+QTEST_APPLESS_MAIN(TstStateSpace)
+
+#include "tst_statespace.moc"
@@ -0,0 +1,6 @@
+include(../solver.pri)
+
+TARGET = tst_statespace
+
+SOURCES += \
+    tst_statespace.cpp